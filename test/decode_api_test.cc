@@ -145,6 +145,60 @@ TEST(DecodeAPI, Vp9InvalidDecode) {
   EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec));
 }
 
+TEST(DecodeAPI, Vp9DecodeStats) {
+  const vpx_codec_iface_t *const codec = &vpx_codec_vp9_dx_algo;
+  libvpx_test::IVFVideoSource video("vp90-2-09-subpixel-00.ivf");
+  video.Init();
+  video.Begin();
+  ASSERT_TRUE(!HasFailure());
+
+  vpx_codec_ctx_t dec;
+  vpx_codec_dec_cfg_t cfg = vpx_codec_dec_cfg_t();
+  cfg.threads = 2;
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_dec_init(&dec, codec, &cfg, 0));
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&dec, VP9D_GET_DECODE_STATS, nullptr));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_control(&dec, VP9D_SET_DECODE_STATS, 1));
+
+  const int kFrames = 5;
+  for (int i = 0; i < kFrames && video.cxdata() != nullptr; ++i) {
+    const uint32_t frame_size = static_cast<uint32_t>(video.frame_size());
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_decode(&dec, video.cxdata(), frame_size, nullptr, 0));
+    video.Next();
+  }
+
+  vpx_decode_stats stats;
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_control(&dec, VP9D_GET_DECODE_STATS, &stats));
+  EXPECT_EQ(static_cast<unsigned int>(kFrames), stats.frames);
+  EXPECT_GE(stats.num_threads, 1);
+  EXPECT_LE(stats.num_threads, 2);
+  EXPECT_GE(stats.num_tiles, 1);
+  int64_t total = 0;
+  for (int s = 0; s < VPX_DECODE_STAGES; ++s) {
+    int64_t thread_total = 0;
+    EXPECT_GE(stats.time[s], 0) << s;
+    for (int t = 0; t < stats.num_threads; ++t) {
+      thread_total += stats.thread_time[t][s];
+    }
+    EXPECT_EQ(stats.time[s], thread_total) << s;
+    total += stats.time[s];
+  }
+  EXPECT_GT(total, 0);
+
+  // Disabling the stats keeps the times collected so far.
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_control(&dec, VP9D_SET_DECODE_STATS, 0));
+  const uint32_t frame_size = static_cast<uint32_t>(video.frame_size());
+  EXPECT_EQ(VPX_CODEC_OK,
+            vpx_codec_decode(&dec, video.cxdata(), frame_size, nullptr, 0));
+  vpx_decode_stats stats2;
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_control(&dec, VP9D_GET_DECODE_STATS, &stats2));
+  EXPECT_EQ(stats.frames, stats2.frames);
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec));
+}
+
 void TestPeekInfo(const uint8_t *const data, uint32_t data_sz,
                   uint32_t peek_size) {
   const vpx_codec_iface_t *const codec = &vpx_codec_vp9_dx_algo;
@@ -388,11 +388,6 @@ TEST_P(ExternalFrameBufferMD5Test, ExtFBMD5Match) {
       VP9_MAXIMUM_REF_BUFFERS + VPX_MAXIMUM_WORK_BUFFERS + jitter_buffers;
   set_num_buffers(num_buffers);
 
-#if CONFIG_VP8_DECODER
-  // Tell compiler we are not using kVP8TestVectors.
-  (void)libvpx_test::kVP8TestVectors;
-#endif
-
   // Open compressed video file.
   std::unique_ptr<libvpx_test::CompressedVideoSource> video;
   if (filename.substr(filename.length() - 3, 3) == "ivf") {
@@ -516,4 +511,12 @@ VP9_INSTANTIATE_TEST_SUITE(
     ::testing::ValuesIn(libvpx_test::kVP9TestVectors,
                         libvpx_test::kVP9TestVectors +
                             libvpx_test::kNumVP9TestVectors));
+
+#if CONFIG_VP8_DECODER
+VP8_INSTANTIATE_TEST_SUITE(
+    ExternalFrameBufferMD5Test,
+    ::testing::ValuesIn(libvpx_test::kVP8TestVectors,
+                        libvpx_test::kVP8TestVectors +
+                            libvpx_test::kNumVP8TestVectors));
+#endif  // CONFIG_VP8_DECODER
 }  // namespace
@@ -533,6 +533,15 @@ INSTANTIATE_TEST_SUITE_P(SSE2, VpxMbPostProcDownTest,
                          ::testing::Values(vpx_mbpost_proc_down_sse2));
 #endif  // HAVE_SSE2
 
+#if HAVE_AVX2
+INSTANTIATE_TEST_SUITE_P(
+    AVX2, VpxPostProcDownAndAcrossMbRowTest,
+    ::testing::Values(vpx_post_proc_down_and_across_mb_row_avx2));
+
+INSTANTIATE_TEST_SUITE_P(AVX2, VpxMbPostProcDownTest,
+                         ::testing::Values(vpx_mbpost_proc_down_avx2));
+#endif  // HAVE_AVX2
+
 #if HAVE_NEON
 INSTANTIATE_TEST_SUITE_P(
     NEON, VpxPostProcDownAndAcrossMbRowTest,
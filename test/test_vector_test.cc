@@ -69,6 +69,10 @@ class TestVectorTest : public ::libvpx_test::DecoderTest,
       } else if (mt_mode_ == 2) {
         decoder->Control(VP9D_SET_LOOP_FILTER_OPT, 0);
         decoder->Control(VP9D_SET_ROW_MT, 1);
+      } else if (mt_mode_ == 3) {
+        decoder->Control(VP9D_SET_LOOP_FILTER_OPT, 0);
+        decoder->Control(VP9D_SET_ROW_MT, 1);
+        decoder->Control(VP9D_SET_MC_PREFETCH, 2);
       } else {
         decoder->Control(VP9D_SET_LOOP_FILTER_OPT, 0);
         decoder->Control(VP9D_SET_ROW_MT, 0);
@@ -194,10 +198,11 @@ INSTANTIATE_TEST_SUITE_P(
             static_cast<const libvpx_test::CodecFactory *>(&libvpx_test::kVP9)),
         ::testing::Combine(
             ::testing::Range(2, 9),  // With 2 ~ 8 threads.
-            ::testing::Range(0, 3),  // With multi threads modes 0 ~ 2
+            ::testing::Range(0, 4),  // With multi threads modes 0 ~ 3
                                      // 0: LPF opt and Row MT disabled
                                      // 1: LPF opt enabled
                                      // 2: Row MT enabled
+                                     // 3: Row MT and MC prefetch enabled
             ::testing::ValuesIn(libvpx_test::kVP9TestVectors,
                                 libvpx_test::kVP9TestVectors +
                                     libvpx_test::kNumVP9TestVectors))));
@@ -0,0 +1,145 @@
+/*
+ *  Copyright (c) 2026 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string>
+#include <vector>
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/md5_helper.h"
+#include "test/video_source.h"
+#include "vpx/vp8dx.h"
+#include "vpx/vpx_decoder.h"
+#include "vpx/vpx_frame_buffer.h"
+
+namespace {
+
+const int kFrames = 20;
+
+// Each frame buffer is allocated when the decoder asks for it and freed when
+// it is released, so that a frame still used after its release is caught by
+// the memory checkers, or by its MD5 once the memory is reused. Call number
+// 'fail_at' of Get() fails.
+class FrameBufferList {
+ public:
+  explicit FrameBufferList(int fail_at)
+      : fail_at_(fail_at), num_gets_(0), num_used_(0) {}
+
+  static int Get(void *user_priv, size_t min_size,
+                 vpx_codec_frame_buffer_t *fb) {
+    FrameBufferList *const list = static_cast<FrameBufferList *>(user_priv);
+    if (++list->num_gets_ == list->fail_at_) return -1;
+    fb->data = new uint8_t[min_size]();
+    fb->size = min_size;
+    fb->priv = nullptr;
+    ++list->num_used_;
+    return 0;
+  }
+
+  static int Release(void *user_priv, vpx_codec_frame_buffer_t *fb) {
+    FrameBufferList *const list = static_cast<FrameBufferList *>(user_priv);
+    EXPECT_NE(nullptr, fb->data);
+    delete[] fb->data;
+    --list->num_used_;
+    return 0;
+  }
+
+  int num_gets() const { return num_gets_; }
+  int num_used() const { return num_used_; }
+
+ private:
+  const int fail_at_;
+  int num_gets_;
+  int num_used_;
+};
+
+class VP8FrameBufferTest : public ::libvpx_test::EncoderTest,
+                           public ::testing::Test {
+ protected:
+  VP8FrameBufferTest() : EncoderTest(&::libvpx_test::kVP8) {}
+  virtual ~VP8FrameBufferTest() {}
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(::libvpx_test::kRealTime);
+    cfg_.rc_dropframe_thresh = 0;
+  }
+
+  virtual bool DoDecode() const { return false; }
+
+  virtual void FramePktHook(const vpx_codec_cx_pkt_t *pkt) {
+    packets_.push_back(
+        std::string(reinterpret_cast<const char *>(pkt->data.frame.buf),
+                    pkt->data.frame.sz));
+  }
+
+  // Decodes the packets, with the frame buffers of 'fbs' if it is not null,
+  // and returns the MD5 of every frame. A packet is decoded again if the
+  // frame buffer could not be had the first time.
+  std::vector<std::string> Decode(FrameBufferList *fbs) {
+    vpx_codec_ctx_t dec;
+    std::vector<std::string> md5s;
+
+    EXPECT_EQ(VPX_CODEC_OK,
+              vpx_codec_dec_init(&dec, vpx_codec_vp8_dx(), nullptr, 0));
+    if (fbs != nullptr) {
+      EXPECT_EQ(VPX_CODEC_OK, vpx_codec_set_frame_buffer_functions(
+                                  &dec, FrameBufferList::Get,
+                                  FrameBufferList::Release, fbs));
+    }
+    for (size_t i = 0; i < packets_.size(); ++i) {
+      const uint8_t *const data =
+          reinterpret_cast<const uint8_t *>(packets_[i].data());
+      const unsigned int size = static_cast<unsigned int>(packets_[i].size());
+      if (vpx_codec_decode(&dec, data, size, nullptr, 0) != VPX_CODEC_OK) {
+        EXPECT_EQ(VPX_CODEC_MEM_ERROR, dec.err) << "frame " << i;
+        EXPECT_EQ(VPX_CODEC_OK, vpx_codec_decode(&dec, data, size, nullptr, 0))
+            << "frame " << i;
+      }
+      vpx_codec_iter_t iter = nullptr;
+      const vpx_image_t *const img = vpx_codec_get_frame(&dec, &iter);
+      EXPECT_NE(nullptr, img);
+      if (img == nullptr) break;
+      ::libvpx_test::MD5 md5;
+      md5.Add(img);
+      md5s.push_back(md5.Get());
+    }
+    EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec));
+    return md5s;
+  }
+
+  std::vector<std::string> packets_;
+};
+
+// A frame buffer that cannot be had fails the frame, but leaves the reference
+// frames as they were: decoding the frame again gives the same output.
+TEST_F(VP8FrameBufferTest, GetFailureKeepsReferences) {
+  ::libvpx_test::RandomVideoSource video;
+  video.SetSize(176, 144);
+  video.set_limit(kFrames);
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  ASSERT_EQ(static_cast<size_t>(kFrames), packets_.size());
+
+  const std::vector<std::string> md5s = Decode(nullptr);
+  ASSERT_EQ(static_cast<size_t>(kFrames), md5s.size());
+  FrameBufferList all_fbs(0);
+  EXPECT_TRUE(md5s == Decode(&all_fbs));
+  EXPECT_EQ(0, all_fbs.num_used());
+
+  for (int fail_at = 1; fail_at <= all_fbs.num_gets(); ++fail_at) {
+    FrameBufferList fbs(fail_at);
+    EXPECT_TRUE(md5s == Decode(&fbs)) << "failed get: " << fail_at;
+    EXPECT_EQ(0, fbs.num_used()) << "failed get: " << fail_at;
+  }
+}
+
+}  // namespace
@@ -0,0 +1,122 @@
+/*
+ *  Copyright (c) 2026 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string>
+#include <vector>
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/md5_helper.h"
+#include "test/util.h"
+#include "test/video_source.h"
+#include "vpx/vp8cx.h"
+#include "vpx/vpx_decoder.h"
+
+namespace {
+
+const int kFrames = 20;
+
+// Encodes a random clip with 'log2_partitions' token partitions, which the
+// decoder threads the rows with. The partitions change half way so that the
+// threads are counted again on the next frame. Profile 1 has the simple loop
+// filter, profile 0 the normal one.
+class VP8ThreadTest
+    : public ::libvpx_test::EncoderTest,
+      public ::libvpx_test::CodecTestWith2Params<int, int> {
+ protected:
+  VP8ThreadTest()
+      : EncoderTest(GET_PARAM(0)), log2_partitions_(GET_PARAM(1)),
+        profile_(GET_PARAM(2)) {}
+  virtual ~VP8ThreadTest() {}
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(::libvpx_test::kRealTime);
+    cfg_.g_profile = profile_;
+    cfg_.rc_dropframe_thresh = 0;
+    cfg_.rc_target_bitrate = 300;
+  }
+
+  virtual void PreEncodeFrameHook(::libvpx_test::VideoSource *video,
+                                  ::libvpx_test::Encoder *encoder) {
+    if (video->frame() == 0) {
+      encoder->Control(VP8E_SET_CPUUSED, -6);
+      encoder->Control(VP8E_SET_TOKEN_PARTITIONS, log2_partitions_);
+    } else if (video->frame() == kFrames / 2) {
+      encoder->Control(VP8E_SET_TOKEN_PARTITIONS, VP8_ONE_TOKENPARTITION);
+    }
+  }
+
+  virtual bool DoDecode() const { return false; }
+
+  virtual void FramePktHook(const vpx_codec_cx_pkt_t *pkt) {
+    packets_.push_back(
+        std::string(reinterpret_cast<const char *>(pkt->data.frame.buf),
+                    pkt->data.frame.sz));
+  }
+
+  // Decodes the packets with 'threads' and returns the MD5 of every frame.
+  std::vector<std::string> Decode(int threads) {
+    vpx_codec_dec_cfg_t cfg = vpx_codec_dec_cfg_t();
+    cfg.threads = threads;
+    vpx_codec_ctx_t dec;
+    std::vector<std::string> md5s;
+
+    EXPECT_EQ(VPX_CODEC_OK,
+              vpx_codec_dec_init(&dec, vpx_codec_vp8_dx(), &cfg, 0));
+    for (size_t i = 0; i < packets_.size(); ++i) {
+      EXPECT_EQ(VPX_CODEC_OK,
+                vpx_codec_decode(
+                    &dec, reinterpret_cast<const uint8_t *>(packets_[i].data()),
+                    static_cast<unsigned int>(packets_[i].size()), nullptr, 0))
+          << "frame " << i;
+      vpx_codec_iter_t iter = nullptr;
+      const vpx_image_t *const img = vpx_codec_get_frame(&dec, &iter);
+      EXPECT_NE(nullptr, img);
+      if (img == nullptr) break;
+      ::libvpx_test::MD5 md5;
+      md5.Add(img);
+      md5s.push_back(md5.Get());
+    }
+    EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec));
+    return md5s;
+  }
+
+  int log2_partitions_;
+  int profile_;
+  std::vector<std::string> packets_;
+};
+
+// The rows are decoded and filtered on the threads in the order of a single
+// thread: the frames are the same with any number of threads.
+TEST_P(VP8ThreadTest, MatchesSingleThread) {
+  ::libvpx_test::RandomVideoSource video;
+  video.SetSize(640, 360);
+  video.set_limit(kFrames);
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  ASSERT_EQ(static_cast<size_t>(kFrames), packets_.size());
+
+  const std::vector<std::string> serial = Decode(1);
+  ASSERT_EQ(static_cast<size_t>(kFrames), serial.size());
+  const int kThreads[] = { 2, 8, 16 };
+  for (size_t i = 0; i < sizeof(kThreads) / sizeof(kThreads[0]); ++i) {
+    EXPECT_TRUE(serial == Decode(kThreads[i])) << "threads: " << kThreads[i];
+  }
+}
+
+VP8_INSTANTIATE_TEST_SUITE(VP8ThreadTest,
+                           ::testing::Values(VP8_ONE_TOKENPARTITION,
+                                             VP8_TWO_TOKENPARTITION,
+                                             VP8_EIGHT_TOKENPARTITION),
+                           ::testing::Values(0, 1));
+
+}  // namespace
@@ -0,0 +1,143 @@
+/*
+ *  Copyright (c) 2026 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+
+#include "./vpx_config.h"
+#include "test/md5_helper.h"
+#include "test/vp9_decoder_test_helper.h"
+#include "vpx/vp8dx.h"
+#include "vpx/vpx_decoder.h"
+
+namespace {
+
+using libvpx_test::DecodeParam;
+
+const int kWidth = 352;
+const int kHeight = 288;
+const int kFrames = 40;
+
+class VP9CheckpointTest : public ::testing::TestWithParam<DecodeParam> {
+ protected:
+  virtual void SetUp() {
+    libvpx_test::PatternEncoder encoder(kWidth, kHeight, VPX_DL_REALTIME);
+
+    // Hidden alt-ref frames and the segmentation of the cyclic refresh.
+    encoder.cfg()->g_lag_in_frames = 16;
+    encoder.cfg()->rc_end_usage = VPX_CBR;
+    encoder.cfg()->rc_target_bitrate = 300;
+    ASSERT_NO_FATAL_FAILURE(encoder.Init());
+    EXPECT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(encoder.ctx(), VP8E_SET_CPUUSED, 4));
+    EXPECT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(encoder.ctx(), VP8E_SET_ENABLEAUTOALTREF, 1));
+    EXPECT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(encoder.ctx(), VP9E_SET_AQ_MODE, 3));
+    encoder.EncodeFrames(kFrames);
+    encoder.Flush();
+    packets_ = encoder.packets();
+    ASSERT_EQ(static_cast<size_t>(kFrames), packets_.size());
+  }
+
+  // Decodes the packets [begin, end) and appends the MD5 of their frames.
+  void Decode(vpx_codec_ctx_t *dec, size_t begin, size_t end,
+              std::vector<std::string> *md5s) {
+    for (size_t i = begin; i < end; ++i) {
+      ASSERT_EQ(VPX_CODEC_OK, libvpx_test::DecodePacket(dec, packets_[i]))
+          << vpx_codec_error_detail(dec);
+      vpx_codec_iter_t iter = nullptr;
+      const vpx_image_t *const img = vpx_codec_get_frame(dec, &iter);
+      ASSERT_NE(nullptr, img);
+      libvpx_test::MD5 md5;
+      md5.Add(img);
+      md5s->push_back(md5.Get());
+    }
+  }
+
+  std::vector<std::string> packets_;
+};
+
+TEST(VP9Checkpoint, InvalidCheckpoint) {
+  vpx_codec_ctx_t dec;
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_dec_init(&dec, vpx_codec_vp9_dx(), nullptr, 0));
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&dec, VP9D_SAVE_CHECKPOINT, -1));
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&dec, VP9D_RESTORE_CHECKPOINT,
+                              VP9_MAX_DECODER_CHECKPOINTS));
+  // Nothing decoded yet.
+  EXPECT_EQ(VPX_CODEC_ERROR, vpx_codec_control(&dec, VP9D_SAVE_CHECKPOINT, 0));
+  EXPECT_EQ(VPX_CODEC_ERROR,
+            vpx_codec_control(&dec, VP9D_RESTORE_CHECKPOINT, 0));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_control(&dec, VP9D_RELEASE_CHECKPOINT, 0));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec));
+}
+
+TEST_P(VP9CheckpointTest, RestoreMatchesDecode) {
+  const size_t kCheckpoints[] = { 5, 17, 31 };
+  vpx_codec_ctx_t dec;
+  std::vector<std::string> md5s;
+
+  ASSERT_NO_FATAL_FAILURE(libvpx_test::InitDecoder(&dec, GetParam()));
+  for (size_t i = 0; i < 3; ++i) {
+    ASSERT_NO_FATAL_FAILURE(Decode(&dec, md5s.size(), kCheckpoints[i], &md5s));
+    ASSERT_EQ(VPX_CODEC_OK, vpx_codec_control(&dec, VP9D_SAVE_CHECKPOINT,
+                                              static_cast<int>(i)));
+  }
+  ASSERT_NO_FATAL_FAILURE(Decode(&dec, md5s.size(), packets_.size(), &md5s));
+
+  // Seek back to each checkpoint, out of order, then to the first one again.
+  const int kOrder[] = { 1, 0, 2, 0 };
+  for (int i = 0; i < 4; ++i) {
+    const size_t start = kCheckpoints[kOrder[i]];
+    std::vector<std::string> seek_md5s;
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(&dec, VP9D_RESTORE_CHECKPOINT, kOrder[i]));
+    vpx_codec_iter_t iter = nullptr;
+    EXPECT_EQ(nullptr, vpx_codec_get_frame(&dec, &iter));
+    ASSERT_NO_FATAL_FAILURE(Decode(&dec, start, packets_.size(), &seek_md5s));
+    EXPECT_TRUE(std::equal(seek_md5s.begin(), seek_md5s.end(),
+                           md5s.begin() + start))
+        << "checkpoint " << kOrder[i];
+  }
+
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_control(&dec, VP9D_RELEASE_CHECKPOINT, 1));
+  EXPECT_EQ(VPX_CODEC_ERROR,
+            vpx_codec_control(&dec, VP9D_RESTORE_CHECKPOINT, 1));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec));
+}
+
+TEST_P(VP9CheckpointTest, RestoreAfterCorruptFrame) {
+  vpx_codec_ctx_t dec;
+  std::vector<std::string> md5s;
+  std::vector<std::string> seek_md5s;
+
+  ASSERT_NO_FATAL_FAILURE(libvpx_test::InitDecoder(&dec, GetParam()));
+  ASSERT_NO_FATAL_FAILURE(Decode(&dec, 0, packets_.size(), &md5s));
+  // A checkpoint restored after an error decodes as before it.
+  ASSERT_NO_FATAL_FAILURE(Decode(&dec, 0, 9, &seek_md5s));
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_control(&dec, VP9D_SAVE_CHECKPOINT, 3));
+  const std::string corrupt(packets_[9].size(), '\xff');
+  EXPECT_NE(VPX_CODEC_OK, libvpx_test::DecodePacket(&dec, corrupt));
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_control(&dec, VP9D_RESTORE_CHECKPOINT, 3));
+  ASSERT_NO_FATAL_FAILURE(Decode(&dec, 9, packets_.size(), &seek_md5s));
+  EXPECT_TRUE(md5s == seek_md5s);
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec));
+}
+
+INSTANTIATE_TEST_SUITE_P(VP9, VP9CheckpointTest,
+                         ::testing::ValuesIn(libvpx_test::kDecodeParams));
+
+}  // namespace
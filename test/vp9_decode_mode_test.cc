@@ -0,0 +1,142 @@
+/*
+ *  Copyright (c) 2026 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string>
+#include <vector>
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+
+#include "./vpx_config.h"
+#include "test/md5_helper.h"
+#include "test/vp9_decoder_test_helper.h"
+#include "vpx/vp8cx.h"
+#include "vpx/vp8dx.h"
+#include "vpx/vpx_decoder.h"
+
+namespace {
+
+const int kWidth = 352;
+const int kHeight = 288;
+const int kFrames = 30;
+const int kKeyFrameInterval = 10;
+
+class VP9DecodeModeTest : public ::testing::Test {
+ protected:
+  // Encodes with a key frame every kKeyFrameInterval frames. The odd frames
+  // refresh no reference buffer if 'non_reference' is set.
+  void Encode(bool error_resilient, bool non_reference) {
+    libvpx_test::PatternEncoder encoder(kWidth, kHeight, VPX_DL_REALTIME);
+
+    encoder.cfg()->g_error_resilient = error_resilient;
+    encoder.cfg()->rc_target_bitrate = 300;
+    ASSERT_NO_FATAL_FAILURE(encoder.Init());
+    EXPECT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(encoder.ctx(), VP8E_SET_CPUUSED, 6));
+    for (int frame = 0; frame < kFrames; ++frame) {
+      vpx_enc_frame_flags_t flags = 0;
+      if (frame % kKeyFrameInterval == 0) flags |= VPX_EFLAG_FORCE_KF;
+      if (non_reference && (frame & 1)) {
+        flags |= VP8_EFLAG_NO_UPD_LAST | VP8_EFLAG_NO_UPD_GF |
+                 VP8_EFLAG_NO_UPD_ARF;
+      }
+      encoder.EncodeFrame(flags);
+    }
+    packets_ = encoder.packets();
+    ASSERT_EQ(static_cast<size_t>(kFrames), packets_.size());
+  }
+
+  // Decodes the packets, changing the decode mode to modes[i] before packet
+  // i, and returns the MD5 of the frame output for each packet, or an empty
+  // string if there is none.
+  std::vector<std::string> Decode(const std::vector<vpx_decode_mode> &modes) {
+    vpx_codec_ctx_t dec;
+    std::vector<std::string> md5s;
+
+    EXPECT_EQ(VPX_CODEC_OK,
+              vpx_codec_dec_init(&dec, vpx_codec_vp9_dx(), nullptr, 0));
+    for (size_t i = 0; i < packets_.size(); ++i) {
+      EXPECT_EQ(VPX_CODEC_OK,
+                vpx_codec_control(&dec, VP9D_SET_DECODE_MODE, modes[i]));
+      EXPECT_EQ(VPX_CODEC_OK, libvpx_test::DecodePacket(&dec, packets_[i]))
+          << vpx_codec_error_detail(&dec);
+      vpx_codec_iter_t iter = nullptr;
+      const vpx_image_t *const img = vpx_codec_get_frame(&dec, &iter);
+      if (img == nullptr) {
+        md5s.push_back(std::string());
+        continue;
+      }
+      EXPECT_EQ(nullptr, vpx_codec_get_frame(&dec, &iter));
+      libvpx_test::MD5 md5;
+      md5.Add(img);
+      md5s.push_back(md5.Get());
+    }
+    EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec));
+    return md5s;
+  }
+
+  std::vector<std::string> packets_;
+};
+
+TEST(VP9DecodeMode, InvalidMode) {
+  vpx_codec_ctx_t dec;
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_dec_init(&dec, vpx_codec_vp9_dx(), nullptr, 0));
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&dec, VP9D_SET_DECODE_MODE, 3));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_control(&dec, VP9D_SET_DECODE_MODE,
+                                            VPX_DECODE_KEY_FRAMES));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec));
+}
+
+TEST_F(VP9DecodeModeTest, KeyFrames) {
+  ASSERT_NO_FATAL_FAILURE(Encode(false, false));
+  const std::vector<std::string> full =
+      Decode(std::vector<vpx_decode_mode>(kFrames, VPX_DECODE_ALL_FRAMES));
+
+  // Back to all the frames in the middle of the second group of frames: the
+  // frames are skipped until the next key frame.
+  std::vector<vpx_decode_mode> modes(kFrames, VPX_DECODE_ALL_FRAMES);
+  for (int i = 0; i < kKeyFrameInterval + 5; ++i) {
+    modes[i] = VPX_DECODE_KEY_FRAMES;
+  }
+  const std::vector<std::string> md5s = Decode(modes);
+  ASSERT_EQ(full.size(), md5s.size());
+  for (int i = 0; i < kFrames; ++i) {
+    if (i % kKeyFrameInterval == 0 || i >= 2 * kKeyFrameInterval) {
+      EXPECT_EQ(full[i], md5s[i]) << "frame " << i;
+    } else {
+      EXPECT_EQ("", md5s[i]) << "frame " << i;
+    }
+  }
+}
+
+TEST_F(VP9DecodeModeTest, ReferenceFrames) {
+  ASSERT_NO_FATAL_FAILURE(Encode(true, true));
+  const std::vector<std::string> full =
+      Decode(std::vector<vpx_decode_mode>(kFrames, VPX_DECODE_ALL_FRAMES));
+  const std::vector<std::string> md5s = Decode(
+      std::vector<vpx_decode_mode>(kFrames, VPX_DECODE_REFERENCE_FRAMES));
+  ASSERT_EQ(full.size(), md5s.size());
+  for (int i = 0; i < kFrames; ++i) {
+    EXPECT_NE("", full[i]);
+    EXPECT_EQ((i & 1) ? "" : full[i], md5s[i]) << "frame " << i;
+  }
+}
+
+TEST_F(VP9DecodeModeTest, ReferenceFramesNotErrorResilient) {
+  ASSERT_NO_FATAL_FAILURE(Encode(false, true));
+  const std::vector<std::string> full =
+      Decode(std::vector<vpx_decode_mode>(kFrames, VPX_DECODE_ALL_FRAMES));
+  // The next frames depend on the contexts of the non-reference frames.
+  EXPECT_TRUE(full == Decode(std::vector<vpx_decode_mode>(
+                          kFrames, VPX_DECODE_REFERENCE_FRAMES)));
+}
+
+}  // namespace
@@ -0,0 +1,134 @@
+/*
+ *  Copyright (c) 2026 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string>
+#include <vector>
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+
+#include "./vpx_config.h"
+#include "test/vp9_decoder_test_helper.h"
+#include "vpx/vp8cx.h"
+#include "vpx/vp8dx.h"
+#include "vpx/vpx_decoder.h"
+
+namespace {
+
+using libvpx_test::DecodeParam;
+
+const int kWidth = 640;
+const int kHeight = 360;
+const int kFrames = 8;
+
+// The rows of 'img' within 'rect', one string per row of each plane.
+std::vector<std::string> GetRect(const vpx_image_t *img,
+                                 const vpx_image_rect_t &rect) {
+  std::vector<std::string> rows;
+  for (int plane = 0; plane < 3; ++plane) {
+    const int shift = plane ? 1 : 0;
+    const unsigned int y_end = (rect.y + rect.h + shift) >> shift;
+    for (unsigned int y = rect.y >> shift; y < y_end; ++y) {
+      const uint8_t *const row =
+          img->planes[plane] + y * img->stride[plane] + (rect.x >> shift);
+      rows.push_back(std::string(reinterpret_cast<const char *>(row),
+                                 (rect.w + shift) >> shift));
+    }
+  }
+  return rows;
+}
+
+class VP9DecodeRegionTest : public ::testing::TestWithParam<DecodeParam> {
+ protected:
+  virtual void SetUp() {
+    libvpx_test::PatternEncoder encoder(kWidth, kHeight, VPX_DL_GOOD_QUALITY);
+
+    ASSERT_NO_FATAL_FAILURE(encoder.Init());
+    EXPECT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(encoder.ctx(), VP8E_SET_CPUUSED, 6));
+    // Two tile columns, split at x = 320.
+    EXPECT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(encoder.ctx(), VP9E_SET_TILE_COLUMNS, 1));
+    encoder.EncodeFrames(kFrames);
+    packets_ = encoder.packets();
+    ASSERT_EQ(static_cast<size_t>(kFrames), packets_.size());
+  }
+
+  // Decodes the packets with 'region' set, and returns the pixels of
+  // 'check_rect' in every frame.
+  std::vector<std::vector<std::string> > Decode(
+      const DecodeParam &param, vpx_image_rect_t *region,
+      const vpx_image_rect_t &check_rect) {
+    vpx_codec_ctx_t dec;
+    std::vector<std::vector<std::string> > frames;
+
+    libvpx_test::InitDecoder(&dec, param);
+    EXPECT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(&dec, VP9D_SET_DECODE_REGION, region));
+    for (size_t i = 0; i < packets_.size(); ++i) {
+      EXPECT_EQ(VPX_CODEC_OK, libvpx_test::DecodePacket(&dec, packets_[i]))
+          << vpx_codec_error_detail(&dec);
+      vpx_codec_iter_t iter = nullptr;
+      const vpx_image_t *const img = vpx_codec_get_frame(&dec, &iter);
+      EXPECT_NE(nullptr, img);
+      if (img == nullptr) break;
+      frames.push_back(GetRect(img, check_rect));
+    }
+    EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec));
+    return frames;
+  }
+
+  std::vector<std::string> packets_;
+};
+
+TEST(VP9DecodeRegion, InvalidRegion) {
+  vpx_codec_ctx_t dec;
+  vpx_image_rect_t rect = { 0, 0, 1 << 20, 16 };
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_dec_init(&dec, vpx_codec_vp9_dx(), nullptr, 0));
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&dec, VP9D_SET_DECODE_REGION, &rect));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_control(&dec, VP9D_SET_DECODE_REGION,
+                                            static_cast<vpx_image_rect_t *>(
+                                                nullptr)));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec));
+}
+
+TEST_P(VP9DecodeRegionTest, RegionMatchesFullDecode) {
+  // Away from the tile boundary at x = 320.
+  vpx_image_rect_t region = { 16, 24, 160, 96 };
+  const vpx_image_rect_t far_rect = { 448, 256, 192, 104 };
+  const DecodeParam full_param = { 1, 0 };
+
+  const std::vector<std::vector<std::string> > full =
+      Decode(full_param, nullptr, region);
+  ASSERT_EQ(static_cast<size_t>(kFrames), full.size());
+  EXPECT_TRUE(full == Decode(GetParam(), &region, region));
+
+  // The superblocks far from the region are not reconstructed.
+  const std::vector<std::vector<std::string> > far_full =
+      Decode(full_param, nullptr, far_rect);
+  const std::vector<std::vector<std::string> > far_region =
+      Decode(GetParam(), &region, far_rect);
+  ASSERT_EQ(static_cast<size_t>(kFrames), far_region.size());
+  EXPECT_NE(far_full[0], far_region[0]);
+}
+
+// Row based multi-threading also runs on a single thread.
+const DecodeParam kDecodeParams[] = {
+  { 1, 0 },
+  { 1, 1 },
+  { 4, 0 },
+  { 4, 1 },
+};
+
+INSTANTIATE_TEST_SUITE_P(VP9, VP9DecodeRegionTest,
+                         ::testing::ValuesIn(kDecodeParams));
+
+}  // namespace
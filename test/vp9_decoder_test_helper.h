@@ -0,0 +1,182 @@
+/*
+ *  Copyright (c) 2026 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef VPX_TEST_VP9_DECODER_TEST_HELPER_H_
+#define VPX_TEST_VP9_DECODER_TEST_HELPER_H_
+
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+
+#include "vpx/vp8cx.h"
+#include "vpx/vp8dx.h"
+#include "vpx/vpx_decoder.h"
+#include "vpx/vpx_encoder.h"
+
+// Helpers shared by the tests of the VP9 decoder controls, which encode a
+// synthetic clip and compare the frames decoded in different ways.
+namespace libvpx_test {
+
+// Fills 'img' with frame 'frame' of a pattern of blocks and ramps moving by
+// 3, 5 pixels per frame. 16-bit images are filled with samples of
+// 'bit_depth' bits.
+inline void FillPatternFrame(vpx_image_t *img, int frame, int bit_depth) {
+  const bool high = (img->fmt & VPX_IMG_FMT_HIGHBITDEPTH) != 0;
+  for (int plane = 0; plane < 3; ++plane) {
+    const int shift = plane ? 1 : 0;
+    const int w = (img->d_w + shift) >> shift;
+    const int h = (img->d_h + shift) >> shift;
+    for (int r = 0; r < h; ++r) {
+      uint8_t *const row = img->planes[plane] + r * img->stride[plane];
+      for (int c = 0; c < w; ++c) {
+        const int x = c + 3 * frame;
+        const int y = r + 5 * frame;
+        const int v = ((x >> 3) ^ (y >> 4)) * 17 + plane * 40 + ((x * y) >> 6);
+        if (high) {
+          reinterpret_cast<uint16_t *>(row)[c] = static_cast<uint16_t>(
+              (v << (bit_depth - 8)) & ((1 << bit_depth) - 1));
+        } else {
+          row[c] = static_cast<uint8_t>(v);
+        }
+      }
+    }
+  }
+}
+
+// Encodes the pattern of FillPatternFrame() with VP9 and keeps the compressed
+// frames. cfg() and ctx() are there for the settings of each test.
+class PatternEncoder {
+ public:
+  PatternEncoder(int width, int height, unsigned long deadline)  // NOLINT
+      : iface_(vpx_codec_vp9_cx()), deadline_(deadline), frame_(0),
+        initialized_(false) {
+    EXPECT_EQ(VPX_CODEC_OK, vpx_codec_enc_config_default(iface_, &cfg_, 0));
+    cfg_.g_w = width;
+    cfg_.g_h = height;
+    cfg_.g_lag_in_frames = 0;
+    cfg_.rc_target_bitrate = 500;
+    memset(&img_, 0, sizeof(img_));
+  }
+
+  ~PatternEncoder() {
+    vpx_img_free(&img_);
+    if (initialized_) {
+      EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&enc_));
+    }
+  }
+
+  vpx_codec_enc_cfg_t *cfg() { return &cfg_; }
+  vpx_codec_ctx_t *ctx() { return &enc_; }
+
+  // Initializes the encoder with the settings of cfg(), in high bit depth if
+  // g_bit_depth is more than 8 bits.
+  void Init() {
+    const bool high = cfg_.g_bit_depth > VPX_BITS_8;
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_enc_init(&enc_, iface_, &cfg_,
+                                 high ? VPX_CODEC_USE_HIGHBITDEPTH : 0));
+    initialized_ = true;
+    ASSERT_NE(nullptr,
+              vpx_img_alloc(&img_, high ? VPX_IMG_FMT_I42016 : VPX_IMG_FMT_I420,
+                            cfg_.g_w, cfg_.g_h, 32));
+  }
+
+  // Changes the frame size from the next frame on.
+  void SetSize(unsigned int width, unsigned int height) {
+    cfg_.g_w = width;
+    cfg_.g_h = height;
+    ASSERT_EQ(VPX_CODEC_OK, vpx_codec_enc_config_set(&enc_, &cfg_));
+    const vpx_img_fmt_t fmt = img_.fmt;
+    vpx_img_free(&img_);
+    ASSERT_NE(nullptr, vpx_img_alloc(&img_, fmt, width, height, 32));
+  }
+
+  // Encodes the next frame of the pattern.
+  void EncodeFrame(vpx_enc_frame_flags_t flags) {
+    FillPatternFrame(&img_, frame_, cfg_.g_input_bit_depth);
+    EXPECT_EQ(VPX_CODEC_OK,
+              vpx_codec_encode(&enc_, &img_, frame_, 1, flags, deadline_));
+    ++frame_;
+    GetPackets();
+  }
+
+  void EncodeFrames(int frames) {
+    for (int i = 0; i < frames; ++i) EncodeFrame(0);
+  }
+
+  // Outputs the frames left in the lookahead.
+  void Flush() {
+    EXPECT_EQ(VPX_CODEC_OK,
+              vpx_codec_encode(&enc_, nullptr, frame_, 1, 0, deadline_));
+    GetPackets();
+  }
+
+  const std::vector<std::string> &packets() const { return packets_; }
+  const std::vector<bool> &key_frames() const { return key_frames_; }
+
+ private:
+  void GetPackets() {
+    vpx_codec_iter_t iter = nullptr;
+    const vpx_codec_cx_pkt_t *pkt;
+    while ((pkt = vpx_codec_get_cx_data(&enc_, &iter)) != nullptr) {
+      if (pkt->kind != VPX_CODEC_CX_FRAME_PKT) continue;
+      packets_.push_back(std::string(
+          static_cast<const char *>(pkt->data.frame.buf), pkt->data.frame.sz));
+      key_frames_.push_back((pkt->data.frame.flags & VPX_FRAME_IS_KEY) != 0);
+    }
+  }
+
+  vpx_codec_iface_t *const iface_;
+  const unsigned long deadline_;  // NOLINT
+  vpx_codec_enc_cfg_t cfg_;
+  vpx_codec_ctx_t enc_;
+  vpx_image_t img_;
+  int frame_;
+  bool initialized_;
+  std::vector<std::string> packets_;
+  std::vector<bool> key_frames_;
+};
+
+// The threading of the decoder the tests run with.
+struct DecodeParam {
+  int threads;
+  int row_mt;
+};
+
+inline std::ostream &operator<<(std::ostream &os, const DecodeParam &p) {
+  return os << "threads: " << p.threads << " row_mt: " << p.row_mt;
+}
+
+const DecodeParam kDecodeParams[] = {
+  { 1, 0 },
+  { 4, 0 },
+  { 4, 1 },
+};
+
+inline void InitDecoder(vpx_codec_ctx_t *dec, const DecodeParam &param) {
+  vpx_codec_dec_cfg_t cfg = vpx_codec_dec_cfg_t();
+  cfg.threads = param.threads;
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_dec_init(dec, vpx_codec_vp9_dx(), &cfg, 0));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_control(dec, VP9D_SET_ROW_MT, param.row_mt));
+}
+
+inline vpx_codec_err_t DecodePacket(vpx_codec_ctx_t *dec,
+                                    const std::string &packet) {
+  return vpx_codec_decode(dec, reinterpret_cast<const uint8_t *>(packet.data()),
+                          static_cast<unsigned int>(packet.size()), nullptr,
+                          0);
+}
+
+}  // namespace libvpx_test
+
+#endif  // VPX_TEST_VP9_DECODER_TEST_HELPER_H_
@@ -198,8 +198,9 @@ class EndToEndTestLarge
 };
 
 #if CONFIG_VP9_DECODER
-// The test parameters control VP9D_SET_LOOP_FILTER_OPT and the number of
-// decoder threads.
+// The test parameters control VP9D_SET_LOOP_FILTER_OPT, and
+// VP9D_SET_FUSED_LOOP_FILTER with a single thread, and the number of decoder
+// threads.
 class EndToEndTestLoopFilterThreading
     : public ::libvpx_test::EncoderTest,
       public ::libvpx_test::CodecTestWith2Params<bool, int> {
@@ -233,6 +234,8 @@ class EndToEndTestLoopFilterThreading
                                   ::libvpx_test::Decoder *decoder) {
     if (video->frame() == 0) {
       decoder->Control(VP9D_SET_LOOP_FILTER_OPT, use_loop_filter_opt_ ? 1 : 0);
+      decoder->Control(VP9D_SET_FUSED_LOOP_FILTER,
+                       use_loop_filter_opt_ ? 1 : 0);
     }
   }
 
@@ -349,6 +352,6 @@ VP9_INSTANTIATE_TEST_SUITE(EndToEndTestAdaptiveRDThresh,
 
 #if CONFIG_VP9_DECODER
 VP9_INSTANTIATE_TEST_SUITE(EndToEndTestLoopFilterThreading, ::testing::Bool(),
-                           ::testing::Range(2, 6));
+                           ::testing::Range(1, 6));
 #endif  // CONFIG_VP9_DECODER
 }  // namespace
@@ -15,6 +15,8 @@
 #include "test/encode_test_driver.h"
 #include "test/md5_helper.h"
 #include "test/util.h"
+#include "test/video_source.h"
+#include "test/vp9_decoder_test_helper.h"
 #include "test/y4m_video_source.h"
 #include "vp9/encoder/vp9_firstpass.h"
 
@@ -390,6 +392,97 @@ TEST_P(VPxEncoderThreadTest, EncoderResultTest) {
   EXPECT_NEAR(single_thr_psnr, multi_thr_psnr, 0.2);
 }
 
+class PatternVideoSource : public ::libvpx_test::DummyVideoSource {
+ public:
+  PatternVideoSource(unsigned int width, unsigned int height, int frames) {
+    SetSize(width, height);
+    set_limit(frames);
+  }
+
+ protected:
+  virtual void FillFrame() {
+    if (img_ != nullptr) libvpx_test::FillPatternFrame(img_, frame_, 8);
+  }
+};
+
+// In realtime mode the tiles of each tile row are packed on the threads, as
+// many at once as there are threads.
+class VPxEncoderTileRowsThreadTest
+    : public ::libvpx_test::EncoderTest,
+      public ::libvpx_test::CodecTestWith3Params<int, int, int> {
+ protected:
+  VPxEncoderTileRowsThreadTest()
+      : EncoderTest(GET_PARAM(0)), encoder_initialized_(false),
+        tile_rows_(GET_PARAM(1)), row_mt_mode_(GET_PARAM(2)),
+        set_cpu_used_(GET_PARAM(3)) {}
+  virtual ~VPxEncoderTileRowsThreadTest() {}
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(::libvpx_test::kRealTime);
+
+    cfg_.g_lag_in_frames = 0;
+    cfg_.rc_end_usage = VPX_CBR;
+    cfg_.rc_target_bitrate = 1500;
+    cfg_.g_error_resilient = 1;
+  }
+
+  virtual void BeginPassHook(unsigned int /*pass*/) {
+    encoder_initialized_ = false;
+  }
+
+  virtual void PreEncodeFrameHook(::libvpx_test::VideoSource * /*video*/,
+                                  ::libvpx_test::Encoder *encoder) {
+    if (!encoder_initialized_) {
+      // Encode 4 column tiles.
+      encoder->Control(VP9E_SET_TILE_COLUMNS, 2);
+      encoder->Control(VP9E_SET_TILE_ROWS, tile_rows_);
+      encoder->Control(VP8E_SET_CPUUSED, set_cpu_used_);
+      encoder->Control(VP9E_SET_AQ_MODE, 3);
+      encoder->Control(VP9E_SET_ROW_MT, row_mt_mode_);
+
+      encoder_initialized_ = true;
+    }
+  }
+
+  virtual void FramePktHook(const vpx_codec_cx_pkt_t *pkt) {
+    ::libvpx_test::MD5 md5_res;
+    md5_res.Add(static_cast<const uint8_t *>(pkt->data.frame.buf),
+                pkt->data.frame.sz);
+    md5_.push_back(md5_res.Get());
+  }
+
+  bool encoder_initialized_;
+  int tile_rows_;
+  int row_mt_mode_;
+  int set_cpu_used_;
+  std::vector<std::string> md5_;
+};
+
+// The decoder also checks that each frame matches the one of the encoder.
+TEST_P(VPxEncoderTileRowsThreadTest, BitstreamMatchesSingleThread) {
+  PatternVideoSource video(1024, 576, 10);
+
+  // With row_mt the encode of one thread differs from the others, the packing
+  // of 2 threads is compared with the others then.
+  const int ref_threads = row_mt_mode_ ? 2 : 1;
+  cfg_.g_threads = ref_threads;
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  const std::vector<std::string> ref_md5 = md5_;
+  md5_.clear();
+  ASSERT_EQ(10u, ref_md5.size());
+
+  const int kThreads[] = { 2, 3, 4, 8 };
+  for (int i = 0; i < 4; ++i) {
+    const int threads = kThreads[i];
+    if (threads == ref_threads) continue;
+    cfg_.g_threads = threads;
+    ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+    EXPECT_EQ(ref_md5, md5_) << "threads: " << threads;
+    md5_.clear();
+  }
+}
+
 INSTANTIATE_TEST_SUITE_P(
     VP9, VPxFirstPassEncoderThreadTest,
     ::testing::Combine(
@@ -413,6 +506,15 @@ INSTANTIATE_TEST_SUITE_P(
         ::testing::Range(0, 3),    // tile_columns
         ::testing::Range(2, 5)));  // threads
 
+INSTANTIATE_TEST_SUITE_P(
+    VP9, VPxEncoderTileRowsThreadTest,
+    ::testing::Combine(
+        ::testing::Values(
+            static_cast<const libvpx_test::CodecFactory *>(&libvpx_test::kVP9)),
+        ::testing::Range(1, 3),     // tile_rows
+        ::testing::Range(0, 2),     // row_mt
+        ::testing::Values(7, 8)));  // cpu_used
+
 INSTANTIATE_TEST_SUITE_P(
     VP9Large, VPxEncoderThreadTest,
     ::testing::Combine(
@@ -0,0 +1,139 @@
+/*
+ *  Copyright (c) 2026 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string>
+#include <vector>
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+
+#include "./vpx_config.h"
+#include "test/vp9_decoder_test_helper.h"
+#include "vpx/vp8cx.h"
+#include "vpx/vp8dx.h"
+#include "vpx/vpx_decoder.h"
+
+namespace {
+
+const int kWidth = 352;
+const int kHeight = 288;
+const int kFrames = 40;
+const int kKeyFrame = 30;
+
+class VP9FrameHeaderTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    libvpx_test::PatternEncoder encoder(kWidth, kHeight, VPX_DL_REALTIME);
+
+    encoder.cfg()->g_lag_in_frames = 16;
+    encoder.cfg()->rc_target_bitrate = 300;
+    ASSERT_NO_FATAL_FAILURE(encoder.Init());
+    EXPECT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(encoder.ctx(), VP8E_SET_CPUUSED, 4));
+    EXPECT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(encoder.ctx(), VP8E_SET_ENABLEAUTOALTREF, 1));
+    for (int frame = 0; frame < kFrames; ++frame) {
+      encoder.EncodeFrame(frame == kKeyFrame ? VPX_EFLAG_FORCE_KF : 0);
+    }
+    encoder.Flush();
+    packets_ = encoder.packets();
+    key_frames_ = encoder.key_frames();
+    ASSERT_EQ(static_cast<size_t>(kFrames), packets_.size());
+  }
+
+  std::vector<std::string> packets_;
+  std::vector<bool> key_frames_;
+};
+
+TEST_F(VP9FrameHeaderTest, MatchesDecoder) {
+  vpx_codec_ctx_t dec;
+  vpx_frame_header_info frames[8];
+  int hidden_frames = 0;
+  int key_frames = 0;
+
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_dec_init(&dec, vpx_codec_vp9_dx(), nullptr, 0));
+  for (size_t i = 0; i < packets_.size(); ++i) {
+    const uint8_t *const data =
+        reinterpret_cast<const uint8_t *>(packets_[i].data());
+    vpx_frame_header_list list = { data, packets_[i].size(), frames, 8,
+                                   0 };
+
+    // Parsed ahead of the decoder.
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(&dec, VP9D_PARSE_FRAME_HEADERS, &list));
+    ASSERT_GE(list.num_frames, 1);
+    size_t offset = 0;
+    int shown = 0;
+    for (int j = 0; j < list.num_frames; ++j) {
+      const vpx_frame_header_info &info = frames[j];
+      EXPECT_EQ(offset, info.offset);
+      offset += info.size;
+      shown += info.show_frame;
+      hidden_frames += !info.show_frame;
+      if (info.is_key_frame) {
+        ++key_frames;
+        EXPECT_EQ(0xff, info.refresh_frame_flags);
+        EXPECT_EQ(static_cast<unsigned int>(kWidth), info.width);
+        EXPECT_EQ(static_cast<unsigned int>(kHeight), info.height);
+        EXPECT_EQ(-1, info.ref_frame_idx[0]);
+      } else if (!info.show_existing_frame && !info.intra_only) {
+        for (int k = 0; k < 3; ++k) {
+          EXPECT_GE(info.ref_frame_idx[k], 0);
+          EXPECT_LT(info.ref_frame_idx[k], 8);
+        }
+        // The size does not change.
+        EXPECT_EQ(0, info.size_from_ref);
+      }
+    }
+    EXPECT_LE(offset, packets_[i].size());
+    EXPECT_EQ(1, shown);
+    EXPECT_EQ(key_frames_[i], frames[0].is_key_frame != 0);
+
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_decode(&dec, data,
+                               static_cast<unsigned int>(list.data_sz), nullptr,
+                               0));
+    int ref_updates = -1;
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(&dec, VP8D_GET_LAST_REF_UPDATES, &ref_updates));
+    EXPECT_EQ(frames[list.num_frames - 1].refresh_frame_flags, ref_updates);
+  }
+  EXPECT_EQ(2, key_frames);
+  EXPECT_GT(hidden_frames, 0);
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec));
+}
+
+TEST_F(VP9FrameHeaderTest, InvalidList) {
+  vpx_codec_ctx_t dec;
+  vpx_frame_header_info frames[8];
+  const uint8_t *const data =
+      reinterpret_cast<const uint8_t *>(packets_[0].data());
+
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_dec_init(&dec, vpx_codec_vp9_dx(), nullptr, 0));
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&dec, VP9D_PARSE_FRAME_HEADERS,
+                              static_cast<vpx_frame_header_list *>(nullptr)));
+
+  // Too small for the frames of the chunk.
+  vpx_frame_header_list list = { data, packets_[0].size(), frames, 0, 0 };
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&dec, VP9D_PARSE_FRAME_HEADERS, &list));
+  EXPECT_GE(list.num_frames, 1);
+
+  // The key frame header does not fit in 8 bytes.
+  list.max_frames = 8;
+  list.data_sz = 8;
+  EXPECT_EQ(VPX_CODEC_UNSUP_BITSTREAM,
+            vpx_codec_control(&dec, VP9D_PARSE_FRAME_HEADERS, &list));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec));
+}
+
+}  // namespace
@@ -0,0 +1,175 @@
+/*
+ *  Copyright (c) 2026 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string>
+#include <vector>
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/md5_helper.h"
+#include "test/util.h"
+#include "test/video_source.h"
+#include "test/vp9_decoder_test_helper.h"
+#include "vpx/vp8dx.h"
+
+namespace {
+
+const int kWidth = 352;
+const int kHeight = 288;
+const int kFrames = 30;
+
+// The pattern moves by a few pixels every frame, so that inter frames predict
+// from rows of the reference frames far from the current one.
+class MovingPatternVideoSource : public ::libvpx_test::DummyVideoSource {
+ public:
+  MovingPatternVideoSource() {
+    SetSize(kWidth, kHeight);
+    set_limit(kFrames);
+  }
+
+ protected:
+  virtual void FillFrame() {
+    if (img_ != NULL) libvpx_test::FillPatternFrame(img_, frame_, 8);
+  }
+};
+
+class VP9FrameParallelTest
+    : public ::libvpx_test::EncoderTest,
+      public ::libvpx_test::CodecTestWith2Params<libvpx_test::TestMode, int> {
+ protected:
+  VP9FrameParallelTest()
+      : EncoderTest(GET_PARAM(0)), encoding_mode_(GET_PARAM(1)),
+        frame_parallel_decoding_mode_(GET_PARAM(2)) {}
+
+  virtual ~VP9FrameParallelTest() {}
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(encoding_mode_);
+    cfg_.g_lag_in_frames = 25;
+    cfg_.rc_end_usage = VPX_VBR;
+    cfg_.rc_target_bitrate = 800;
+    cfg_.g_threads = 1;
+  }
+
+  virtual void PreEncodeFrameHook(::libvpx_test::VideoSource *video,
+                                  ::libvpx_test::Encoder *encoder) {
+    if (video->frame() == 0) {
+      encoder->Control(VP8E_SET_CPUUSED, 4);
+      encoder->Control(VP9E_SET_FRAME_PARALLEL_DECODING,
+                       frame_parallel_decoding_mode_);
+      encoder->Control(VP9E_SET_TILE_COLUMNS, 1);
+      if (encoding_mode_ == ::libvpx_test::kRealTime) {
+        encoder->Control(VP9E_SET_AQ_MODE, 3);
+      } else {
+        encoder->Control(VP8E_SET_ENABLEAUTOALTREF, 1);
+      }
+    }
+  }
+
+  virtual bool DoDecode() const { return false; }
+
+  virtual void FramePktHook(const vpx_codec_cx_pkt_t *pkt) {
+    packets_.push_back(
+        std::string(reinterpret_cast<const char *>(pkt->data.frame.buf),
+                    pkt->data.frame.sz));
+  }
+
+  void AddFrames(::libvpx_test::Decoder *decoder,
+                 std::vector<std::string> *md5s) {
+    ::libvpx_test::DxDataIterator dec_iter = decoder->GetDxData();
+    const vpx_image_t *img;
+    while ((img = dec_iter.Next()) != NULL) {
+      ::libvpx_test::MD5 md5;
+      md5.Add(img);
+      md5s->push_back(md5.Get());
+    }
+  }
+
+  // Decodes all the chunks and returns the MD5 of every frame output.
+  std::vector<std::string> DecodeChunks(const std::vector<std::string> &chunks,
+                                        int threads, int frame_parallel) {
+    vpx_codec_dec_cfg_t cfg = vpx_codec_dec_cfg_t();
+    cfg.threads = threads;
+    ::libvpx_test::Decoder *const decoder = codec_->CreateDecoder(cfg, 0);
+    std::vector<std::string> md5s;
+
+    decoder->Control(VP9D_SET_FRAME_PARALLEL, frame_parallel);
+    for (size_t i = 0; i < chunks.size(); ++i) {
+      const vpx_codec_err_t res = decoder->DecodeFrame(
+          reinterpret_cast<const uint8_t *>(chunks[i].data()),
+          chunks[i].size());
+      EXPECT_EQ(VPX_CODEC_OK, res) << decoder->DecodeError();
+      AddFrames(decoder, &md5s);
+    }
+    EXPECT_EQ(VPX_CODEC_OK, decoder->DecodeFrame(NULL, 0));
+    AddFrames(decoder, &md5s);
+
+    delete decoder;
+    return md5s;
+  }
+
+  void ExpectSerialOutput(const std::vector<std::string> &chunks,
+                          size_t num_frames) {
+    const std::vector<std::string> serial = DecodeChunks(chunks, 1, 0);
+    ASSERT_EQ(num_frames, serial.size());
+    for (int threads = 2; threads <= 8; threads *= 2) {
+      const std::vector<std::string> frame_parallel =
+          DecodeChunks(chunks, threads, 1);
+      ASSERT_EQ(serial.size(), frame_parallel.size()) << "threads: " << threads;
+      for (size_t i = 0; i < serial.size(); ++i) {
+        EXPECT_EQ(serial[i], frame_parallel[i])
+            << "threads: " << threads << " frame: " << i;
+      }
+    }
+  }
+
+  ::libvpx_test::TestMode encoding_mode_;
+  int frame_parallel_decoding_mode_;
+  std::vector<std::string> packets_;
+};
+
+TEST_P(VP9FrameParallelTest, MatchesSerialDecode) {
+  MovingPatternVideoSource video;
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  ASSERT_FALSE(packets_.empty());
+  ExpectSerialOutput(packets_, kFrames);
+}
+
+// Frames put one after the other in a chunk without a superframe index are
+// all decoded, and only the last one is output.
+TEST_P(VP9FrameParallelTest, ChunksWithoutIndex) {
+  MovingPatternVideoSource video;
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  ASSERT_FALSE(packets_.empty());
+
+  // Join the packets without a superframe index in pairs.
+  std::vector<std::string> chunks;
+  bool can_join = false;
+  for (size_t i = 0; i < packets_.size(); ++i) {
+    const bool has_index = (packets_[i].back() & 0xe0) == 0xc0;
+    if (can_join && !has_index) {
+      chunks.back() += packets_[i];
+      can_join = false;
+    } else {
+      chunks.push_back(packets_[i]);
+      can_join = !has_index;
+    }
+  }
+  ASSERT_LT(chunks.size(), packets_.size());
+  ExpectSerialOutput(chunks, chunks.size());
+}
+
+VP9_INSTANTIATE_TEST_SUITE(VP9FrameParallelTest,
+                           ::testing::Values(::libvpx_test::kOnePassGood,
+                                             ::libvpx_test::kRealTime),
+                           ::testing::Range(0, 2));
+
+}  // namespace
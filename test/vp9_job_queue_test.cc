@@ -0,0 +1,143 @@
+/*
+ *  Copyright (c) 2026 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <vector>
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "./vpx_config.h"
+#include "vp9/decoder/vp9_job_queue.h"
+#include "vpx_util/vpx_atomics.h"
+#include "vpx_util/vpx_thread.h"
+
+namespace {
+
+const int kMaxWorkers = 8;
+// Jobs form a binary tree, every job queues its two children.
+const int kNumJobs = 4095;
+
+struct TestJob {
+  int id;
+};
+
+class VP9JobQueueTest : public ::testing::TestWithParam<int> {
+ protected:
+  virtual void SetUp() {
+    num_workers_ = GetParam();
+    buf_.resize(kNumJobs * sizeof(TestJob) * num_workers_);
+    vp9_jobq_init(&jobq_, queues_, num_workers_, &buf_[0], buf_.size());
+  }
+
+  virtual void TearDown() { vp9_jobq_deinit(&jobq_); }
+
+  JobQueueRowMt jobq_;
+  JobQueueWorker queues_[kMaxWorkers];
+  std::vector<uint8_t> buf_;
+  int num_workers_;
+};
+
+TEST_P(VP9JobQueueTest, NonBlocking) {
+  TestJob job = { 7 };
+  TestJob out = { 0 };
+
+  EXPECT_EQ(1, vp9_jobq_dequeue(&jobq_, 0, &out, sizeof(out), 0));
+  EXPECT_EQ(0, vp9_jobq_queue(&jobq_, 0, &job, sizeof(job)));
+  // Any worker takes the job, stealing it from worker 0 if needed.
+  EXPECT_EQ(0, vp9_jobq_dequeue(&jobq_, num_workers_ - 1, &out, sizeof(out),
+                                0));
+  EXPECT_EQ(7, out.id);
+  EXPECT_EQ(1, vp9_jobq_dequeue(&jobq_, 0, &out, sizeof(out), 0));
+
+  JobQueueStats stats;
+  vp9_jobq_get_stats(&jobq_, &stats);
+  EXPECT_EQ(num_workers_ > 1 ? 1 : 0, stats.num_steals);
+
+  // Terminating unblocks the workers once the queues are empty.
+  EXPECT_EQ(0, vp9_jobq_queue(&jobq_, 0, &job, sizeof(job)));
+  vp9_jobq_terminate(&jobq_);
+  EXPECT_EQ(0, vp9_jobq_dequeue(&jobq_, 0, &out, sizeof(out), 1));
+  EXPECT_EQ(1, vp9_jobq_dequeue(&jobq_, 0, &out, sizeof(out), 1));
+
+  // Reset empties the queues.
+  vp9_jobq_reset(&jobq_);
+  EXPECT_EQ(0, vp9_jobq_queue(&jobq_, 0, &job, sizeof(job)));
+  vp9_jobq_reset(&jobq_);
+  EXPECT_EQ(1, vp9_jobq_dequeue(&jobq_, 0, &out, sizeof(out), 0));
+}
+
+#if CONFIG_MULTITHREAD
+struct WorkerData {
+  JobQueueRowMt *jobq;
+  vpx_atomic_int *num_done;
+  int worker_id;
+  std::vector<int> ids;
+};
+
+int JobHook(void *arg1, void * /*arg2*/) {
+  WorkerData *const data = static_cast<WorkerData *>(arg1);
+  TestJob job;
+
+  while (!vp9_jobq_dequeue(data->jobq, data->worker_id, &job, sizeof(job),
+                           1)) {
+    data->ids.push_back(job.id);
+    for (int child = 2 * job.id + 1; child <= 2 * job.id + 2; ++child) {
+      if (child < kNumJobs) {
+        TestJob child_job = { child };
+        vp9_jobq_queue(data->jobq, data->worker_id, &child_job,
+                       sizeof(child_job));
+      }
+    }
+    if (vpx_atomic_fetch_add(data->num_done, 1) + 1 == kNumJobs)
+      vp9_jobq_terminate(data->jobq);
+  }
+  return 1;
+}
+
+TEST_P(VP9JobQueueTest, EveryJobDequeuedOnce) {
+  const VPxWorkerInterface *const winterface = vpx_get_worker_interface();
+  VPxWorker workers[kMaxWorkers];
+  WorkerData data[kMaxWorkers];
+  vpx_atomic_int num_done;
+  vpx_atomic_init(&num_done, 0);
+
+  // All the work starts in the queue of the first worker.
+  TestJob root = { 0 };
+  ASSERT_EQ(0, vp9_jobq_queue(&jobq_, 0, &root, sizeof(root)));
+
+  for (int i = 0; i < num_workers_; ++i) {
+    data[i].jobq = &jobq_;
+    data[i].num_done = &num_done;
+    data[i].worker_id = i;
+    winterface->init(&workers[i]);
+    workers[i].hook = JobHook;
+    workers[i].data1 = &data[i];
+    ASSERT_NE(0, winterface->reset(&workers[i]));
+  }
+  for (int i = 0; i < num_workers_; ++i) winterface->launch(&workers[i]);
+  for (int i = 0; i < num_workers_; ++i) {
+    EXPECT_NE(0, winterface->sync(&workers[i]));
+    winterface->end(&workers[i]);
+  }
+
+  std::vector<int> count(kNumJobs, 0);
+  for (int i = 0; i < num_workers_; ++i) {
+    for (size_t j = 0; j < data[i].ids.size(); ++j) ++count[data[i].ids[j]];
+  }
+  for (int id = 0; id < kNumJobs; ++id) EXPECT_EQ(1, count[id]) << id;
+
+  JobQueueStats stats;
+  vp9_jobq_get_stats(&jobq_, &stats);
+  EXPECT_GE(stats.idle_time, 0);
+  if (num_workers_ == 1) EXPECT_EQ(0, stats.num_steals);
+}
+#endif  // CONFIG_MULTITHREAD
+
+INSTANTIATE_TEST_SUITE_P(VP9, VP9JobQueueTest, ::testing::Values(1, 2, 4, 8));
+
+}  // namespace
@@ -0,0 +1,272 @@
+/*
+ *  Copyright (c) 2026 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string.h>
+#include <vector>
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+
+#include "test/acm_random.h"
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/util.h"
+#include "test/video_source.h"
+#include "vp9/common/vp9_loopfilter.h"
+#include "vp9/common/vp9_onyxc_int.h"
+#include "vpx_mem/vpx_mem.h"
+
+namespace {
+
+using libvpx_test::ACMRandom;
+
+const int kWidth = 352;
+const int kHeight = 288;
+const int kFrames = 30;
+
+// Static content with a square moving over it, so that most superblocks keep
+// their mode info and loop filter masks from frame to frame.
+class StaticVideoSource : public ::libvpx_test::DummyVideoSource {
+ public:
+  StaticVideoSource() {
+    SetSize(kWidth, kHeight);
+    set_limit(kFrames);
+  }
+
+ protected:
+  virtual void FillFrame() {
+    if (img_ == nullptr) return;
+    for (int plane = 0; plane < 3; ++plane) {
+      const int w = plane ? kWidth / 2 : kWidth;
+      const int h = plane ? kHeight / 2 : kHeight;
+      const int size = plane ? 16 : 32;
+      const int x0 = (plane ? 8 : 16) + (plane ? 2 : 4) * frame_;
+      const int y0 = plane ? 24 : 48;
+      for (int r = 0; r < h; ++r) {
+        for (int c = 0; c < w; ++c) {
+          int v = ((c >> 3) ^ (r >> 4)) * 17 + plane * 40 + ((c * r) >> 7);
+          if (c >= x0 && c < x0 + size && r >= y0 && r < y0 + size) {
+            v += 7 * frame_;
+          }
+          img_->planes[plane][r * img_->stride[plane] + c] =
+              static_cast<uint8_t>(v);
+        }
+      }
+    }
+  }
+};
+
+class LoopFilterMaskCacheTest
+    : public ::libvpx_test::EncoderTest,
+      public ::libvpx_test::CodecTestWith2Params<libvpx_test::TestMode, int> {
+ protected:
+  LoopFilterMaskCacheTest()
+      : EncoderTest(GET_PARAM(0)), encoding_mode_(GET_PARAM(1)),
+        cpu_used_(GET_PARAM(2)) {}
+
+  virtual ~LoopFilterMaskCacheTest() {}
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(encoding_mode_);
+    cfg_.rc_target_bitrate = 300;
+    // The filter level search of the good quality modes builds the masks
+    // several times per frame.
+    cfg_.g_lag_in_frames =
+        encoding_mode_ == ::libvpx_test::kRealTime ? 0 : 10;
+  }
+
+  virtual void PreEncodeFrameHook(::libvpx_test::VideoSource *video,
+                                  ::libvpx_test::Encoder *encoder) {
+    if (video->frame() == 0) {
+      encoder->Control(VP8E_SET_CPUUSED, cpu_used_);
+      encoder->Control(VP9E_SET_TUNE_CONTENT, VP9E_CONTENT_SCREEN);
+    }
+  }
+
+  libvpx_test::TestMode encoding_mode_;
+  int cpu_used_;
+};
+
+// The encoder and decoder reconstructions match, with the masks of the
+// unchanged superblocks reused by the encoder.
+TEST_P(LoopFilterMaskCacheTest, MatchesDecoder) {
+  StaticVideoSource video;
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+}
+
+VP9_INSTANTIATE_TEST_SUITE(LoopFilterMaskCacheTest,
+                           ::testing::Values(::libvpx_test::kOnePassGood,
+                                             ::libvpx_test::kRealTime),
+                           ::testing::Values(2, 6));
+
+// A frame ending with partial superblocks.
+const int kMiRows = 3 * MI_BLOCK_SIZE + 5;
+const int kMiCols = 4 * MI_BLOCK_SIZE + 3;
+
+// Calls vp9_build_mask_frame() on random mode info and compares the masks it
+// keeps with those vp9_setup_mask() builds from scratch.
+class BuildMaskFrameTest : public ::testing::Test {
+ protected:
+  BuildMaskFrameTest() : rnd_(ACMRandom::DeterministicSeed()), cm_(nullptr) {}
+
+  virtual void SetUp() {
+    cm_ = static_cast<VP9_COMMON *>(vpx_calloc(1, sizeof(*cm_)));
+    ASSERT_NE(nullptr, cm_);
+    cm_->mi_rows = kMiRows;
+    cm_->mi_cols = kMiCols;
+    cm_->mi_stride = kMiCols + MI_BLOCK_SIZE;
+    mi_.resize(cm_->mi_stride * (kMiRows + MI_BLOCK_SIZE));
+    grid_.resize(mi_.size());
+    cm_->mi_grid_visible = &grid_[0];
+    vp9_loop_filter_init(cm_);
+    ASSERT_EQ(0, vp9_alloc_loop_filter(cm_));
+    for (int mi_row = 0; mi_row < kMiRows; mi_row += MI_BLOCK_SIZE) {
+      for (int mi_col = 0; mi_col < kMiCols; mi_col += MI_BLOCK_SIZE)
+        FillPartition(mi_row, mi_col, BLOCK_64X64);
+    }
+  }
+
+  virtual void TearDown() {
+    if (cm_ != nullptr) {
+      vpx_free(cm_->lf.lfm);
+      vpx_free(cm_->lf.lfm_sig);
+    }
+    vpx_free(cm_);
+  }
+
+  void SetBlock(int mi_row, int mi_col, BLOCK_SIZE bsize) {
+    MODE_INFO *const mi = &mi_[mi_row * cm_->mi_stride + mi_col];
+    if (mi_row >= kMiRows || mi_col >= kMiCols) return;
+    memset(mi, 0, sizeof(*mi));
+    mi->sb_type = bsize;
+    mi->tx_size = static_cast<TX_SIZE>(rnd_(max_txsize_lookup[bsize] + 1));
+    mi->skip = rnd_(2);
+    if (rnd_(2)) {
+      mi->ref_frame[0] = static_cast<MV_REFERENCE_FRAME>(LAST_FRAME + rnd_(3));
+      mi->mode = static_cast<PREDICTION_MODE>(NEARESTMV + rnd_(INTER_MODES));
+    } else {
+      mi->ref_frame[0] = INTRA_FRAME;
+      mi->mode = static_cast<PREDICTION_MODE>(rnd_(INTRA_MODES));
+    }
+    for (int r = 0; r < num_8x8_blocks_high_lookup[bsize]; ++r) {
+      for (int c = 0; c < num_8x8_blocks_wide_lookup[bsize]; ++c) {
+        if (mi_row + r < kMiRows && mi_col + c < kMiCols)
+          grid_[(mi_row + r) * cm_->mi_stride + mi_col + c] = mi;
+      }
+    }
+  }
+
+  void FillPartition(int mi_row, int mi_col, BLOCK_SIZE bsize) {
+    const int hbs = num_8x8_blocks_wide_lookup[bsize] / 2;
+    const PARTITION_TYPE partition = static_cast<PARTITION_TYPE>(rnd_(4));
+    const BLOCK_SIZE subsize = get_subsize(bsize, partition);
+    if (mi_row >= kMiRows || mi_col >= kMiCols) return;
+    if (hbs == 0 || partition == PARTITION_NONE) {
+      SetBlock(mi_row, mi_col, subsize);
+    } else if (partition == PARTITION_HORZ) {
+      SetBlock(mi_row, mi_col, subsize);
+      SetBlock(mi_row + hbs, mi_col, subsize);
+    } else if (partition == PARTITION_VERT) {
+      SetBlock(mi_row, mi_col, subsize);
+      SetBlock(mi_row, mi_col + hbs, subsize);
+    } else {
+      FillPartition(mi_row, mi_col, subsize);
+      FillPartition(mi_row, mi_col + hbs, subsize);
+      FillPartition(mi_row + hbs, mi_col, subsize);
+      FillPartition(mi_row + hbs, mi_col + hbs, subsize);
+    }
+  }
+
+  // Builds in 'lfm' the masks of the superblock at mi_row, mi_col.
+  void SetupMask(int mi_row, int mi_col, LOOP_FILTER_MASK *lfm) {
+    vp9_setup_mask(cm_, mi_row, mi_col,
+                   cm_->mi_grid_visible + mi_row * cm_->mi_stride + mi_col,
+                   cm_->mi_stride, lfm);
+  }
+
+  ACMRandom rnd_;
+  VP9_COMMON *cm_;
+  std::vector<MODE_INFO> mi_;
+  std::vector<MODE_INFO *> grid_;
+};
+
+// The masks are the same as without the cache, whatever changes between the
+// frames, once adjusted as the loop filter does.
+TEST_F(BuildMaskFrameTest, MatchesSetupMask) {
+  for (int i = 0; i < 200; ++i) {
+    const int level = 1 + rnd_(MAX_LOOP_FILTER);
+    switch (rnd_(4)) {
+      case 0: {
+        // New partitions.
+        const int mi_row = rnd_(kMiRows) & ~(MI_BLOCK_SIZE - 1);
+        const int mi_col = rnd_(kMiCols) & ~(MI_BLOCK_SIZE - 1);
+        FillPartition(mi_row, mi_col, BLOCK_64X64);
+        break;
+      }
+      case 1: {
+        // The transform size or skip flag of a block.
+        MODE_INFO *const mi =
+            grid_[rnd_(kMiRows) * cm_->mi_stride + rnd_(kMiCols)];
+        mi->tx_size = static_cast<TX_SIZE>(
+            rnd_(max_txsize_lookup[mi->sb_type] + 1));
+        mi->skip = !mi->skip;
+        break;
+      }
+      case 2:
+        // The filter level deltas.
+        cm_->lf.mode_ref_delta_enabled = rnd_(2);
+        cm_->lf.ref_deltas[rnd_(MAX_REF_LF_DELTAS)] = rnd_(31) - 15;
+        cm_->lf.mode_deltas[rnd_(MAX_MODE_LF_DELTAS)] = rnd_(31) - 15;
+        break;
+      default: break;
+    }
+    vp9_build_mask_frame(cm_, level, 0);
+
+    for (int mi_row = 0; mi_row < kMiRows; mi_row += MI_BLOCK_SIZE) {
+      for (int mi_col = 0; mi_col < kMiCols; mi_col += MI_BLOCK_SIZE) {
+        LOOP_FILTER_MASK *const lfm = get_lfm(&cm_->lf, mi_row, mi_col);
+        LOOP_FILTER_MASK ref_lfm;
+        SetupMask(mi_row, mi_col, &ref_lfm);
+        vp9_adjust_mask(cm_, mi_row, mi_col, &ref_lfm);
+        vp9_adjust_mask(cm_, mi_row, mi_col, lfm);
+        ASSERT_EQ(0, memcmp(&ref_lfm, lfm, sizeof(ref_lfm)))
+            << "frame " << i << " at (" << mi_row << ", " << mi_col << ")";
+      }
+    }
+  }
+}
+
+// The masks of the superblocks that don't change are kept, and only their
+// filter levels are updated.
+TEST_F(BuildMaskFrameTest, KeepsUnchangedMasks) {
+  SetBlock(0, 0, BLOCK_64X64);
+  vp9_build_mask_frame(cm_, 20, 0);
+  // Marks the masks, as the masks built again won't be.
+  for (int mi_row = 0; mi_row < kMiRows; mi_row += MI_BLOCK_SIZE) {
+    for (int mi_col = 0; mi_col < kMiCols; mi_col += MI_BLOCK_SIZE)
+      get_lfm(&cm_->lf, mi_row, mi_col)->int_4x4_y ^= 1;
+  }
+
+  for (int i = 0; i < 4; ++i) SetBlock((i >> 1) * 4, (i & 1) * 4, BLOCK_32X32);
+  vp9_build_mask_frame(cm_, 30, 0);
+
+  for (int mi_row = 0; mi_row < kMiRows; mi_row += MI_BLOCK_SIZE) {
+    for (int mi_col = 0; mi_col < kMiCols; mi_col += MI_BLOCK_SIZE) {
+      LOOP_FILTER_MASK lfm = *get_lfm(&cm_->lf, mi_row, mi_col);
+      LOOP_FILTER_MASK ref_lfm;
+      SetupMask(mi_row, mi_col, &ref_lfm);
+      if (mi_row != 0 || mi_col != 0) lfm.int_4x4_y ^= 1;
+      EXPECT_EQ(0, memcmp(&ref_lfm, &lfm, sizeof(ref_lfm)))
+          << "at (" << mi_row << ", " << mi_col << ")";
+    }
+  }
+}
+
+}  // namespace
@@ -0,0 +1,110 @@
+/*
+ *  Copyright (c) 2026 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string>
+#include <vector>
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+
+#include "./vpx_config.h"
+#include "test/md5_helper.h"
+#include "test/vp9_decoder_test_helper.h"
+#include "vpx/vp8cx.h"
+#include "vpx/vp8dx.h"
+#include "vpx/vpx_decoder.h"
+
+namespace {
+
+using libvpx_test::DecodeParam;
+
+const int kFrames = 40;
+const int kFramesPerSize = 10;
+// The frames change size without key frames, down then up again.
+const int kSizes[][2] = {
+  { 352, 288 }, { 176, 144 }, { 104, 72 }, { 320, 240 }
+};
+
+class VP9LowMemoryTest : public ::testing::TestWithParam<DecodeParam> {
+ protected:
+  virtual void SetUp() {
+    libvpx_test::PatternEncoder encoder(kSizes[0][0], kSizes[0][1],
+                                        VPX_DL_REALTIME);
+
+    encoder.cfg()->rc_target_bitrate = 300;
+    encoder.cfg()->kf_mode = VPX_KF_DISABLED;
+    ASSERT_NO_FATAL_FAILURE(encoder.Init());
+    EXPECT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(encoder.ctx(), VP8E_SET_CPUUSED, 6));
+    for (int frame = 0; frame < kFrames; ++frame) {
+      if (frame > 0 && frame % kFramesPerSize == 0) {
+        ASSERT_NO_FATAL_FAILURE(
+            encoder.SetSize(kSizes[frame / kFramesPerSize][0],
+                            kSizes[frame / kFramesPerSize][1]));
+      }
+      encoder.EncodeFrame(0);
+    }
+    packets_ = encoder.packets();
+    ASSERT_EQ(static_cast<size_t>(kFrames), packets_.size());
+    for (int frame = 0; frame < kFrames; ++frame) {
+      EXPECT_EQ(frame == 0, encoder.key_frames()[frame]);
+    }
+  }
+
+  // Returns the MD5 of every decoded frame.
+  std::vector<std::string> Decode(const DecodeParam &param, int low_memory) {
+    vpx_codec_ctx_t dec;
+    std::vector<std::string> md5s;
+
+    libvpx_test::InitDecoder(&dec, param);
+    EXPECT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(&dec, VP9D_SET_LOW_MEMORY, low_memory));
+    for (size_t i = 0; i < packets_.size(); ++i) {
+      EXPECT_EQ(VPX_CODEC_OK, libvpx_test::DecodePacket(&dec, packets_[i]))
+          << vpx_codec_error_detail(&dec);
+      vpx_codec_iter_t iter = nullptr;
+      const vpx_image_t *const img = vpx_codec_get_frame(&dec, &iter);
+      EXPECT_NE(nullptr, img);
+      if (img == nullptr) break;
+      EXPECT_EQ(static_cast<unsigned int>(kSizes[i / kFramesPerSize][0]),
+                img->d_w);
+      libvpx_test::MD5 md5;
+      md5.Add(img);
+      md5s.push_back(md5.Get());
+    }
+    EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec));
+    return md5s;
+  }
+
+  std::vector<std::string> packets_;
+};
+
+TEST(VP9LowMemory, InvalidValue) {
+  vpx_codec_ctx_t dec;
+  const uint8_t data[1] = { 0 };
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_dec_init(&dec, vpx_codec_vp9_dx(), nullptr, 0));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_control(&dec, VP9D_SET_LOW_MEMORY, 2));
+  // Checked when the decoder is initialized, on the first frame.
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_decode(&dec, data, sizeof(data), nullptr, 0));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec));
+}
+
+TEST_P(VP9LowMemoryTest, MatchesDecode) {
+  const DecodeParam full_param = { 1, 0 };
+  const std::vector<std::string> full = Decode(full_param, 0);
+  ASSERT_EQ(static_cast<size_t>(kFrames), full.size());
+  EXPECT_TRUE(full == Decode(GetParam(), 1));
+}
+
+INSTANTIATE_TEST_SUITE_P(VP9, VP9LowMemoryTest,
+                         ::testing::ValuesIn(libvpx_test::kDecodeParams));
+
+}  // namespace
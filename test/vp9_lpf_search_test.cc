@@ -0,0 +1,106 @@
+/*
+ *  Copyright (c) 2026 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string>
+#include <vector>
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/md5_helper.h"
+#include "test/util.h"
+#include "test/video_source.h"
+#include "test/vp9_decoder_test_helper.h"
+
+namespace {
+
+const int kWidth = 1024;
+const int kFrames = 6;
+
+class PatternVideoSource : public ::libvpx_test::DummyVideoSource {
+ public:
+  explicit PatternVideoSource(unsigned int height) {
+    SetSize(kWidth, height);
+    set_limit(kFrames);
+  }
+
+ protected:
+  virtual void FillFrame() {
+    if (img_ != nullptr) libvpx_test::FillPatternFrame(img_, frame_, 8);
+  }
+};
+
+// The loop filter levels are searched on the threads of the tile encode, one
+// level per thread. From speed 4 the frames that are not boosted are searched
+// on one superblock row in four.
+class VP9LpfSearchTest
+    : public ::libvpx_test::EncoderTest,
+      public ::libvpx_test::CodecTestWith2Params<int, int> {
+ protected:
+  VP9LpfSearchTest()
+      : EncoderTest(GET_PARAM(0)), height_(GET_PARAM(1)),
+        set_cpu_used_(GET_PARAM(2)) {}
+
+  virtual ~VP9LpfSearchTest() {}
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(::libvpx_test::kOnePassGood);
+    cfg_.g_lag_in_frames = 0;
+    cfg_.rc_end_usage = VPX_VBR;
+    cfg_.rc_target_bitrate = 800;
+  }
+
+  virtual void PreEncodeFrameHook(::libvpx_test::VideoSource *video,
+                                  ::libvpx_test::Encoder *encoder) {
+    if (video->frame() == 0) {
+      encoder->Control(VP8E_SET_CPUUSED, set_cpu_used_);
+      // Encode 4 column tiles, without row_mt the encode does not depend on
+      // the threads.
+      encoder->Control(VP9E_SET_TILE_COLUMNS, 2);
+      encoder->Control(VP9E_SET_ROW_MT, 0);
+    }
+  }
+
+  virtual void FramePktHook(const vpx_codec_cx_pkt_t *pkt) {
+    ::libvpx_test::MD5 md5;
+    md5.Add(static_cast<const uint8_t *>(pkt->data.frame.buf),
+            pkt->data.frame.sz);
+    md5_.push_back(md5.Get());
+  }
+
+  std::vector<std::string> Encode(int threads) {
+    PatternVideoSource video(height_);
+    cfg_.g_threads = threads;
+    md5_.clear();
+    EXPECT_NO_FATAL_FAILURE(RunLoop(&video));
+    return md5_;
+  }
+
+  int height_;
+  int set_cpu_used_;
+  std::vector<std::string> md5_;
+};
+
+// The levels picked, so the bitstream, do not depend on the threads. The
+// decoder also checks every frame against the encoder's.
+TEST_P(VP9LpfSearchTest, MatchesSingleThread) {
+  const std::vector<std::string> serial = Encode(1);
+  ASSERT_EQ(static_cast<size_t>(kFrames), serial.size());
+  for (int threads = 2; threads <= 4; ++threads) {
+    EXPECT_EQ(serial, Encode(threads)) << "threads: " << threads;
+  }
+}
+
+// 136 is less than LPF_SAMPLE_ROW_STEP superblock rows, 320 is 5 whole rows
+// and 420 is 7 with a partial one.
+VP9_INSTANTIATE_TEST_SUITE(VP9LpfSearchTest, ::testing::Values(136, 320, 420),
+                           ::testing::Values(2, 4));
+
+}  // namespace
@@ -0,0 +1,127 @@
+/*
+ *  Copyright (c) 2026 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string>
+#include <vector>
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/md5_helper.h"
+#include "test/util.h"
+#include "test/video_source.h"
+#include "test/vp9_decoder_test_helper.h"
+
+namespace {
+
+const int kWidth = 1024;
+const int kHeight = 256;
+const int kFrames = 16;
+
+// The pattern moves in the top half of the frames and stays still in the
+// bottom half, which the ARF frames code as a static segment.
+class HalfStaticVideoSource : public ::libvpx_test::DummyVideoSource {
+ public:
+  HalfStaticVideoSource() {
+    SetSize(kWidth, kHeight);
+    set_limit(kFrames);
+  }
+
+ protected:
+  virtual void FillFrame() {
+    if (img_ == nullptr) return;
+    libvpx_test::FillPatternFrame(img_, frame_, 8);
+    for (int plane = 0; plane < 3; ++plane) {
+      const int shift = plane ? 1 : 0;
+      const int w = (img_->d_w + shift) >> shift;
+      const int h = (img_->d_h + shift) >> shift;
+      for (int r = h / 2; r < h; ++r) {
+        uint8_t *const row = img_->planes[plane] + r * img_->stride[plane];
+        for (int c = 0; c < w; ++c) {
+          row[c] = static_cast<uint8_t>(((c >> 3) ^ (r >> 4)) * 17 +
+                                        plane * 40 + ((c * r) >> 6));
+        }
+      }
+    }
+  }
+};
+
+// Encodes with the static segmentation on, so the ARF of every GF group
+// searches the mbgraph stats of the frames up to it, and keeps the MD5 of
+// each compressed frame.
+class VP9MbgraphThreadTest
+    : public ::libvpx_test::EncoderTest,
+      public ::libvpx_test::CodecTestWithParam<int> {
+ protected:
+  VP9MbgraphThreadTest()
+      : EncoderTest(GET_PARAM(0)), set_cpu_used_(GET_PARAM(1)),
+        static_segmentation_(1) {}
+
+  virtual ~VP9MbgraphThreadTest() {}
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(::libvpx_test::kTwoPassGood);
+    cfg_.g_lag_in_frames = 16;
+    cfg_.rc_end_usage = VPX_VBR;
+    cfg_.rc_target_bitrate = 500;
+  }
+
+  virtual void BeginPassHook(unsigned int /*pass*/) { md5_.clear(); }
+
+  virtual void PreEncodeFrameHook(::libvpx_test::VideoSource *video,
+                                  ::libvpx_test::Encoder *encoder) {
+    if (video->frame() == 0) {
+      encoder->Control(VP8E_SET_CPUUSED, set_cpu_used_);
+      encoder->Control(VP8E_SET_ENABLEAUTOALTREF, 1);
+      // Encode 4 column tiles, without row_mt the encode does not depend on
+      // the threads.
+      encoder->Control(VP9E_SET_TILE_COLUMNS, 2);
+      encoder->Control(VP9E_SET_ROW_MT, 0);
+      encoder->Control(VP9E_SET_STATIC_SEGMENTATION, static_segmentation_);
+    }
+  }
+
+  virtual void FramePktHook(const vpx_codec_cx_pkt_t *pkt) {
+    ::libvpx_test::MD5 md5;
+    md5.Add(static_cast<const uint8_t *>(pkt->data.frame.buf),
+            pkt->data.frame.sz);
+    md5_.push_back(md5.Get());
+  }
+
+  std::vector<std::string> Encode(int threads) {
+    HalfStaticVideoSource video;
+    cfg_.g_threads = threads;
+    EXPECT_NO_FATAL_FAILURE(RunLoop(&video));
+    return md5_;
+  }
+
+  int set_cpu_used_;
+  int static_segmentation_;
+  std::vector<std::string> md5_;
+};
+
+// The rows of the mbgraph search are spread over the threads, and the stats,
+// so the segment of every block, are the same as searched serially. The
+// decoder also checks every frame against the encoder's.
+TEST_P(VP9MbgraphThreadTest, SerialMatchesThreaded) {
+  const std::vector<std::string> serial = Encode(1);
+  ASSERT_EQ(static_cast<size_t>(kFrames), serial.size());
+  for (int threads = 2; threads <= 4; ++threads) {
+    EXPECT_EQ(serial, Encode(threads)) << "threads: " << threads;
+  }
+
+  // The segmentation changes the stream, so the stats were searched above.
+  static_segmentation_ = 0;
+  EXPECT_NE(serial, Encode(1));
+}
+
+VP9_INSTANTIATE_TEST_SUITE(VP9MbgraphThreadTest, ::testing::Values(1, 4));
+
+}  // namespace
@@ -0,0 +1,118 @@
+/*
+ *  Copyright (c) 2026 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string.h>
+#include <tuple>
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+
+#include "./vp9_rtcd.h"
+#include "./vpx_config.h"
+#include "test/acm_random.h"
+#include "test/clear_system_state.h"
+#include "test/register_state_check.h"
+#include "test/util.h"
+#include "vp9/common/vp9_postproc.h"
+#include "vpx_ports/mem.h"
+
+namespace {
+
+using libvpx_test::ACMRandom;
+
+typedef void (*FilterByWeightFunc)(const uint8_t *src, int src_stride,
+                                   uint8_t *dst, int dst_stride,
+                                   int src_weight);
+
+// The block size, the C function and the function tested against it.
+typedef std::tuple<int, FilterByWeightFunc, FilterByWeightFunc>
+    FilterByWeightParam;
+
+const int kStride = 48;
+
+class VP9FilterByWeightTest
+    : public ::testing::TestWithParam<FilterByWeightParam> {
+ public:
+  virtual void TearDown() { libvpx_test::ClearSystemState(); }
+
+ protected:
+  // Runs both functions on 'src' and 'dst' with all the weights.
+  void CheckAllWeights(const uint8_t *src, const uint8_t *dst) {
+    const int size = GET_PARAM(0);
+    DECLARE_ALIGNED(16, uint8_t, ref_dst[16 * kStride]);
+    DECLARE_ALIGNED(16, uint8_t, test_dst[16 * kStride]);
+
+    for (int weight = 0; weight <= 1 << MFQE_PRECISION; ++weight) {
+      memcpy(ref_dst, dst, sizeof(ref_dst));
+      memcpy(test_dst, dst, sizeof(test_dst));
+      GET_PARAM(1)(src, kStride, ref_dst, kStride, weight);
+      ASM_REGISTER_STATE_CHECK(
+          GET_PARAM(2)(src, kStride, test_dst, kStride, weight));
+      for (int r = 0; r < 16; ++r) {
+        for (int c = 0; c < kStride; ++c) {
+          ASSERT_EQ(ref_dst[r * kStride + c], test_dst[r * kStride + c])
+              << "weight " << weight << " at (" << r << ", " << c
+              << "), size " << size;
+        }
+      }
+    }
+  }
+};
+GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST(VP9FilterByWeightTest);
+
+TEST_P(VP9FilterByWeightTest, ExtremeValues) {
+  DECLARE_ALIGNED(16, uint8_t, src[16 * kStride]);
+  DECLARE_ALIGNED(16, uint8_t, dst[16 * kStride]);
+
+  memset(src, 255, sizeof(src));
+  memset(dst, 0, sizeof(dst));
+  ASSERT_NO_FATAL_FAILURE(CheckAllWeights(src, dst));
+  ASSERT_NO_FATAL_FAILURE(CheckAllWeights(dst, src));
+}
+
+TEST_P(VP9FilterByWeightTest, MatchesC) {
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  DECLARE_ALIGNED(16, uint8_t, src[16 * kStride]);
+  DECLARE_ALIGNED(16, uint8_t, dst[16 * kStride]);
+
+  for (int i = 0; i < 100; ++i) {
+    for (int j = 0; j < 16 * kStride; ++j) {
+      src[j] = rnd.Rand8();
+      dst[j] = rnd.Rand8();
+    }
+    ASSERT_NO_FATAL_FAILURE(CheckAllWeights(src, dst));
+  }
+}
+
+#if HAVE_SSE2
+INSTANTIATE_TEST_SUITE_P(
+    SSE2, VP9FilterByWeightTest,
+    ::testing::Values(std::make_tuple(16, &vp9_filter_by_weight16x16_c,
+                                      &vp9_filter_by_weight16x16_sse2),
+                      std::make_tuple(8, &vp9_filter_by_weight8x8_c,
+                                      &vp9_filter_by_weight8x8_sse2)));
+#endif  // HAVE_SSE2
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_SUITE_P(
+    AVX2, VP9FilterByWeightTest,
+    ::testing::Values(std::make_tuple(16, &vp9_filter_by_weight16x16_c,
+                                      &vp9_filter_by_weight16x16_avx2)));
+#endif  // HAVE_AVX2
+
+#if HAVE_MSA
+INSTANTIATE_TEST_SUITE_P(
+    MSA, VP9FilterByWeightTest,
+    ::testing::Values(std::make_tuple(16, &vp9_filter_by_weight16x16_c,
+                                      &vp9_filter_by_weight16x16_msa),
+                      std::make_tuple(8, &vp9_filter_by_weight8x8_c,
+                                      &vp9_filter_by_weight8x8_msa)));
+#endif  // HAVE_MSA
+
+}  // namespace
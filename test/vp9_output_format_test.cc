@@ -0,0 +1,205 @@
+/*
+ *  Copyright (c) 2026 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+
+#include "./vpx_config.h"
+#include "test/vp9_decoder_test_helper.h"
+#include "vpx/vp8cx.h"
+#include "vpx/vp8dx.h"
+#include "vpx/vpx_decoder.h"
+#include "vpx/vpx_frame_buffer.h"
+
+namespace {
+
+using libvpx_test::DecodeParam;
+
+// Odd height for the last chroma row.
+const int kWidth = 640;
+const int kHeight = 361;
+const int kFrames = 6;
+
+// Each frame buffer is allocated when requested. The decoder keeps the
+// reference frames until it is destroyed, the buffers are freed with the list.
+class FrameBufferList {
+ public:
+  ~FrameBufferList() {
+    for (size_t i = 0; i < buffers_.size(); ++i) delete[] buffers_[i];
+  }
+
+  static int Get(void *user_priv, size_t min_size,
+                 vpx_codec_frame_buffer_t *fb) {
+    FrameBufferList *const list = static_cast<FrameBufferList *>(user_priv);
+    fb->data = new uint8_t[min_size];
+    fb->size = min_size;
+    fb->priv = nullptr;
+    list->buffers_.push_back(fb->data);
+    return 0;
+  }
+
+  static int Release(void *user_priv, vpx_codec_frame_buffer_t *fb) {
+    FrameBufferList *const list = static_cast<FrameBufferList *>(user_priv);
+    for (size_t i = 0; i < list->buffers_.size(); ++i) {
+      if (list->buffers_[i] == fb->data) {
+        delete[] fb->data;
+        list->buffers_.erase(list->buffers_.begin() + i);
+        return 0;
+      }
+    }
+    ADD_FAILURE() << "Unknown frame buffer released";
+    return -1;
+  }
+
+ private:
+  std::vector<uint8_t *> buffers_;
+};
+
+// Returns 'plane' of 'img' as packed rows of 16-bit samples, taking the
+// interleaved chroma planes of NV12 and P010 apart.
+std::vector<uint16_t> GetPlane(const vpx_image_t *img, int plane) {
+  const bool semi_planar =
+      (img->fmt & ~VPX_IMG_FMT_HIGHBITDEPTH) == VPX_IMG_FMT_NV12;
+  const bool high = (img->fmt & VPX_IMG_FMT_HIGHBITDEPTH) != 0;
+  const int w = plane ? (img->d_w + 1) >> 1 : img->d_w;
+  const int h = plane ? (img->d_h + 1) >> 1 : img->d_h;
+  const int step = plane && semi_planar ? 2 : 1;
+  const int shift = img->fmt == VPX_IMG_FMT_P010 ? 6 : 0;
+  std::vector<uint16_t> samples;
+
+  for (int r = 0; r < h; ++r) {
+    const uint8_t *const row = img->planes[plane] + r * img->stride[plane];
+    for (int c = 0; c < w; ++c) {
+      if (high) {
+        const uint16_t s = reinterpret_cast<const uint16_t *>(row)[c * step];
+        if (shift) {
+          EXPECT_EQ(0, s & ((1 << shift) - 1));
+        }
+        samples.push_back(s >> shift);
+      } else {
+        samples.push_back(row[c * step]);
+      }
+    }
+  }
+  return samples;
+}
+
+// The decoder threading, and whether the frame buffers are external.
+typedef std::tuple<DecodeParam, bool> OutputFormatParam;
+
+class VP9OutputFormatTest
+    : public ::testing::TestWithParam<OutputFormatParam> {
+ protected:
+  void Encode(int bit_depth) {
+    libvpx_test::PatternEncoder encoder(kWidth, kHeight, VPX_DL_GOOD_QUALITY);
+
+    if (bit_depth > 8) {
+      encoder.cfg()->g_profile = 2;
+      encoder.cfg()->g_bit_depth = static_cast<vpx_bit_depth_t>(bit_depth);
+      encoder.cfg()->g_input_bit_depth = bit_depth;
+    }
+    ASSERT_NO_FATAL_FAILURE(encoder.Init());
+    EXPECT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(encoder.ctx(), VP8E_SET_CPUUSED, 6));
+    EXPECT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(encoder.ctx(), VP9E_SET_TILE_COLUMNS, 1));
+    encoder.EncodeFrames(kFrames);
+    packets_ = encoder.packets();
+    ASSERT_EQ(static_cast<size_t>(kFrames), packets_.size());
+  }
+
+  // Decodes the packets with 'fmt' as output format and returns the planes of
+  // every frame.
+  std::vector<std::vector<uint16_t> > Decode(const OutputFormatParam &param,
+                                             vpx_img_fmt_t fmt,
+                                             vpx_img_fmt_t expected_fmt) {
+    vpx_codec_ctx_t dec;
+    std::vector<std::vector<uint16_t> > planes;
+    FrameBufferList fbs;
+
+    libvpx_test::InitDecoder(&dec, std::get<0>(param));
+    EXPECT_EQ(VPX_CODEC_OK, vpx_codec_control(&dec, VP9D_SET_OUTPUT_FORMAT,
+                                              static_cast<int>(fmt)));
+    if (std::get<1>(param)) {
+      EXPECT_EQ(VPX_CODEC_OK, vpx_codec_set_frame_buffer_functions(
+                                  &dec, FrameBufferList::Get,
+                                  FrameBufferList::Release, &fbs));
+    }
+    for (size_t i = 0; i < packets_.size(); ++i) {
+      EXPECT_EQ(VPX_CODEC_OK, libvpx_test::DecodePacket(&dec, packets_[i]))
+          << vpx_codec_error_detail(&dec);
+      vpx_codec_iter_t iter = nullptr;
+      const vpx_image_t *const img = vpx_codec_get_frame(&dec, &iter);
+      EXPECT_NE(nullptr, img);
+      if (img == nullptr) break;
+      EXPECT_EQ(expected_fmt, img->fmt);
+      EXPECT_EQ(static_cast<unsigned int>(kWidth), img->d_w);
+      EXPECT_EQ(static_cast<unsigned int>(kHeight), img->d_h);
+      for (int plane = 0; plane < 3; ++plane) {
+        planes.push_back(GetPlane(img, plane));
+      }
+    }
+    // Only set before the first frame.
+    EXPECT_EQ(VPX_CODEC_ERROR, vpx_codec_control(&dec, VP9D_SET_OUTPUT_FORMAT,
+                                                 VPX_IMG_FMT_NONE));
+    EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec));
+    return planes;
+  }
+
+  std::vector<std::string> packets_;
+};
+
+TEST(VP9OutputFormat, InvalidFormat) {
+  vpx_codec_ctx_t dec;
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_dec_init(&dec, vpx_codec_vp9_dx(), nullptr, 0));
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&dec, VP9D_SET_OUTPUT_FORMAT, VPX_IMG_FMT_I444));
+  EXPECT_EQ(VPX_CODEC_OK,
+            vpx_codec_control(&dec, VP9D_SET_OUTPUT_FORMAT, VPX_IMG_FMT_NV12));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec));
+}
+
+TEST_P(VP9OutputFormatTest, NV12MatchesI420) {
+  ASSERT_NO_FATAL_FAILURE(Encode(8));
+  const OutputFormatParam native(libvpx_test::kDecodeParams[0], false);
+  const std::vector<std::vector<uint16_t> > i420 =
+      Decode(native, VPX_IMG_FMT_NONE, VPX_IMG_FMT_I420);
+  ASSERT_EQ(static_cast<size_t>(3 * kFrames), i420.size());
+  const std::vector<std::vector<uint16_t> > nv12 =
+      Decode(GetParam(), VPX_IMG_FMT_NV12, VPX_IMG_FMT_NV12);
+  EXPECT_TRUE(i420 == nv12);
+
+  // 8-bit frames are not output as P010.
+  EXPECT_TRUE(i420 == Decode(GetParam(), VPX_IMG_FMT_P010, VPX_IMG_FMT_I420));
+}
+
+#if CONFIG_VP9_HIGHBITDEPTH
+TEST_P(VP9OutputFormatTest, P010MatchesI42016) {
+  ASSERT_NO_FATAL_FAILURE(Encode(10));
+  const OutputFormatParam native(libvpx_test::kDecodeParams[0], false);
+  const std::vector<std::vector<uint16_t> > i42016 =
+      Decode(native, VPX_IMG_FMT_NONE, VPX_IMG_FMT_I42016);
+  ASSERT_EQ(static_cast<size_t>(3 * kFrames), i42016.size());
+  const std::vector<std::vector<uint16_t> > p010 =
+      Decode(GetParam(), VPX_IMG_FMT_P010, VPX_IMG_FMT_P010);
+  EXPECT_TRUE(i42016 == p010);
+}
+#endif  // CONFIG_VP9_HIGHBITDEPTH
+
+INSTANTIATE_TEST_SUITE_P(
+    VP9, VP9OutputFormatTest,
+    ::testing::Combine(::testing::ValuesIn(libvpx_test::kDecodeParams),
+                       ::testing::Bool()));
+
+}  // namespace
@@ -0,0 +1,143 @@
+/*
+ *  Copyright (c) 2026 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+
+#include "./vpx_config.h"
+#include "test/util.h"
+#include "test/vp9_decoder_test_helper.h"
+#include "vpx/vp8cx.h"
+#include "vpx/vp8dx.h"
+#include "vpx/vpx_decoder.h"
+
+namespace {
+
+const int kWidth = 640;
+const int kHeight = 360;
+const int kFrames = 8;
+
+int PlaneHeight(const vpx_image_t *img, int plane) {
+  return plane ? (img->d_h + img->y_chroma_shift) >> img->y_chroma_shift
+               : img->d_h;
+}
+
+std::string PlaneRow(const vpx_image_t *img, int plane, int row) {
+  const int bytes_per_sample = (img->fmt & VPX_IMG_FMT_HIGHBITDEPTH) ? 2 : 1;
+  const int w =
+      plane ? (img->d_w + img->x_chroma_shift) >> img->x_chroma_shift
+            : img->d_w;
+  return std::string(reinterpret_cast<const char *>(img->planes[plane]) +
+                         row * img->stride[plane],
+                     w * bytes_per_sample);
+}
+
+// The decoder threading, and whether the loop filter optimizations are on.
+class VP9PutSliceTest : public ::testing::TestWithParam<
+                            std::tuple<libvpx_test::DecodeParam, bool> > {
+ protected:
+  virtual void SetUp() {
+    libvpx_test::PatternEncoder encoder(kWidth, kHeight, VPX_DL_GOOD_QUALITY);
+
+    ASSERT_NO_FATAL_FAILURE(encoder.Init());
+    EXPECT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(encoder.ctx(), VP8E_SET_CPUUSED, 6));
+    // The rows of the tile columns are decoded by different threads.
+    EXPECT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(encoder.ctx(), VP9E_SET_TILE_COLUMNS, 1));
+    encoder.EncodeFrames(kFrames);
+    packets_ = encoder.packets();
+    ASSERT_EQ(static_cast<size_t>(kFrames), packets_.size());
+  }
+
+  static void PutSlice(void *user_priv, const vpx_image_t *img,
+                       const vpx_image_rect_t *valid,
+                       const vpx_image_rect_t *update) {
+    static_cast<VP9PutSliceTest *>(user_priv)->OnSlice(img, valid, update);
+  }
+
+  void OnSlice(const vpx_image_t *img, const vpx_image_rect_t *valid,
+               const vpx_image_rect_t *update) {
+    EXPECT_EQ(0u, valid->x);
+    EXPECT_EQ(0u, valid->y);
+    EXPECT_EQ(img->d_w, valid->w);
+    EXPECT_EQ(0u, update->x);
+    EXPECT_EQ(img->d_w, update->w);
+    EXPECT_EQ(rows_done_, update->y);
+    EXPECT_GT(update->h, 0u);
+    EXPECT_EQ(update->y + update->h, valid->h);
+    EXPECT_LE(valid->h, img->d_h);
+    ++num_slices_;
+
+    // Keep the rows to check they are final.
+    for (int plane = 0; plane < 3; ++plane) {
+      const int shift = plane ? img->y_chroma_shift : 0;
+      const int start = update->y >> shift;
+      const int end = valid->h == img->d_h ? PlaneHeight(img, plane)
+                                           : valid->h >> shift;
+      rows_[plane].resize(PlaneHeight(img, plane));
+      for (int r = start; r < end; ++r) {
+        rows_[plane][r] = PlaneRow(img, plane, r);
+      }
+    }
+    rows_done_ = valid->h;
+  }
+
+  std::vector<std::string> packets_;
+  std::vector<std::string> rows_[3];
+  unsigned int rows_done_;
+  int num_slices_;
+};
+
+TEST_P(VP9PutSliceTest, RowsAreFinal) {
+  const int lpf_opt = GET_PARAM(1);
+  vpx_codec_ctx_t dec;
+
+  ASSERT_NO_FATAL_FAILURE(libvpx_test::InitDecoder(&dec, GET_PARAM(0)));
+  ASSERT_NE(0,
+            vpx_codec_get_caps(vpx_codec_vp9_dx()) & VPX_CODEC_CAP_PUT_SLICE);
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_register_put_slice_cb(&dec, PutSlice, this));
+  EXPECT_EQ(VPX_CODEC_OK,
+            vpx_codec_control(&dec, VP9D_SET_LOOP_FILTER_OPT, lpf_opt));
+  EXPECT_EQ(VPX_CODEC_OK,
+            vpx_codec_control(&dec, VP9D_SET_FUSED_LOOP_FILTER, lpf_opt));
+
+  for (size_t i = 0; i < packets_.size(); ++i) {
+    rows_done_ = 0;
+    num_slices_ = 0;
+    ASSERT_EQ(VPX_CODEC_OK, libvpx_test::DecodePacket(&dec, packets_[i]));
+    vpx_codec_iter_t iter = nullptr;
+    const vpx_image_t *const img = vpx_codec_get_frame(&dec, &iter);
+    ASSERT_NE(nullptr, img);
+    EXPECT_EQ(img->d_h, rows_done_) << "frame: " << i;
+    // The frame is reported as it is decoded, not all at once.
+    EXPECT_GT(num_slices_, 1) << "frame: " << i;
+    for (int plane = 0; plane < 3; ++plane) {
+      ASSERT_EQ(static_cast<size_t>(PlaneHeight(img, plane)),
+                rows_[plane].size());
+      for (int r = 0; r < PlaneHeight(img, plane); ++r) {
+        ASSERT_EQ(PlaneRow(img, plane, r), rows_[plane][r])
+            << "frame: " << i << " plane: " << plane << " row: " << r;
+      }
+    }
+  }
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    VP9, VP9PutSliceTest,
+    ::testing::Combine(::testing::ValuesIn(libvpx_test::kDecodeParams),
+                       ::testing::Bool()));
+
+}  // namespace
@@ -0,0 +1,142 @@
+/*
+ *  Copyright (c) 2026 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string>
+#include <vector>
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+
+#include "./vpx_config.h"
+#include "test/md5_helper.h"
+#include "test/vp9_decoder_test_helper.h"
+#include "vpx/vp8cx.h"
+#include "vpx/vp8dx.h"
+#include "vpx/vpx_decoder.h"
+
+namespace {
+
+const int kWidth = 640;
+const int kHeight = 360;
+const int kFrames = 10;
+const int kThreads = 4;
+
+typedef std::vector<std::string> Packets;
+
+TEST(VP9ThreadPoolTest, InvalidParams) {
+  EXPECT_EQ(nullptr, vpx_thread_pool_create(0));
+  EXPECT_EQ(nullptr, vpx_thread_pool_create(-1));
+  vpx_thread_pool_destroy(nullptr);
+}
+
+#if CONFIG_MULTITHREAD
+Packets Encode(vpx_thread_pool_t *pool) {
+  libvpx_test::PatternEncoder encoder(kWidth, kHeight, VPX_DL_GOOD_QUALITY);
+
+  encoder.cfg()->g_threads = kThreads;
+  EXPECT_NO_FATAL_FAILURE(encoder.Init());
+  EXPECT_EQ(VPX_CODEC_OK,
+            vpx_codec_control(encoder.ctx(), VP8E_SET_CPUUSED, 6));
+  // Two tile columns, for the tile based threading of the decoders.
+  EXPECT_EQ(VPX_CODEC_OK,
+            vpx_codec_control(encoder.ctx(), VP9E_SET_TILE_COLUMNS, 1));
+  EXPECT_EQ(VPX_CODEC_OK,
+            vpx_codec_control(encoder.ctx(), VP9E_SET_THREAD_POOL, pool));
+  encoder.EncodeFrames(kFrames);
+  encoder.Flush();
+
+  // The threads are set up with the first frame.
+  EXPECT_EQ(VPX_CODEC_ERROR,
+            vpx_codec_control(encoder.ctx(), VP9E_SET_THREAD_POOL, pool));
+  return encoder.packets();
+}
+
+class Decoder {
+ public:
+  Decoder(vpx_thread_pool_t *pool, int threads, int row_mt,
+          int frame_parallel) {
+    vpx_codec_dec_cfg_t cfg = vpx_codec_dec_cfg_t();
+    cfg.threads = threads;
+    EXPECT_EQ(VPX_CODEC_OK,
+              vpx_codec_dec_init(&dec_, vpx_codec_vp9_dx(), &cfg, 0));
+    EXPECT_EQ(VPX_CODEC_OK, vpx_codec_control(&dec_, VP9D_SET_ROW_MT, row_mt));
+    EXPECT_EQ(VPX_CODEC_OK, vpx_codec_control(&dec_, VP9D_SET_FRAME_PARALLEL,
+                                              frame_parallel));
+    EXPECT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(&dec_, VP9D_SET_THREAD_POOL, pool));
+  }
+
+  ~Decoder() { EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec_)); }
+
+  // Decodes 'packet', or flushes the decoder if it is null, and records the
+  // MD5 of the frames output.
+  void Decode(const std::string *packet) {
+    const uint8_t *const data =
+        packet ? reinterpret_cast<const uint8_t *>(packet->data()) : nullptr;
+    const unsigned int size = packet ? static_cast<unsigned int>(packet->size())
+                                     : 0;
+    EXPECT_EQ(VPX_CODEC_OK, vpx_codec_decode(&dec_, data, size, nullptr, 0))
+        << vpx_codec_error_detail(&dec_);
+    vpx_codec_iter_t iter = nullptr;
+    vpx_image_t *img;
+    while ((img = vpx_codec_get_frame(&dec_, &iter)) != nullptr) {
+      libvpx_test::MD5 md5;
+      md5.Add(img);
+      md5s_.push_back(md5.Get());
+    }
+  }
+
+  const std::vector<std::string> &md5s() const { return md5s_; }
+
+ private:
+  vpx_codec_ctx_t dec_;
+  std::vector<std::string> md5s_;
+};
+
+TEST(VP9ThreadPoolTest, DecodersMatchSerialDecode) {
+  const Packets packets = Encode(nullptr);
+  ASSERT_EQ(static_cast<size_t>(kFrames), packets.size());
+
+  Decoder serial(nullptr, 1, 0, 0);
+  for (size_t i = 0; i < packets.size(); ++i) serial.Decode(&packets[i]);
+  ASSERT_EQ(static_cast<size_t>(kFrames), serial.md5s().size());
+
+  // Fewer threads in the pool than requested by any of the decoders.
+  for (int pool_threads = 1; pool_threads <= 2; ++pool_threads) {
+    vpx_thread_pool_t *const pool = vpx_thread_pool_create(pool_threads);
+    ASSERT_NE(nullptr, pool);
+    {
+      Decoder tiles(pool, kThreads, 0, 0);
+      Decoder rows(pool, kThreads, 1, 0);
+      Decoder frames(pool, kThreads, 0, 1);
+      Decoder *const decoders[] = { &tiles, &rows, &frames };
+      for (size_t i = 0; i <= packets.size(); ++i) {
+        for (int d = 0; d < 3; ++d) {
+          decoders[d]->Decode(i < packets.size() ? &packets[i] : nullptr);
+        }
+      }
+      for (int d = 0; d < 3; ++d) {
+        EXPECT_EQ(serial.md5s(), decoders[d]->md5s())
+            << "pool threads: " << pool_threads << " decoder: " << d;
+      }
+    }
+    vpx_thread_pool_destroy(pool);
+  }
+}
+
+TEST(VP9ThreadPoolTest, EncoderMatchesOwnThreads) {
+  const Packets packets = Encode(nullptr);
+  vpx_thread_pool_t *const pool = vpx_thread_pool_create(1);
+  ASSERT_NE(nullptr, pool);
+  EXPECT_EQ(packets, Encode(pool));
+  vpx_thread_pool_destroy(pool);
+}
+#endif  // CONFIG_MULTITHREAD
+
+}  // namespace
@@ -9,12 +9,16 @@
  */
 
 #include <string>
+#include <vector>
 
 #include "third_party/googletest/src/include/gtest/gtest.h"
 #include "./vpx_config.h"
 #include "test/codec_factory.h"
 #include "test/decode_test_driver.h"
 #include "test/md5_helper.h"
+#if CONFIG_VP9_ENCODER
+#include "test/vp9_decoder_test_helper.h"
+#endif
 #if CONFIG_WEBM_IO
 #include "test/webm_video_source.h"
 #endif
@@ -316,6 +320,61 @@ TEST(VP9DecodeMultiThreadedTest, NonFrameParallel) {
 }
 #endif  // CONFIG_WEBM_IO
 
+#if CONFIG_VP9_ENCODER
+// Decodes |packets| with |num_threads| and |row_mt|. Returns the md5 of the
+// decoded frames.
+string DecodePackets(const std::vector<string> &packets, int num_threads,
+                     int row_mt) {
+  vpx_codec_dec_cfg_t cfg = vpx_codec_dec_cfg_t();
+  cfg.threads = num_threads;
+  libvpx_test::VP9Decoder decoder(cfg, 0);
+  decoder.Control(VP9D_SET_ROW_MT, row_mt);
+
+  libvpx_test::MD5 md5;
+  for (size_t i = 0; i < packets.size(); ++i) {
+    const vpx_codec_err_t res = decoder.DecodeFrame(
+        reinterpret_cast<const uint8_t *>(packets[i].data()),
+        packets[i].size());
+    if (res != VPX_CODEC_OK) {
+      EXPECT_EQ(VPX_CODEC_OK, res) << decoder.DecodeError();
+      break;
+    }
+
+    libvpx_test::DxDataIterator dec_iter = decoder.GetDxData();
+    const vpx_image_t *img = nullptr;
+    while ((img = dec_iter.Next())) {
+      md5.Add(img);
+    }
+  }
+  return string(md5.Get());
+}
+
+TEST(VP9DecodeMultiThreadedTest, Portrait) {
+  // 720x1280 is 12 superblock columns and 20 rows, filtered by the threads as
+  // a wavefront per plane. The two tile columns are decoded on the threads
+  // before the loop filter of the frame without row_mt, and with it the
+  // filter follows the decoded rows.
+  libvpx_test::PatternEncoder encoder(720, 1280, VPX_DL_REALTIME);
+  encoder.cfg()->rc_target_bitrate = 1000;
+  ASSERT_NO_FATAL_FAILURE(encoder.Init());
+  EXPECT_EQ(VPX_CODEC_OK,
+            vpx_codec_control(encoder.ctx(), VP8E_SET_CPUUSED, 8));
+  EXPECT_EQ(VPX_CODEC_OK,
+            vpx_codec_control(encoder.ctx(), VP9E_SET_TILE_COLUMNS, 1));
+  encoder.EncodeFrames(10);
+  encoder.Flush();
+  ASSERT_EQ(10u, encoder.packets().size());
+
+  const string expected_md5 = DecodePackets(encoder.packets(), 1, 0);
+  for (int row_mt = 0; row_mt <= 1; ++row_mt) {
+    for (int t = 4; t <= 16; t *= 4) {
+      EXPECT_EQ(expected_md5, DecodePackets(encoder.packets(), t, row_mt))
+          << "threads = " << t << " row_mt = " << row_mt;
+    }
+  }
+}
+#endif  // CONFIG_VP9_ENCODER
+
 INSTANTIATE_TEST_SUITE_P(Synchronous, VPxWorkerThreadTest, ::testing::Bool());
 
 }  // namespace
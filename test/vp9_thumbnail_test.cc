@@ -0,0 +1,180 @@
+/*
+ *  Copyright (c) 2026 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+
+#include "./vpx_config.h"
+#include "test/vp9_decoder_test_helper.h"
+#include "vpx/vp8cx.h"
+#include "vpx/vp8dx.h"
+#include "vpx/vpx_decoder.h"
+
+namespace {
+
+// Odd height for the blocks cut at the bottom edge.
+const int kWidth = 640;
+const int kHeight = 361;
+const int kFrames = 4;
+const int kKeyFrame = 2;
+
+struct ThumbnailParam {
+  int scale_log2;
+  libvpx_test::DecodeParam decode;
+};
+
+std::ostream &operator<<(std::ostream &os, const ThumbnailParam &p) {
+  return os << "scale_log2: " << p.scale_log2 << " " << p.decode;
+}
+
+// The luma plane of 'img', scaled down by 1 << scale_log2 the way the decoder
+// does it.
+std::vector<int> ScaleDown(const vpx_image_t *img, int scale_log2) {
+  const int size = 1 << scale_log2;
+  const int w = (img->d_w + size - 1) >> scale_log2;
+  const int h = (img->d_h + size - 1) >> scale_log2;
+  std::vector<int> samples;
+
+  for (int r = 0; r < h; ++r) {
+    for (int c = 0; c < w; ++c) {
+      int sum = 0;
+      int count = 0;
+      for (int y = r * size; y < (r + 1) * size && y < (int)img->d_h; ++y) {
+        for (int x = c * size; x < (c + 1) * size && x < (int)img->d_w; ++x) {
+          sum += img->planes[VPX_PLANE_Y][y * img->stride[VPX_PLANE_Y] + x];
+          ++count;
+        }
+      }
+      samples.push_back((sum + count / 2) / count);
+    }
+  }
+  return samples;
+}
+
+std::vector<int> GetLuma(const vpx_image_t *img) {
+  std::vector<int> samples;
+  for (unsigned int r = 0; r < img->d_h; ++r) {
+    for (unsigned int c = 0; c < img->d_w; ++c)
+      samples.push_back(img->planes[VPX_PLANE_Y][r * img->stride[0] + c]);
+  }
+  return samples;
+}
+
+double MeanAbsDiff(const std::vector<int> &a, const std::vector<int> &b) {
+  double sum = 0;
+  for (size_t i = 0; i < a.size(); ++i) sum += abs(a[i] - b[i]);
+  return sum / a.size();
+}
+
+class VP9ThumbnailTest : public ::testing::TestWithParam<ThumbnailParam> {
+ protected:
+  virtual void SetUp() {
+    libvpx_test::PatternEncoder encoder(kWidth, kHeight, VPX_DL_GOOD_QUALITY);
+
+    ASSERT_NO_FATAL_FAILURE(encoder.Init());
+    EXPECT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(encoder.ctx(), VP8E_SET_CPUUSED, 6));
+    EXPECT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(encoder.ctx(), VP9E_SET_TILE_COLUMNS, 1));
+    for (int frame = 0; frame < kFrames; ++frame) {
+      encoder.EncodeFrame(frame == kKeyFrame ? VPX_EFLAG_FORCE_KF : 0);
+    }
+    packets_ = encoder.packets();
+    ASSERT_EQ(static_cast<size_t>(kFrames), packets_.size());
+  }
+
+  // Decodes the packets and returns the luma plane of every output frame,
+  // scaled down by the test if 'mode' is NULL.
+  std::vector<std::vector<int> > Decode(const ThumbnailParam &param,
+                                        vpx_thumbnail_mode *mode) {
+    vpx_codec_ctx_t dec;
+    std::vector<std::vector<int> > frames;
+    const int size = 1 << param.scale_log2;
+
+    libvpx_test::InitDecoder(&dec, param.decode);
+    EXPECT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(&dec, VP9D_SET_THUMBNAIL_MODE, mode));
+    for (size_t i = 0; i < packets_.size(); ++i) {
+      EXPECT_EQ(VPX_CODEC_OK, libvpx_test::DecodePacket(&dec, packets_[i]))
+          << vpx_codec_error_detail(&dec);
+      vpx_codec_iter_t iter = nullptr;
+      const vpx_image_t *const img = vpx_codec_get_frame(&dec, &iter);
+      if (img == nullptr) continue;
+      if (mode == nullptr) {
+        frames.push_back(ScaleDown(img, param.scale_log2));
+      } else {
+        EXPECT_EQ(static_cast<unsigned int>((kWidth + size - 1) / size),
+                  img->d_w);
+        EXPECT_EQ(static_cast<unsigned int>((kHeight + size - 1) / size),
+                  img->d_h);
+        frames.push_back(GetLuma(img));
+      }
+    }
+    // Only set before the first frame.
+    EXPECT_EQ(VPX_CODEC_ERROR, vpx_codec_control(&dec, VP9D_SET_THUMBNAIL_MODE,
+                                                 mode));
+    EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec));
+    return frames;
+  }
+
+  std::vector<std::string> packets_;
+};
+
+TEST(VP9Thumbnail, InvalidMode) {
+  vpx_codec_ctx_t dec;
+  vpx_thumbnail_mode mode = { 4, 0 };
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_dec_init(&dec, vpx_codec_vp9_dx(), nullptr, 0));
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&dec, VP9D_SET_THUMBNAIL_MODE, &mode));
+  mode.scale_log2 = -1;
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&dec, VP9D_SET_THUMBNAIL_MODE, &mode));
+  mode.scale_log2 = 3;
+  EXPECT_EQ(VPX_CODEC_OK,
+            vpx_codec_control(&dec, VP9D_SET_THUMBNAIL_MODE, &mode));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec));
+}
+
+TEST_P(VP9ThumbnailTest, CloseToScaledFullDecode) {
+  const ThumbnailParam param = GetParam();
+  const std::vector<std::vector<int> > full = Decode(param, nullptr);
+  ASSERT_EQ(static_cast<size_t>(kFrames), full.size());
+
+  // Only the key frames are output, without loop filter.
+  vpx_thumbnail_mode mode = { param.scale_log2, 0 };
+  const std::vector<std::vector<int> > key_frames = Decode(param, &mode);
+  ASSERT_EQ(2u, key_frames.size());
+  ASSERT_EQ(full[0].size(), key_frames[0].size());
+  EXPECT_LT(MeanAbsDiff(full[0], key_frames[0]), 1.0);
+  EXPECT_LT(MeanAbsDiff(full[kKeyFrame], key_frames[1]), 1.0);
+
+  mode.inter_frames = 1;
+  const std::vector<std::vector<int> > all = Decode(param, &mode);
+  ASSERT_EQ(static_cast<size_t>(kFrames), all.size());
+  EXPECT_TRUE(all[0] == key_frames[0]);
+  EXPECT_TRUE(all[kKeyFrame] == key_frames[1]);
+  for (int i = 0; i < kFrames; ++i) {
+    EXPECT_LT(MeanAbsDiff(full[i], all[i]), 1.0) << "frame " << i;
+  }
+}
+
+const ThumbnailParam kThumbnailParams[] = {
+  { 1, { 1, 0 } }, { 2, { 1, 0 } }, { 3, { 1, 0 } },
+  { 3, { 4, 0 } }, { 3, { 4, 1 } },
+};
+
+INSTANTIATE_TEST_SUITE_P(VP9, VP9ThumbnailTest,
+                         ::testing::ValuesIn(kThumbnailParams));
+
+}  // namespace
@@ -0,0 +1,128 @@
+/*
+ *  Copyright (c) 2026 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string>
+#include <vector>
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/md5_helper.h"
+#include "test/util.h"
+#include "test/video_source.h"
+#include "test/vp9_decoder_test_helper.h"
+
+namespace {
+
+const int kWidth = 640;
+const int kHeight = 192;
+const int kFrames = 16;
+
+class PatternVideoSource : public ::libvpx_test::DummyVideoSource {
+ public:
+  PatternVideoSource() {
+    SetSize(kWidth, kHeight);
+    set_limit(kFrames);
+  }
+
+ protected:
+  virtual void FillFrame() {
+    if (img_ != nullptr) libvpx_test::FillPatternFrame(img_, frame_, 8);
+  }
+};
+
+// Encodes with the TPL model on, which the ARF of every GF group builds its
+// stats with, and keeps the MD5 of each compressed frame.
+class VP9TplThreadTest
+    : public ::libvpx_test::EncoderTest,
+      public ::libvpx_test::CodecTestWithParam<int> {
+ protected:
+  VP9TplThreadTest()
+      : EncoderTest(GET_PARAM(0)), set_cpu_used_(GET_PARAM(1)), row_mt_(0),
+        tpl_(1) {}
+
+  virtual ~VP9TplThreadTest() {}
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(::libvpx_test::kTwoPassGood);
+    cfg_.g_lag_in_frames = 16;
+    cfg_.rc_end_usage = VPX_VBR;
+    cfg_.rc_target_bitrate = 500;
+  }
+
+  virtual void BeginPassHook(unsigned int /*pass*/) { md5_.clear(); }
+
+  virtual void PreEncodeFrameHook(::libvpx_test::VideoSource *video,
+                                  ::libvpx_test::Encoder *encoder) {
+    if (video->frame() == 0) {
+      encoder->Control(VP8E_SET_CPUUSED, set_cpu_used_);
+      encoder->Control(VP8E_SET_ENABLEAUTOALTREF, 1);
+      encoder->Control(VP9E_SET_TILE_COLUMNS, 1);
+      encoder->Control(VP9E_SET_ROW_MT, row_mt_);
+      encoder->Control(VP9E_SET_TPL, tpl_);
+    }
+  }
+
+  virtual bool DoDecode() const { return false; }
+
+  virtual void FramePktHook(const vpx_codec_cx_pkt_t *pkt) {
+    ::libvpx_test::MD5 md5;
+    md5.Add(static_cast<const uint8_t *>(pkt->data.frame.buf),
+            pkt->data.frame.sz);
+    md5_.push_back(md5.Get());
+  }
+
+  std::vector<std::string> Encode(int threads, int row_mt) {
+    PatternVideoSource video;
+    cfg_.g_threads = threads;
+    row_mt_ = row_mt;
+    EXPECT_NO_FATAL_FAILURE(RunLoop(&video));
+    return md5_;
+  }
+
+  int set_cpu_used_;
+  int row_mt_;
+  int tpl_;
+  std::vector<std::string> md5_;
+};
+
+// Without row_mt the encode of a single tile column does not depend on the
+// threads, only the model is built on them.
+TEST_P(VP9TplThreadTest, SerialMatchesThreaded) {
+  const std::vector<std::string> serial = Encode(1, 0);
+  ASSERT_EQ(static_cast<size_t>(kFrames), serial.size());
+  EXPECT_EQ(serial, Encode(4, 0));
+
+  // The model changes the stream, so it was built above.
+  tpl_ = 0;
+  EXPECT_NE(serial, Encode(1, 0));
+}
+
+// The frames of a GF group are estimated on the threads together, in a
+// different order with each number of threads.
+TEST_P(VP9TplThreadTest, MatchesAcrossThreads) {
+  const std::vector<std::string> serial = Encode(1, 0);
+  ASSERT_EQ(static_cast<size_t>(kFrames), serial.size());
+  EXPECT_EQ(serial, Encode(1, 1));
+  for (int threads = 2; threads <= 8; threads *= 2) {
+    EXPECT_EQ(serial, Encode(threads, 0)) << "threads: " << threads;
+  }
+
+  // With row_mt the encode of one thread differs from the others.
+  const std::vector<std::string> row_mt = Encode(2, 1);
+  ASSERT_EQ(static_cast<size_t>(kFrames), row_mt.size());
+  for (int threads = 4; threads <= 16; threads *= 2) {
+    EXPECT_EQ(row_mt, Encode(threads, 1)) << "threads: " << threads;
+  }
+}
+
+VP9_INSTANTIATE_TEST_SUITE(VP9TplThreadTest, ::testing::Values(1, 4));
+
+}  // namespace
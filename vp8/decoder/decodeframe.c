@@ -804,7 +804,9 @@ static void setup_token_decoder(VP8D_COMP *pbi,
   }
 
 #if CONFIG_MULTITHREAD
-  /* Clamp number of decoder threads */
+  /* Clamp number of decoder threads. The threads that are left over run the
+   * loop filter stage. */
+  pbi->decoding_thread_count = pbi->allocated_decoding_thread_count;
   if (pbi->decoding_thread_count > num_token_partitions - 1) {
     pbi->decoding_thread_count = num_token_partitions - 1;
   }
@@ -42,8 +42,8 @@
 #endif
 
 extern void vp8_init_loop_filter(VP8_COMMON *cm);
-static int get_free_fb(VP8_COMMON *cm);
-static void ref_cnt_fb(int *buf, int *idx, int new_idx);
+static int get_free_fb(VP8D_COMP *pbi);
+static void ref_cnt_fb(VP8D_COMP *pbi, int *idx, int new_idx);
 
 static void initialize_dec(void) {
   static volatile int init_done = 0;
@@ -59,6 +59,7 @@ static void remove_decompressor(VP8D_COMP *pbi) {
 #if CONFIG_ERROR_CONCEALMENT
   vp8_de_alloc_overlap_lists(pbi);
 #endif
+  vp8dx_release_ext_fbs(pbi);
   vp8_remove_common(&pbi->common);
   vpx_free(pbi);
 }
@@ -82,6 +83,7 @@ static struct VP8D_COMP *create_decompressor(VP8D_CONFIG *oxcf) {
 
   pbi->common.current_video_frame = 0;
   pbi->ready_for_new_data = 1;
+  pbi->held_fb_idx = -1;
 
   /* vp8cx_init_de_quantizer() is first called here. Add check in
    * frame_init_dequantizer() to avoid
@@ -177,40 +179,101 @@ vpx_codec_err_t vp8dx_set_reference(VP8D_COMP *pbi,
                        "Incorrect buffer dimensions");
   } else {
     /* Find an empty frame buffer. */
-    free_fb = get_free_fb(cm);
+    free_fb = get_free_fb(pbi);
+    if (free_fb < 0) return pbi->common.error.error_code;
     /* Decrease fb_idx_ref_cnt since it will be increased again in
      * ref_cnt_fb() below. */
     cm->fb_idx_ref_cnt[free_fb]--;
 
     /* Manage the reference counters and copy image. */
-    ref_cnt_fb(cm->fb_idx_ref_cnt, ref_fb_ptr, free_fb);
+    ref_cnt_fb(pbi, ref_fb_ptr, free_fb);
     vp8_yv12_copy_frame(sd, &cm->yv12_fb[*ref_fb_ptr]);
   }
 
   return pbi->common.error.error_code;
 }
 
-static int get_free_fb(VP8_COMMON *cm) {
+static int get_free_fb(VP8D_COMP *pbi) {
+  VP8_COMMON *cm = &pbi->common;
   int i;
   for (i = 0; i < NUM_YV12_BUFFERS; ++i) {
     if (cm->fb_idx_ref_cnt[i] == 0) break;
   }
 
+  /* Between frames the held frame may take the last free buffer. */
+  if (i == NUM_YV12_BUFFERS && pbi->held_fb_idx >= 0) {
+    vp8dx_release_fb(pbi, pbi->held_fb_idx);
+    pbi->held_fb_idx = -1;
+    for (i = 0; i < NUM_YV12_BUFFERS; ++i) {
+      if (cm->fb_idx_ref_cnt[i] == 0) break;
+    }
+  }
+
   assert(i < NUM_YV12_BUFFERS);
   cm->fb_idx_ref_cnt[i] = 1;
+
+  if (pbi->get_ext_fb_cb != NULL) {
+    /* Our internal buffers are always multiples of 16. */
+    const int width = (cm->Width + 15) & ~15;
+    const int height = (cm->Height + 15) & ~15;
+
+    memset(&pbi->ext_fb[i], 0, sizeof(pbi->ext_fb[i]));
+    if (vp8_yv12_alloc_ext_frame_buffer(&cm->yv12_fb[i], width, height,
+                                        VP8BORDERINPIXELS, &pbi->ext_fb[i],
+                                        pbi->get_ext_fb_cb, pbi->ext_priv)) {
+      vp8dx_release_fb(pbi, i);
+      vpx_internal_error(&cm->error, VPX_CODEC_MEM_ERROR,
+                         "Failed to get an external frame buffer");
+      return -1;
+    }
+  }
+
   return i;
 }
 
-static void ref_cnt_fb(int *buf, int *idx, int new_idx) {
-  if (buf[*idx] > 0) buf[*idx]--;
+/* Drops a reference to the frame buffer. Once the buffer is unused, its
+ * memory goes back to the application if it came from there. */
+void vp8dx_release_fb(VP8D_COMP *pbi, int idx) {
+  VP8_COMMON *cm = &pbi->common;
+
+  if (cm->fb_idx_ref_cnt[idx] == 0) return;
+  if (--cm->fb_idx_ref_cnt[idx] > 0 || pbi->get_ext_fb_cb == NULL) return;
+
+  /* Buffers that were allocated before the first frame are freed here. */
+  vp8_yv12_de_alloc_frame_buffer(&cm->yv12_fb[idx]);
+  if (pbi->ext_fb[idx].data != NULL) {
+    pbi->release_ext_fb_cb(pbi->ext_priv, &pbi->ext_fb[idx]);
+  }
+  memset(&pbi->ext_fb[idx], 0, sizeof(pbi->ext_fb[idx]));
+}
+
+/* Hands all the application frame buffers back, before the frame buffers are
+ * reallocated or freed. */
+void vp8dx_release_ext_fbs(VP8D_COMP *pbi) {
+  VP8_COMMON *cm = &pbi->common;
+  int i;
+
+  for (i = 0; i < NUM_YV12_BUFFERS; ++i) {
+    if (pbi->ext_fb[i].data != NULL) {
+      vp8_yv12_de_alloc_frame_buffer(&cm->yv12_fb[i]);
+      pbi->release_ext_fb_cb(pbi->ext_priv, &pbi->ext_fb[i]);
+      memset(&pbi->ext_fb[i], 0, sizeof(pbi->ext_fb[i]));
+    }
+  }
+  pbi->held_fb_idx = -1;
+}
+
+static void ref_cnt_fb(VP8D_COMP *pbi, int *idx, int new_idx) {
+  vp8dx_release_fb(pbi, *idx);
 
   *idx = new_idx;
 
-  buf[new_idx]++;
+  pbi->common.fb_idx_ref_cnt[new_idx]++;
 }
 
 /* If any buffer copy / swapping is signalled it should be done here. */
-static int swap_frame_buffers(VP8_COMMON *cm) {
+static int swap_frame_buffers(VP8D_COMP *pbi) {
+  VP8_COMMON *cm = &pbi->common;
   int err = 0;
 
   /* The alternate reference frame or golden frame can be updated
@@ -229,7 +292,7 @@ static int swap_frame_buffers(VP8_COMMON *cm) {
       err = -1;
     }
 
-    ref_cnt_fb(cm->fb_idx_ref_cnt, &cm->alt_fb_idx, new_fb);
+    ref_cnt_fb(pbi, &cm->alt_fb_idx, new_fb);
   }
 
   if (cm->copy_buffer_to_gf) {
@@ -243,26 +306,32 @@ static int swap_frame_buffers(VP8_COMMON *cm) {
       err = -1;
     }
 
-    ref_cnt_fb(cm->fb_idx_ref_cnt, &cm->gld_fb_idx, new_fb);
+    ref_cnt_fb(pbi, &cm->gld_fb_idx, new_fb);
   }
 
   if (cm->refresh_golden_frame) {
-    ref_cnt_fb(cm->fb_idx_ref_cnt, &cm->gld_fb_idx, cm->new_fb_idx);
+    ref_cnt_fb(pbi, &cm->gld_fb_idx, cm->new_fb_idx);
   }
 
   if (cm->refresh_alt_ref_frame) {
-    ref_cnt_fb(cm->fb_idx_ref_cnt, &cm->alt_fb_idx, cm->new_fb_idx);
+    ref_cnt_fb(pbi, &cm->alt_fb_idx, cm->new_fb_idx);
   }
 
   if (cm->refresh_last_frame) {
-    ref_cnt_fb(cm->fb_idx_ref_cnt, &cm->lst_fb_idx, cm->new_fb_idx);
+    ref_cnt_fb(pbi, &cm->lst_fb_idx, cm->new_fb_idx);
 
     cm->frame_to_show = &cm->yv12_fb[cm->lst_fb_idx];
   } else {
     cm->frame_to_show = &cm->yv12_fb[cm->new_fb_idx];
   }
 
-  cm->fb_idx_ref_cnt[cm->new_fb_idx]--;
+  /* The application reads the shown frame from its frame buffer, so keep it
+   * until the next frame. */
+  if (pbi->get_ext_fb_cb != NULL && cm->show_frame) {
+    pbi->held_fb_idx = cm->new_fb_idx;
+  } else {
+    vp8dx_release_fb(pbi, cm->new_fb_idx);
+  }
 
   return err;
 }
@@ -281,8 +350,11 @@ static int check_fragments_for_errors(VP8D_COMP *pbi) {
        * corrupt, otherwise we will make multiple buffers corrupt.
        */
       const int prev_idx = cm->lst_fb_idx;
+      /* get_free_fb() may longjmp, leave the reference alone until it has
+       * returned. */
+      const int free_fb = get_free_fb(pbi);
       cm->fb_idx_ref_cnt[prev_idx]--;
-      cm->lst_fb_idx = get_free_fb(cm);
+      cm->lst_fb_idx = free_fb;
       vp8_yv12_copy_frame(&cm->yv12_fb[prev_idx], &cm->yv12_fb[cm->lst_fb_idx]);
     }
     /* This is used to signal that we are missing frames.
@@ -308,10 +380,19 @@ int vp8dx_receive_compressed_data(VP8D_COMP *pbi, int64_t time_stamp) {
 
   pbi->common.error.error_code = VPX_CODEC_OK;
 
+  if (pbi->held_fb_idx >= 0) {
+    vp8dx_release_fb(pbi, pbi->held_fb_idx);
+    pbi->held_fb_idx = -1;
+  }
+
+  /* No buffer is taken for this frame until get_free_fb() returns. The error
+   * handler releases new_fb_idx, which must not be the previous frame's. */
+  cm->new_fb_idx = -1;
+
   retcode = check_fragments_for_errors(pbi);
   if (retcode <= 0) return retcode;
 
-  cm->new_fb_idx = get_free_fb(cm);
+  cm->new_fb_idx = get_free_fb(pbi);
 
   /* setup reference frames for vp8_decode_frame */
   pbi->dec_fb_ref[INTRA_FRAME] = &cm->yv12_fb[cm->new_fb_idx];
@@ -322,9 +403,7 @@ int vp8dx_receive_compressed_data(VP8D_COMP *pbi, int64_t time_stamp) {
   retcode = vp8_decode_frame(pbi);
 
   if (retcode < 0) {
-    if (cm->fb_idx_ref_cnt[cm->new_fb_idx] > 0) {
-      cm->fb_idx_ref_cnt[cm->new_fb_idx]--;
-    }
+    vp8dx_release_fb(pbi, cm->new_fb_idx);
 
     pbi->common.error.error_code = VPX_CODEC_ERROR;
     // Propagate the error info.
@@ -336,7 +415,7 @@ int vp8dx_receive_compressed_data(VP8D_COMP *pbi, int64_t time_stamp) {
     goto decode_exit;
   }
 
-  if (swap_frame_buffers(cm)) {
+  if (swap_frame_buffers(pbi)) {
     pbi->common.error.error_code = VPX_CODEC_ERROR;
     goto decode_exit;
   }
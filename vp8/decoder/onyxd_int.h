@@ -75,11 +75,23 @@ typedef struct VP8D_COMP {
   int current_mb_col_main;
   unsigned int decoding_thread_count;
   int allocated_decoding_thread_count;
+  /* Threads running the loop filter stage behind the token decoding threads
+   * in the current frame. 0 when the loop filter is done inline. */
+  unsigned int lf_thread_count;
 
   int mt_baseline_filter_level[MAX_MB_SEGMENTS];
   int sync_range;
   /* Each row remembers its already decoded column. */
   vpx_atomic_int *mt_current_mb_col;
+  /* Each row remembers its already loop filtered column when the loop filter
+   * runs as a separate stage. */
+  vpx_atomic_int *mt_lf_current_mb_col;
+
+  /* Threads that wait on the progress of another row for too long sleep on
+   * mt_sync_cond until the row moves on. */
+  pthread_mutex_t mt_sync_mutex;
+  pthread_cond_t mt_sync_cond;
+  vpx_atomic_int mt_sync_waiters;
 
   unsigned char **mt_yabove_row; /* mb_rows x width */
   unsigned char **mt_uabove_row;
@@ -118,6 +130,16 @@ typedef struct VP8D_COMP {
 
   vpx_decrypt_cb decrypt_cb;
   void *decrypt_state;
+
+  /* Frame buffers from the application. While common.yv12_fb[i] is
+   * referenced its memory is ext_fb[i]. */
+  vpx_get_frame_buffer_cb_fn_t get_ext_fb_cb;
+  vpx_release_frame_buffer_cb_fn_t release_ext_fb_cb;
+  void *ext_priv;
+  vpx_codec_frame_buffer_t ext_fb[NUM_YV12_BUFFERS];
+  /* The shown frame keeps its application frame buffer until the next frame
+   * is decoded, or -1. */
+  int held_fb_idx;
 #if CONFIG_MULTITHREAD
   // Restart threads on next frame if set to 1.
   // This is set when error happens in multithreaded decoding and all threads
@@ -130,6 +152,9 @@ void vp8cx_init_de_quantizer(VP8D_COMP *pbi);
 void vp8_mb_init_dequantizer(VP8D_COMP *pbi, MACROBLOCKD *xd);
 int vp8_decode_frame(VP8D_COMP *pbi);
 
+void vp8dx_release_fb(VP8D_COMP *pbi, int idx);
+void vp8dx_release_ext_fbs(VP8D_COMP *pbi);
+
 int vp8_create_decoder_instances(struct frame_buffers *fb, VP8D_CONFIG *oxcf);
 int vp8_remove_decoder_instances(struct frame_buffers *fb);
 
@@ -30,6 +30,9 @@
 #include "error_concealment.h"
 #endif
 
+/* Number of progress checks before a waiting thread goes to sleep. */
+#define MT_SPIN_COUNT 256
+
 #define CALLOC_ARRAY(p, n) CHECK_MEM_ERROR((p), vpx_calloc(sizeof(*(p)), (n)))
 #define CALLOC_ARRAY_ALIGNED(p, n, algn)                            \
   do {                                                              \
@@ -79,8 +82,44 @@ static void setup_decoding_thread_data(VP8D_COMP *pbi, MACROBLOCKD *xd,
     if (pc->full_pixel) mbd->fullpixel_mask = 0xfffffff8;
   }
 
-  for (i = 0; i < pc->mb_rows; ++i)
+  for (i = 0; i < pc->mb_rows; ++i) {
     vpx_atomic_store_release(&pbi->mt_current_mb_col[i], -1);
+    vpx_atomic_store_release(&pbi->mt_lf_current_mb_col[i], -1);
+  }
+}
+
+/* Waits until the row progress reaches mb_col. The thread spins for a short
+ * while, as the row usually moves on within a few macroblocks, and then sleeps
+ * so that waiting threads leave the cores to the ones doing work when there are
+ * more threads than cores. */
+static void mt_wait_mb_col(VP8D_COMP *pbi, const vpx_atomic_int *progress,
+                           int mb_col) {
+  int i;
+
+  for (i = 0; i < MT_SPIN_COUNT; ++i) {
+    if (vpx_atomic_load_acquire(progress) >= mb_col) return;
+    x86_pause_hint();
+  }
+
+  pthread_mutex_lock(&pbi->mt_sync_mutex);
+  /* The full barrier of the increment pairs with the one in mt_set_mb_col():
+   * either the writer sees this waiter or this load sees the new progress. */
+  vpx_atomic_fetch_add(&pbi->mt_sync_waiters, 1);
+  while (vpx_atomic_load_acquire(progress) < mb_col) {
+    pthread_cond_wait(&pbi->mt_sync_cond, &pbi->mt_sync_mutex);
+  }
+  vpx_atomic_fetch_add(&pbi->mt_sync_waiters, -1);
+  pthread_mutex_unlock(&pbi->mt_sync_mutex);
+}
+
+static void mt_set_mb_col(VP8D_COMP *pbi, vpx_atomic_int *progress,
+                          int mb_col) {
+  vpx_atomic_store_release(progress, mb_col);
+  if (vpx_atomic_fetch_add(&pbi->mt_sync_waiters, 0) > 0) {
+    pthread_mutex_lock(&pbi->mt_sync_mutex);
+    pthread_cond_broadcast(&pbi->mt_sync_cond);
+    pthread_mutex_unlock(&pbi->mt_sync_mutex);
+  }
 }
 
 static void mt_decode_macroblock(VP8D_COMP *pbi, MACROBLOCKD *xd,
@@ -246,6 +285,100 @@ static void mt_decode_macroblock(VP8D_COMP *pbi, MACROBLOCKD *xd,
   }
 }
 
+/* Saves the edges of the reconstructed macroblock that the intra prediction
+ * of its right and bottom neighbors reads, before the loop filter modifies
+ * them. */
+static void mt_save_intra_edges(VP8D_COMP *pbi, const MACROBLOCKD *xd,
+                                int mb_row, int mb_col) {
+  const VP8_COMMON *const pc = &pbi->common;
+  const int recon_y_stride = xd->dst.y_stride;
+  const int recon_uv_stride = xd->dst.uv_stride;
+  int i;
+
+  if (mb_row != pc->mb_rows - 1) {
+    /* Save decoded MB last row data for next-row decoding */
+    memcpy((pbi->mt_yabove_row[mb_row + 1] + 32 + mb_col * 16),
+           (xd->dst.y_buffer + 15 * recon_y_stride), 16);
+    memcpy((pbi->mt_uabove_row[mb_row + 1] + 16 + mb_col * 8),
+           (xd->dst.u_buffer + 7 * recon_uv_stride), 8);
+    memcpy((pbi->mt_vabove_row[mb_row + 1] + 16 + mb_col * 8),
+           (xd->dst.v_buffer + 7 * recon_uv_stride), 8);
+  }
+
+  /* save left_col for next MB decoding */
+  if (mb_col != pc->mb_cols - 1) {
+    const MODE_INFO *next = xd->mode_info_context + 1;
+
+    if (next->mbmi.ref_frame == INTRA_FRAME) {
+      for (i = 0; i < 16; ++i) {
+        pbi->mt_yleft_col[mb_row][i] =
+            xd->dst.y_buffer[i * recon_y_stride + 15];
+      }
+      for (i = 0; i < 8; ++i) {
+        pbi->mt_uleft_col[mb_row][i] =
+            xd->dst.u_buffer[i * recon_uv_stride + 7];
+        pbi->mt_vleft_col[mb_row][i] =
+            xd->dst.v_buffer[i * recon_uv_stride + 7];
+      }
+    }
+  }
+}
+
+/* Loop filters the macroblock at y, u and v whose mode info is mi. */
+static void mt_loop_filter_mb(VP8D_COMP *pbi, const MODE_INFO *mi,
+                              unsigned char *y, unsigned char *u,
+                              unsigned char *v, int mb_row, int mb_col) {
+  VP8_COMMON *const pc = &pbi->common;
+  const loop_filter_info_n *const lfi_n = &pc->lf_info;
+  const YV12_BUFFER_CONFIG *const yv12_fb_new = pbi->dec_fb_ref[INTRA_FRAME];
+  const int recon_y_stride = yv12_fb_new->y_stride;
+  const int recon_uv_stride = yv12_fb_new->uv_stride;
+  const int skip_lf = (mi->mbmi.mode != B_PRED && mi->mbmi.mode != SPLITMV &&
+                       mi->mbmi.mb_skip_coeff);
+  const int mode_index = lfi_n->mode_lf_lut[mi->mbmi.mode];
+  const int seg = mi->mbmi.segment_id;
+  const int ref_frame = mi->mbmi.ref_frame;
+  const int filter_level = lfi_n->lvl[seg][ref_frame][mode_index];
+
+  if (!filter_level) return;
+
+  if (pc->filter_type == NORMAL_LOOPFILTER) {
+    loop_filter_info lfi;
+    FRAME_TYPE frame_type = pc->frame_type;
+    const int hev_index = lfi_n->hev_thr_lut[frame_type][filter_level];
+    lfi.mblim = lfi_n->mblim[filter_level];
+    lfi.blim = lfi_n->blim[filter_level];
+    lfi.lim = lfi_n->lim[filter_level];
+    lfi.hev_thr = lfi_n->hev_thr[hev_index];
+
+    if (mb_col > 0)
+      vp8_loop_filter_mbv(y, u, v, recon_y_stride, recon_uv_stride, &lfi);
+
+    if (!skip_lf)
+      vp8_loop_filter_bv(y, u, v, recon_y_stride, recon_uv_stride, &lfi);
+
+    /* don't apply across umv border */
+    if (mb_row > 0)
+      vp8_loop_filter_mbh(y, u, v, recon_y_stride, recon_uv_stride, &lfi);
+
+    if (!skip_lf)
+      vp8_loop_filter_bh(y, u, v, recon_y_stride, recon_uv_stride, &lfi);
+  } else {
+    if (mb_col > 0)
+      vp8_loop_filter_simple_mbv(y, recon_y_stride, lfi_n->mblim[filter_level]);
+
+    if (!skip_lf)
+      vp8_loop_filter_simple_bv(y, recon_y_stride, lfi_n->blim[filter_level]);
+
+    /* don't apply across umv border */
+    if (mb_row > 0)
+      vp8_loop_filter_simple_mbh(y, recon_y_stride, lfi_n->mblim[filter_level]);
+
+    if (!skip_lf)
+      vp8_loop_filter_simple_bh(y, recon_y_stride, lfi_n->blim[filter_level]);
+  }
+}
+
 static void mt_decode_mb_rows(VP8D_COMP *pbi, MACROBLOCKD *xd,
                               int start_mb_row) {
   const vpx_atomic_int *last_row_current_mb_col;
@@ -294,8 +427,6 @@ static void mt_decode_mb_rows(VP8D_COMP *pbi, MACROBLOCKD *xd,
        mb_row += (pbi->decoding_thread_count + 1)) {
     int recon_yoffset, recon_uvoffset;
     int mb_col;
-    int filter_level;
-    loop_filter_info_n *lfi_n = &pc->lf_info;
 
     /* save last row processed by this thread */
     last_mb_row = mb_row;
@@ -358,11 +489,11 @@ static void mt_decode_mb_rows(VP8D_COMP *pbi, MACROBLOCKD *xd,
 
     for (mb_col = 0; mb_col < pc->mb_cols; ++mb_col) {
       if (((mb_col - 1) % nsync) == 0) {
-        vpx_atomic_store_release(current_mb_col, mb_col - 1);
+        mt_set_mb_col(pbi, current_mb_col, mb_col - 1);
       }
 
       if (mb_row && !(mb_col & (nsync - 1))) {
-        vp8_atomic_spin_wait(mb_col, last_row_current_mb_col, nsync);
+        mt_wait_mb_col(pbi, last_row_current_mb_col, mb_col + nsync);
       }
 
       /* Distance of MB to the various image edges.
@@ -409,7 +540,7 @@ static void mt_decode_mb_rows(VP8D_COMP *pbi, MACROBLOCKD *xd,
         for (; mb_row < pc->mb_rows;
              mb_row += (pbi->decoding_thread_count + 1)) {
           current_mb_col = &pbi->mt_current_mb_col[mb_row];
-          vpx_atomic_store_release(current_mb_col, pc->mb_cols + nsync);
+          mt_set_mb_col(pbi, current_mb_col, pc->mb_cols + nsync);
         }
         vpx_internal_error(&xd->error_info, VPX_CODEC_CORRUPT_FRAME,
                            "Corrupted reference frame");
@@ -444,94 +575,11 @@ static void mt_decode_mb_rows(VP8D_COMP *pbi, MACROBLOCKD *xd,
       }
 
       if (pbi->common.filter_level) {
-        int skip_lf = (xd->mode_info_context->mbmi.mode != B_PRED &&
-                       xd->mode_info_context->mbmi.mode != SPLITMV &&
-                       xd->mode_info_context->mbmi.mb_skip_coeff);
-
-        const int mode_index =
-            lfi_n->mode_lf_lut[xd->mode_info_context->mbmi.mode];
-        const int seg = xd->mode_info_context->mbmi.segment_id;
-        const int ref_frame = xd->mode_info_context->mbmi.ref_frame;
-
-        filter_level = lfi_n->lvl[seg][ref_frame][mode_index];
-
-        if (mb_row != pc->mb_rows - 1) {
-          /* Save decoded MB last row data for next-row decoding */
-          memcpy((pbi->mt_yabove_row[mb_row + 1] + 32 + mb_col * 16),
-                 (xd->dst.y_buffer + 15 * recon_y_stride), 16);
-          memcpy((pbi->mt_uabove_row[mb_row + 1] + 16 + mb_col * 8),
-                 (xd->dst.u_buffer + 7 * recon_uv_stride), 8);
-          memcpy((pbi->mt_vabove_row[mb_row + 1] + 16 + mb_col * 8),
-                 (xd->dst.v_buffer + 7 * recon_uv_stride), 8);
-        }
-
-        /* save left_col for next MB decoding */
-        if (mb_col != pc->mb_cols - 1) {
-          MODE_INFO *next = xd->mode_info_context + 1;
-
-          if (next->mbmi.ref_frame == INTRA_FRAME) {
-            for (i = 0; i < 16; ++i) {
-              pbi->mt_yleft_col[mb_row][i] =
-                  xd->dst.y_buffer[i * recon_y_stride + 15];
-            }
-            for (i = 0; i < 8; ++i) {
-              pbi->mt_uleft_col[mb_row][i] =
-                  xd->dst.u_buffer[i * recon_uv_stride + 7];
-              pbi->mt_vleft_col[mb_row][i] =
-                  xd->dst.v_buffer[i * recon_uv_stride + 7];
-            }
-          }
-        }
-
-        /* loopfilter on this macroblock. */
-        if (filter_level) {
-          if (pc->filter_type == NORMAL_LOOPFILTER) {
-            loop_filter_info lfi;
-            FRAME_TYPE frame_type = pc->frame_type;
-            const int hev_index = lfi_n->hev_thr_lut[frame_type][filter_level];
-            lfi.mblim = lfi_n->mblim[filter_level];
-            lfi.blim = lfi_n->blim[filter_level];
-            lfi.lim = lfi_n->lim[filter_level];
-            lfi.hev_thr = lfi_n->hev_thr[hev_index];
-
-            if (mb_col > 0)
-              vp8_loop_filter_mbv(xd->dst.y_buffer, xd->dst.u_buffer,
-                                  xd->dst.v_buffer, recon_y_stride,
-                                  recon_uv_stride, &lfi);
-
-            if (!skip_lf)
-              vp8_loop_filter_bv(xd->dst.y_buffer, xd->dst.u_buffer,
-                                 xd->dst.v_buffer, recon_y_stride,
-                                 recon_uv_stride, &lfi);
-
-            /* don't apply across umv border */
-            if (mb_row > 0)
-              vp8_loop_filter_mbh(xd->dst.y_buffer, xd->dst.u_buffer,
-                                  xd->dst.v_buffer, recon_y_stride,
-                                  recon_uv_stride, &lfi);
-
-            if (!skip_lf)
-              vp8_loop_filter_bh(xd->dst.y_buffer, xd->dst.u_buffer,
-                                 xd->dst.v_buffer, recon_y_stride,
-                                 recon_uv_stride, &lfi);
-          } else {
-            if (mb_col > 0)
-              vp8_loop_filter_simple_mbv(xd->dst.y_buffer, recon_y_stride,
-                                         lfi_n->mblim[filter_level]);
-
-            if (!skip_lf)
-              vp8_loop_filter_simple_bv(xd->dst.y_buffer, recon_y_stride,
-                                        lfi_n->blim[filter_level]);
-
-            /* don't apply across umv border */
-            if (mb_row > 0)
-              vp8_loop_filter_simple_mbh(xd->dst.y_buffer, recon_y_stride,
-                                         lfi_n->mblim[filter_level]);
-
-            if (!skip_lf)
-              vp8_loop_filter_simple_bh(xd->dst.y_buffer, recon_y_stride,
-                                        lfi_n->blim[filter_level]);
-          }
+        mt_save_intra_edges(pbi, xd, mb_row, mb_col);
+        if (!pbi->lf_thread_count) {
+          mt_loop_filter_mb(pbi, xd->mode_info_context, xd->dst.y_buffer,
+                            xd->dst.u_buffer, xd->dst.v_buffer, mb_row,
+                            mb_col);
         }
       }
 
@@ -564,7 +612,7 @@ static void mt_decode_mb_rows(VP8D_COMP *pbi, MACROBLOCKD *xd,
     }
 
     /* last MB of row is ready just after extension is done */
-    vpx_atomic_store_release(current_mb_col, mb_col + nsync);
+    mt_set_mb_col(pbi, current_mb_col, mb_col + nsync);
 
     ++xd->mode_info_context; /* skip prediction column */
     xd->up_available = 1;
@@ -578,6 +626,57 @@ static void mt_decode_mb_rows(VP8D_COMP *pbi, MACROBLOCKD *xd,
     sem_post(&pbi->h_event_end_decoding);
 }
 
+/* Runs the loop filter stage on the rows start_mb_row,
+ * start_mb_row + lf_thread_count, ... It follows the reconstruction of each
+ * row, and the filtering of the row above it, by at least one macroblock. */
+static void mt_loop_filter_rows(VP8D_COMP *pbi, int start_mb_row) {
+  VP8_COMMON *const pc = &pbi->common;
+  YV12_BUFFER_CONFIG *const yv12_fb_new = pbi->dec_fb_ref[INTRA_FRAME];
+  const int nsync = pbi->sync_range;
+  const int recon_y_stride = yv12_fb_new->y_stride;
+  const int recon_uv_stride = yv12_fb_new->uv_stride;
+  int mb_row;
+
+  for (mb_row = start_mb_row; mb_row < pc->mb_rows;
+       mb_row += pbi->lf_thread_count) {
+    const vpx_atomic_int *const recon_mb_col = &pbi->mt_current_mb_col[mb_row];
+    vpx_atomic_int *const current_mb_col = &pbi->mt_lf_current_mb_col[mb_row];
+    const MODE_INFO *mi = pc->mi + pc->mode_info_stride * mb_row;
+    unsigned char *y = yv12_fb_new->y_buffer + mb_row * recon_y_stride * 16;
+    unsigned char *u = yv12_fb_new->u_buffer + mb_row * recon_uv_stride * 8;
+    unsigned char *v = yv12_fb_new->v_buffer + mb_row * recon_uv_stride * 8;
+    int recon_done = -1;
+    int mb_col;
+
+    for (mb_col = 0; mb_col < pc->mb_cols; ++mb_col) {
+      if (((mb_col - 1) % nsync) == 0) {
+        mt_set_mb_col(pbi, current_mb_col, mb_col - 1);
+      }
+
+      if (mb_row && !(mb_col & (nsync - 1))) {
+        mt_wait_mb_col(pbi, &pbi->mt_lf_current_mb_col[mb_row - 1],
+                       mb_col + nsync);
+      }
+
+      if (mb_col > recon_done) {
+        mt_wait_mb_col(pbi, recon_mb_col, mb_col);
+        recon_done = vpx_atomic_load_acquire(recon_mb_col);
+      }
+
+      mt_loop_filter_mb(pbi, mi, y, u, v, mb_row, mb_col);
+
+      ++mi;
+      y += 16;
+      u += 8;
+      v += 8;
+    }
+
+    mt_set_mb_col(pbi, current_mb_col, mb_col + nsync);
+  }
+
+  sem_post(&pbi->h_event_end_decoding);
+}
+
 static THREAD_FUNCTION thread_decoding_proc(void *p_data) {
   int ithread = ((DECODETHREAD_DATA *)p_data)->ithread;
   VP8D_COMP *pbi = (VP8D_COMP *)(((DECODETHREAD_DATA *)p_data)->ptr1);
@@ -600,7 +699,11 @@ static THREAD_FUNCTION thread_decoding_proc(void *p_data) {
           continue;
         }
         xd->error_info.setjmp = 1;
-        mt_decode_mb_rows(pbi, xd, ithread + 1);
+        if (ithread < (int)pbi->decoding_thread_count) {
+          mt_decode_mb_rows(pbi, xd, ithread + 1);
+        } else {
+          mt_loop_filter_rows(pbi, ithread - pbi->decoding_thread_count);
+        }
       }
     }
   }
@@ -615,8 +718,9 @@ void vp8_decoder_create_threads(VP8D_COMP *pbi) {
   vpx_atomic_init(&pbi->b_multithreaded_rd, 0);
   pbi->allocated_decoding_thread_count = 0;
 
-  /* limit decoding threads to the max number of token partitions */
-  core_count = (pbi->max_threads > 8) ? 8 : pbi->max_threads;
+  /* limit decoding threads to the max number of token partitions, and as many
+   * threads again for the loop filter stage */
+  core_count = (pbi->max_threads > 16) ? 16 : pbi->max_threads;
 
   /* limit decoding threads to the available cores */
   if (core_count > pbi->common.processor_core_count) {
@@ -627,6 +731,10 @@ void vp8_decoder_create_threads(VP8D_COMP *pbi) {
     vpx_atomic_init(&pbi->b_multithreaded_rd, 1);
     pbi->decoding_thread_count = core_count - 1;
 
+    pthread_mutex_init(&pbi->mt_sync_mutex, NULL);
+    pthread_cond_init(&pbi->mt_sync_cond, NULL);
+    vpx_atomic_init(&pbi->mt_sync_waiters, 0);
+
     CALLOC_ARRAY(pbi->h_decoding_thread, pbi->decoding_thread_count);
     CALLOC_ARRAY(pbi->h_event_start_decoding, pbi->decoding_thread_count);
     CALLOC_ARRAY_ALIGNED(pbi->mb_row_di, pbi->decoding_thread_count, 32);
@@ -673,6 +781,9 @@ void vp8mt_de_alloc_temp_buffers(VP8D_COMP *pbi, int mb_rows) {
   vpx_free(pbi->mt_current_mb_col);
   pbi->mt_current_mb_col = NULL;
 
+  vpx_free(pbi->mt_lf_current_mb_col);
+  pbi->mt_lf_current_mb_col = NULL;
+
   /* Free above_row buffers. */
   if (pbi->mt_yabove_row) {
     for (i = 0; i < mb_rows; ++i) {
@@ -759,6 +870,12 @@ void vp8mt_alloc_temp_buffers(VP8D_COMP *pbi, int width, int prev_mb_rows) {
     for (i = 0; i < pc->mb_rows; ++i)
       vpx_atomic_init(&pbi->mt_current_mb_col[i], 0);
 
+    CHECK_MEM_ERROR(
+        pbi->mt_lf_current_mb_col,
+        vpx_malloc(sizeof(*pbi->mt_lf_current_mb_col) * pc->mb_rows));
+    for (i = 0; i < pc->mb_rows; ++i)
+      vpx_atomic_init(&pbi->mt_lf_current_mb_col[i], 0);
+
     /* Allocate memory for above_row buffers. */
     CALLOC_ARRAY(pbi->mt_yabove_row, pc->mb_rows);
     for (i = 0; i < pc->mb_rows; ++i) {
@@ -822,6 +939,9 @@ void vp8_decoder_remove_threads(VP8D_COMP *pbi) {
       sem_destroy(&pbi->h_event_end_decoding);
     }
 
+    pthread_mutex_destroy(&pbi->mt_sync_mutex);
+    pthread_cond_destroy(&pbi->mt_sync_cond);
+
     vpx_free(pbi->h_decoding_thread);
     pbi->h_decoding_thread = NULL;
 
@@ -841,6 +961,7 @@ void vp8_decoder_remove_threads(VP8D_COMP *pbi) {
 int vp8mt_decode_mb_rows(VP8D_COMP *pbi, MACROBLOCKD *xd) {
   VP8_COMMON *pc = &pbi->common;
   unsigned int i;
+  unsigned int num_threads;
   int j;
 
   int filter_level = pc->filter_level;
@@ -877,10 +998,22 @@ int vp8mt_decode_mb_rows(VP8D_COMP *pbi, MACROBLOCKD *xd) {
     vp8_setup_intra_recon_top_line(yv12_fb_new);
   }
 
+  /* The threads left without a token partition run the loop filter as a
+   * separate stage, up to one per token decoding thread. */
+  pbi->lf_thread_count = 0;
+  if (filter_level) {
+    pbi->lf_thread_count =
+        pbi->allocated_decoding_thread_count - pbi->decoding_thread_count;
+    if (pbi->lf_thread_count > pbi->decoding_thread_count + 1) {
+      pbi->lf_thread_count = pbi->decoding_thread_count + 1;
+    }
+  }
+  num_threads = pbi->decoding_thread_count + pbi->lf_thread_count;
+
   setup_decoding_thread_data(pbi, xd, pbi->mb_row_di,
                              pbi->decoding_thread_count);
 
-  for (i = 0; i < pbi->decoding_thread_count; ++i) {
+  for (i = 0; i < num_threads; ++i) {
     sem_post(&pbi->h_event_start_decoding[i]);
   }
 
@@ -890,15 +1023,14 @@ int vp8mt_decode_mb_rows(VP8D_COMP *pbi, MACROBLOCKD *xd) {
     // Wait for other threads to finish. This prevents other threads decoding
     // the current frame while the main thread starts decoding the next frame,
     // which causes a data race.
-    for (i = 0; i < pbi->decoding_thread_count; ++i)
-      sem_wait(&pbi->h_event_end_decoding);
+    for (i = 0; i < num_threads; ++i) sem_wait(&pbi->h_event_end_decoding);
     return -1;
   }
 
   xd->error_info.setjmp = 1;
   mt_decode_mb_rows(pbi, xd, 0);
 
-  for (i = 0; i < pbi->decoding_thread_count + 1; ++i)
+  for (i = 0; i < num_threads + 1; ++i)
     sem_wait(&pbi->h_event_end_decoding); /* add back for each frame */
 
   return 0;
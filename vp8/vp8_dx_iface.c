@@ -55,6 +55,9 @@ struct vpx_codec_alg_priv {
   vp8_postproc_cfg_t postproc_cfg;
   vpx_decrypt_cb decrypt_cb;
   void *decrypt_state;
+  vpx_get_frame_buffer_cb_fn_t get_ext_fb_cb;
+  vpx_release_frame_buffer_cb_fn_t release_ext_fb_cb;
+  void *ext_priv;
   vpx_image_t img;
   int img_setup;
   struct frame_buffers yv12_frame_buffers;
@@ -358,6 +361,9 @@ static vpx_codec_err_t vp8_decode(vpx_codec_alg_priv_t *ctx,
   if (ctx->decoder_init) {
     ctx->yv12_frame_buffers.pbi[0]->decrypt_cb = ctx->decrypt_cb;
     ctx->yv12_frame_buffers.pbi[0]->decrypt_state = ctx->decrypt_state;
+    ctx->yv12_frame_buffers.pbi[0]->get_ext_fb_cb = ctx->get_ext_fb_cb;
+    ctx->yv12_frame_buffers.pbi[0]->release_ext_fb_cb = ctx->release_ext_fb_cb;
+    ctx->yv12_frame_buffers.pbi[0]->ext_priv = ctx->ext_priv;
   }
 
   if (!res) {
@@ -398,6 +404,7 @@ static vpx_codec_err_t vp8_decode(vpx_codec_alg_priv_t *ctx,
                              "Invalid frame height");
         }
 
+        vp8dx_release_ext_fbs(pbi);
         if (vp8_alloc_frame_buffers(pc, pc->Width, pc->Height)) {
           vpx_internal_error(&pc->error, VPX_CODEC_MEM_ERROR,
                              "Failed to allocate frame buffers");
@@ -463,9 +470,7 @@ static vpx_codec_err_t vp8_decode(vpx_codec_alg_priv_t *ctx,
        */
       pc->yv12_fb[pc->lst_fb_idx].corrupted = 1;
 
-      if (pc->fb_idx_ref_cnt[pc->new_fb_idx] > 0) {
-        pc->fb_idx_ref_cnt[pc->new_fb_idx]--;
-      }
+      if (pc->new_fb_idx >= 0) vp8dx_release_fb(pbi, pc->new_fb_idx);
       pc->error.setjmp = 0;
 #if CONFIG_MULTITHREAD
       if (pbi->restart_threads) {
@@ -518,8 +523,17 @@ static vpx_image_t *vp8_get_frame(vpx_codec_alg_priv_t *ctx,
 
     if (0 == vp8dx_get_raw_frame(ctx->yv12_frame_buffers.pbi[0], &sd,
                                  &time_stamp, &time_end_stamp, &flags)) {
+      const VP8D_COMP *const pbi = ctx->yv12_frame_buffers.pbi[0];
+      const int held = pbi->held_fb_idx;
+
       yuvconfig2image(&ctx->img, &sd, ctx->user_priv);
 
+      /* Postprocessed frames are in a buffer of our own. */
+      ctx->img.fb_priv = NULL;
+      if (held >= 0 && sd.y_buffer == pbi->common.yv12_fb[held].y_buffer) {
+        ctx->img.fb_priv = pbi->ext_fb[held].priv;
+      }
+
       img = &ctx->img;
       *iter = img;
     }
@@ -687,6 +701,23 @@ static vpx_codec_err_t vp8_set_decryptor(vpx_codec_alg_priv_t *ctx,
   return VPX_CODEC_OK;
 }
 
+static vpx_codec_err_t vp8_set_fb_fn(
+    vpx_codec_alg_priv_t *ctx, vpx_get_frame_buffer_cb_fn_t cb_get,
+    vpx_release_frame_buffer_cb_fn_t cb_release, void *cb_priv) {
+  if (cb_get == NULL || cb_release == NULL) {
+    return VPX_CODEC_INVALID_PARAM;
+  } else if (!ctx->decoder_init) {
+    /* The callbacks are passed on to the decoder when it is created on the
+     * first frame. */
+    ctx->get_ext_fb_cb = cb_get;
+    ctx->release_ext_fb_cb = cb_release;
+    ctx->ext_priv = cb_priv;
+    return VPX_CODEC_OK;
+  }
+
+  return VPX_CODEC_ERROR;
+}
+
 static vpx_codec_ctrl_fn_map_t vp8_ctf_maps[] = {
   { VP8_SET_REFERENCE, vp8_set_reference },
   { VP8_COPY_REFERENCE, vp8_get_reference },
@@ -706,7 +737,7 @@ CODEC_INTERFACE(vpx_codec_vp8_dx) = {
   "WebM Project VP8 Decoder" VERSION_STRING,
   VPX_CODEC_INTERNAL_ABI_VERSION,
   VPX_CODEC_CAP_DECODER | VP8_CAP_POSTPROC | VP8_CAP_ERROR_CONCEALMENT |
-      VPX_CODEC_CAP_INPUT_FRAGMENTS,
+      VPX_CODEC_CAP_INPUT_FRAGMENTS | VPX_CODEC_CAP_EXTERNAL_FRAME_BUFFER,
   /* vpx_codec_caps_t          caps; */
   vp8_init,     /* vpx_codec_init_fn_t       init; */
   vp8_destroy,  /* vpx_codec_destroy_fn_t    destroy; */
@@ -716,7 +747,7 @@ CODEC_INTERFACE(vpx_codec_vp8_dx) = {
       vp8_get_si,    /* vpx_codec_get_si_fn_t     get_si; */
       vp8_decode,    /* vpx_codec_decode_fn_t     decode; */
       vp8_get_frame, /* vpx_codec_frame_get_fn_t  frame_get; */
-      NULL,
+      vp8_set_fb_fn, /* vpx_codec_set_fb_fn_t     set_fb_fn; */
   },
   {
       /* encoder functions */
@@ -65,6 +65,7 @@ static void free_seg_map(VP9_COMMON *cm) {
     vpx_free(cm->seg_map_array[i]);
     cm->seg_map_array[i] = NULL;
   }
+  cm->seg_map_alloc_size = 0;
 
   cm->current_frame_seg_map = NULL;
   cm->last_frame_seg_map = NULL;
@@ -82,6 +83,8 @@ void vp9_free_ref_frame_buffers(BufferPool *pool) {
     }
     vpx_free(pool->frame_bufs[i].mvs);
     pool->frame_bufs[i].mvs = NULL;
+    vpx_free(pool->frame_bufs[i].seg_map);
+    pool->frame_bufs[i].seg_map = NULL;
     vpx_free_frame_buffer(&pool->frame_bufs[i].buf);
   }
 }
@@ -94,6 +97,9 @@ void vp9_free_postproc_buffers(VP9_COMMON *cm) {
   cm->postproc_state.limits = NULL;
   vpx_free(cm->postproc_state.generated_noise);
   cm->postproc_state.generated_noise = NULL;
+  vpx_free(cm->postproc_state.worker_data);
+  cm->postproc_state.worker_data = NULL;
+  cm->postproc_state.num_workers = 0;
 #else
   (void)cm;
 #endif
@@ -106,12 +112,17 @@ void vp9_free_context_buffers(VP9_COMMON *cm) {
   cm->above_context = NULL;
   vpx_free(cm->above_seg_context);
   cm->above_seg_context = NULL;
+  cm->above_context_alloc_cols = 0;
   vpx_free(cm->lf.lfm);
   cm->lf.lfm = NULL;
+  vpx_free(cm->lf.lfm_sig);
+  cm->lf.lfm_sig = NULL;
 }
 
 int vp9_alloc_loop_filter(VP9_COMMON *cm) {
   vpx_free(cm->lf.lfm);
+  vpx_free(cm->lf.lfm_sig);
+  cm->lf.lfm_sig = NULL;
   // Each lfm holds bit masks for all the 8x8 blocks in a 64x64 region.  The
   // stride and rows are rounded up / truncated to a multiple of 8.
   cm->lf.lfm_stride = (cm->mi_cols + (MI_BLOCK_SIZE - 1)) >> 3;
@@ -177,7 +188,8 @@ void vp9_remove_common(VP9_COMMON *cm) {
 
 void vp9_init_context_buffers(VP9_COMMON *cm) {
   cm->setup_mi(cm);
-  if (cm->last_frame_seg_map)
+  // In frame parallel decode the map belongs to another frame's buffer.
+  if (cm->last_frame_seg_map && !cm->frame_parallel_decode)
     memset(cm->last_frame_seg_map, 0, cm->mi_rows * cm->mi_cols);
 }
 
@@ -44,6 +44,18 @@ int vp9_get_frame_buffer(void *cb_priv, size_t min_size,
       (InternalFrameBufferList *)cb_priv;
   if (int_fb_list == NULL) return -1;
 
+  if (int_fb_list->low_memory) {
+    // Drop the buffers left from frames of other sizes, larger ones included.
+    for (i = 0; i < int_fb_list->num_internal_frame_buffers; ++i) {
+      InternalFrameBuffer *const int_fb = &int_fb_list->int_fb[i];
+      if (!int_fb->in_use && int_fb->size != min_size) {
+        vpx_free(int_fb->data);
+        int_fb->data = NULL;
+        int_fb->size = 0;
+      }
+    }
+  }
+
   // Find a free frame buffer.
   for (i = 0; i < int_fb_list->num_internal_frame_buffers; ++i) {
     if (!int_fb_list->int_fb[i].in_use) break;
@@ -27,6 +27,8 @@ typedef struct InternalFrameBuffer {
 typedef struct InternalFrameBufferList {
   int num_internal_frame_buffers;
   InternalFrameBuffer *int_fb;
+  // Free the buffers not in use when a frame of another size is requested.
+  int low_memory;
 } InternalFrameBufferList;
 
 // Initializes |list|. Returns 0 on success.
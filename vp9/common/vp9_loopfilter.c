@@ -16,6 +16,7 @@
 #include "vpx_dsp/vpx_dsp_common.h"
 #include "vpx_mem/vpx_mem.h"
 #include "vpx_ports/mem.h"
+#include "vpx_ports/vpx_timer.h"
 
 #include "vp9/common/vp9_seg_common.h"
 
@@ -877,13 +878,29 @@ void vp9_adjust_mask(VP9_COMMON *const cm, const int mi_row, const int mi_col,
   assert(!(lfm->int_4x4_uv & lfm->above_uv[TX_16X16]));
 }
 
-// This function sets up the bit masks for the entire 64x64 region represented
-// by mi_row, mi_col.
-void vp9_setup_mask(VP9_COMMON *const cm, const int mi_row, const int mi_col,
-                    MODE_INFO **mi8x8, const int mode_info_stride,
-                    LOOP_FILTER_MASK *lfm) {
+// A block of a 64x64 region, whose masks are built with build_masks(), or
+// build_y_mask() if y_only is set.
+typedef struct {
+  const MODE_INFO *mi;
+  int shift_y;
+  int y_only;
+} LF_BLOCK;
+
+static INLINE void add_block(const MODE_INFO *mi, int shift_y, int y_only,
+                             LF_BLOCK *blocks, int *num_blocks) {
+  LF_BLOCK *const b = &blocks[(*num_blocks)++];
+  b->mi = mi;
+  b->shift_y = shift_y;
+  b->y_only = y_only;
+}
+
+// Lists in 'blocks' the blocks of the 64x64 region represented by mi_row,
+// mi_col and returns their number.
+static int get_sb_blocks(const VP9_COMMON *const cm, const int mi_row,
+                         const int mi_col, MODE_INFO **mi8x8,
+                         const int mode_info_stride, LF_BLOCK *blocks) {
   int idx_32, idx_16, idx_8;
-  const loop_filter_info_n *const lfi_n = &cm->lf_info;
+  int num_blocks = 0;
   MODE_INFO **mip = mi8x8;
   MODE_INFO **mip2 = mi8x8;
 
@@ -904,8 +921,6 @@ void vp9_setup_mask(VP9_COMMON *const cm, const int mi_row, const int mi_col,
   const int shift_32_y[] = { 0, 4, 32, 36 };
   const int shift_16_y[] = { 0, 2, 16, 18 };
   const int shift_8_y[] = { 0, 1, 8, 9 };
-  const int shift_32_uv[] = { 0, 2, 8, 10 };
-  const int shift_16_uv[] = { 0, 1, 4, 5 };
   const int max_rows =
       (mi_row + MI_BLOCK_SIZE > cm->mi_rows ? cm->mi_rows - mi_row
                                             : MI_BLOCK_SIZE);
@@ -913,51 +928,48 @@ void vp9_setup_mask(VP9_COMMON *const cm, const int mi_row, const int mi_col,
       (mi_col + MI_BLOCK_SIZE > cm->mi_cols ? cm->mi_cols - mi_col
                                             : MI_BLOCK_SIZE);
 
-  vp9_zero(*lfm);
   assert(mip[0] != NULL);
 
   switch (mip[0]->sb_type) {
-    case BLOCK_64X64: build_masks(lfi_n, mip[0], 0, 0, lfm); break;
+    case BLOCK_64X64: add_block(mip[0], 0, 0, blocks, &num_blocks); break;
     case BLOCK_64X32:
-      build_masks(lfi_n, mip[0], 0, 0, lfm);
+      add_block(mip[0], 0, 0, blocks, &num_blocks);
       mip2 = mip + mode_info_stride * 4;
       if (4 >= max_rows) break;
-      build_masks(lfi_n, mip2[0], 32, 8, lfm);
+      add_block(mip2[0], 32, 0, blocks, &num_blocks);
       break;
     case BLOCK_32X64:
-      build_masks(lfi_n, mip[0], 0, 0, lfm);
+      add_block(mip[0], 0, 0, blocks, &num_blocks);
       mip2 = mip + 4;
       if (4 >= max_cols) break;
-      build_masks(lfi_n, mip2[0], 4, 2, lfm);
+      add_block(mip2[0], 4, 0, blocks, &num_blocks);
       break;
     default:
       for (idx_32 = 0; idx_32 < 4; mip += offset_32[idx_32], ++idx_32) {
         const int shift_y = shift_32_y[idx_32];
-        const int shift_uv = shift_32_uv[idx_32];
         const int mi_32_col_offset = ((idx_32 & 1) << 2);
         const int mi_32_row_offset = ((idx_32 >> 1) << 2);
         if (mi_32_col_offset >= max_cols || mi_32_row_offset >= max_rows)
           continue;
         switch (mip[0]->sb_type) {
           case BLOCK_32X32:
-            build_masks(lfi_n, mip[0], shift_y, shift_uv, lfm);
+            add_block(mip[0], shift_y, 0, blocks, &num_blocks);
             break;
           case BLOCK_32X16:
-            build_masks(lfi_n, mip[0], shift_y, shift_uv, lfm);
+            add_block(mip[0], shift_y, 0, blocks, &num_blocks);
             if (mi_32_row_offset + 2 >= max_rows) continue;
             mip2 = mip + mode_info_stride * 2;
-            build_masks(lfi_n, mip2[0], shift_y + 16, shift_uv + 4, lfm);
+            add_block(mip2[0], shift_y + 16, 0, blocks, &num_blocks);
             break;
           case BLOCK_16X32:
-            build_masks(lfi_n, mip[0], shift_y, shift_uv, lfm);
+            add_block(mip[0], shift_y, 0, blocks, &num_blocks);
             if (mi_32_col_offset + 2 >= max_cols) continue;
             mip2 = mip + 2;
-            build_masks(lfi_n, mip2[0], shift_y + 2, shift_uv + 1, lfm);
+            add_block(mip2[0], shift_y + 2, 0, blocks, &num_blocks);
             break;
           default:
             for (idx_16 = 0; idx_16 < 4; mip += offset_16[idx_16], ++idx_16) {
               const int shift_y = shift_32_y[idx_32] + shift_16_y[idx_16];
-              const int shift_uv = shift_32_uv[idx_32] + shift_16_uv[idx_16];
               const int mi_16_col_offset =
                   mi_32_col_offset + ((idx_16 & 1) << 1);
               const int mi_16_row_offset =
@@ -968,24 +980,24 @@ void vp9_setup_mask(VP9_COMMON *const cm, const int mi_row, const int mi_col,
 
               switch (mip[0]->sb_type) {
                 case BLOCK_16X16:
-                  build_masks(lfi_n, mip[0], shift_y, shift_uv, lfm);
+                  add_block(mip[0], shift_y, 0, blocks, &num_blocks);
                   break;
                 case BLOCK_16X8:
-                  build_masks(lfi_n, mip[0], shift_y, shift_uv, lfm);
+                  add_block(mip[0], shift_y, 0, blocks, &num_blocks);
                   if (mi_16_row_offset + 1 >= max_rows) continue;
                   mip2 = mip + mode_info_stride;
-                  build_y_mask(lfi_n, mip2[0], shift_y + 8, lfm);
+                  add_block(mip2[0], shift_y + 8, 1, blocks, &num_blocks);
                   break;
                 case BLOCK_8X16:
-                  build_masks(lfi_n, mip[0], shift_y, shift_uv, lfm);
+                  add_block(mip[0], shift_y, 0, blocks, &num_blocks);
                   if (mi_16_col_offset + 1 >= max_cols) continue;
                   mip2 = mip + 1;
-                  build_y_mask(lfi_n, mip2[0], shift_y + 1, lfm);
+                  add_block(mip2[0], shift_y + 1, 1, blocks, &num_blocks);
                   break;
                 default: {
                   const int shift_y =
                       shift_32_y[idx_32] + shift_16_y[idx_16] + shift_8_y[0];
-                  build_masks(lfi_n, mip[0], shift_y, shift_uv, lfm);
+                  add_block(mip[0], shift_y, 0, blocks, &num_blocks);
                   mip += offset[0];
                   for (idx_8 = 1; idx_8 < 4; mip += offset[idx_8], ++idx_8) {
                     const int shift_y = shift_32_y[idx_32] +
@@ -998,7 +1010,7 @@ void vp9_setup_mask(VP9_COMMON *const cm, const int mi_row, const int mi_col,
                     if (mi_8_col_offset >= max_cols ||
                         mi_8_row_offset >= max_rows)
                       continue;
-                    build_y_mask(lfi_n, mip[0], shift_y, lfm);
+                    add_block(mip[0], shift_y, 1, blocks, &num_blocks);
                   }
                   break;
                 }
@@ -1009,6 +1021,95 @@ void vp9_setup_mask(VP9_COMMON *const cm, const int mi_row, const int mi_col,
       }
       break;
   }
+  return num_blocks;
+}
+
+static void build_sb_masks(const loop_filter_info_n *const lfi_n,
+                           const LF_BLOCK *blocks, int num_blocks,
+                           LOOP_FILTER_MASK *lfm) {
+  int i;
+
+  vp9_zero(*lfm);
+  for (i = 0; i < num_blocks; ++i) {
+    const LF_BLOCK *const b = &blocks[i];
+    // The uv masks are on a 4x4 grid of 16x16 blocks.
+    const int shift_uv = ((b->shift_y & 7) >> 1) + ((b->shift_y >> 4) << 2);
+    if (b->y_only)
+      build_y_mask(lfi_n, b->mi, b->shift_y, lfm);
+    else
+      build_masks(lfi_n, b->mi, b->shift_y, shift_uv, lfm);
+  }
+}
+
+// This function sets up the bit masks for the entire 64x64 region represented
+// by mi_row, mi_col.
+void vp9_setup_mask(VP9_COMMON *const cm, const int mi_row, const int mi_col,
+                    MODE_INFO **mi8x8, const int mode_info_stride,
+                    LOOP_FILTER_MASK *lfm) {
+  LF_BLOCK blocks[MI_BLOCK_SIZE * MI_BLOCK_SIZE];
+  const int num_blocks =
+      get_sb_blocks(cm, mi_row, mi_col, mi8x8, mode_info_stride, blocks);
+  build_sb_masks(&cm->lf_info, blocks, num_blocks, lfm);
+}
+
+// Packs what the masks of a block depend on: its position, size, transform
+// size, whether its transform edges are filtered and its filter level. The
+// filter level, above BLOCK_SIG_LEVEL_SHIFT, only sets lfl_y once the block is
+// known to be filtered.
+#define BLOCK_SIG_LEVEL_SHIFT 15
+static uint32_t get_block_sig(const loop_filter_info_n *const lfi_n,
+                              const LF_BLOCK *b) {
+  const MODE_INFO *const mi = b->mi;
+  const uint32_t filter_level = get_filter_level(lfi_n, mi);
+  return (uint32_t)b->shift_y | (uint32_t)b->y_only << 6 |
+         (uint32_t)mi->sb_type << 7 | (uint32_t)mi->tx_size << 11 |
+         (uint32_t)(mi->skip && is_inter_block(mi)) << 13 |
+         (uint32_t)(filter_level != 0) << 14 |
+         filter_level << BLOCK_SIG_LEVEL_SHIFT;
+}
+
+// Same as vp9_setup_mask() but keeps the masks of 'lfm' while the blocks are
+// the same as when they were built, as happens from frame to frame with
+// static content, only updating the filter levels. vp9_adjust_mask() can be
+// applied again to an adjusted 'lfm'.
+static void setup_mask_cached(VP9_COMMON *const cm, const int mi_row,
+                              const int mi_col, MODE_INFO **mi8x8,
+                              LOOP_FILTER_MASK *lfm,
+                              LOOP_FILTER_MASK_SIG *sig) {
+  const loop_filter_info_n *const lfi_n = &cm->lf_info;
+  const uint32_t mask_bits = (1 << BLOCK_SIG_LEVEL_SHIFT) - 1;
+  LF_BLOCK blocks[MI_BLOCK_SIZE * MI_BLOCK_SIZE];
+  const int num_blocks =
+      get_sb_blocks(cm, mi_row, mi_col, mi8x8, cm->mi_stride, blocks);
+  int masks_changed = num_blocks != sig->num_blocks;
+  int levels_changed = 0;
+  int i;
+
+  for (i = 0; i < num_blocks; ++i) {
+    const uint32_t block_sig = get_block_sig(lfi_n, &blocks[i]);
+    masks_changed |= (block_sig ^ sig->blocks[i]) & mask_bits;
+    levels_changed |= block_sig != sig->blocks[i];
+    sig->blocks[i] = block_sig;
+  }
+  sig->num_blocks = num_blocks;
+
+  if (masks_changed) {
+    build_sb_masks(lfi_n, blocks, num_blocks, lfm);
+  } else if (levels_changed) {
+    for (i = 0; i < num_blocks; ++i) {
+      const BLOCK_SIZE block_size = blocks[i].mi->sb_type;
+      const int filter_level = sig->blocks[i] >> BLOCK_SIG_LEVEL_SHIFT;
+      const int w = num_8x8_blocks_wide_lookup[block_size];
+      const int h = num_8x8_blocks_high_lookup[block_size];
+      int index = blocks[i].shift_y;
+      int r;
+      if (!filter_level) continue;
+      for (r = 0; r < h; ++r) {
+        memset(&lfm->lfl_y[index], filter_level, w);
+        index += 8;
+      }
+    }
+  }
 }
 
 static void filter_selectively_vert(
@@ -1421,53 +1522,69 @@ void vp9_filter_block_plane_ss11(VP9_COMMON *const cm,
   }
 }
 
-static void loop_filter_rows(YV12_BUFFER_CONFIG *frame_buffer, VP9_COMMON *cm,
-                             struct macroblockd_plane planes[MAX_MB_PLANE],
-                             int start, int stop, int y_only) {
-  const int num_planes = y_only ? 1 : MAX_MB_PLANE;
-  enum lf_path path;
-  int mi_row, mi_col;
-
+static enum lf_path get_lf_path(const struct macroblockd_plane *planes,
+                                int y_only) {
   if (y_only)
-    path = LF_PATH_444;
+    return LF_PATH_444;
   else if (planes[1].subsampling_y == 1 && planes[1].subsampling_x == 1)
-    path = LF_PATH_420;
+    return LF_PATH_420;
   else if (planes[1].subsampling_y == 0 && planes[1].subsampling_x == 0)
-    path = LF_PATH_444;
+    return LF_PATH_444;
   else
-    path = LF_PATH_SLOW;
-
-  for (mi_row = start; mi_row < stop; mi_row += MI_BLOCK_SIZE) {
-    MODE_INFO **mi = cm->mi_grid_visible + mi_row * cm->mi_stride;
-    LOOP_FILTER_MASK *lfm = get_lfm(&cm->lf, mi_row, 0);
-
-    for (mi_col = 0; mi_col < cm->mi_cols; mi_col += MI_BLOCK_SIZE, ++lfm) {
-      int plane;
+    return LF_PATH_SLOW;
+}
 
-      vp9_setup_dst_planes(planes, frame_buffer, mi_row, mi_col);
+static void filter_sb(YV12_BUFFER_CONFIG *frame_buffer, VP9_COMMON *cm,
+                      struct macroblockd_plane planes[MAX_MB_PLANE],
+                      int num_planes, enum lf_path path, int mi_row,
+                      int mi_col) {
+  MODE_INFO **const mi = cm->mi_grid_visible + mi_row * cm->mi_stride;
+  LOOP_FILTER_MASK *const lfm = get_lfm(&cm->lf, mi_row, mi_col);
+  int plane;
+
+  vp9_setup_dst_planes(planes, frame_buffer, mi_row, mi_col);
+
+  // TODO(jimbankoski): For 444 only need to do y mask.
+  vp9_adjust_mask(cm, mi_row, mi_col, lfm);
+
+  vp9_filter_block_plane_ss00(cm, &planes[0], mi_row, lfm);
+  for (plane = 1; plane < num_planes; ++plane) {
+    switch (path) {
+      case LF_PATH_420:
+        vp9_filter_block_plane_ss11(cm, &planes[plane], mi_row, lfm);
+        break;
+      case LF_PATH_444:
+        vp9_filter_block_plane_ss00(cm, &planes[plane], mi_row, lfm);
+        break;
+      case LF_PATH_SLOW:
+        vp9_filter_block_plane_non420(cm, &planes[plane], mi + mi_col, mi_row,
+                                      mi_col);
+        break;
+    }
+  }
+}
 
-      // TODO(jimbankoski): For 444 only need to do y mask.
-      vp9_adjust_mask(cm, mi_row, mi_col, lfm);
+static void loop_filter_rows(YV12_BUFFER_CONFIG *frame_buffer, VP9_COMMON *cm,
+                             struct macroblockd_plane planes[MAX_MB_PLANE],
+                             int start, int stop, int y_only) {
+  const int num_planes = y_only ? 1 : MAX_MB_PLANE;
+  const enum lf_path path = get_lf_path(planes, y_only);
+  int mi_row, mi_col;
 
-      vp9_filter_block_plane_ss00(cm, &planes[0], mi_row, lfm);
-      for (plane = 1; plane < num_planes; ++plane) {
-        switch (path) {
-          case LF_PATH_420:
-            vp9_filter_block_plane_ss11(cm, &planes[plane], mi_row, lfm);
-            break;
-          case LF_PATH_444:
-            vp9_filter_block_plane_ss00(cm, &planes[plane], mi_row, lfm);
-            break;
-          case LF_PATH_SLOW:
-            vp9_filter_block_plane_non420(cm, &planes[plane], mi + mi_col,
-                                          mi_row, mi_col);
-            break;
-        }
-      }
+  for (mi_row = start; mi_row < stop; mi_row += MI_BLOCK_SIZE) {
+    for (mi_col = 0; mi_col < cm->mi_cols; mi_col += MI_BLOCK_SIZE) {
+      filter_sb(frame_buffer, cm, planes, num_planes, path, mi_row, mi_col);
     }
   }
 }
 
+void vp9_loop_filter_sb(YV12_BUFFER_CONFIG *frame_buffer, VP9_COMMON *cm,
+                        struct macroblockd_plane planes[MAX_MB_PLANE],
+                        int mi_row, int mi_col) {
+  filter_sb(frame_buffer, cm, planes, MAX_MB_PLANE, get_lf_path(planes, 0),
+            mi_row, mi_col);
+}
+
 void vp9_loop_filter_frame(YV12_BUFFER_CONFIG *frame, VP9_COMMON *cm,
                            MACROBLOCKD *xd, int frame_filter_level, int y_only,
                            int partial_frame) {
@@ -1489,6 +1606,7 @@ void vp9_loop_filter_frame(YV12_BUFFER_CONFIG *frame, VP9_COMMON *cm,
 //                   build the masks in line as part of the encode process.
 void vp9_build_mask_frame(VP9_COMMON *cm, int frame_filter_level,
                           int partial_frame) {
+  struct loopfilter *const lf = &cm->lf;
   int start_mi_row, end_mi_row, mi_rows_to_filter;
   int mi_col, mi_row;
   if (!frame_filter_level) return;
@@ -1503,12 +1621,33 @@ void vp9_build_mask_frame(VP9_COMMON *cm, int frame_filter_level,
 
   vp9_loop_filter_frame_init(cm, frame_filter_level);
 
+  // The masks adjusted for another frame size can't be reused.
+  if (lf->lfm_sig != NULL &&
+      (lf->lfm_sig_mi_rows != cm->mi_rows ||
+       lf->lfm_sig_mi_cols != cm->mi_cols)) {
+    vpx_free(lf->lfm_sig);
+    lf->lfm_sig = NULL;
+  }
+  if (lf->lfm_sig == NULL) {
+    // Without it the masks are all built again.
+    lf->lfm_sig = (LOOP_FILTER_MASK_SIG *)vpx_calloc(
+        ((cm->mi_rows + (MI_BLOCK_SIZE - 1)) >> 3) * lf->lfm_stride,
+        sizeof(*lf->lfm_sig));
+    lf->lfm_sig_mi_rows = cm->mi_rows;
+    lf->lfm_sig_mi_cols = cm->mi_cols;
+  }
+
   for (mi_row = start_mi_row; mi_row < end_mi_row; mi_row += MI_BLOCK_SIZE) {
     MODE_INFO **mi = cm->mi_grid_visible + mi_row * cm->mi_stride;
     for (mi_col = 0; mi_col < cm->mi_cols; mi_col += MI_BLOCK_SIZE) {
-      // vp9_setup_mask() zeros lfm
-      vp9_setup_mask(cm, mi_row, mi_col, mi + mi_col, cm->mi_stride,
-                     get_lfm(&cm->lf, mi_row, mi_col));
+      LOOP_FILTER_MASK *const lfm = get_lfm(lf, mi_row, mi_col);
+      if (lf->lfm_sig != NULL) {
+        setup_mask_cached(cm, mi_row, mi_col, mi + mi_col, lfm,
+                          &lf->lfm_sig[lfm - lf->lfm]);
+      } else {
+        // vp9_setup_mask() zeros lfm
+        vp9_setup_mask(cm, mi_row, mi_col, mi + mi_col, cm->mi_stride, lfm);
+      }
     }
   }
 }
@@ -1615,6 +1754,8 @@ void vp9_loop_filter_data_reset(
   lf_data->start = 0;
   lf_data->stop = 0;
   lf_data->y_only = 0;
+  lf_data->filter_time = 0;
+  lf_data->wait_time = 0;
   memcpy(lf_data->planes, planes, sizeof(lf_data->planes));
 }
 
@@ -1623,13 +1764,17 @@ void vp9_reset_lfm(VP9_COMMON *const cm) {
     memset(cm->lf.lfm, 0,
            ((cm->mi_rows + (MI_BLOCK_SIZE - 1)) >> 3) * cm->lf.lfm_stride *
                sizeof(*cm->lf.lfm));
+    vpx_free(cm->lf.lfm_sig);
+    cm->lf.lfm_sig = NULL;
   }
 }
 
 int vp9_loop_filter_worker(void *arg1, void *unused) {
   LFWorkerData *const lf_data = (LFWorkerData *)arg1;
+  const int64_t start = vpx_nsec_time();
   (void)unused;
   loop_filter_rows(lf_data->frame_buffer, lf_data->cm, lf_data->planes,
                    lf_data->start, lf_data->stop, lf_data->y_only);
+  lf_data->filter_time += vpx_nsec_time() - start;
   return 1;
 }
@@ -67,6 +67,13 @@ typedef struct {
   uint8_t lfl_y[64];
 } LOOP_FILTER_MASK;
 
+// The blocks a LOOP_FILTER_MASK was built from, for vp9_build_mask_frame() to
+// reuse it while they don't change. num_blocks is 0 until it is built.
+typedef struct {
+  int num_blocks;
+  uint32_t blocks[64];
+} LOOP_FILTER_MASK_SIG;
+
 struct loopfilter {
   int filter_level;
   int last_filt_level;
@@ -87,6 +94,11 @@ struct loopfilter {
 
   LOOP_FILTER_MASK *lfm;
   int lfm_stride;
+
+  // Parallel to lfm, allocated by vp9_build_mask_frame() for the frame size
+  // mi_rows x mi_cols.
+  LOOP_FILTER_MASK_SIG *lfm_sig;
+  int lfm_sig_mi_rows, lfm_sig_mi_cols;
 };
 
 /* assorted loopfilter functions which get used elsewhere */
@@ -123,6 +135,12 @@ void vp9_loop_filter_frame(YV12_BUFFER_CONFIG *frame, struct VP9Common *cm,
                            struct macroblockd *xd, int frame_filter_level,
                            int y_only, int partial_frame);
 
+// Filters the superblock at ('mi_row', 'mi_col'), all the planes, once the
+// superblocks before it in raster order are filtered.
+void vp9_loop_filter_sb(YV12_BUFFER_CONFIG *frame_buffer, struct VP9Common *cm,
+                        struct macroblockd_plane planes[MAX_MB_PLANE],
+                        int mi_row, int mi_col);
+
 // Get the superblock lfm for a given mi_row, mi_col.
 static INLINE LOOP_FILTER_MASK *get_lfm(const struct loopfilter *lf,
                                         const int mi_row, const int mi_col) {
@@ -145,6 +163,11 @@ typedef struct LoopFilterWorkerData {
   int start;
   int stop;
   int y_only;
+
+  // Time spent filtering, and waiting for the rows the filtering depends on
+  // when filtering with several threads, in nanoseconds.
+  int64_t filter_time;
+  int64_t wait_time;
 } LFWorkerData;
 
 void vp9_loop_filter_data_reset(
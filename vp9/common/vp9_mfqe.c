@@ -340,14 +340,17 @@ static void mfqe_partition(VP9_COMMON *cm, MODE_INFO *mi, BLOCK_SIZE bs,
   }
 }
 
-void vp9_mfqe(VP9_COMMON *cm) {
+void vp9_mfqe(VP9_COMMON *cm) { vp9_mfqe_rows(cm, 0, 1); }
+
+void vp9_mfqe_rows(VP9_COMMON *cm, int start, int step) {
   int mi_row, mi_col;
   // Current decoded frame.
   const YV12_BUFFER_CONFIG *show = cm->frame_to_show;
   // Last decoded frame and will store the MFQE result.
   YV12_BUFFER_CONFIG *dest = &cm->post_proc_buffer;
   // Loop through each super block.
-  for (mi_row = 0; mi_row < cm->mi_rows; mi_row += MI_BLOCK_SIZE) {
+  for (mi_row = start * MI_BLOCK_SIZE; mi_row < cm->mi_rows;
+       mi_row += step * MI_BLOCK_SIZE) {
     for (mi_col = 0; mi_col < cm->mi_cols; mi_col += MI_BLOCK_SIZE) {
       MODE_INFO *mi;
       MODE_INFO *mi_local = cm->mi + (mi_row * cm->mi_stride + mi_col);
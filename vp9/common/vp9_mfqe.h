@@ -24,6 +24,10 @@ extern "C" {
 // difference, etc.
 void vp9_mfqe(struct VP9Common *cm);
 
+// Applies MFQE to the superblock rows 'start', 'start' + 'step', ... The rows
+// are independent, so they can be split between threads.
+void vp9_mfqe_rows(struct VP9Common *cm, int start, int step);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -13,6 +13,7 @@
 
 #include "./vpx_config.h"
 #include "vpx/internal/vpx_codec_internal.h"
+#include "vpx_util/vpx_atomics.h"
 #include "vpx_util/vpx_thread.h"
 #include "./vp9_rtcd.h"
 #include "vp9/common/vp9_alloccommon.h"
@@ -79,6 +80,15 @@ typedef struct {
                            // show_idx defined in EncodeFrameInfo.
   int frame_coding_index;  // The coding order (starting from zero) of this
                            // frame.
+
+  // Only used in frame parallel decode: the segmentation map written by the
+  // frame and the number of luma pixel rows that are completely decoded and
+  // loop filtered.
+  uint8_t *seg_map;
+#if CONFIG_MULTITHREAD
+  vpx_atomic_int row;
+#endif
+
   vpx_codec_frame_buffer_t raw_frame_buffer;
   YV12_BUFFER_CONFIG buf;
 } RefCntBuffer;
@@ -94,6 +104,12 @@ typedef struct BufferPool {
 
   // Frame buffers allocated internally by the codec.
   InternalFrameBufferList int_frame_buffers;
+
+#if CONFIG_MULTITHREAD
+  // Signals row progress of the frame buffers in frame parallel decode.
+  pthread_mutex_t pool_mutex;
+  pthread_cond_t pool_cond;
+#endif
 } BufferPool;
 
 typedef struct VP9Common {
@@ -256,9 +272,15 @@ typedef struct VP9Common {
   int error_resilient_mode;
   int frame_parallel_decoding_mode;
 
+  // Several frames are decoded concurrently, each by its own VP9_COMMON.
+  int frame_parallel_decode;
+
   int log2_tile_cols, log2_tile_rows;
   int byte_alignment;
   int skip_loop_filter;
+  // The buffers sized by the frame dimensions shrink with the frames too, and
+  // only the previous frame keeps its motion vectors.
+  int low_memory;
 
   // External BufferPool passed from outside.
   BufferPool *buffer_pool;
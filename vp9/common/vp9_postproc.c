@@ -19,6 +19,7 @@
 
 #include "vpx_dsp/vpx_dsp_common.h"
 #include "vpx_dsp/postproc.h"
+#include "vpx_mem/vpx_mem.h"
 #include "vpx_ports/mem.h"
 #include "vpx_ports/system_state.h"
 #include "vpx_scale/vpx_scale.h"
@@ -183,11 +184,153 @@ void vp9_highbd_mbpost_proc_down_c(uint16_t *dst, int pitch, int rows, int cols,
 }
 #endif  // CONFIG_VP9_HIGHBITDEPTH
 
+typedef enum {
+  PP_MFQE,
+  // Deblocking, followed by the horizontal pass of the demacroblocking filter.
+  PP_DEBLOCK,
+  // Vertical pass of the demacroblocking filter.
+  PP_MBPOST_DOWN
+} PostProcStage;
+
+// The share of a thread of a post processing stage: the rows start,
+// start + step, ... or for PP_MBPOST_DOWN the strip of columns 'start'.
+typedef struct PostProcWorkerData {
+  VP9_COMMON *cm;
+  PostProcStage stage;
+  const YV12_BUFFER_CONFIG *src;
+  YV12_BUFFER_CONFIG *dst;
+  uint8_t *limits;
+  int mbpost_limit;  // 0 without demacroblocking
+  int start;
+  int step;
+} PostProcWorkerData;
+
+static void deblock_rows(const PostProcWorkerData *data) {
+  const YV12_BUFFER_CONFIG *const src = data->src;
+  YV12_BUFFER_CONFIG *const dst = data->dst;
+  int mbr;
+
+  for (mbr = data->start; mbr < data->cm->mb_rows; mbr += data->step) {
+    vpx_post_proc_down_and_across_mb_row(
+        src->y_buffer + 16 * mbr * src->y_stride,
+        dst->y_buffer + 16 * mbr * dst->y_stride, src->y_stride, dst->y_stride,
+        src->y_width, data->limits, 16);
+    vpx_post_proc_down_and_across_mb_row(
+        src->u_buffer + 8 * mbr * src->uv_stride,
+        dst->u_buffer + 8 * mbr * dst->uv_stride, src->uv_stride,
+        dst->uv_stride, src->uv_width, data->limits, 8);
+    vpx_post_proc_down_and_across_mb_row(
+        src->v_buffer + 8 * mbr * src->uv_stride,
+        dst->v_buffer + 8 * mbr * dst->uv_stride, src->uv_stride,
+        dst->uv_stride, src->uv_width, data->limits, 8);
+    if (data->mbpost_limit) {
+      const int rows = VPXMIN(16, dst->y_height - 16 * mbr);
+      if (rows > 0) {
+        vpx_mbpost_proc_across_ip(dst->y_buffer + 16 * mbr * dst->y_stride,
+                                  dst->y_stride, rows, dst->y_width,
+                                  data->mbpost_limit);
+      }
+    }
+  }
+}
+
+static void mbpost_proc_down_cols(const PostProcWorkerData *data) {
+  YV12_BUFFER_CONFIG *const dst = data->dst;
+  // Whole cache lines per thread. The strips start on a multiple of 8 columns
+  // so the noise added does not depend on the split.
+  const int strip =
+      ALIGN_POWER_OF_TWO((dst->y_width + data->step - 1) / data->step, 6);
+  const int col = data->start * strip;
+
+  if (col < dst->y_width) {
+    vpx_mbpost_proc_down(dst->y_buffer + col, dst->y_stride, dst->y_height,
+                         VPXMIN(strip, dst->y_width - col), data->mbpost_limit);
+  }
+}
+
+static int postproc_worker_hook(void *arg1, void *unused) {
+  const PostProcWorkerData *const data = (const PostProcWorkerData *)arg1;
+  (void)unused;
+  switch (data->stage) {
+    case PP_MFQE: vp9_mfqe_rows(data->cm, data->start, data->step); break;
+    case PP_DEBLOCK: deblock_rows(data); break;
+    default: mbpost_proc_down_cols(data); break;
+  }
+  return 1;
+}
+
+// Runs 'stage' on the workers of the frame, or on the calling thread without
+// any.
+static void run_postproc_stage(VP9_COMMON *cm, PostProcStage stage,
+                               const YV12_BUFFER_CONFIG *src,
+                               YV12_BUFFER_CONFIG *dst, uint8_t *limits,
+                               int mbpost_limit, VPxWorker *workers,
+                               int num_workers) {
+  struct postproc_state *const ppstate = &cm->postproc_state;
+  const VPxWorkerInterface *const winterface = vpx_get_worker_interface();
+  PostProcWorkerData single;
+  PostProcWorkerData *const worker_data =
+      num_workers > 1 ? ppstate->worker_data : &single;
+  int i;
+
+  if (num_workers <= 1) num_workers = 1;
+  for (i = 0; i < num_workers; ++i) {
+    PostProcWorkerData *const data = &worker_data[i];
+    data->cm = cm;
+    data->stage = stage;
+    data->src = src;
+    data->dst = dst;
+    data->limits = limits;
+    data->mbpost_limit = mbpost_limit;
+    data->start = i;
+    data->step = num_workers;
+  }
+
+  if (num_workers == 1) {
+    postproc_worker_hook(&single, NULL);
+    return;
+  }
+
+  for (i = 0; i < num_workers; ++i) {
+    VPxWorker *const worker = &workers[i];
+    worker->hook = postproc_worker_hook;
+    worker->data1 = &worker_data[i];
+    worker->data2 = NULL;
+    if (i == num_workers - 1) {
+      winterface->execute(worker);
+    } else {
+      winterface->launch(worker);
+    }
+  }
+  for (i = 0; i < num_workers; ++i) winterface->sync(&workers[i]);
+}
+
+static int deblock_limit(int q) {
+  return (int)(6.0e-05 * q * q * q - 0.0067 * q * q + 0.306 * q + 0.0065 +
+               0.5);
+}
+
+// Deblocks the 8 bit frame 'src' into 'dst', followed by the
+// demacroblocking filter with 'mbpost_limit' if it is not 0.
+static void deblock_frame(VP9_COMMON *cm, const YV12_BUFFER_CONFIG *src,
+                          YV12_BUFFER_CONFIG *dst, int q, int mbpost_limit,
+                          uint8_t *limits, VPxWorker *workers,
+                          int num_workers) {
+  memset(limits, (unsigned char)deblock_limit(q), 16 * cm->mb_cols);
+  run_postproc_stage(cm, PP_DEBLOCK, src, dst, limits, mbpost_limit, workers,
+                     num_workers);
+  if (mbpost_limit) {
+    run_postproc_stage(cm, PP_MBPOST_DOWN, NULL, dst, limits, mbpost_limit,
+                       workers, num_workers);
+  }
+}
+
 static void deblock_and_de_macro_block(VP9_COMMON *cm,
                                        YV12_BUFFER_CONFIG *source,
                                        YV12_BUFFER_CONFIG *post, int q,
                                        int low_var_thresh, int flag,
-                                       uint8_t *limits) {
+                                       uint8_t *limits, VPxWorker *workers,
+                                       int num_workers) {
   (void)low_var_thresh;
   (void)flag;
 #if CONFIG_VP9_HIGHBITDEPTH
@@ -217,22 +360,19 @@ static void deblock_and_de_macro_block(VP9_COMMON *cm,
         source->uv_height, source->uv_width, ppl);
   } else {
 #endif  // CONFIG_VP9_HIGHBITDEPTH
-    vp9_deblock(cm, source, post, q, limits);
-    vpx_mbpost_proc_across_ip(post->y_buffer, post->y_stride, post->y_height,
-                              post->y_width, q2mbl(q));
-    vpx_mbpost_proc_down(post->y_buffer, post->y_stride, post->y_height,
-                         post->y_width, q2mbl(q));
+    deblock_frame(cm, source, post, q, q2mbl(q), limits, workers,
+                  num_workers);
 #if CONFIG_VP9_HIGHBITDEPTH
   }
 #endif  // CONFIG_VP9_HIGHBITDEPTH
 }
 
-void vp9_deblock(struct VP9Common *cm, const YV12_BUFFER_CONFIG *src,
-                 YV12_BUFFER_CONFIG *dst, int q, uint8_t *limits) {
-  const int ppl =
-      (int)(6.0e-05 * q * q * q - 0.0067 * q * q + 0.306 * q + 0.0065 + 0.5);
+static void deblock_mt(struct VP9Common *cm, const YV12_BUFFER_CONFIG *src,
+                       YV12_BUFFER_CONFIG *dst, int q, uint8_t *limits,
+                       VPxWorker *workers, int num_workers) {
 #if CONFIG_VP9_HIGHBITDEPTH
   if (src->flags & YV12_FLAG_HIGHBITDEPTH) {
+    const int ppl = deblock_limit(q);
     int i;
     const uint8_t *const srcs[3] = { src->y_buffer, src->u_buffer,
                                      src->v_buffer };
@@ -252,30 +392,17 @@ void vp9_deblock(struct VP9Common *cm, const YV12_BUFFER_CONFIG *src,
     }
   } else {
 #endif  // CONFIG_VP9_HIGHBITDEPTH
-    int mbr;
-    const int mb_rows = cm->mb_rows;
-    const int mb_cols = cm->mb_cols;
-    memset(limits, (unsigned char)ppl, 16 * mb_cols);
-
-    for (mbr = 0; mbr < mb_rows; mbr++) {
-      vpx_post_proc_down_and_across_mb_row(
-          src->y_buffer + 16 * mbr * src->y_stride,
-          dst->y_buffer + 16 * mbr * dst->y_stride, src->y_stride,
-          dst->y_stride, src->y_width, limits, 16);
-      vpx_post_proc_down_and_across_mb_row(
-          src->u_buffer + 8 * mbr * src->uv_stride,
-          dst->u_buffer + 8 * mbr * dst->uv_stride, src->uv_stride,
-          dst->uv_stride, src->uv_width, limits, 8);
-      vpx_post_proc_down_and_across_mb_row(
-          src->v_buffer + 8 * mbr * src->uv_stride,
-          dst->v_buffer + 8 * mbr * dst->uv_stride, src->uv_stride,
-          dst->uv_stride, src->uv_width, limits, 8);
-    }
+    deblock_frame(cm, src, dst, q, 0, limits, workers, num_workers);
 #if CONFIG_VP9_HIGHBITDEPTH
   }
 #endif  // CONFIG_VP9_HIGHBITDEPTH
 }
 
+void vp9_deblock(struct VP9Common *cm, const YV12_BUFFER_CONFIG *src,
+                 YV12_BUFFER_CONFIG *dst, int q, uint8_t *limits) {
+  deblock_mt(cm, src, dst, q, limits, NULL, 0);
+}
+
 void vp9_denoise(struct VP9Common *cm, const YV12_BUFFER_CONFIG *src,
                  YV12_BUFFER_CONFIG *dst, int q, uint8_t *limits) {
   vp9_deblock(cm, src, dst, q, limits);
@@ -294,6 +421,12 @@ static void swap_mi_and_prev_mi(VP9_COMMON *cm) {
 
 int vp9_post_proc_frame(struct VP9Common *cm, YV12_BUFFER_CONFIG *dest,
                         vp9_ppflags_t *ppflags, int unscaled_width) {
+  return vp9_post_proc_frame_mt(cm, dest, ppflags, unscaled_width, NULL, 0);
+}
+
+int vp9_post_proc_frame_mt(struct VP9Common *cm, YV12_BUFFER_CONFIG *dest,
+                           vp9_ppflags_t *ppflags, int unscaled_width,
+                           VPxWorker *workers, int num_workers) {
   const int q = VPXMIN(105, cm->lf.filter_level * 2);
   const int flags = ppflags->post_proc_flag;
   YV12_BUFFER_CONFIG *const ppbuf = &cm->post_proc_buffer;
@@ -363,6 +496,15 @@ int vp9_post_proc_frame(struct VP9Common *cm, YV12_BUFFER_CONFIG *dest,
     }
   }
 
+  if (num_workers > ppstate->num_workers) {
+    vpx_free(ppstate->worker_data);
+    ppstate->worker_data = (PostProcWorkerData *)vpx_malloc(
+        num_workers * sizeof(*ppstate->worker_data));
+    ppstate->num_workers = ppstate->worker_data != NULL ? num_workers : 0;
+  }
+  // Without the worker data the filters run on the calling thread.
+  num_workers = VPXMIN(num_workers, ppstate->num_workers);
+
   if (flags & VP9D_ADDNOISE) {
     if (!cm->postproc_state.generated_noise) {
       cm->postproc_state.generated_noise = vpx_calloc(
@@ -375,7 +517,7 @@ int vp9_post_proc_frame(struct VP9Common *cm, YV12_BUFFER_CONFIG *dest,
       ppstate->last_frame_valid && cm->bit_depth == 8 &&
       ppstate->last_base_qindex <= last_q_thresh &&
       cm->base_qindex - ppstate->last_base_qindex >= q_diff_thresh) {
-    vp9_mfqe(cm);
+    run_postproc_stage(cm, PP_MFQE, NULL, NULL, NULL, 0, workers, num_workers);
     // TODO(jackychen): Consider whether enable deblocking by default
     // if mfqe is enabled. Need to take both the quality and the speed
     // into consideration.
@@ -385,19 +527,21 @@ int vp9_post_proc_frame(struct VP9Common *cm, YV12_BUFFER_CONFIG *dest,
     if ((flags & VP9D_DEMACROBLOCK) && cm->post_proc_buffer_int.buffer_alloc) {
       deblock_and_de_macro_block(cm, &cm->post_proc_buffer_int, ppbuf,
                                  q + (ppflags->deblocking_level - 5) * 10, 1, 0,
-                                 cm->postproc_state.limits);
+                                 cm->postproc_state.limits, workers,
+                                 num_workers);
     } else if (flags & VP9D_DEBLOCK) {
-      vp9_deblock(cm, &cm->post_proc_buffer_int, ppbuf, q,
-                  cm->postproc_state.limits);
+      deblock_mt(cm, &cm->post_proc_buffer_int, ppbuf, q,
+                 cm->postproc_state.limits, workers, num_workers);
     } else {
       vpx_yv12_copy_frame(&cm->post_proc_buffer_int, ppbuf);
     }
   } else if (flags & VP9D_DEMACROBLOCK) {
     deblock_and_de_macro_block(cm, cm->frame_to_show, ppbuf,
                                q + (ppflags->deblocking_level - 5) * 10, 1, 0,
-                               cm->postproc_state.limits);
+                               cm->postproc_state.limits, workers, num_workers);
   } else if (flags & VP9D_DEBLOCK) {
-    vp9_deblock(cm, cm->frame_to_show, ppbuf, q, cm->postproc_state.limits);
+    deblock_mt(cm, cm->frame_to_show, ppbuf, q, cm->postproc_state.limits,
+               workers, num_workers);
   } else {
     vpx_yv12_copy_frame(cm->frame_to_show, ppbuf);
   }
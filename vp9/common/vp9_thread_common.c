@@ -13,6 +13,7 @@
 #include "./vpx_config.h"
 #include "vpx_dsp/vpx_dsp_common.h"
 #include "vpx_mem/vpx_mem.h"
+#include "vpx_ports/vpx_timer.h"
 #include "vp9/common/vp9_entropymode.h"
 #include "vp9/common/vp9_thread_common.h"
 #include "vp9/common/vp9_reconinter.h"
@@ -35,16 +36,24 @@ static INLINE void mutex_lock(pthread_mutex_t *const mutex) {
 }
 #endif  // CONFIG_MULTITHREAD
 
-static INLINE void sync_read(VP9LfSync *const lf_sync, int r, int c) {
+// Waits for the superblock row 'r' to be filtered past column 'c', 'r' being
+// the row above or, with the planes filtered separately, the same row of the
+// luma plane. The time spent waiting is added to 'wait_time'.
+static INLINE void sync_read(VP9LfSync *const lf_sync, int r, int c,
+                             int64_t *const wait_time) {
 #if CONFIG_MULTITHREAD
   const int nsync = lf_sync->sync_range;
 
-  if (r && !(c & (nsync - 1))) {
-    pthread_mutex_t *const mutex = &lf_sync->mutex[r - 1];
+  if (!(c & (nsync - 1))) {
+    pthread_mutex_t *const mutex = &lf_sync->mutex[r];
     mutex_lock(mutex);
 
-    while (c > lf_sync->cur_sb_col[r - 1] - nsync) {
-      pthread_cond_wait(&lf_sync->cond[r - 1], mutex);
+    if (c > lf_sync->cur_sb_col[r] - nsync) {
+      const int64_t start = vpx_nsec_time();
+      do {
+        pthread_cond_wait(&lf_sync->cond[r], mutex);
+      } while (c > lf_sync->cur_sb_col[r] - nsync);
+      *wait_time += vpx_nsec_time() - start;
     }
     pthread_mutex_unlock(mutex);
   }
@@ -52,6 +61,7 @@ static INLINE void sync_read(VP9LfSync *const lf_sync, int r, int c) {
   (void)lf_sync;
   (void)r;
   (void)c;
+  (void)wait_time;
 #endif  // CONFIG_MULTITHREAD
 }
 
@@ -75,7 +85,8 @@ static INLINE void sync_write(VP9LfSync *const lf_sync, int r, int c,
 
     lf_sync->cur_sb_col[r] = cur;
 
-    pthread_cond_signal(&lf_sync->cond[r]);
+    // A luma row is waited on by the row below and by the chroma planes.
+    pthread_cond_broadcast(&lf_sync->cond[r]);
     pthread_mutex_unlock(&lf_sync->mutex[r]);
   }
 #else
@@ -86,24 +97,28 @@ static INLINE void sync_write(VP9LfSync *const lf_sync, int r, int c,
 #endif  // CONFIG_MULTITHREAD
 }
 
+static enum lf_path get_lf_path(const struct macroblockd_plane *planes,
+                                int y_only) {
+  if (y_only)
+    return LF_PATH_444;
+  else if (planes[1].subsampling_y == 1 && planes[1].subsampling_x == 1)
+    return LF_PATH_420;
+  else if (planes[1].subsampling_y == 0 && planes[1].subsampling_x == 0)
+    return LF_PATH_444;
+  else
+    return LF_PATH_SLOW;
+}
+
 // Implement row loopfiltering for each thread.
 static INLINE void thread_loop_filter_rows(
     const YV12_BUFFER_CONFIG *const frame_buffer, VP9_COMMON *const cm,
     struct macroblockd_plane planes[MAX_MB_PLANE], int start, int stop,
-    int y_only, VP9LfSync *const lf_sync) {
+    int y_only, VP9LfSync *const lf_sync, int64_t *const wait_time) {
   const int num_planes = y_only ? 1 : MAX_MB_PLANE;
   const int sb_cols = mi_cols_aligned_to_sb(cm->mi_cols) >> MI_BLOCK_SIZE_LOG2;
   const int num_active_workers = lf_sync->num_active_workers;
+  const enum lf_path path = get_lf_path(planes, y_only);
   int mi_row, mi_col;
-  enum lf_path path;
-  if (y_only)
-    path = LF_PATH_444;
-  else if (planes[1].subsampling_y == 1 && planes[1].subsampling_x == 1)
-    path = LF_PATH_420;
-  else if (planes[1].subsampling_y == 0 && planes[1].subsampling_x == 0)
-    path = LF_PATH_444;
-  else
-    path = LF_PATH_SLOW;
 
   assert(num_active_workers > 0);
 
@@ -117,7 +132,7 @@ static INLINE void thread_loop_filter_rows(
       const int c = mi_col >> MI_BLOCK_SIZE_LOG2;
       int plane;
 
-      sync_read(lf_sync, r, c);
+      if (r > 0) sync_read(lf_sync, r - 1, c, wait_time);
 
       vp9_setup_dst_planes(planes, frame_buffer, mi_row, mi_col);
 
@@ -139,18 +154,108 @@ static INLINE void thread_loop_filter_rows(
         }
       }
 
+      if (c == sb_cols - 1 && lf_sync->row_done != NULL)
+        lf_sync->row_done(lf_sync->row_done_priv, r);
       sync_write(lf_sync, r, c, sb_cols);
     }
   }
 }
 
+// Filters the superblock row at 'mi_row' of one plane. Each plane is filtered
+// as a separate wavefront, the rows of the chroma planes also waiting for the
+// luma plane to adjust the masks of their superblocks. 'r' indexes the rows
+// of all the planes in lf_sync.
+static void thread_loop_filter_plane_row(
+    const YV12_BUFFER_CONFIG *const frame_buffer, VP9_COMMON *const cm,
+    struct macroblockd_plane planes[MAX_MB_PLANE], int plane, int num_planes,
+    enum lf_path path, int mi_row, int first_row, VP9LfSync *const lf_sync,
+    int64_t *const wait_time) {
+  const int sb_cols = mi_cols_aligned_to_sb(cm->mi_cols) >> MI_BLOCK_SIZE_LOG2;
+  const int sb_row = mi_row >> MI_BLOCK_SIZE_LOG2;
+  const int r = plane * lf_sync->rows + sb_row;
+  MODE_INFO **const mi = cm->mi_grid_visible + mi_row * cm->mi_stride;
+  LOOP_FILTER_MASK *lfm = get_lfm(&cm->lf, mi_row, 0);
+  int mi_col, c;
+
+  for (mi_col = 0, c = 0; mi_col < cm->mi_cols;
+       mi_col += MI_BLOCK_SIZE, ++lfm, ++c) {
+    if (!first_row) sync_read(lf_sync, r - 1, c, wait_time);
+    if (plane > 0) sync_read(lf_sync, sb_row, c, wait_time);
+
+    vp9_setup_dst_planes(planes, frame_buffer, mi_row, mi_col);
+
+    if (plane == 0) {
+      vp9_adjust_mask(cm, mi_row, mi_col, lfm);
+      vp9_filter_block_plane_ss00(cm, &planes[0], mi_row, lfm);
+    } else {
+      switch (path) {
+        case LF_PATH_420:
+          vp9_filter_block_plane_ss11(cm, &planes[plane], mi_row, lfm);
+          break;
+        case LF_PATH_444:
+          vp9_filter_block_plane_ss00(cm, &planes[plane], mi_row, lfm);
+          break;
+        case LF_PATH_SLOW:
+          vp9_filter_block_plane_non420(cm, &planes[plane], mi + mi_col,
+                                        mi_row, mi_col);
+          break;
+      }
+    }
+
+    if (c == sb_cols - 1 && lf_sync->row_done != NULL) {
+      // The plane that completes the row reports it, before the row below
+      // can complete.
+      int row_done;
+#if CONFIG_MULTITHREAD
+      pthread_mutex_lock(lf_sync->lf_mutex);
+#endif
+      row_done = ++lf_sync->planes_done[sb_row] == num_planes;
+#if CONFIG_MULTITHREAD
+      pthread_mutex_unlock(lf_sync->lf_mutex);
+#endif
+      if (row_done) lf_sync->row_done(lf_sync->row_done_priv, sb_row);
+    }
+    sync_write(lf_sync, r, c, sb_cols);
+  }
+}
+
+// Returns the next job, a superblock row of a plane, or -1 once all the jobs
+// have been taken.
+static int get_next_mt_job(VP9LfSync *const lf_sync, int num_jobs) {
+  int job = -1;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(lf_sync->lf_mutex);
+#endif
+  if (lf_sync->next_job < num_jobs) job = lf_sync->next_job++;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(lf_sync->lf_mutex);
+#endif
+  return job;
+}
+
 // Row-based multi-threaded loopfilter hook
 static int loop_filter_row_worker(void *arg1, void *arg2) {
   VP9LfSync *const lf_sync = (VP9LfSync *)arg1;
   LFWorkerData *const lf_data = (LFWorkerData *)arg2;
-  thread_loop_filter_rows(lf_data->frame_buffer, lf_data->cm, lf_data->planes,
-                          lf_data->start, lf_data->stop, lf_data->y_only,
-                          lf_sync);
+  const int num_planes = lf_data->y_only ? 1 : MAX_MB_PLANE;
+  const int num_rows = (lf_data->stop - lf_data->start + MI_BLOCK_SIZE - 1) >>
+                       MI_BLOCK_SIZE_LOG2;
+  const enum lf_path path = get_lf_path(lf_data->planes, lf_data->y_only);
+  const int64_t start = vpx_nsec_time();
+  const int64_t wait_start = lf_data->wait_time;
+  int job;
+  // The jobs are the rows of each plane, the planes of a row in turn, and are
+  // taken in order, so that a job only waits on jobs of running workers,
+  // however many of them actually got a thread.
+  while ((job = get_next_mt_job(lf_sync, num_rows * num_planes)) != -1) {
+    const int row = job / num_planes;
+    thread_loop_filter_plane_row(lf_data->frame_buffer, lf_data->cm,
+                                 lf_data->planes, job % num_planes, num_planes,
+                                 path, lf_data->start + row * MI_BLOCK_SIZE,
+                                 row == 0, lf_sync, &lf_data->wait_time);
+  }
+  lf_data->filter_time +=
+      vpx_nsec_time() - start - (lf_data->wait_time - wait_start);
   return 1;
 }
 
@@ -162,12 +267,11 @@ static void loop_filter_rows_mt(YV12_BUFFER_CONFIG *frame, VP9_COMMON *cm,
   const VPxWorkerInterface *const winterface = vpx_get_worker_interface();
   // Number of superblock rows and cols
   const int sb_rows = mi_cols_aligned_to_sb(cm->mi_rows) >> MI_BLOCK_SIZE_LOG2;
-  const int num_tile_cols = 1 << cm->log2_tile_cols;
-  // Limit the number of workers to prevent changes in frame dimensions from
-  // causing incorrect sync calculations when sb_rows < threads/tile_cols.
-  // Further restrict them by the number of tile columns should the user
-  // request more as this implementation doesn't scale well beyond that.
-  const int num_workers = VPXMIN(nworkers, VPXMIN(num_tile_cols, sb_rows));
+  const int num_planes = y_only ? 1 : MAX_MB_PLANE;
+  // Limit the number of workers to the number of jobs, the superblock rows of
+  // each plane. The planes being separate wavefronts, short frames still keep
+  // several workers busy.
+  const int num_workers = VPXMIN(nworkers, num_planes * sb_rows);
   int i;
 
   if (!lf_sync->sync_range || sb_rows != lf_sync->rows ||
@@ -176,18 +280,18 @@ static void loop_filter_rows_mt(YV12_BUFFER_CONFIG *frame, VP9_COMMON *cm,
     vp9_loop_filter_alloc(lf_sync, cm, sb_rows, cm->width, num_workers);
   }
   lf_sync->num_active_workers = num_workers;
+  lf_sync->next_job = 0;
 
-  // Initialize cur_sb_col to -1 for all SB rows.
-  memset(lf_sync->cur_sb_col, -1, sizeof(*lf_sync->cur_sb_col) * sb_rows);
+  // Initialize cur_sb_col to -1 for all SB rows of all the planes.
+  memset(lf_sync->cur_sb_col, -1,
+         sizeof(*lf_sync->cur_sb_col) * sb_rows * MAX_MB_PLANE);
+  memset(lf_sync->planes_done, 0, sizeof(*lf_sync->planes_done) * sb_rows);
 
   // Set up loopfilter thread data.
-  // The decoder is capping num_workers because it has been observed that using
-  // more threads on the loopfilter than there are cores will hurt performance
-  // on Android. This is because the system will only schedule the tile decode
-  // workers on cores equal to the number of tile columns. Then if the decoder
-  // tries to use more threads for the loopfilter, it will hurt performance
-  // because of contention. If the multithreading code changes in the future
-  // then the number of workers used by the loopfilter should be revisited.
+  // Each worker takes jobs until there are none left, so with num_workers
+  // capped to the num_planes * sb_rows jobs every worker started has one. The
+  // workers given by the caller beyond that cap are left idle rather than
+  // contending for jobs that are not there.
   for (i = 0; i < num_workers; ++i) {
     VPxWorker *const worker = &workers[i];
     LFWorkerData *const lf_data = &lf_sync->lfdata[i];
@@ -198,7 +302,7 @@ static void loop_filter_rows_mt(YV12_BUFFER_CONFIG *frame, VP9_COMMON *cm,
 
     // Loopfilter data
     vp9_loop_filter_data_reset(lf_data, frame, cm, planes);
-    lf_data->start = start + i * MI_BLOCK_SIZE;
+    lf_data->start = start;
     lf_data->stop = stop;
     lf_data->y_only = y_only;
 
@@ -284,17 +388,17 @@ void vp9_loop_filter_alloc(VP9LfSync *lf_sync, VP9_COMMON *cm, int rows,
     int i;
 
     CHECK_MEM_ERROR(cm, lf_sync->mutex,
-                    vpx_malloc(sizeof(*lf_sync->mutex) * rows));
+                    vpx_malloc(sizeof(*lf_sync->mutex) * rows * MAX_MB_PLANE));
     if (lf_sync->mutex) {
-      for (i = 0; i < rows; ++i) {
+      for (i = 0; i < rows * MAX_MB_PLANE; ++i) {
         pthread_mutex_init(&lf_sync->mutex[i], NULL);
       }
     }
 
     CHECK_MEM_ERROR(cm, lf_sync->cond,
-                    vpx_malloc(sizeof(*lf_sync->cond) * rows));
+                    vpx_malloc(sizeof(*lf_sync->cond) * rows * MAX_MB_PLANE));
     if (lf_sync->cond) {
-      for (i = 0; i < rows; ++i) {
+      for (i = 0; i < rows * MAX_MB_PLANE; ++i) {
         pthread_cond_init(&lf_sync->cond[i], NULL);
       }
     }
@@ -324,12 +428,16 @@ void vp9_loop_filter_alloc(VP9LfSync *lf_sync, VP9_COMMON *cm, int rows,
 #endif  // CONFIG_MULTITHREAD
 
   CHECK_MEM_ERROR(cm, lf_sync->lfdata,
-                  vpx_malloc(num_workers * sizeof(*lf_sync->lfdata)));
+                  vpx_calloc(num_workers, sizeof(*lf_sync->lfdata)));
   lf_sync->num_workers = num_workers;
   lf_sync->num_active_workers = lf_sync->num_workers;
 
-  CHECK_MEM_ERROR(cm, lf_sync->cur_sb_col,
-                  vpx_malloc(sizeof(*lf_sync->cur_sb_col) * rows));
+  CHECK_MEM_ERROR(
+      cm, lf_sync->cur_sb_col,
+      vpx_malloc(sizeof(*lf_sync->cur_sb_col) * rows * MAX_MB_PLANE));
+
+  CHECK_MEM_ERROR(cm, lf_sync->planes_done,
+                  vpx_malloc(sizeof(*lf_sync->planes_done) * rows));
 
   CHECK_MEM_ERROR(cm, lf_sync->num_tiles_done,
                   vpx_malloc(sizeof(*lf_sync->num_tiles_done) *
@@ -342,19 +450,23 @@ void vp9_loop_filter_alloc(VP9LfSync *lf_sync, VP9_COMMON *cm, int rows,
 
 // Deallocate lf synchronization related mutex and data
 void vp9_loop_filter_dealloc(VP9LfSync *lf_sync) {
+  void (*row_done)(void *, int);
+  void *row_done_priv;
   assert(lf_sync != NULL);
+  row_done = lf_sync->row_done;
+  row_done_priv = lf_sync->row_done_priv;
 
 #if CONFIG_MULTITHREAD
   if (lf_sync->mutex != NULL) {
     int i;
-    for (i = 0; i < lf_sync->rows; ++i) {
+    for (i = 0; i < lf_sync->rows * MAX_MB_PLANE; ++i) {
       pthread_mutex_destroy(&lf_sync->mutex[i]);
     }
     vpx_free(lf_sync->mutex);
   }
   if (lf_sync->cond != NULL) {
     int i;
-    for (i = 0; i < lf_sync->rows; ++i) {
+    for (i = 0; i < lf_sync->rows * MAX_MB_PLANE; ++i) {
       pthread_cond_destroy(&lf_sync->cond[i]);
     }
     vpx_free(lf_sync->cond);
@@ -382,13 +494,18 @@ void vp9_loop_filter_dealloc(VP9LfSync *lf_sync) {
 
   vpx_free(lf_sync->lfdata);
   vpx_free(lf_sync->cur_sb_col);
+  vpx_free(lf_sync->planes_done);
   vpx_free(lf_sync->num_tiles_done);
   // clear the structure as the source of this call may be a resize in which
   // case this call will be followed by an _alloc() which may fail.
   vp9_zero(*lf_sync);
+  // The callback is set up by the owner of lf_sync, not by _alloc().
+  lf_sync->row_done = row_done;
+  lf_sync->row_done_priv = row_done_priv;
 }
 
-static int get_next_row(VP9_COMMON *cm, VP9LfSync *lf_sync) {
+static int get_next_row(VP9_COMMON *cm, VP9LfSync *lf_sync,
+                        int64_t *const wait_time) {
   int return_val = -1;
   int cur_row;
   const int max_rows = cm->mi_rows;
@@ -413,8 +530,10 @@ static int get_next_row(VP9_COMMON *cm, VP9LfSync *lf_sync) {
 
   pthread_mutex_lock(&lf_sync->recon_done_mutex[cur_row]);
   if (lf_sync->num_tiles_done[cur_row] < tile_cols) {
+    const int64_t start = vpx_nsec_time();
     pthread_cond_wait(&lf_sync->recon_done_cond[cur_row],
                       &lf_sync->recon_done_mutex[cur_row]);
+    *wait_time += vpx_nsec_time() - start;
   }
   pthread_mutex_unlock(&lf_sync->recon_done_mutex[cur_row]);
   pthread_mutex_lock(lf_sync->lf_mutex);
@@ -429,6 +548,7 @@ static int get_next_row(VP9_COMMON *cm, VP9LfSync *lf_sync) {
   pthread_mutex_unlock(lf_sync->lf_mutex);
 #else
   (void)lf_sync;
+  (void)wait_time;
   if (cm->lf_row < max_rows) {
     cur_row = cm->lf_row >> MI_BLOCK_SIZE_LOG2;
     return_val = cm->lf_row;
@@ -447,15 +567,20 @@ static int get_next_row(VP9_COMMON *cm, VP9LfSync *lf_sync) {
 void vp9_loopfilter_rows(LFWorkerData *lf_data, VP9LfSync *lf_sync) {
   int mi_row;
   VP9_COMMON *cm = lf_data->cm;
+  const int64_t start = vpx_nsec_time();
+  const int64_t wait_start = lf_data->wait_time;
 
-  while ((mi_row = get_next_row(cm, lf_sync)) != -1 && mi_row < cm->mi_rows) {
+  while ((mi_row = get_next_row(cm, lf_sync, &lf_data->wait_time)) != -1 &&
+         mi_row < cm->mi_rows) {
     lf_data->start = mi_row;
     lf_data->stop = mi_row + MI_BLOCK_SIZE;
 
     thread_loop_filter_rows(lf_data->frame_buffer, lf_data->cm, lf_data->planes,
                             lf_data->start, lf_data->stop, lf_data->y_only,
-                            lf_sync);
+                            lf_sync, &lf_data->wait_time);
   }
+  lf_data->filter_time +=
+      vpx_nsec_time() - start - (lf_data->wait_time - wait_start);
 }
 
 void vp9_set_row(VP9LfSync *lf_sync, int num_tiles, int row, int is_last_row,
@@ -487,9 +612,13 @@ void vp9_set_row(VP9LfSync *lf_sync, int num_tiles, int row, int is_last_row,
 }
 
 void vp9_loopfilter_job(LFWorkerData *lf_data, VP9LfSync *lf_sync) {
+  const int64_t start = vpx_nsec_time();
+  const int64_t wait_start = lf_data->wait_time;
   thread_loop_filter_rows(lf_data->frame_buffer, lf_data->cm, lf_data->planes,
                           lf_data->start, lf_data->stop, lf_data->y_only,
-                          lf_sync);
+                          lf_sync, &lf_data->wait_time);
+  lf_data->filter_time +=
+      vpx_nsec_time() - start - (lf_data->wait_time - wait_start);
 }
 
 // Accumulate frame counts.
@@ -27,7 +27,8 @@ typedef struct VP9LfSyncData {
   pthread_mutex_t *mutex;
   pthread_cond_t *cond;
 #endif
-  // Allocate memory to store the loop-filtered superblock index in each row.
+  // Allocate memory to store the loop-filtered superblock index in each row,
+  // the rows of each plane in turn.
   int *cur_sb_col;
   // The optimal sync_range for different resolution and platform should be
   // determined by testing. Currently, it is chosen to be a power-of-2 number.
@@ -38,6 +39,8 @@ typedef struct VP9LfSyncData {
   LFWorkerData *lfdata;
   int num_workers;         // number of allocated workers.
   int num_active_workers;  // number of scheduled workers.
+  int next_job;            // next plane row to filter by the scheduled workers.
+  int *planes_done;        // number of planes filtered in each row.
 
 #if CONFIG_MULTITHREAD
   pthread_mutex_t *lf_mutex;
@@ -46,6 +49,12 @@ typedef struct VP9LfSyncData {
 #endif
   int *num_tiles_done;
   int corrupted;
+
+  // If set, called with the index of each superblock row once it is filtered.
+  // The call is made before the row below can complete, so the calls are in
+  // row order and do not overlap.
+  void (*row_done)(void *priv, int sb_row);
+  void *row_done_priv;
 } VP9LfSync;
 
 // Allocate memory for loopfilter row synchronization.
@@ -0,0 +1,38 @@
+/*
+ *  Copyright (c) 2026 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <immintrin.h>
+
+#include "./vp9_rtcd.h"
+#include "vpx/vpx_integer.h"
+#include "vp9/common/vp9_postproc.h"
+
+void vp9_filter_by_weight16x16_avx2(const uint8_t *src, int src_stride,
+                                    uint8_t *dst, int dst_stride,
+                                    int src_weight) {
+  const __m256i src_w = _mm256_set1_epi16(src_weight);
+  const __m256i dst_w = _mm256_set1_epi16((1 << MFQE_PRECISION) - src_weight);
+  const __m256i rounding = _mm256_set1_epi16(1 << (MFQE_PRECISION - 1));
+  int r;
+
+  for (r = 0; r < 16; r++) {
+    const __m256i s =
+        _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)src));
+    const __m256i d =
+        _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)dst));
+    __m256i out = _mm256_add_epi16(_mm256_mullo_epi16(s, src_w),
+                                   _mm256_mullo_epi16(d, dst_w));
+    out = _mm256_srli_epi16(_mm256_add_epi16(out, rounding), MFQE_PRECISION);
+    out = _mm256_permute4x64_epi64(_mm256_packus_epi16(out, out), 0xd8);
+    _mm_storeu_si128((__m128i *)dst, _mm256_castsi256_si128(out));
+    src += src_stride;
+    dst += dst_stride;
+  }
+}
@@ -21,6 +21,7 @@
 #include "vpx_mem/vpx_mem.h"
 #include "vpx_ports/mem.h"
 #include "vpx_ports/mem_ops.h"
+#include "vpx_ports/vpx_timer.h"
 #include "vpx_scale/vpx_scale.h"
 #include "vpx_util/vpx_thread.h"
 #if CONFIG_BITSTREAM_DEBUG || CONFIG_MISMATCH_DEBUG
@@ -45,6 +46,7 @@
 #include "vp9/decoder/vp9_decodemv.h"
 #include "vp9/decoder/vp9_decoder.h"
 #include "vp9/decoder/vp9_dsubexp.h"
+#include "vp9/decoder/vp9_dthread.h"
 #include "vp9/decoder/vp9_job_queue.h"
 
 #define MAX_VP9_HEADER_SIZE 80
@@ -165,6 +167,30 @@ static void read_mv_probs(nmv_context *ctx, int allow_hp, vpx_reader *r) {
   }
 }
 
+// Starts timing the stages of the blocks decoded with 'twd'.
+static INLINE void start_stage(TileWorkerData *twd) {
+  if (twd->timing) twd->stage_end = vpx_nsec_time();
+}
+
+// Adds the time since the last stage ended to 'stage'.
+static INLINE void end_stage(TileWorkerData *twd, vpx_decode_stage stage) {
+  if (twd->timing) {
+    const int64_t now = vpx_nsec_time();
+    twd->stage_time[stage] += now - twd->stage_end;
+    twd->stage_end = now;
+  }
+}
+
+static void init_stage_times(const VP9Decoder *pbi, TileWorkerData *twd) {
+  twd->timing = pbi->collect_stats;
+  memset(twd->stage_time, 0, sizeof(twd->stage_time));
+}
+
+static void add_stage_times(VP9Decoder *pbi, TileWorkerData *twd, int thread,
+                            int tile) {
+  if (twd->timing) vp9_add_decode_times(pbi, thread, tile, twd->stage_time);
+}
+
 static void inverse_transform_block_inter(MACROBLOCKD *xd, int plane,
                                           const TX_SIZE tx_size, uint8_t *dst,
                                           int stride, int eob) {
@@ -319,6 +345,7 @@ static void predict_and_reconstruct_intra_block(TileWorkerData *twd,
 
   vp9_predict_intra_block(xd, pd->n4_wl, tx_size, mode, dst, pd->dst.stride,
                           dst, pd->dst.stride, col, row, plane);
+  end_stage(twd, VPX_DECODE_STAGE_PREDICTION);
 
   if (!mi->skip) {
     const TX_TYPE tx_type =
@@ -328,9 +355,11 @@ static void predict_and_reconstruct_intra_block(TileWorkerData *twd,
                                : &vp9_scan_orders[tx_size][tx_type];
     const int eob = vp9_decode_block_tokens(twd, plane, sc, col, row, tx_size,
                                             mi->segment_id);
+    end_stage(twd, VPX_DECODE_STAGE_COEFFS);
     if (eob > 0) {
       inverse_transform_block_intra(xd, plane, tx_type, tx_size, dst,
                                     pd->dst.stride, eob);
+      end_stage(twd, VPX_DECODE_STAGE_INV_TRANSFORM);
     }
   }
 }
@@ -374,6 +403,7 @@ static void predict_and_reconstruct_intra_block_row_mt(TileWorkerData *twd,
 
   vp9_predict_intra_block(xd, pd->n4_wl, tx_size, mode, dst, pd->dst.stride,
                           dst, pd->dst.stride, col, row, plane);
+  end_stage(twd, VPX_DECODE_STAGE_PREDICTION);
 
   if (!mi->skip) {
     const TX_TYPE tx_type =
@@ -381,6 +411,7 @@ static void predict_and_reconstruct_intra_block_row_mt(TileWorkerData *twd,
     if (*pd->eob > 0) {
       inverse_transform_block_intra(xd, plane, tx_type, tx_size, dst,
                                     pd->dst.stride, *pd->eob);
+      end_stage(twd, VPX_DECODE_STAGE_INV_TRANSFORM);
     }
     /* Keep the alignment to 16 */
     pd->dqcoeff += (16 << (tx_size << 1));
@@ -388,6 +419,28 @@ static void predict_and_reconstruct_intra_block_row_mt(TileWorkerData *twd,
   }
 }
 
+static void parse_intra_block(TileWorkerData *twd, MODE_INFO *const mi,
+                              int plane, int row, int col, TX_SIZE tx_size) {
+  MACROBLOCKD *const xd = &twd->xd;
+  PREDICTION_MODE mode = (plane == 0) ? mi->mode : mi->uv_mode;
+
+  if (mi->sb_type < BLOCK_8X8)
+    if (plane == 0) mode = xd->mi[0]->bmi[(row << 1) + col].as_mode;
+
+  if (!mi->skip) {
+    struct macroblockd_plane *const pd = &xd->plane[plane];
+    const TX_TYPE tx_type =
+        (plane || xd->lossless) ? DCT_DCT : intra_mode_to_tx_type_lookup[mode];
+    const scan_order *sc = (plane || xd->lossless)
+                               ? &vp9_default_scan_orders[tx_size]
+                               : &vp9_scan_orders[tx_size][tx_type];
+    const int eob = vp9_decode_block_tokens(twd, plane, sc, col, row, tx_size,
+                                            mi->segment_id);
+    if (eob > 0)
+      memset(pd->dqcoeff, 0, (16 << (tx_size << 1)) * sizeof(pd->dqcoeff[0]));
+  }
+}
+
 static int reconstruct_inter_block(TileWorkerData *twd, MODE_INFO *const mi,
                                    int plane, int row, int col, TX_SIZE tx_size,
                                    int mi_row, int mi_col) {
@@ -398,8 +451,10 @@ static int reconstruct_inter_block(TileWorkerData *twd, MODE_INFO *const mi,
                                           mi->segment_id);
   uint8_t *dst = &pd->dst.buf[4 * row * pd->dst.stride + 4 * col];
 
+  end_stage(twd, VPX_DECODE_STAGE_COEFFS);
   if (eob > 0) {
     inverse_transform_block_inter(xd, plane, tx_size, dst, pd->dst.stride, eob);
+    end_stage(twd, VPX_DECODE_STAGE_INV_TRANSFORM);
   }
 #if CONFIG_MISMATCH_DEBUG
   {
@@ -434,6 +489,18 @@ static int parse_inter_block_row_mt(TileWorkerData *twd, MODE_INFO *const mi,
   return eob;
 }
 
+static int parse_inter_block(TileWorkerData *twd, MODE_INFO *const mi,
+                             int plane, int row, int col, TX_SIZE tx_size) {
+  MACROBLOCKD *const xd = &twd->xd;
+  struct macroblockd_plane *const pd = &xd->plane[plane];
+  const scan_order *sc = &vp9_default_scan_orders[tx_size];
+  const int eob = vp9_decode_block_tokens(twd, plane, sc, col, row, tx_size,
+                                          mi->segment_id);
+  if (eob > 0)
+    memset(pd->dqcoeff, 0, (16 << (tx_size << 1)) * sizeof(pd->dqcoeff[0]));
+  return eob;
+}
+
 static int reconstruct_inter_block_row_mt(TileWorkerData *twd,
                                           MODE_INFO *const mi, int plane,
                                           int row, int col, TX_SIZE tx_size) {
@@ -574,11 +641,11 @@ static void extend_and_predict(TileWorkerData *twd, const uint8_t *buf_ptr1,
 #endif  // CONFIG_VP9_HIGHBITDEPTH
 
 static void dec_build_inter_predictors(
-    TileWorkerData *twd, MACROBLOCKD *xd, int plane, int bw, int bh, int x,
-    int y, int w, int h, int mi_x, int mi_y, const InterpKernel *kernel,
-    const struct scale_factors *sf, struct buf_2d *pre_buf,
-    struct buf_2d *dst_buf, const MV *mv, RefCntBuffer *ref_frame_buf,
-    int is_scaled, int ref) {
+    TileWorkerData *twd, VP9Decoder *const pbi, MACROBLOCKD *xd, int plane,
+    int bw, int bh, int x, int y, int w, int h, int mi_x, int mi_y,
+    const InterpKernel *kernel, const struct scale_factors *sf,
+    struct buf_2d *pre_buf, struct buf_2d *dst_buf, const MV *mv,
+    RefCntBuffer *ref_frame_buf, int is_scaled, int ref) {
   struct macroblockd_plane *const pd = &xd->plane[plane];
   uint8_t *const dst = dst_buf->buf + dst_buf->stride * y + x;
   MV32 scaled_mv;
@@ -651,6 +718,15 @@ static void dec_build_inter_predictors(
   x0_16 += scaled_mv.col;
   y0_16 += scaled_mv.row;
 
+  if (pbi->common.frame_parallel_decode) {
+    // Wait until the reference rows used by the prediction, including the
+    // interpolation filter taps, are decoded.
+    const int y1 =
+        ((y0_16 + (h - 1) * ys) >> SUBPEL_BITS) + 1 + VP9_INTERP_EXTEND;
+    vp9_frameworker_wait(pbi->common.buffer_pool, ref_frame_buf,
+                         (y1 + 1) << pd->subsampling_y);
+  }
+
   // Get reference block pointer.
   buf_ptr = ref_frame + y0 * pre_buf->stride + x0;
   buf_stride = pre_buf->stride;
@@ -755,10 +831,10 @@ static void dec_build_inter_predictors_sb(TileWorkerData *twd,
         for (y = 0; y < num_4x4_h; ++y) {
           for (x = 0; x < num_4x4_w; ++x) {
             const MV mv = average_split_mvs(pd, mi, ref, i++);
-            dec_build_inter_predictors(twd, xd, plane, n4w_x4, n4h_x4, 4 * x,
-                                       4 * y, 4, 4, mi_x, mi_y, kernel, sf,
-                                       pre_buf, dst_buf, &mv, ref_frame_buf,
-                                       is_scaled, ref);
+            dec_build_inter_predictors(twd, pbi, xd, plane, n4w_x4, n4h_x4,
+                                       4 * x, 4 * y, 4, 4, mi_x, mi_y, kernel,
+                                       sf, pre_buf, dst_buf, &mv,
+                                       ref_frame_buf, is_scaled, ref);
           }
         }
       }
@@ -772,9 +848,10 @@ static void dec_build_inter_predictors_sb(TileWorkerData *twd,
         const int n4w_x4 = 4 * num_4x4_w;
         const int n4h_x4 = 4 * num_4x4_h;
         struct buf_2d *const pre_buf = &pd->pre[ref];
-        dec_build_inter_predictors(twd, xd, plane, n4w_x4, n4h_x4, 0, 0, n4w_x4,
-                                   n4h_x4, mi_x, mi_y, kernel, sf, pre_buf,
-                                   dst_buf, &mv, ref_frame_buf, is_scaled, ref);
+        dec_build_inter_predictors(twd, pbi, xd, plane, n4w_x4, n4h_x4, 0, 0,
+                                   n4w_x4, n4h_x4, mi_x, mi_y, kernel, sf,
+                                   pre_buf, dst_buf, &mv, ref_frame_buf,
+                                   is_scaled, ref);
       }
     }
   }
@@ -935,6 +1012,21 @@ static void decode_block(TileWorkerData *twd, VP9Decoder *const pbi, int mi_row,
   if (mi->skip) {
     dec_reset_skip_context(xd);
   }
+  end_stage(twd, VPX_DECODE_STAGE_MODE_INFO);
+
+  if (twd->parse_only) {
+    // The tokens are still read for the contexts of the next blocks and for
+    // the frame counts.
+    if (!is_inter_block(mi)) {
+      predict_recon_intra(xd, mi, twd, parse_intra_block);
+    } else if (!mi->skip) {
+      const int eobtotal = predict_recon_inter(xd, mi, twd, parse_inter_block);
+      if (!less8x8 && eobtotal == 0) mi->skip = 1;
+    }
+    end_stage(twd, VPX_DECODE_STAGE_COEFFS);
+    xd->corrupted |= vpx_reader_has_error(r);
+    return;
+  }
 
   if (!is_inter_block(mi)) {
     int plane;
@@ -983,6 +1075,7 @@ static void decode_block(TileWorkerData *twd, VP9Decoder *const pbi, int mi_row,
       }
     }
 #endif
+    end_stage(twd, VPX_DECODE_STAGE_PREDICTION);
 
     // Reconstruction
     if (!mi->skip) {
@@ -1023,6 +1116,7 @@ static void decode_block(TileWorkerData *twd, VP9Decoder *const pbi, int mi_row,
 
   if (cm->lf.filter_level) {
     vp9_build_mask(cm, mi, mi_row, mi_col, bw, bh);
+    end_stage(twd, VPX_DECODE_STAGE_LOOP_FILTER);
   }
 }
 
@@ -1049,14 +1143,17 @@ static void recon_block(TileWorkerData *twd, VP9Decoder *const pbi, int mi_row,
   } else {
     // Prediction
     dec_build_inter_predictors_sb(twd, pbi, xd, mi_row, mi_col);
+    end_stage(twd, VPX_DECODE_STAGE_PREDICTION);
 
     // Reconstruction
     if (!mi->skip) {
       predict_recon_inter(xd, mi, twd, reconstruct_inter_block_row_mt);
+      end_stage(twd, VPX_DECODE_STAGE_INV_TRANSFORM);
     }
   }
 
   vp9_build_mask(cm, mi, mi_row, mi_col, bw, bh);
+  end_stage(twd, VPX_DECODE_STAGE_LOOP_FILTER);
 }
 
 static void parse_block(TileWorkerData *twd, VP9Decoder *const pbi, int mi_row,
@@ -1085,6 +1182,7 @@ static void parse_block(TileWorkerData *twd, VP9Decoder *const pbi, int mi_row,
   if (mi->skip) {
     dec_reset_skip_context(xd);
   }
+  end_stage(twd, VPX_DECODE_STAGE_MODE_INFO);
 
   if (!is_inter_block(mi)) {
     predict_recon_intra(xd, mi, twd, parse_intra_block_row_mt);
@@ -1114,6 +1212,7 @@ static void parse_block(TileWorkerData *twd, VP9Decoder *const pbi, int mi_row,
       }
     }
   }
+  end_stage(twd, VPX_DECODE_STAGE_COEFFS);
 
   xd->corrupted |= vpx_reader_has_error(r);
 }
@@ -1472,6 +1571,29 @@ static void resize_mv_buffer(VP9_COMMON *cm) {
   CHECK_MEM_ERROR(cm, cm->cur_frame->mvs,
                   (MV_REF *)vpx_calloc(cm->mi_rows * cm->mi_cols,
                                        sizeof(*cm->cur_frame->mvs)));
+  if (cm->frame_parallel_decode) {
+    vpx_free(cm->cur_frame->seg_map);
+    CHECK_MEM_ERROR(cm, cm->cur_frame->seg_map,
+                    (uint8_t *)vpx_calloc(cm->mi_rows * cm->mi_cols, 1));
+  }
+}
+
+// Gives the current frame the motion vectors of a frame buffer other than the
+// previous frame, the only one whose motion vectors are read.
+static void take_mv_buffer(VP9_COMMON *cm) {
+  RefCntBuffer *const frame_bufs = cm->buffer_pool->frame_bufs;
+  int i;
+
+  for (i = 0; i < FRAME_BUFFERS; ++i) {
+    RefCntBuffer *const buf = &frame_bufs[i];
+    if (buf != cm->cur_frame && buf != cm->prev_frame && buf->mvs != NULL) {
+      cm->cur_frame->mvs = buf->mvs;
+      cm->cur_frame->mi_rows = buf->mi_rows;
+      cm->cur_frame->mi_cols = buf->mi_cols;
+      buf->mvs = NULL;
+      return;
+    }
+  }
 }
 
 static void resize_context_buffers(VP9_COMMON *cm, int width, int height) {
@@ -1488,8 +1610,12 @@ static void resize_context_buffers(VP9_COMMON *cm, int width, int height) {
         ALIGN_POWER_OF_TWO(width, MI_SIZE_LOG2) >> MI_SIZE_LOG2;
 
     // Allocations in vp9_alloc_context_buffers() depend on individual
-    // dimensions as well as the overall size.
-    if (new_mi_cols > cm->mi_cols || new_mi_rows > cm->mi_rows) {
+    // dimensions as well as the overall size. In low memory mode they are
+    // made again for smaller frames too.
+    if (new_mi_cols > cm->mi_cols || new_mi_rows > cm->mi_rows ||
+        (cm->low_memory &&
+         (new_mi_cols != cm->mi_cols || new_mi_rows != cm->mi_rows))) {
+      if (cm->low_memory) vp9_free_context_buffers(cm);
       if (vp9_alloc_context_buffers(cm, width, height)) {
         // The cm->mi_* values have been cleared and any existing context
         // buffers have been freed. Clear cm->width and cm->height to be
@@ -1506,8 +1632,12 @@ static void resize_context_buffers(VP9_COMMON *cm, int width, int height) {
     cm->width = width;
     cm->height = height;
   }
+  if (cm->low_memory && cm->cur_frame->mvs == NULL) take_mv_buffer(cm);
   if (cm->cur_frame->mvs == NULL || cm->mi_rows > cm->cur_frame->mi_rows ||
-      cm->mi_cols > cm->cur_frame->mi_cols) {
+      cm->mi_cols > cm->cur_frame->mi_cols ||
+      (cm->low_memory && (cm->mi_rows != cm->cur_frame->mi_rows ||
+                          cm->mi_cols != cm->cur_frame->mi_cols)) ||
+      (cm->frame_parallel_decode && cm->cur_frame->seg_map == NULL)) {
     resize_mv_buffer(cm);
   }
 }
@@ -1772,20 +1902,156 @@ static void vp9_jobq_alloc(VP9Decoder *pbi) {
   const int aligned_rows = mi_cols_aligned_to_sb(cm->mi_rows);
   const int sb_rows = aligned_rows >> MI_BLOCK_SIZE_LOG2;
   const int tile_cols = 1 << cm->log2_tile_cols;
-  const size_t jobq_size = (tile_cols * sb_rows * 2 + sb_rows) * sizeof(Job);
+  const int num_queues = pbi->max_threads;
+  // Every worker may queue all the jobs of the frame.
+  const size_t jobq_size =
+      (tile_cols * sb_rows * 2 + sb_rows) * sizeof(Job) * num_queues;
 
   if (jobq_size > row_mt_worker_data->jobq_size) {
+    if (row_mt_worker_data->jobq_size > 0)
+      vp9_jobq_deinit(&row_mt_worker_data->jobq);
+    row_mt_worker_data->jobq_size = 0;
     vpx_free(row_mt_worker_data->jobq_buf);
+    row_mt_worker_data->jobq_buf = NULL;
+    vpx_free(row_mt_worker_data->jobq_queues);
+    CHECK_MEM_ERROR(cm, row_mt_worker_data->jobq_queues,
+                    vpx_calloc(num_queues,
+                               sizeof(*row_mt_worker_data->jobq_queues)));
     CHECK_MEM_ERROR(cm, row_mt_worker_data->jobq_buf, vpx_calloc(1, jobq_size));
-    vp9_jobq_init(&row_mt_worker_data->jobq, row_mt_worker_data->jobq_buf,
-                  jobq_size);
+    vp9_jobq_init(&row_mt_worker_data->jobq, row_mt_worker_data->jobq_queues,
+                  num_queues, row_mt_worker_data->jobq_buf, jobq_size);
     row_mt_worker_data->jobq_size = jobq_size;
   }
 }
 
+// Superblocks this many pixels away from the decode region are reconstructed
+// as well, for the motion vectors of the next frames pointing out of it.
+#define DECODE_REGION_MARGIN 128
+
+static void setup_decode_region(VP9Decoder *pbi) {
+  const VP9_COMMON *const cm = &pbi->common;
+
+  if (pbi->region_w <= 0 || pbi->region_h <= 0) {
+    pbi->region_mi_row_start = 0;
+    pbi->region_mi_row_end = cm->mi_rows;
+    pbi->region_mi_col_start = 0;
+    pbi->region_mi_col_end = cm->mi_cols;
+    return;
+  }
+  pbi->region_mi_row_start =
+      VPXMAX(pbi->region_y - DECODE_REGION_MARGIN, 0) >> MI_SIZE_LOG2;
+  pbi->region_mi_row_end =
+      (pbi->region_y + pbi->region_h + DECODE_REGION_MARGIN + MI_SIZE - 1) >>
+      MI_SIZE_LOG2;
+  pbi->region_mi_col_start =
+      VPXMAX(pbi->region_x - DECODE_REGION_MARGIN, 0) >> MI_SIZE_LOG2;
+  pbi->region_mi_col_end =
+      (pbi->region_x + pbi->region_w + DECODE_REGION_MARGIN + MI_SIZE - 1) >>
+      MI_SIZE_LOG2;
+}
+
+static INLINE int sb_in_region(const VP9Decoder *pbi, int mi_row,
+                               int mi_col) {
+  return mi_row < pbi->region_mi_row_end &&
+         mi_row + MI_BLOCK_SIZE > pbi->region_mi_row_start &&
+         mi_col < pbi->region_mi_col_end &&
+         mi_col + MI_BLOCK_SIZE > pbi->region_mi_col_start;
+}
+
+// Parses a superblock away from the decode region in row based multi-threaded
+// decode. Its coefficients go to the tile buffer, as it is not reconstructed.
+static void parse_sb_row_mt(TileWorkerData *tile_data, VP9Decoder *pbi,
+                            int mi_row, int mi_col) {
+  int plane;
+  for (plane = 0; plane < MAX_MB_PLANE; ++plane)
+    tile_data->xd.plane[plane].dqcoeff = tile_data->dqcoeff;
+  tile_data->parse_only = 1;
+  decode_partition(tile_data, pbi, mi_row, mi_col, BLOCK_64X64, 4);
+}
+
+// Prefetches the pixels of a plane within columns [x0, x1] and rows [y0, y1],
+// clamped to the plane, one 64 byte cache line at a time.
+static void prefetch_ref_block(const uint8_t *buf, int stride, int width,
+                               int height, int bytes_per_pixel, int x0,
+                               int y0, int x1, int y1) {
+  const int line_pixels = 64 / bytes_per_pixel;
+  int x, y;
+  x0 = clamp(x0, 0, width - 1);
+  x1 = clamp(x1, 0, width - 1);
+  y0 = clamp(y0, 0, height - 1);
+  y1 = clamp(y1, 0, height - 1);
+  for (y = y0; y <= y1; ++y) {
+    const uint8_t *const row = buf + (ptrdiff_t)y * stride * bytes_per_pixel;
+    for (x = x0; x < x1; x += line_pixels)
+      VPX_PREFETCH(row + x * bytes_per_pixel);
+    VPX_PREFETCH(row + x1 * bytes_per_pixel);
+  }
+}
+
+// Prefetches the reference blocks of the inter blocks of a superblock that is
+// parsed but not yet reconstructed, including the interpolation filter taps.
+// The blocks split below 8x8 use the motion vector of their last sub-block.
+// Scaled references are not prefetched.
+static void prefetch_sb_refs(VP9Decoder *pbi, int mi_row, int mi_col) {
+  VP9_COMMON *const cm = &pbi->common;
+  const int mi_row_end = VPXMIN(mi_row + MI_BLOCK_SIZE, cm->mi_rows);
+  const int mi_col_end = VPXMIN(mi_col + MI_BLOCK_SIZE, cm->mi_cols);
+  int r, c;
+
+  for (r = mi_row; r < mi_row_end; ++r) {
+    for (c = mi_col; c < mi_col_end; ++c) {
+      const int offset = r * cm->mi_stride + c;
+      const MODE_INFO *const mi = cm->mi_grid_visible[offset];
+      int ref;
+
+      // A block is listed at each position it covers, and is taken at its
+      // top left one.
+      if (mi != &cm->mi[offset] || !is_inter_block(mi)) continue;
+
+      for (ref = 0; ref < 1 + has_second_ref(mi); ++ref) {
+        const RefBuffer *const ref_buf =
+            &cm->frame_refs[mi->ref_frame[ref] - LAST_FRAME];
+        const YV12_BUFFER_CONFIG *const buf = ref_buf->buf;
+        const MV *const mv = &mi->mv[ref].as_mv;
+        const int bytes_per_pixel =
+            (buf->flags & YV12_FLAG_HIGHBITDEPTH) ? 2 : 1;
+        int plane;
+
+        if (vp9_is_scaled(&ref_buf->sf)) continue;
+
+        for (plane = 0; plane < MAX_MB_PLANE; ++plane) {
+          const int ss_x = plane ? buf->subsampling_x : 0;
+          const int ss_y = plane ? buf->subsampling_y : 0;
+          const int bw = (num_8x8_blocks_wide_lookup[mi->sb_type] * 8) >> ss_x;
+          const int bh = (num_8x8_blocks_high_lookup[mi->sb_type] * 8) >> ss_y;
+          // Top left pixel of the reference block.
+          const int x = ((c * MI_SIZE) >> ss_x) +
+                        ((mv->col * (1 << (1 - ss_x))) >> SUBPEL_BITS);
+          const int y = ((r * MI_SIZE) >> ss_y) +
+                        ((mv->row * (1 << (1 - ss_y))) >> SUBPEL_BITS);
+          const uint8_t *plane_buf =
+              plane == 0 ? buf->y_buffer
+                         : plane == 1 ? buf->u_buffer : buf->v_buffer;
+#if CONFIG_VP9_HIGHBITDEPTH
+          if (bytes_per_pixel == 2)
+            plane_buf = (const uint8_t *)CONVERT_TO_SHORTPTR(plane_buf);
+#endif
+          prefetch_ref_block(plane_buf, plane ? buf->uv_stride : buf->y_stride,
+                             plane ? buf->uv_crop_width : buf->y_crop_width,
+                             plane ? buf->uv_crop_height : buf->y_crop_height,
+                             bytes_per_pixel, x - (VP9_INTERP_EXTEND - 1),
+                             y - (VP9_INTERP_EXTEND - 1),
+                             x + bw - 1 + VP9_INTERP_EXTEND,
+                             y + bh - 1 + VP9_INTERP_EXTEND);
+        }
+      }
+    }
+  }
+}
+
 static void recon_tile_row(TileWorkerData *tile_data, VP9Decoder *pbi,
-                           int mi_row, int is_last_row, VP9LfSync *lf_sync,
-                           int cur_tile_col) {
+                           int thread_id, int mi_row, int is_last_row,
+                           VP9LfSync *lf_sync, int cur_tile_col) {
   VP9_COMMON *const cm = &pbi->common;
   RowMTWorkerData *const row_mt_worker_data = pbi->row_mt_worker_data;
   const int tile_cols = 1 << cm->log2_tile_cols;
@@ -1800,9 +2066,17 @@ static void recon_tile_row(TileWorkerData *tile_data, VP9Decoder *pbi,
   vp9_zero(tile_data->xd.left_seg_context);
   for (mi_col = mi_col_start; mi_col < mi_col_end; mi_col += MI_BLOCK_SIZE) {
     const int c = mi_col >> MI_BLOCK_SIZE_LOG2;
+    const int prefetch_mi_col = mi_col + pbi->mc_prefetch * MI_BLOCK_SIZE;
     int plane;
     const int sb_num = (cur_sb_row * (aligned_cols >> MI_BLOCK_SIZE_LOG2) + c);
 
+    // The whole tile row is parsed, so the reference blocks of the
+    // superblocks ahead are known.
+    if (pbi->mc_prefetch && prefetch_mi_col < mi_col_end &&
+        sb_in_region(pbi, mi_row, prefetch_mi_col)) {
+      prefetch_sb_refs(pbi, mi_row, prefetch_mi_col);
+    }
+
     // Top Dependency
     if (cur_sb_row) {
       map_read(row_mt_worker_data, ((cur_sb_row - 1) * sb_cols) + c,
@@ -1817,8 +2091,11 @@ static void recon_tile_row(TileWorkerData *tile_data, VP9Decoder *pbi,
     }
     tile_data->xd.partition =
         row_mt_worker_data->partition + (sb_num * PARTITIONS_PER_SB);
-    process_partition(tile_data, pbi, mi_row, mi_col, BLOCK_64X64, 4, RECON,
-                      recon_block);
+    if (sb_in_region(pbi, mi_row, mi_col)) {
+      start_stage(tile_data);
+      process_partition(tile_data, pbi, mi_row, mi_col, BLOCK_64X64, 4, RECON,
+                        recon_block);
+    }
     if (cm->lf.filter_level && !cm->skip_loop_filter) {
       // Queue LPF_JOB
       int is_lpf_job_ready = 0;
@@ -1832,12 +2109,12 @@ static void recon_tile_row(TileWorkerData *tile_data, VP9Decoder *pbi,
           lpf_job.job_type = LPF_JOB;
           if (cur_sb_row > 0) {
             lpf_job.row_num = mi_row - MI_BLOCK_SIZE;
-            vp9_jobq_queue(&row_mt_worker_data->jobq, &lpf_job,
+            vp9_jobq_queue(&row_mt_worker_data->jobq, thread_id, &lpf_job,
                            sizeof(lpf_job));
           }
           if (is_last_row) {
             lpf_job.row_num = mi_row;
-            vp9_jobq_queue(&row_mt_worker_data->jobq, &lpf_job,
+            vp9_jobq_queue(&row_mt_worker_data->jobq, thread_id, &lpf_job,
                            sizeof(lpf_job));
           }
         }
@@ -1871,12 +2148,17 @@ static void parse_tile_row(TileWorkerData *tile_data, VP9Decoder *pbi,
 
   vp9_zero(tile_data->xd.left_context);
   vp9_zero(tile_data->xd.left_seg_context);
+  start_stage(tile_data);
   for (mi_col = tile->mi_col_start; mi_col < tile->mi_col_end;
        mi_col += MI_BLOCK_SIZE) {
     const int r = mi_row >> MI_BLOCK_SIZE_LOG2;
     const int c = mi_col >> MI_BLOCK_SIZE_LOG2;
     int plane;
     const int sb_num = (r * (aligned_cols >> MI_BLOCK_SIZE_LOG2) + c);
+    if (!sb_in_region(pbi, mi_row, mi_col)) {
+      parse_sb_row_mt(tile_data, pbi, mi_row, mi_col);
+      continue;
+    }
     for (plane = 0; plane < MAX_MB_PLANE; ++plane) {
       tile_data->xd.plane[plane].eob =
           row_mt_worker_data->eob[plane] + (sb_num << EOBS_PER_SB_LOG2);
@@ -1906,7 +2188,8 @@ static int row_decode_worker_hook(void *arg1, void *arg2) {
   volatile int corrupted = 0;
   TileWorkerData *volatile tile_data_recon = NULL;
 
-  while (!vp9_jobq_dequeue(&row_mt_worker_data->jobq, &job, sizeof(job), 1)) {
+  while (!vp9_jobq_dequeue(&row_mt_worker_data->jobq, thread_data->thread_id,
+                           &job, sizeof(job), 1)) {
     int mi_col;
     const int mi_row = job.row_num;
 
@@ -1951,8 +2234,11 @@ static int row_decode_worker_hook(void *arg1, void *arg2) {
       tile_data_recon->error_info.setjmp = 1;
       tile_data_recon->xd.error_info = &tile_data_recon->error_info;
 
-      recon_tile_row(tile_data_recon, pbi, mi_row, is_last_row, lf_sync,
-                     job.tile_col);
+      init_stage_times(pbi, tile_data_recon);
+      recon_tile_row(tile_data_recon, pbi, thread_data->thread_id, mi_row,
+                     is_last_row, lf_sync, job.tile_col);
+      add_stage_times(pbi, tile_data_recon, thread_data->thread_id,
+                      job.tile_col);
 
       if (corrupted)
         vpx_internal_error(&tile_data_recon->error_info,
@@ -1978,7 +2264,9 @@ static int row_decode_worker_hook(void *arg1, void *arg2) {
 
       tile_data->error_info.setjmp = 1;
 
+      init_stage_times(pbi, tile_data);
       parse_tile_row(tile_data, pbi, mi_row, job.tile_col, data_end);
+      add_stage_times(pbi, tile_data, thread_data->thread_id, job.tile_col);
 
       corrupted |= tile_data->xd.corrupted;
       if (corrupted)
@@ -1991,8 +2279,8 @@ static int row_decode_worker_hook(void *arg1, void *arg2) {
         recon_job.row_num = mi_row;
         recon_job.tile_col = job.tile_col;
         recon_job.job_type = RECON_JOB;
-        vp9_jobq_queue(&row_mt_worker_data->jobq, &recon_job,
-                       sizeof(recon_job));
+        vp9_jobq_queue(&row_mt_worker_data->jobq, thread_data->thread_id,
+                       &recon_job, sizeof(recon_job));
       }
 
       /* Queue next parse job */
@@ -2001,8 +2289,8 @@ static int row_decode_worker_hook(void *arg1, void *arg2) {
         parse_job.row_num = mi_row + MI_BLOCK_SIZE;
         parse_job.tile_col = job.tile_col;
         parse_job.job_type = PARSE_JOB;
-        vp9_jobq_queue(&row_mt_worker_data->jobq, &parse_job,
-                       sizeof(parse_job));
+        vp9_jobq_queue(&row_mt_worker_data->jobq, thread_data->thread_id,
+                       &parse_job, sizeof(parse_job));
       }
     }
   }
@@ -2011,6 +2299,147 @@ static int row_decode_worker_hook(void *arg1, void *arg2) {
   return !corrupted;
 }
 
+// Reports the rows of the frame being decoded above 'rows' to the put_rows
+// callback, if they have not been already.
+static void put_rows(VP9Decoder *pbi, int rows) {
+  VP9_COMMON *const cm = &pbi->common;
+  const YV12_BUFFER_CONFIG *const buf = get_frame_new_buffer(cm);
+
+  rows = VPXMIN(rows, buf->y_crop_height);
+  if (pbi->put_rows_cb == NULL || !cm->show_frame || rows <= pbi->rows_put)
+    return;
+  pbi->put_rows_cb(pbi->put_rows_priv, buf, pbi->rows_put, rows);
+  pbi->rows_put = rows;
+}
+
+// Announces the frame being decoded to the put_rows callback.
+static void start_put_rows(VP9Decoder *pbi) {
+  VP9_COMMON *const cm = &pbi->common;
+  pbi->rows_put = 0;
+  if (pbi->put_rows_cb != NULL && cm->show_frame)
+    pbi->put_rows_cb(pbi->put_rows_priv, get_frame_new_buffer(cm), 0, 0);
+}
+
+// Reports the rows left final once the superblock rows above 'mi_row' are
+// loop filtered. Filtering the next row changes up to 7 pixel rows above it,
+// 14 luma rows for subsampled chroma.
+static void put_filtered_rows(VP9Decoder *pbi, int mi_row) {
+  const int rows = mi_row << MI_SIZE_LOG2;
+  put_rows(pbi, mi_row < pbi->common.mi_rows ? rows - 16 : rows);
+}
+
+// Row callback of the multi-threaded loop filter.
+static void lf_row_done(void *priv, int sb_row) {
+  put_filtered_rows((VP9Decoder *)priv, (sb_row + 1) << MI_BLOCK_SIZE_LOG2);
+}
+
+// Start of pixel row 'y' of 'plane' in 'buf'.
+static uint8_t *get_plane_row(const YV12_BUFFER_CONFIG *buf, int plane,
+                              int y) {
+  uint8_t *const buffers[MAX_MB_PLANE] = { buf->y_buffer, buf->u_buffer,
+                                           buf->v_buffer };
+  const int stride = plane ? buf->uv_stride : buf->y_stride;
+#if CONFIG_VP9_HIGHBITDEPTH
+  if (buf->flags & YV12_FLAG_HIGHBITDEPTH)
+    return (uint8_t *)(CONVERT_TO_SHORTPTR(buffers[plane]) + y * stride);
+#endif
+  return buffers[plane] + y * stride;
+}
+
+static int get_pixel_bytes(const YV12_BUFFER_CONFIG *buf) {
+#if CONFIG_VP9_HIGHBITDEPTH
+  return (buf->flags & YV12_FLAG_HIGHBITDEPTH) ? 2 : 1;
+#else
+  (void)buf;
+  return 1;
+#endif
+}
+
+// Line of 'plane' kept for the superblock rows of the same parity as the one
+// at 'mi_row'.
+static uint8_t *get_lf_line(VP9Decoder *pbi, int mi_row, int plane) {
+  VP9_COMMON *const cm = &pbi->common;
+  const size_t width = (size_t)mi_cols_aligned_to_sb(cm->mi_cols)
+                       << MI_SIZE_LOG2;
+  const int parity = (mi_row >> MI_BLOCK_SIZE_LOG2) & 1;
+  return pbi->lf_line + (parity * MAX_MB_PLANE + plane) * width *
+                            get_pixel_bytes(get_frame_new_buffer(cm));
+}
+
+static void alloc_lf_line(VP9Decoder *pbi) {
+  VP9_COMMON *const cm = &pbi->common;
+  const size_t size = 2 * MAX_MB_PLANE *
+                      ((size_t)mi_cols_aligned_to_sb(cm->mi_cols)
+                       << MI_SIZE_LOG2) *
+                      get_pixel_bytes(get_frame_new_buffer(cm));
+  if (size > pbi->lf_line_size) {
+    vpx_free(pbi->lf_line);
+    pbi->lf_line_size = 0;
+    CHECK_MEM_ERROR(cm, pbi->lf_line, vpx_malloc(size));
+    pbi->lf_line_size = size;
+  }
+}
+
+// Copies the last pixel row of the superblock at ('mi_row', 'mi_col') to its
+// line before the superblock is filtered.
+static void save_lf_line(VP9Decoder *pbi, int mi_row, int mi_col) {
+  const YV12_BUFFER_CONFIG *const buf = get_frame_new_buffer(&pbi->common);
+  const int bytes = get_pixel_bytes(buf);
+  int plane;
+
+  for (plane = 0; plane < MAX_MB_PLANE; ++plane) {
+    const int ss_x = plane ? buf->subsampling_x : 0;
+    const int ss_y = plane ? buf->subsampling_y : 0;
+    const int width = plane ? buf->uv_width : buf->y_width;
+    const int x = (mi_col << MI_SIZE_LOG2) >> ss_x;
+    const int y = ((mi_row + MI_BLOCK_SIZE) << MI_SIZE_LOG2) >> ss_y;
+    const int w = VPXMIN((MI_BLOCK_SIZE << MI_SIZE_LOG2) >> ss_x, width - x);
+    memcpy(get_lf_line(pbi, mi_row, plane) + x * bytes,
+           get_plane_row(buf, plane, y - 1) + x * bytes, w * bytes);
+  }
+}
+
+// Exchanges the pixel row above the superblock at ('mi_row', 'mi_col'),
+// from the pixel above and to the left of it, with the line of the row above.
+// Called before the superblock is decoded to give the intra prediction the
+// pixels before filtering, and after to put the filtered ones back.
+static void swap_lf_line(VP9Decoder *pbi, int mi_row, int mi_col) {
+  const YV12_BUFFER_CONFIG *const buf = get_frame_new_buffer(&pbi->common);
+  const int bytes = get_pixel_bytes(buf);
+  int plane;
+
+  for (plane = 0; plane < MAX_MB_PLANE; ++plane) {
+    const int ss_x = plane ? buf->subsampling_x : 0;
+    const int ss_y = plane ? buf->subsampling_y : 0;
+    const int width = plane ? buf->uv_width : buf->y_width;
+    const int x = ((mi_col << MI_SIZE_LOG2) >> ss_x) - (mi_col > 0);
+    const int w =
+        VPXMIN(((mi_col + MI_BLOCK_SIZE) << MI_SIZE_LOG2) >> ss_x, width) - x;
+    uint8_t *const line =
+        get_lf_line(pbi, mi_row - MI_BLOCK_SIZE, plane) + x * bytes;
+    uint8_t *const row =
+        get_plane_row(buf, plane, ((mi_row << MI_SIZE_LOG2) >> ss_y) - 1) +
+        x * bytes;
+    uint8_t tmp[2 * (64 + 1)];
+    if (w <= 0) continue;
+    memcpy(tmp, row, w * bytes);
+    memcpy(row, line, w * bytes);
+    memcpy(line, tmp, w * bytes);
+  }
+}
+
+// Loop filters the superblock at ('mi_row', 'mi_col'), the next one in raster
+// order being decoded.
+static void loop_filter_sb(VP9Decoder *pbi, int mi_row, int mi_col) {
+  LFWorkerData *const lf_data = (LFWorkerData *)pbi->lf_worker.data1;
+  const int64_t start = pbi->collect_stats ? vpx_nsec_time() : 0;
+  if (mi_row + MI_BLOCK_SIZE < pbi->common.mi_rows)
+    save_lf_line(pbi, mi_row, mi_col);
+  vp9_loop_filter_sb(lf_data->frame_buffer, lf_data->cm, lf_data->planes,
+                     mi_row, mi_col);
+  if (pbi->collect_stats) lf_data->filter_time += vpx_nsec_time() - start;
+}
+
 static const uint8_t *decode_tiles(VP9Decoder *pbi, const uint8_t *data,
                                    const uint8_t *data_end) {
   VP9_COMMON *const cm = &pbi->common;
@@ -2021,13 +2450,21 @@ static const uint8_t *decode_tiles(VP9Decoder *pbi, const uint8_t *data,
   TileBuffer tile_buffers[4][1 << 6];
   int tile_row, tile_col;
   int mi_row, mi_col;
+  int n;
   TileWorkerData *tile_data = NULL;
+  // With a single thread each superblock can be filtered once the next one is
+  // decoded, while it is still in the cache, instead of a row later. The
+  // tiles must then be decoded in raster order.
+  const int lf_per_sb = cm->lf.filter_level && !cm->skip_loop_filter &&
+                        pbi->fused_lf && pbi->max_threads <= 1 &&
+                        !pbi->inv_tile_order;
 
   if (cm->lf.filter_level && !cm->skip_loop_filter &&
       pbi->lf_worker.data1 == NULL) {
     CHECK_MEM_ERROR(cm, pbi->lf_worker.data1,
                     vpx_memalign(32, sizeof(LFWorkerData)));
     pbi->lf_worker.hook = vp9_loop_filter_worker;
+    pbi->lf_worker.pool = pbi->thread_pool;
     if (pbi->max_threads > 1 && !winterface->reset(&pbi->lf_worker)) {
       vpx_internal_error(&cm->error, VPX_CODEC_ERROR,
                          "Loop filter thread creation failed");
@@ -2041,6 +2478,7 @@ static const uint8_t *decode_tiles(VP9Decoder *pbi, const uint8_t *data,
     vp9_loop_filter_data_reset(lf_data, get_frame_new_buffer(cm), cm,
                                pbi->mb.plane);
   }
+  if (lf_per_sb) alloc_lf_line(pbi);
 
   assert(tile_rows <= 4);
   assert(tile_cols <= (1 << 6));
@@ -2072,6 +2510,7 @@ static const uint8_t *decode_tiles(VP9Decoder *pbi, const uint8_t *data,
                           &tile_data->bit_reader, pbi->decrypt_cb,
                           pbi->decrypt_state);
       vp9_init_macroblockd(cm, &tile_data->xd, tile_data->dqcoeff);
+      init_stage_times(pbi, tile_data);
     }
   }
 
@@ -2080,6 +2519,14 @@ static const uint8_t *decode_tiles(VP9Decoder *pbi, const uint8_t *data,
     vp9_tile_set_row(&tile, cm, tile_row);
     for (mi_row = tile.mi_row_start; mi_row < tile.mi_row_end;
          mi_row += MI_BLOCK_SIZE) {
+      if (cm->frame_parallel_decode) {
+        // Wait for the co-located motion vectors and segment ids of the row.
+        const int row = (mi_row + MI_BLOCK_SIZE) << MI_SIZE_LOG2;
+        if (cm->use_prev_frame_mvs)
+          vp9_frameworker_wait(cm->buffer_pool, cm->prev_frame, row);
+        if (cm->seg.enabled && pbi->seg_map_buf != NULL)
+          vp9_frameworker_wait(cm->buffer_pool, pbi->seg_map_buf, row);
+      }
       for (tile_col = 0; tile_col < tile_cols; ++tile_col) {
         const int col =
             pbi->inv_tile_order ? tile_cols - tile_col - 1 : tile_col;
@@ -2089,7 +2536,16 @@ static const uint8_t *decode_tiles(VP9Decoder *pbi, const uint8_t *data,
         vp9_zero(tile_data->xd.left_seg_context);
         for (mi_col = tile.mi_col_start; mi_col < tile.mi_col_end;
              mi_col += MI_BLOCK_SIZE) {
-          if (pbi->row_mt == 1) {
+          if (lf_per_sb && mi_row > 0) swap_lf_line(pbi, mi_row, mi_col);
+          start_stage(tile_data);
+          if (!sb_in_region(pbi, mi_row, mi_col)) {
+            if (pbi->row_mt == 1) {
+              parse_sb_row_mt(tile_data, pbi, mi_row, mi_col);
+            } else {
+              tile_data->parse_only = 1;
+              decode_partition(tile_data, pbi, mi_row, mi_col, BLOCK_64X64, 4);
+            }
+          } else if (pbi->row_mt == 1) {
             int plane;
             RowMTWorkerData *const row_mt_worker_data = pbi->row_mt_worker_data;
             for (plane = 0; plane < MAX_MB_PLANE; ++plane) {
@@ -2110,16 +2566,35 @@ static const uint8_t *decode_tiles(VP9Decoder *pbi, const uint8_t *data,
             process_partition(tile_data, pbi, mi_row, mi_col, BLOCK_64X64, 4,
                               RECON, recon_block);
           } else {
+            tile_data->parse_only = 0;
             decode_partition(tile_data, pbi, mi_row, mi_col, BLOCK_64X64, 4);
           }
+          if (lf_per_sb) {
+            if (mi_row > 0) swap_lf_line(pbi, mi_row, mi_col);
+            if (mi_col > 0) loop_filter_sb(pbi, mi_row, mi_col - MI_BLOCK_SIZE);
+          }
         }
         pbi->mb.corrupted |= tile_data->xd.corrupted;
         if (pbi->mb.corrupted)
           vpx_internal_error(&cm->error, VPX_CODEC_CORRUPT_FRAME,
                              "Failed to decode tile data");
       }
-      // Loopfilter one row.
-      if (cm->lf.filter_level && !cm->skip_loop_filter) {
+      if (!(cm->lf.filter_level && !cm->skip_loop_filter)) {
+        const int rows = (mi_row + MI_BLOCK_SIZE) << MI_SIZE_LOG2;
+        if (cm->frame_parallel_decode)
+          vp9_frameworker_broadcast(cm->buffer_pool, pbi->cur_buf, rows);
+        put_rows(pbi, rows);
+      } else if (lf_per_sb) {
+        const int mi_row_end = mi_row + MI_BLOCK_SIZE;
+        loop_filter_sb(pbi, mi_row,
+                       mi_cols_aligned_to_sb(cm->mi_cols) - MI_BLOCK_SIZE);
+        put_filtered_rows(pbi, mi_row_end);
+        if (cm->frame_parallel_decode && mi_row_end < cm->mi_rows) {
+          vp9_frameworker_broadcast(cm->buffer_pool, pbi->cur_buf,
+                                    (mi_row_end << MI_SIZE_LOG2) - 16);
+        }
+      } else {
+        // Loopfilter one row.
         const int lf_start = mi_row - MI_BLOCK_SIZE;
         LFWorkerData *const lf_data = (LFWorkerData *)pbi->lf_worker.data1;
 
@@ -2130,26 +2605,40 @@ static const uint8_t *decode_tiles(VP9Decoder *pbi, const uint8_t *data,
         if (mi_row + MI_BLOCK_SIZE >= cm->mi_rows) continue;
 
         winterface->sync(&pbi->lf_worker);
+        put_filtered_rows(pbi, lf_data->stop);
         lf_data->start = lf_start;
         lf_data->stop = mi_row;
         if (pbi->max_threads > 1) {
           winterface->launch(&pbi->lf_worker);
         } else {
           winterface->execute(&pbi->lf_worker);
+          put_filtered_rows(pbi, mi_row);
+        }
+
+        // Filtering the next row changes up to 7 pixel rows above it, 14 luma
+        // rows for subsampled chroma, and leaves the rows above those final.
+        if (cm->frame_parallel_decode) {
+          assert(pbi->max_threads == 1);
+          vp9_frameworker_broadcast(cm->buffer_pool, pbi->cur_buf,
+                                    (mi_row << MI_SIZE_LOG2) - 16);
         }
       }
     }
   }
 
   // Loopfilter remaining rows in the frame.
-  if (cm->lf.filter_level && !cm->skip_loop_filter) {
+  if (cm->lf.filter_level && !cm->skip_loop_filter && !lf_per_sb) {
     LFWorkerData *const lf_data = (LFWorkerData *)pbi->lf_worker.data1;
     winterface->sync(&pbi->lf_worker);
     lf_data->start = lf_data->stop;
     lf_data->stop = cm->mi_rows;
     winterface->execute(&pbi->lf_worker);
+    put_filtered_rows(pbi, cm->mi_rows);
   }
 
+  for (n = 0; n < tile_cols * tile_rows; ++n)
+    add_stage_times(pbi, pbi->tile_worker_data + n, 0, n);
+
   // Get last tile data.
   tile_data = pbi->tile_worker_data + tile_cols * tile_rows - 1;
 
@@ -2186,6 +2675,8 @@ static int tile_worker_hook(void *arg1, void *arg2) {
   const int final_col = (1 << pbi->common.log2_tile_cols) - 1;
   const uint8_t *volatile bit_reader_end = NULL;
   VP9_COMMON *cm = &pbi->common;
+  const int thread =
+      (int)(tile_data - pbi->tile_worker_data) - pbi->total_tiles;
 
   LFWorkerData *lf_data = tile_data->lf_data;
   VP9LfSync *lf_sync = tile_data->lf_sync;
@@ -2226,13 +2717,16 @@ static int tile_worker_hook(void *arg1, void *arg2) {
     vp9_init_macroblockd(&pbi->common, &tile_data->xd, tile_data->dqcoeff);
     // init resets xd.error_info
     tile_data->xd.error_info = &tile_data->error_info;
+    init_stage_times(pbi, tile_data);
 
     for (mi_row = tile->mi_row_start; mi_row < tile->mi_row_end;
          mi_row += MI_BLOCK_SIZE) {
       vp9_zero(tile_data->xd.left_context);
       vp9_zero(tile_data->xd.left_seg_context);
+      start_stage(tile_data);
       for (mi_col = tile->mi_col_start; mi_col < tile->mi_col_end;
            mi_col += MI_BLOCK_SIZE) {
+        tile_data->parse_only = !sb_in_region(pbi, mi_row, mi_col);
         decode_partition(tile_data, pbi, mi_row, mi_col, BLOCK_64X64, 4);
       }
       if (pbi->lpf_mt_opt && cm->lf.filter_level && !cm->skip_loop_filter) {
@@ -2245,6 +2739,8 @@ static int tile_worker_hook(void *arg1, void *arg2) {
       }
     }
 
+    add_stage_times(pbi, tile_data, thread, buf->col);
+
     if (buf->col == final_col) {
       bit_reader_end = vpx_reader_find_end(&tile_data->bit_reader);
     }
@@ -2292,6 +2788,7 @@ static INLINE void init_mt(VP9Decoder *pbi) {
       ++pbi->num_tile_workers;
 
       winterface->init(worker);
+      worker->pool = pbi->thread_pool;
       if (n < num_threads - 1 && !winterface->reset(worker)) {
         vpx_internal_error(&cm->error, VPX_CODEC_ERROR,
                            "Tile decoder thread creation failed");
@@ -2357,6 +2854,8 @@ static const uint8_t *decode_tiles_row_wise_mt(VP9Decoder *pbi,
     }
 
     thread_data->pbi = pbi;
+    thread_data->thread_id = n;
+    thread_data->idle_time = row_mt_worker_data->jobq_queues[n].stats.idle_time;
 
     worker->hook = row_decode_worker_hook;
     worker->data1 = thread_data;
@@ -2387,13 +2886,14 @@ static const uint8_t *decode_tiles_row_wise_mt(VP9Decoder *pbi,
     }
   }
 
-  // queue parse jobs for 0th row of every tile
+  // queue parse jobs for 0th row of every tile, spread over the workers
   for (col = 0; col < tile_cols; ++col) {
     Job parse_job;
     parse_job.row_num = 0;
     parse_job.tile_col = col;
     parse_job.job_type = PARSE_JOB;
-    vp9_jobq_queue(&row_mt_worker_data->jobq, &parse_job, sizeof(parse_job));
+    vp9_jobq_queue(&row_mt_worker_data->jobq, col % num_workers, &parse_job,
+                   sizeof(parse_job));
   }
 
   for (i = 0; i < num_workers; ++i) {
@@ -2415,6 +2915,17 @@ static const uint8_t *decode_tiles_row_wise_mt(VP9Decoder *pbi,
     corrupted |= !winterface->sync(worker);
   }
 
+  if (pbi->collect_stats) {
+    for (n = 0; n < num_workers; ++n) {
+      const ThreadData *const thread_data = &row_mt_worker_data->thread_data[n];
+      int64_t times[VPX_DECODE_STAGES] = { 0 };
+      times[VPX_DECODE_STAGE_JOB_WAIT] =
+          row_mt_worker_data->jobq_queues[n].stats.idle_time -
+          thread_data->idle_time;
+      vp9_add_decode_times(pbi, n, -1, times);
+    }
+  }
+
   pbi->mb.corrupted = corrupted;
 
   {
@@ -2693,7 +3204,8 @@ static size_t read_uncompressed_header(VP9Decoder *pbi,
     setup_frame_size(cm, rb);
     if (pbi->need_resync) {
       memset(&cm->ref_frame_map, -1, sizeof(cm->ref_frame_map));
-      flush_all_fb_on_key(cm);
+      // Frames still in flight hold buffers in frame parallel decode.
+      if (!cm->frame_parallel_decode) flush_all_fb_on_key(cm);
       pbi->need_resync = 0;
     }
   } else {
@@ -2773,6 +3285,16 @@ static size_t read_uncompressed_header(VP9Decoder *pbi,
                        " state");
   }
 
+  if (cm->frame_parallel_decode) {
+    // Each frame buffer carries the segmentation map of its frame. A change of
+    // frame size starts again from an empty map.
+    if (cm->width != cm->last_width || cm->height != cm->last_height)
+      pbi->seg_map_buf = NULL;
+    cm->current_frame_seg_map = cm->cur_frame->seg_map;
+    cm->last_frame_seg_map =
+        pbi->seg_map_buf != NULL ? pbi->seg_map_buf->seg_map : NULL;
+  }
+
   if (!cm->error_resilient_mode) {
     cm->refresh_frame_context = vpx_rb_read_bit(rb);
     cm->frame_parallel_decoding_mode = vpx_rb_read_bit(rb);
@@ -2808,8 +3330,13 @@ static size_t read_uncompressed_header(VP9Decoder *pbi,
   }
   pbi->hold_ref_buf = 1;
 
-  if (frame_is_intra_only(cm) || cm->error_resilient_mode)
+  if (frame_is_intra_only(cm) || cm->error_resilient_mode) {
     vp9_setup_past_independence(cm);
+    if (cm->frame_parallel_decode) {
+      pbi->seg_map_buf = NULL;
+      cm->last_frame_seg_map = NULL;
+    }
+  }
 
   setup_loopfilter(&cm->lf, rb);
   setup_quantization(cm, &pbi->mb, rb);
@@ -2839,7 +3366,8 @@ static size_t read_uncompressed_header(VP9Decoder *pbi,
     }
 
     if (num_sbs > pbi->row_mt_worker_data->num_sbs ||
-        num_jobs > pbi->row_mt_worker_data->num_jobs) {
+        num_jobs > pbi->row_mt_worker_data->num_jobs ||
+        (cm->low_memory && num_sbs != pbi->row_mt_worker_data->num_sbs)) {
       vp9_dec_free_row_mt_mem(pbi->row_mt_worker_data);
       vp9_dec_alloc_row_mt_mem(pbi->row_mt_worker_data, cm, num_sbs,
                                pbi->max_threads, num_jobs);
@@ -2944,17 +3472,16 @@ BITSTREAM_PROFILE vp9_read_profile(struct vpx_read_bit_buffer *rb) {
   return (BITSTREAM_PROFILE)profile;
 }
 
-void vp9_decode_frame(VP9Decoder *pbi, const uint8_t *data,
-                      const uint8_t *data_end, const uint8_t **p_data_end) {
+const uint8_t *vp9_decode_frame_headers(VP9Decoder *pbi, const uint8_t *data,
+                                        const uint8_t *data_end,
+                                        const uint8_t **p_data_end) {
   VP9_COMMON *const cm = &pbi->common;
   MACROBLOCKD *const xd = &pbi->mb;
   struct vpx_read_bit_buffer rb;
-  int context_updated = 0;
   uint8_t clear_data[MAX_VP9_HEADER_SIZE];
+  const int64_t start = pbi->collect_stats ? vpx_nsec_time() : 0;
   const size_t first_partition_size = read_uncompressed_header(
       pbi, init_read_bit_buffer(pbi, &rb, data, data_end, clear_data));
-  const int tile_rows = 1 << cm->log2_tile_rows;
-  const int tile_cols = 1 << cm->log2_tile_cols;
   YV12_BUFFER_CONFIG *const new_fb = get_frame_new_buffer(cm);
 #if CONFIG_BITSTREAM_DEBUG || CONFIG_MISMATCH_DEBUG
   bitstream_queue_set_frame_read(cm->current_video_frame * 2 + cm->show_frame);
@@ -2964,10 +3491,13 @@ void vp9_decode_frame(VP9Decoder *pbi, const uint8_t *data,
 #endif
   xd->cur_buf = new_fb;
 
+  if (pbi->collect_stats) ++pbi->stats->frames;
+
   if (!first_partition_size) {
     // showing a frame directly
     *p_data_end = data + (cm->profile <= PROFILE_2 ? 1 : 2);
-    return;
+    vp9_add_decode_time(pbi, VPX_DECODE_STAGE_HEADER, start);
+    return NULL;
   }
 
   data += vpx_rb_bytes_read(&rb);
@@ -2993,10 +3523,59 @@ void vp9_decode_frame(VP9Decoder *pbi, const uint8_t *data,
     vpx_internal_error(&cm->error, VPX_CODEC_CORRUPT_FRAME,
                        "Decode failed. Frame data header is corrupted.");
 
+  // Without backward adaptation the frame context is final already, and the
+  // next frame may start before the tiles of this one are decoded.
+  if (cm->frame_parallel_decode && cm->refresh_frame_context &&
+      cm->frame_parallel_decoding_mode)
+    cm->frame_contexts[cm->frame_context_idx] = *cm->fc;
+
+  vp9_add_decode_time(pbi, VPX_DECODE_STAGE_HEADER, start);
+  return data + first_partition_size;
+}
+
+// Moves the loop filter times of the frame from the filter workers to the
+// decode stats.
+static void collect_lf_times(VP9Decoder *pbi) {
+  LFWorkerData *const lf_data = (LFWorkerData *)pbi->lf_worker.data1;
+  VP9LfSync *const lf_sync = &pbi->lf_row_sync;
+  int64_t times[VPX_DECODE_STAGES] = { 0 };
+  int i;
+
+  if (lf_data != NULL) {
+    times[VPX_DECODE_STAGE_LOOP_FILTER] = lf_data->filter_time;
+    times[VPX_DECODE_STAGE_LF_SYNC_WAIT] = lf_data->wait_time;
+    lf_data->filter_time = lf_data->wait_time = 0;
+    if (pbi->collect_stats) vp9_add_decode_times(pbi, 0, -1, times);
+  }
+  for (i = 0; lf_sync->lfdata != NULL && i < lf_sync->num_workers; ++i) {
+    LFWorkerData *const data = &lf_sync->lfdata[i];
+    times[VPX_DECODE_STAGE_LOOP_FILTER] = data->filter_time;
+    times[VPX_DECODE_STAGE_LF_SYNC_WAIT] = data->wait_time;
+    data->filter_time = data->wait_time = 0;
+    if (pbi->collect_stats) vp9_add_decode_times(pbi, i, -1, times);
+  }
+}
+
+void vp9_decode_frame_tiles(VP9Decoder *pbi, const uint8_t *data,
+                            const uint8_t *data_end,
+                            const uint8_t **p_data_end) {
+  VP9_COMMON *const cm = &pbi->common;
+  MACROBLOCKD *const xd = &pbi->mb;
+  const int context_updated =
+      cm->frame_parallel_decode && cm->frame_parallel_decoding_mode;
+  const int tile_rows = 1 << cm->log2_tile_rows;
+  const int tile_cols = 1 << cm->log2_tile_cols;
+  YV12_BUFFER_CONFIG *const new_fb = get_frame_new_buffer(cm);
+
   if (cm->lf.filter_level && !cm->skip_loop_filter) {
     vp9_loop_filter_frame_init(cm, cm->lf.filter_level);
   }
 
+  setup_decode_region(pbi);
+  start_put_rows(pbi);
+  pbi->lf_row_sync.row_done = pbi->put_rows_cb != NULL ? lf_row_done : NULL;
+  pbi->lf_row_sync.row_done_priv = pbi;
+
   if (pbi->tile_worker_data == NULL ||
       (tile_cols * tile_rows) != pbi->total_tiles) {
     const int num_tile_workers =
@@ -3013,11 +3592,10 @@ void vp9_decode_frame(VP9Decoder *pbi, const uint8_t *data,
   if (pbi->max_threads > 1 && tile_rows == 1 &&
       (tile_cols > 1 || pbi->row_mt == 1)) {
     if (pbi->row_mt == 1) {
-      *p_data_end =
-          decode_tiles_row_wise_mt(pbi, data + first_partition_size, data_end);
+      *p_data_end = decode_tiles_row_wise_mt(pbi, data, data_end);
     } else {
       // Multi-threaded tile decoder
-      *p_data_end = decode_tiles_mt(pbi, data + first_partition_size, data_end);
+      *p_data_end = decode_tiles_mt(pbi, data, data_end);
       if (!pbi->lpf_mt_opt) {
         if (!xd->corrupted) {
           if (!cm->skip_loop_filter) {
@@ -3034,17 +3612,24 @@ void vp9_decode_frame(VP9Decoder *pbi, const uint8_t *data,
       }
     }
   } else {
-    *p_data_end = decode_tiles(pbi, data + first_partition_size, data_end);
+    *p_data_end = decode_tiles(pbi, data, data_end);
   }
 
+  collect_lf_times(pbi);
+
   if (!xd->corrupted) {
+    // The rows are not reported by the threads without the loop filter.
+    put_rows(pbi, new_fb->y_crop_height);
+
     if (!cm->error_resilient_mode && !cm->frame_parallel_decoding_mode) {
+      const int64_t start = pbi->collect_stats ? vpx_nsec_time() : 0;
       vp9_adapt_coef_probs(cm);
 
       if (!frame_is_intra_only(cm)) {
         vp9_adapt_mode_probs(cm);
         vp9_adapt_mv_probs(cm, cm->allow_high_precision_mv);
       }
+      vp9_add_decode_time(pbi, VPX_DECODE_STAGE_HEADER, start);
     }
   } else {
     vpx_internal_error(&cm->error, VPX_CODEC_CORRUPT_FRAME,
@@ -3055,3 +3640,16 @@ void vp9_decode_frame(VP9Decoder *pbi, const uint8_t *data,
   if (cm->refresh_frame_context && !context_updated)
     cm->frame_contexts[cm->frame_context_idx] = *cm->fc;
 }
+
+void vp9_decode_frame(VP9Decoder *pbi, const uint8_t *data,
+                      const uint8_t *data_end, const uint8_t **p_data_end) {
+  const uint8_t *const tile_data =
+      vp9_decode_frame_headers(pbi, data, data_end, p_data_end);
+  if (tile_data != NULL) {
+    vp9_decode_frame_tiles(pbi, tile_data, data_end, p_data_end);
+  } else {
+    // The frame shown directly is complete.
+    start_put_rows(pbi);
+    put_rows(pbi, get_frame_new_buffer(&pbi->common)->y_crop_height);
+  }
+}
@@ -35,6 +35,7 @@
 #include "vp9/decoder/vp9_decodeframe.h"
 #include "vp9/decoder/vp9_decoder.h"
 #include "vp9/decoder/vp9_detokenize.h"
+#include "vp9/decoder/vp9_dthread.h"
 
 static void initialize_dec(void) {
   static volatile int init_done = 0;
@@ -172,6 +173,9 @@ VP9Decoder *vp9_decoder_create(BufferPool *const pool) {
   if (!cm) return NULL;
 
   vp9_zero(*pbi);
+#if CONFIG_MULTITHREAD
+  pthread_mutex_init(&pbi->stats_mutex, NULL);
+#endif
 
   if (setjmp(cm->error.jmp)) {
     cm->error.setjmp = 0;
@@ -227,6 +231,7 @@ void vp9_decoder_remove(VP9Decoder *pbi) {
   }
 
   vpx_free(pbi->tile_worker_data);
+  vpx_free(pbi->lf_line);
   vpx_free(pbi->tile_workers);
 
   if (pbi->num_tile_workers > 0) {
@@ -238,6 +243,7 @@ void vp9_decoder_remove(VP9Decoder *pbi) {
     if (pbi->row_mt_worker_data != NULL) {
       vp9_jobq_deinit(&pbi->row_mt_worker_data->jobq);
       vpx_free(pbi->row_mt_worker_data->jobq_buf);
+      vpx_free(pbi->row_mt_worker_data->jobq_queues);
 #if CONFIG_MULTITHREAD
       pthread_mutex_destroy(&pbi->row_mt_worker_data->recon_done_mutex);
 #endif
@@ -245,6 +251,11 @@ void vp9_decoder_remove(VP9Decoder *pbi) {
     vpx_free(pbi->row_mt_worker_data);
   }
 
+  vpx_free(pbi->stats);
+#if CONFIG_MULTITHREAD
+  pthread_mutex_destroy(&pbi->stats_mutex);
+#endif
+
   vp9_remove_common(&pbi->common);
   vpx_free(pbi);
 }
@@ -330,6 +341,265 @@ vpx_codec_err_t vp9_set_reference_dec(VP9_COMMON *cm,
   return cm->error.error_code;
 }
 
+// Copies the decoded area of the planes of 'src' to 'dst', of the same size.
+static void copy_frame_planes(const YV12_BUFFER_CONFIG *src,
+                              YV12_BUFFER_CONFIG *dst) {
+  const uint8_t *const src_planes[3] = { src->y_buffer, src->u_buffer,
+                                         src->v_buffer };
+  uint8_t *const dst_planes[3] = { dst->y_buffer, dst->u_buffer,
+                                   dst->v_buffer };
+  int plane, r;
+
+  for (plane = 0; plane < 3; ++plane) {
+    const int width = plane ? src->uv_width : src->y_width;
+    const int height = plane ? src->uv_height : src->y_height;
+    const int src_stride = plane ? src->uv_stride : src->y_stride;
+    const int dst_stride = plane ? dst->uv_stride : dst->y_stride;
+#if CONFIG_VP9_HIGHBITDEPTH
+    if (src->flags & YV12_FLAG_HIGHBITDEPTH) {
+      const uint16_t *const s = CONVERT_TO_SHORTPTR(src_planes[plane]);
+      uint16_t *const d = CONVERT_TO_SHORTPTR(dst_planes[plane]);
+      for (r = 0; r < height; ++r)
+        memcpy(d + r * dst_stride, s + r * src_stride, width * sizeof(*s));
+      continue;
+    }
+#endif
+    for (r = 0; r < height; ++r) {
+      memcpy(dst_planes[plane] + r * dst_stride,
+             src_planes[plane] + r * src_stride, width);
+    }
+  }
+}
+
+static void copy_frame_info(const YV12_BUFFER_CONFIG *src,
+                            YV12_BUFFER_CONFIG *dst) {
+  dst->bit_depth = src->bit_depth;
+  dst->color_space = src->color_space;
+  dst->color_range = src->color_range;
+  dst->render_width = src->render_width;
+  dst->render_height = src->render_height;
+  dst->corrupted = src->corrupted;
+}
+
+vpx_codec_err_t vp9_save_checkpoint(VP9Decoder *pbi,
+                                    VP9DecoderCheckpoint *cp) {
+  VP9_COMMON *const cm = &pbi->common;
+  RefCntBuffer *const frame_bufs = cm->buffer_pool->frame_bufs;
+  const int mi_size = cm->mi_rows * cm->mi_cols;
+  int buf_of_fb[FRAME_BUFFERS];
+  int i;
+
+  if (cm->prev_frame == NULL || cm->prev_frame->mvs == NULL)
+    return VPX_CODEC_ERROR;
+
+  for (i = 0; i < FRAME_BUFFERS; ++i) buf_of_fb[i] = -1;
+  cp->num_bufs = 0;
+  for (i = 0; i < REF_FRAMES; ++i) {
+    const int idx = cm->ref_frame_map[i];
+    if (idx < 0) {
+      cp->ref_buf[i] = -1;
+      continue;
+    }
+    if (buf_of_fb[idx] < 0) {
+      const YV12_BUFFER_CONFIG *const src = &frame_bufs[idx].buf;
+      YV12_BUFFER_CONFIG *const dst = &cp->bufs[cp->num_bufs];
+      if (vpx_realloc_frame_buffer(dst, src->y_crop_width, src->y_crop_height,
+                                   src->subsampling_x, src->subsampling_y,
+#if CONFIG_VP9_HIGHBITDEPTH
+                                   (src->flags & YV12_FLAG_HIGHBITDEPTH) != 0,
+#endif
+                                   0, 0, NULL, NULL, NULL))
+        return VPX_CODEC_MEM_ERROR;
+      copy_frame_planes(src, dst);
+      copy_frame_info(src, dst);
+      buf_of_fb[idx] = cp->num_bufs++;
+    }
+    cp->ref_buf[i] = buf_of_fb[idx];
+  }
+  cp->prev_buf = buf_of_fb[cm->prev_frame - frame_bufs];
+
+  if (mi_size > cp->mi_alloc_size) {
+    vpx_free(cp->prev_mvs);
+    vpx_free(cp->seg_map);
+    cp->mi_alloc_size = 0;
+    cp->prev_mvs = (MV_REF *)vpx_malloc(mi_size * sizeof(*cp->prev_mvs));
+    cp->seg_map = (uint8_t *)vpx_malloc(mi_size);
+    if (cp->prev_mvs == NULL || cp->seg_map == NULL) return VPX_CODEC_MEM_ERROR;
+    cp->mi_alloc_size = mi_size;
+  }
+  memcpy(cp->prev_mvs, cm->prev_frame->mvs, mi_size * sizeof(*cp->prev_mvs));
+  memcpy(cp->seg_map, cm->last_frame_seg_map, mi_size);
+
+  cp->fc = *cm->fc;
+  memcpy(cp->frame_contexts, cm->frame_contexts, sizeof(cp->frame_contexts));
+  cp->seg = cm->seg;
+  cp->mode_ref_delta_enabled = cm->lf.mode_ref_delta_enabled;
+  memcpy(cp->ref_deltas, cm->lf.ref_deltas, sizeof(cp->ref_deltas));
+  memcpy(cp->mode_deltas, cm->lf.mode_deltas, sizeof(cp->mode_deltas));
+
+  cp->width = cm->width;
+  cp->height = cm->height;
+  cp->last_width = cm->last_width;
+  cp->last_height = cm->last_height;
+  cp->render_width = cm->render_width;
+  cp->render_height = cm->render_height;
+  cp->subsampling_x = cm->subsampling_x;
+  cp->subsampling_y = cm->subsampling_y;
+#if CONFIG_VP9_HIGHBITDEPTH
+  cp->use_highbitdepth = cm->use_highbitdepth;
+#endif
+  cp->bit_depth = cm->bit_depth;
+  cp->color_space = cm->color_space;
+  cp->color_range = cm->color_range;
+  cp->frame_type = cm->frame_type;
+  cp->intra_only = cm->intra_only;
+  cp->last_show_frame = cm->last_show_frame;
+  cp->current_video_frame = cm->current_video_frame;
+  cp->current_frame_coding_index = cm->current_frame_coding_index;
+  cp->need_resync = pbi->need_resync;
+  return VPX_CODEC_OK;
+}
+
+vpx_codec_err_t vp9_restore_checkpoint(VP9Decoder *pbi,
+                                       const VP9DecoderCheckpoint *cp) {
+  VP9_COMMON *const cm = &pbi->common;
+  BufferPool *const pool = cm->buffer_pool;
+  RefCntBuffer *const frame_bufs = pool->frame_bufs;
+  int fb_of_buf[REF_FRAMES];
+  RefCntBuffer *prev;
+  int mi_size, i;
+
+  // Release the reference frames, and the last frame if it has none.
+  if (cm->new_fb_idx >= 0 && frame_bufs[cm->new_fb_idx].ref_count == 0 &&
+      !frame_bufs[cm->new_fb_idx].released) {
+    pool->release_fb_cb(pool->cb_priv,
+                        &frame_bufs[cm->new_fb_idx].raw_frame_buffer);
+    frame_bufs[cm->new_fb_idx].released = 1;
+  }
+  for (i = 0; i < REF_FRAMES; ++i) {
+    decrease_ref_count(cm->ref_frame_map[i], frame_bufs, pool);
+    cm->ref_frame_map[i] = -1;
+  }
+  // Until the state is restored, a failure leaves the decoder waiting for a
+  // key frame.
+  pbi->need_resync = 1;
+  pbi->ready_for_new_data = 1;
+  cm->prev_frame = NULL;
+
+  if (cm->width != cp->width || cm->height != cp->height) {
+    const int mi_rows =
+        ALIGN_POWER_OF_TWO(cp->height, MI_SIZE_LOG2) >> MI_SIZE_LOG2;
+    const int mi_cols =
+        ALIGN_POWER_OF_TWO(cp->width, MI_SIZE_LOG2) >> MI_SIZE_LOG2;
+    if (mi_cols > cm->mi_cols || mi_rows > cm->mi_rows) {
+      if (vp9_alloc_context_buffers(cm, cp->width, cp->height)) {
+        cm->width = 0;
+        cm->height = 0;
+        return VPX_CODEC_MEM_ERROR;
+      }
+    } else {
+      vp9_set_mb_mi(cm, cp->width, cp->height);
+    }
+    vp9_init_context_buffers(cm);
+    cm->width = cp->width;
+    cm->height = cp->height;
+  }
+  mi_size = cm->mi_rows * cm->mi_cols;
+
+  for (i = 0; i < cp->num_bufs; ++i) {
+    const YV12_BUFFER_CONFIG *const src = &cp->bufs[i];
+    RefCntBuffer *buf;
+    fb_of_buf[i] = get_free_fb(cm);
+    if (fb_of_buf[i] == INVALID_IDX) break;
+    buf = &frame_bufs[fb_of_buf[i]];
+    if (vpx_realloc_frame_buffer(&buf->buf, src->y_crop_width,
+                                 src->y_crop_height, src->subsampling_x,
+                                 src->subsampling_y,
+#if CONFIG_VP9_HIGHBITDEPTH
+                                 (src->flags & YV12_FLAG_HIGHBITDEPTH) != 0,
+#endif
+                                 VP9_DEC_BORDER_IN_PIXELS, cm->byte_alignment,
+                                 &buf->raw_frame_buffer, pool->get_fb_cb,
+                                 pool->cb_priv)) {
+      decrease_ref_count(fb_of_buf[i], frame_bufs, pool);
+      break;
+    }
+    buf->released = 0;
+    buf->buf.subsampling_x = src->subsampling_x;
+    buf->buf.subsampling_y = src->subsampling_y;
+    copy_frame_planes(src, &buf->buf);
+    copy_frame_info(src, &buf->buf);
+  }
+  if (i < cp->num_bufs) {
+    while (--i >= 0) decrease_ref_count(fb_of_buf[i], frame_bufs, pool);
+    return VPX_CODEC_MEM_ERROR;
+  }
+  for (i = 0; i < REF_FRAMES; ++i) {
+    if (cp->ref_buf[i] < 0) continue;
+    cm->ref_frame_map[i] = fb_of_buf[cp->ref_buf[i]];
+    ++frame_bufs[cm->ref_frame_map[i]].ref_count;
+  }
+  for (i = 0; i < cp->num_bufs; ++i) --frame_bufs[fb_of_buf[i]].ref_count;
+
+  // The motion vectors of a previous frame that is not a reference are kept
+  // in a free buffer. The next frame may be decoded in it, as its motion
+  // vectors are written where the previous ones have been read.
+  if (cp->prev_buf >= 0) {
+    prev = &frame_bufs[fb_of_buf[cp->prev_buf]];
+  } else {
+    for (i = 0; i < FRAME_BUFFERS; ++i)
+      if (frame_bufs[i].ref_count == 0) break;
+    if (i == FRAME_BUFFERS) return VPX_CODEC_MEM_ERROR;
+    prev = &frame_bufs[i];
+  }
+  if (prev->mvs == NULL || cm->mi_rows > prev->mi_rows ||
+      cm->mi_cols > prev->mi_cols) {
+    vpx_free(prev->mvs);
+    prev->mi_rows = cm->mi_rows;
+    prev->mi_cols = cm->mi_cols;
+    prev->mvs = (MV_REF *)vpx_calloc(mi_size, sizeof(*prev->mvs));
+    if (prev->mvs == NULL) return VPX_CODEC_MEM_ERROR;
+  }
+  memcpy(prev->mvs, cp->prev_mvs, mi_size * sizeof(*prev->mvs));
+  memcpy(cm->last_frame_seg_map, cp->seg_map, mi_size);
+  cm->prev_frame = prev;
+
+  *cm->fc = cp->fc;
+  memcpy(cm->frame_contexts, cp->frame_contexts, sizeof(cp->frame_contexts));
+  cm->seg = cp->seg;
+  cm->lf.mode_ref_delta_enabled = cp->mode_ref_delta_enabled;
+  memcpy(cm->lf.ref_deltas, cp->ref_deltas, sizeof(cp->ref_deltas));
+  memcpy(cm->lf.mode_deltas, cp->mode_deltas, sizeof(cp->mode_deltas));
+
+  cm->last_width = cp->last_width;
+  cm->last_height = cp->last_height;
+  cm->render_width = cp->render_width;
+  cm->render_height = cp->render_height;
+  cm->subsampling_x = cp->subsampling_x;
+  cm->subsampling_y = cp->subsampling_y;
+#if CONFIG_VP9_HIGHBITDEPTH
+  cm->use_highbitdepth = cp->use_highbitdepth;
+#endif
+  cm->bit_depth = cp->bit_depth;
+  cm->color_space = cp->color_space;
+  cm->color_range = cp->color_range;
+  cm->frame_type = cp->frame_type;
+  cm->intra_only = cp->intra_only;
+  cm->last_show_frame = cp->last_show_frame;
+  cm->current_video_frame = cp->current_video_frame;
+  cm->current_frame_coding_index = cp->current_frame_coding_index;
+  pbi->need_resync = cp->need_resync;
+  return VPX_CODEC_OK;
+}
+
+void vp9_free_checkpoint(VP9DecoderCheckpoint *cp) {
+  int i;
+  for (i = 0; i < REF_FRAMES; ++i) vpx_free_frame_buffer(&cp->bufs[i]);
+  vpx_free(cp->prev_mvs);
+  vpx_free(cp->seg_map);
+  vpx_free(cp);
+}
+
 /* If any buffer updating is signaled it should be done here. */
 static void swap_frame_buffers(VP9Decoder *pbi) {
   int ref_index = 0, mask;
@@ -491,6 +761,104 @@ int vp9_receive_compressed_data(VP9Decoder *pbi, size_t size,
   return retcode;
 }
 
+int vp9_receive_frame_headers(VP9Decoder *pbi, size_t size,
+                              const uint8_t **psource) {
+  VP9_COMMON *volatile const cm = &pbi->common;
+  BufferPool *volatile const pool = cm->buffer_pool;
+  RefCntBuffer *volatile const frame_bufs = cm->buffer_pool->frame_bufs;
+  const uint8_t *source = *psource;
+  const uint8_t *tile_data;
+  cm->error.error_code = VPX_CODEC_OK;
+
+  pbi->ready_for_new_data = 0;
+
+  // Find a free frame buffer. Return error if can not find any.
+  cm->new_fb_idx = get_free_fb(cm);
+  if (cm->new_fb_idx == INVALID_IDX) {
+    pbi->ready_for_new_data = 1;
+    vpx_clear_system_state();
+    vpx_internal_error(&cm->error, VPX_CODEC_MEM_ERROR,
+                       "Unable to find free frame buffer");
+    return cm->error.error_code;
+  }
+
+  cm->cur_frame = &pool->frame_bufs[cm->new_fb_idx];
+
+  pbi->hold_ref_buf = 0;
+  pbi->cur_buf = &frame_bufs[cm->new_fb_idx];
+#if CONFIG_MULTITHREAD
+  vpx_atomic_init(&pbi->cur_buf->row, 0);
+#endif
+
+  if (setjmp(cm->error.jmp)) {
+    cm->error.setjmp = 0;
+    pbi->ready_for_new_data = 1;
+    release_fb_on_decoder_exit(pbi);
+    // Release current frame.
+    decrease_ref_count(cm->new_fb_idx, frame_bufs, pool);
+    vpx_clear_system_state();
+    return -1;
+  }
+
+  cm->error.setjmp = 1;
+  tile_data = vp9_decode_frame_headers(pbi, source, source + size, psource);
+  if (tile_data != NULL) *psource = tile_data;
+
+  vpx_clear_system_state();
+  cm->error.setjmp = 0;
+  return 0;
+}
+
+int vp9_receive_frame_tiles(VP9Decoder *pbi, const uint8_t *data,
+                            const uint8_t *data_end,
+                            const uint8_t **p_data_end) {
+  VP9_COMMON *volatile const cm = &pbi->common;
+
+  if (setjmp(cm->error.jmp)) {
+    cm->error.setjmp = 0;
+    // The frames predicting from this one are corrupted as well, but must not
+    // wait forever.
+    pbi->cur_buf->buf.corrupted = 1;
+    vp9_frameworker_broadcast(cm->buffer_pool, pbi->cur_buf, INT_MAX);
+    vpx_clear_system_state();
+    return -1;
+  }
+
+  cm->error.setjmp = 1;
+  vp9_decode_frame_tiles(pbi, data, data_end, p_data_end);
+  vp9_frameworker_broadcast(cm->buffer_pool, pbi->cur_buf, INT_MAX);
+
+  vpx_clear_system_state();
+  cm->error.setjmp = 0;
+  return 0;
+}
+
+void vp9_retire_frame(VP9Decoder *pbi, int decode_failed) {
+  VP9_COMMON *const cm = &pbi->common;
+  BufferPool *const pool = cm->buffer_pool;
+  RefCntBuffer *const frame_bufs = pool->frame_bufs;
+
+  if (decode_failed) {
+    pbi->ready_for_new_data = 1;
+    release_fb_on_decoder_exit(pbi);
+    // Release current frame.
+    decrease_ref_count(cm->new_fb_idx, frame_bufs, pool);
+  } else {
+    swap_frame_buffers(pbi);
+    if (cm->show_frame) cm->cur_show_frame_fb_idx = cm->new_fb_idx;
+
+    // Release the frame if it is neither a reference nor held for output.
+    if (frame_bufs[cm->new_fb_idx].ref_count == 0 &&
+        !frame_bufs[cm->new_fb_idx].released) {
+      pool->release_fb_cb(pool->cb_priv,
+                          &frame_bufs[cm->new_fb_idx].raw_frame_buffer);
+      frame_bufs[cm->new_fb_idx].released = 1;
+    }
+  }
+
+  vp9_frameworker_release_context(pbi);
+}
+
 int vp9_get_raw_frame(VP9Decoder *pbi, YV12_BUFFER_CONFIG *sd,
                       vp9_ppflags_t *flags) {
   VP9_COMMON *const cm = &pbi->common;
@@ -510,7 +878,11 @@ int vp9_get_raw_frame(VP9Decoder *pbi, YV12_BUFFER_CONFIG *sd,
 
 #if CONFIG_VP9_POSTPROC
   if (!cm->show_existing_frame) {
-    ret = vp9_post_proc_frame(cm, sd, flags, cm->width);
+    const int64_t start = pbi->collect_stats ? vpx_nsec_time() : 0;
+    // The decoder threads are idle between the frames.
+    ret = vp9_post_proc_frame_mt(cm, sd, flags, cm->width, pbi->tile_workers,
+                                 pbi->num_tile_workers);
+    vp9_add_decode_time(pbi, VPX_DECODE_STAGE_POSTPROC, start);
   } else {
     *sd = *cm->frame_to_show;
     ret = 0;
@@ -523,6 +895,50 @@ int vp9_get_raw_frame(VP9Decoder *pbi, YV12_BUFFER_CONFIG *sd,
   return ret;
 }
 
+vpx_codec_err_t vp9_set_decode_stats(VP9Decoder *pbi, int enable) {
+  if (enable) {
+    if (pbi->stats == NULL) {
+      pbi->stats = (vpx_decode_stats *)vpx_malloc(sizeof(*pbi->stats));
+      if (pbi->stats == NULL) return VPX_CODEC_MEM_ERROR;
+    }
+    memset(pbi->stats, 0, sizeof(*pbi->stats));
+  }
+  pbi->collect_stats = enable;
+  return VPX_CODEC_OK;
+}
+
+void vp9_add_decode_times(VP9Decoder *pbi, int thread, int tile,
+                          int64_t times[VPX_DECODE_STAGES]) {
+  vpx_decode_stats *const stats = pbi->stats;
+  int i;
+
+  thread = VPXMIN(thread, VPX_DECODE_STATS_MAX_THREADS - 1);
+  assert(tile < VPX_DECODE_STATS_MAX_TILES);
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(&pbi->stats_mutex);
+#endif
+  stats->num_threads = VPXMAX(stats->num_threads, thread + 1);
+  if (tile >= 0) stats->num_tiles = VPXMAX(stats->num_tiles, tile + 1);
+  for (i = 0; i < VPX_DECODE_STAGES; ++i) {
+    stats->time[i] += times[i];
+    stats->thread_time[thread][i] += times[i];
+    if (tile >= 0) stats->tile_time[tile][i] += times[i];
+  }
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(&pbi->stats_mutex);
+#endif
+  memset(times, 0, VPX_DECODE_STAGES * sizeof(*times));
+}
+
+void vp9_add_decode_time(VP9Decoder *pbi, vpx_decode_stage stage,
+                         int64_t start) {
+  if (pbi->collect_stats) {
+    int64_t times[VPX_DECODE_STAGES] = { 0 };
+    times[stage] = vpx_nsec_time() - start;
+    vp9_add_decode_times(pbi, 0, -1, times);
+  }
+}
+
 vpx_codec_err_t vp9_parse_superframe_index(const uint8_t *data, size_t data_sz,
                                            uint32_t sizes[8], int *count,
                                            vpx_decrypt_cb decrypt_cb,
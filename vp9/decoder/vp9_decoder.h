@@ -37,6 +37,8 @@ typedef struct ThreadData {
   struct VP9Decoder *pbi;
   LFWorkerData *lf_data;
   VP9LfSync *lf_sync;
+  int thread_id;  // index of the job queue of the worker
+  int64_t idle_time;  // job queue idle time when the frame started
 } ThreadData;
 
 typedef struct TileBuffer {
@@ -57,6 +59,13 @@ typedef struct TileWorkerData {
   DECLARE_ALIGNED(16, tran_low_t, dqcoeff[32 * 32]);
   DECLARE_ALIGNED(16, uint16_t, extend_and_predict_buf[80 * 2 * 80 * 2]);
   struct vpx_internal_error_info error_info;
+  // Set when the superblock being decoded is away from the decode region.
+  int parse_only;
+  // With the stats collected, the time of each stage of the blocks decoded
+  // since the times were added to the stats, and the end of the last stage.
+  int timing;
+  int64_t stage_time[VPX_DECODE_STAGES];
+  int64_t stage_end;
 } TileWorkerData;
 
 typedef void (*process_block_fn_t)(TileWorkerData *twd,
@@ -72,6 +81,7 @@ typedef struct RowMTWorkerData {
   int8_t *recon_map;
   const uint8_t *data_end;
   uint8_t *jobq_buf;
+  JobQueueWorker *jobq_queues;
   JobQueueRowMt jobq;
   size_t jobq_size;
   int num_tiles_done;
@@ -91,6 +101,12 @@ typedef struct Job {
   JobType job_type;
 } Job;
 
+// Called with the frame being decoded when its luma rows [start, end), and the
+// chroma rows next to them, will no longer change. Each frame is announced by
+// a call with start == end == 0, made before its tiles are decoded.
+typedef void (*vp9_put_rows_cb)(void *priv, const YV12_BUFFER_CONFIG *buf,
+                                int start, int end);
+
 typedef struct VP9Decoder {
   DECLARE_ALIGNED(16, MACROBLOCKD, mb);
 
@@ -113,9 +129,29 @@ typedef struct VP9Decoder {
 
   VP9LfSync lf_row_sync;
 
+  // With a single thread the loop filter runs one superblock behind the
+  // reconstruction. lf_line keeps the last pixel row of the superblock rows
+  // as it was before filtering, for the intra prediction of the next row.
+  uint8_t *lf_line;
+  size_t lf_line_size;
+
   vpx_decrypt_cb decrypt_cb;
   void *decrypt_state;
 
+  // Rows of the shown frames are reported in order, possibly from the
+  // decoder threads, with rows_put rows of the current frame done so far.
+  vp9_put_rows_cb put_rows_cb;
+  void *put_rows_priv;
+  int rows_put;
+
+  // Region of the frames to reconstruct, in pixels, or the whole frames if
+  // region_w or region_h is 0. The superblocks of the current frame within
+  // [region_mi_row_start, region_mi_row_end) and [region_mi_col_start,
+  // region_mi_col_end) are reconstructed, the others are only parsed.
+  int region_x, region_y, region_w, region_h;
+  int region_mi_row_start, region_mi_row_end;
+  int region_mi_col_start, region_mi_col_end;
+
   int max_threads;
   int inv_tile_order;
   int need_resync;   // wait for key/intra-only frame.
@@ -123,15 +159,60 @@ typedef struct VP9Decoder {
 
   int row_mt;
   int lpf_mt_opt;
+  int fused_lf;  // loop filter each superblock right after the next one
+  // Superblocks ahead of the reconstruction to prefetch the reference blocks
+  // of in row based multi-threaded decode, 0 if off.
+  int mc_prefetch;
+  // Shared pool running the hooks of the workers, NULL if they own threads.
+  VPxWorkerPool *thread_pool;
   RowMTWorkerData *row_mt_worker_data;
+
+  // Times of the decoding stages, added up while collect_stats is set.
+  int collect_stats;
+  vpx_decode_stats *stats;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t stats_mutex;
+#endif
+
+  // Frame parallel decode only: the buffer owning cm->last_frame_seg_map and
+  // the buffers held on behalf of the frame by vp9_frameworker_copy_context().
+  RefCntBuffer *seg_map_buf;
+  RefCntBuffer *held_bufs[2];
 } VP9Decoder;
 
 int vp9_receive_compressed_data(struct VP9Decoder *pbi, size_t size,
                                 const uint8_t **psource);
 
+// Frame parallel decode splits vp9_receive_compressed_data() in three steps.
+// The headers are read on the calling thread, which sets *psource to the
+// start of the tile data. The tiles are then decoded by a frame worker, which
+// sets *p_data_end to the end of the frame, and the reference buffers are
+// updated when the frame is retired in decode order, on the calling thread
+// again.
+int vp9_receive_frame_headers(struct VP9Decoder *pbi, size_t size,
+                              const uint8_t **psource);
+int vp9_receive_frame_tiles(struct VP9Decoder *pbi, const uint8_t *data,
+                            const uint8_t *data_end,
+                            const uint8_t **p_data_end);
+void vp9_retire_frame(struct VP9Decoder *pbi, int decode_failed);
+
 int vp9_get_raw_frame(struct VP9Decoder *pbi, YV12_BUFFER_CONFIG *sd,
                       vp9_ppflags_t *flags);
 
+// Starts collecting the times of the decoding stages in pbi->stats, from 0,
+// or stops if 'enable' is 0. The stats are kept until the decoder is removed.
+vpx_codec_err_t vp9_set_decode_stats(struct VP9Decoder *pbi, int enable);
+
+// Adds 'times' to the stats of 'thread' and, if not negative, of 'tile', then
+// clears 'times'. Can be called from any thread.
+void vp9_add_decode_times(struct VP9Decoder *pbi, int thread, int tile,
+                          int64_t times[VPX_DECODE_STAGES]);
+
+// Adds the time since 'start', from vpx_nsec_time(), to 'stage' of thread 0
+// if the stats are collected.
+void vp9_add_decode_time(struct VP9Decoder *pbi, vpx_decode_stage stage,
+                         int64_t start);
+
 vpx_codec_err_t vp9_copy_reference_dec(struct VP9Decoder *pbi,
                                        VP9_REFFRAME ref_frame_flag,
                                        YV12_BUFFER_CONFIG *sd);
@@ -140,6 +221,56 @@ vpx_codec_err_t vp9_set_reference_dec(VP9_COMMON *cm,
                                       VP9_REFFRAME ref_frame_flag,
                                       YV12_BUFFER_CONFIG *sd);
 
+// Copy of the decoder state between two frames. The reference frames are
+// stored once each, ref_buf[] giving the one of each slot of ref_frame_map,
+// and the motion vectors and segment ids of the previous frame are kept for
+// the prediction of the next one. The allocations are reused when the
+// checkpoint is saved again.
+typedef struct VP9DecoderCheckpoint {
+  YV12_BUFFER_CONFIG bufs[REF_FRAMES];
+  int num_bufs;
+  int ref_buf[REF_FRAMES];
+  int prev_buf;  // index in bufs of the previous frame, -1 if not a reference
+
+  MV_REF *prev_mvs;
+  uint8_t *seg_map;
+  int mi_alloc_size;  // of prev_mvs and seg_map
+
+  FRAME_CONTEXT fc;
+  FRAME_CONTEXT frame_contexts[FRAME_CONTEXTS];
+  struct segmentation seg;
+  uint8_t mode_ref_delta_enabled;
+  signed char ref_deltas[MAX_REF_LF_DELTAS];
+  signed char mode_deltas[MAX_MODE_LF_DELTAS];
+
+  int width, height;
+  int last_width, last_height;
+  int render_width, render_height;
+  int subsampling_x, subsampling_y;
+#if CONFIG_VP9_HIGHBITDEPTH
+  int use_highbitdepth;
+#endif
+  vpx_bit_depth_t bit_depth;
+  vpx_color_space_t color_space;
+  vpx_color_range_t color_range;
+  FRAME_TYPE frame_type;
+  uint8_t intra_only;
+  int last_show_frame;
+  unsigned int current_video_frame;
+  int current_frame_coding_index;
+  int need_resync;
+} VP9DecoderCheckpoint;
+
+// Saves the state of the decoder after the last decoded frame in 'cp', or
+// restores it from 'cp', so that decoding goes on as it did after that frame.
+// Not supported in frame parallel decode. vp9_free_checkpoint() frees the
+// buffers of 'cp' and 'cp' itself, allocated with vpx_calloc().
+vpx_codec_err_t vp9_save_checkpoint(struct VP9Decoder *pbi,
+                                    VP9DecoderCheckpoint *cp);
+vpx_codec_err_t vp9_restore_checkpoint(struct VP9Decoder *pbi,
+                                       const VP9DecoderCheckpoint *cp);
+void vp9_free_checkpoint(VP9DecoderCheckpoint *cp);
+
 static INLINE uint8_t read_marker(vpx_decrypt_cb decrypt_cb,
                                   void *decrypt_state, const uint8_t *data) {
   if (decrypt_cb) {
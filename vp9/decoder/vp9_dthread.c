@@ -0,0 +1,114 @@
+/*
+ *  Copyright (c) 2026 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string.h>
+
+#include "./vpx_config.h"
+#include "vp9/common/vp9_onyxc_int.h"
+#include "vp9/decoder/vp9_decoder.h"
+#include "vp9/decoder/vp9_dthread.h"
+
+void vp9_frameworker_wait(BufferPool *const pool, RefCntBuffer *const ref_buf,
+                          int row) {
+#if CONFIG_MULTITHREAD
+  if (vpx_atomic_load_acquire(&ref_buf->row) >= row) return;
+
+  pthread_mutex_lock(&pool->pool_mutex);
+  while (vpx_atomic_load_acquire(&ref_buf->row) < row)
+    pthread_cond_wait(&pool->pool_cond, &pool->pool_mutex);
+  pthread_mutex_unlock(&pool->pool_mutex);
+#else
+  (void)pool;
+  (void)ref_buf;
+  (void)row;
+#endif  // CONFIG_MULTITHREAD
+}
+
+void vp9_frameworker_broadcast(BufferPool *const pool, RefCntBuffer *const buf,
+                               int row) {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(&pool->pool_mutex);
+  vpx_atomic_store_release(&buf->row, row);
+  pthread_cond_broadcast(&pool->pool_cond);
+  pthread_mutex_unlock(&pool->pool_mutex);
+#else
+  (void)pool;
+  (void)buf;
+  (void)row;
+#endif  // CONFIG_MULTITHREAD
+}
+
+static void hold_buffer(RefCntBuffer **const slot, RefCntBuffer *const buf) {
+  *slot = buf;
+  if (buf != NULL) ++buf->ref_count;
+}
+
+void vp9_frameworker_copy_context(VP9Decoder *const dst,
+                                  const VP9Decoder *const src) {
+  VP9_COMMON *const cm = &dst->common;
+  const VP9_COMMON *const src_cm = &src->common;
+  // Showing an existing frame does not change the decoder state, which then
+  // comes from the frame before it.
+  const int show_existing = src_cm->show_existing_frame;
+
+  memcpy(cm->ref_frame_map,
+         show_existing ? src_cm->ref_frame_map : src_cm->next_ref_frame_map,
+         sizeof(cm->ref_frame_map));
+  memcpy(cm->frame_contexts, src_cm->frame_contexts,
+         FRAME_CONTEXTS * sizeof(*cm->frame_contexts));
+
+  cm->last_show_frame =
+      show_existing ? src_cm->last_show_frame : src_cm->show_frame;
+  cm->last_width = show_existing ? src_cm->last_width : src_cm->width;
+  cm->last_height = show_existing ? src_cm->last_height : src_cm->height;
+  cm->frame_type = src_cm->frame_type;
+  cm->intra_only = src_cm->intra_only;
+  cm->current_video_frame =
+      src_cm->current_video_frame + (src_cm->show_frame ? 1 : 0);
+
+  cm->bit_depth = src_cm->bit_depth;
+#if CONFIG_VP9_HIGHBITDEPTH
+  cm->use_highbitdepth = src_cm->use_highbitdepth;
+#endif
+  cm->subsampling_x = src_cm->subsampling_x;
+  cm->subsampling_y = src_cm->subsampling_y;
+  cm->color_space = src_cm->color_space;
+  cm->color_range = src_cm->color_range;
+
+  memcpy(cm->lf.ref_deltas, src_cm->lf.ref_deltas, sizeof(cm->lf.ref_deltas));
+  memcpy(cm->lf.mode_deltas, src_cm->lf.mode_deltas,
+         sizeof(cm->lf.mode_deltas));
+  cm->seg = src_cm->seg;
+  dst->need_resync = src->need_resync;
+
+  // The motion vectors and the segmentation map of earlier frames are read
+  // from their frame buffers, which must not be reused until this frame is
+  // retired.
+  hold_buffer(&dst->held_bufs[0],
+              show_existing ? src_cm->prev_frame : src_cm->cur_frame);
+  hold_buffer(&dst->held_bufs[1], (!show_existing && src_cm->seg.enabled)
+                                      ? src_cm->cur_frame
+                                      : src->seg_map_buf);
+  cm->prev_frame = dst->held_bufs[0];
+  dst->seg_map_buf = dst->held_bufs[1];
+}
+
+void vp9_frameworker_release_context(VP9Decoder *const pbi) {
+  BufferPool *const pool = pbi->common.buffer_pool;
+  int i;
+
+  for (i = 0; i < 2; ++i) {
+    if (pbi->held_bufs[i] != NULL) {
+      decrease_ref_count((int)(pbi->held_bufs[i] - pool->frame_bufs),
+                         pool->frame_bufs, pool);
+      pbi->held_bufs[i] = NULL;
+    }
+  }
+}
@@ -0,0 +1,71 @@
+/*
+ *  Copyright (c) 2026 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef VPX_VP9_DECODER_VP9_DTHREAD_H_
+#define VPX_VP9_DECODER_VP9_DTHREAD_H_
+
+#include "./vpx_config.h"
+#include "vpx_util/vpx_thread.h"
+#include "vp9/common/vp9_onyxc_int.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct VP9Decoder;
+
+// Maximum number of frames decoded at the same time. Every frame in flight
+// holds a frame buffer, so this is bounded by FRAME_BUFFERS.
+#define MAX_FRAME_WORKERS 4
+
+// Frame worker data, one per frame in flight.
+typedef struct FrameWorkerData {
+  struct VP9Decoder *pbi;
+  const uint8_t *data;
+  const uint8_t *data_end;
+  // The end of the frame, set once its tiles are decoded.
+  const uint8_t *frame_end;
+  void *user_priv;
+  int result;
+
+  // The frame is the last one of its packet and is to be output.
+  int output_frame;
+  // The frame is waiting to be retired.
+  int frame_in_flight;
+
+  // Copy of the compressed frame. The buffer passed to vpx_codec_decode()
+  // is not valid anymore once the call returns.
+  uint8_t *scratch_buffer;
+  size_t scratch_buffer_size;
+} FrameWorkerData;
+
+// Waits until the first 'row' luma pixel rows of 'ref_buf' are decoded.
+void vp9_frameworker_wait(BufferPool *const pool, RefCntBuffer *const ref_buf,
+                          int row);
+
+// Marks the first 'row' luma pixel rows of 'buf' as decoded and wakes up the
+// frame workers waiting on it.
+void vp9_frameworker_broadcast(BufferPool *const pool, RefCntBuffer *const buf,
+                               int row);
+
+// Sets up the decoder state of 'dst' for the frame following the one whose
+// headers were read by 'src'. The buffers 'dst' inherits from 'src' are held
+// until vp9_frameworker_release_context() is called.
+void vp9_frameworker_copy_context(struct VP9Decoder *const dst,
+                                  const struct VP9Decoder *const src);
+
+// Releases the buffers held by vp9_frameworker_copy_context().
+void vp9_frameworker_release_context(struct VP9Decoder *const pbi);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // VPX_VP9_DECODER_VP9_DTHREAD_H_
@@ -12,28 +12,72 @@
 #include <string.h>
 
 #include "vpx/vpx_integer.h"
+#include "vpx_ports/vpx_timer.h"
 
 #include "vp9/decoder/vp9_job_queue.h"
 
-void vp9_jobq_init(JobQueueRowMt *jobq, uint8_t *buf, size_t buf_size) {
+// Number of times an idle worker looks for a job before going to sleep.
+#define JOBQ_SPIN_COUNT 64
+
+#if CONFIG_MULTITHREAD
+static INLINE int load_index(const JobQueueIndex *index) {
+  return vpx_atomic_load_acquire(index);
+}
+
+static INLINE void store_index(JobQueueIndex *index, int value) {
+  vpx_atomic_store_release(index, value);
+}
+
+static INLINE int exchange_index(JobQueueIndex *index, int expected,
+                                 int desired) {
+  return vpx_atomic_compare_exchange(index, expected, desired);
+}
+#else
+static INLINE int load_index(const JobQueueIndex *index) { return *index; }
+
+static INLINE void store_index(JobQueueIndex *index, int value) {
+  *index = value;
+}
+
+static INLINE int exchange_index(JobQueueIndex *index, int expected,
+                                 int desired) {
+  if (*index != expected) return 0;
+  *index = desired;
+  return 1;
+}
+#endif  // CONFIG_MULTITHREAD
+
+void vp9_jobq_init(JobQueueRowMt *jobq, JobQueueWorker *queues, int num_queues,
+                   uint8_t *buf, size_t buf_size) {
+  const int queue_size = (int)(buf_size / num_queues);
+  int i;
 #if CONFIG_MULTITHREAD
   pthread_mutex_init(&jobq->mutex, NULL);
   pthread_cond_init(&jobq->cond, NULL);
 #endif
-  jobq->buf_base = buf;
-  jobq->buf_wr = buf;
-  jobq->buf_rd = buf;
-  jobq->buf_end = buf + buf_size;
-  jobq->terminate = 0;
+  assert(num_queues > 0);
+  jobq->queues = queues;
+  jobq->num_queues = num_queues;
+  for (i = 0; i < num_queues; ++i) {
+    JobQueueWorker *const queue = &queues[i];
+    queue->buf_base = buf + i * queue_size;
+    queue->buf_size = queue_size;
+    memset(&queue->stats, 0, sizeof(queue->stats));
+  }
+  store_index(&jobq->num_idle, 0);
+  vp9_jobq_reset(jobq);
 }
 
 void vp9_jobq_reset(JobQueueRowMt *jobq) {
+  int i;
 #if CONFIG_MULTITHREAD
   pthread_mutex_lock(&jobq->mutex);
 #endif
-  jobq->buf_wr = jobq->buf_base;
-  jobq->buf_rd = jobq->buf_base;
-  jobq->terminate = 0;
+  for (i = 0; i < jobq->num_queues; ++i) {
+    store_index(&jobq->queues[i].rd, 0);
+    store_index(&jobq->queues[i].wr, 0);
+  }
+  store_index(&jobq->terminate, 0);
 #if CONFIG_MULTITHREAD
   pthread_mutex_unlock(&jobq->mutex);
 #endif
@@ -51,74 +95,140 @@ void vp9_jobq_terminate(JobQueueRowMt *jobq) {
 #if CONFIG_MULTITHREAD
   pthread_mutex_lock(&jobq->mutex);
 #endif
-  jobq->terminate = 1;
+  store_index(&jobq->terminate, 1);
 #if CONFIG_MULTITHREAD
   pthread_cond_broadcast(&jobq->cond);
   pthread_mutex_unlock(&jobq->mutex);
 #endif
 }
 
-int vp9_jobq_queue(JobQueueRowMt *jobq, void *job, size_t job_size) {
-  int ret = 0;
-#if CONFIG_MULTITHREAD
-  pthread_mutex_lock(&jobq->mutex);
-#endif
-  if (jobq->buf_end >= jobq->buf_wr + job_size) {
-    memcpy(jobq->buf_wr, job, job_size);
-    jobq->buf_wr = jobq->buf_wr + job_size;
-#if CONFIG_MULTITHREAD
-    pthread_cond_signal(&jobq->cond);
-#endif
-    ret = 0;
-  } else {
+int vp9_jobq_queue(JobQueueRowMt *jobq, int worker, void *job,
+                   size_t job_size) {
+  JobQueueWorker *const queue = &jobq->queues[worker];
+  const int wr = load_index(&queue->wr);
+
+  if (wr + (int)job_size > queue->buf_size) {
     /* Wrap around case is not supported */
     assert(0);
-    ret = 1;
+    return 1;
   }
+
+  memcpy(queue->buf_base + wr, job, job_size);
 #if CONFIG_MULTITHREAD
-  pthread_mutex_unlock(&jobq->mutex);
+  // The full barrier orders the update of wr before the read of num_idle,
+  // which a worker going to sleep updates before looking at wr.
+  vpx_atomic_fetch_add(&queue->wr, (int)job_size);
+  if (vpx_atomic_load_acquire(&jobq->num_idle) > 0) {
+    pthread_mutex_lock(&jobq->mutex);
+    pthread_cond_signal(&jobq->cond);
+    pthread_mutex_unlock(&jobq->mutex);
+  }
+#else
+  store_index(&queue->wr, wr + (int)job_size);
 #endif
-  return ret;
+  return 0;
+}
+
+// Takes the oldest job of 'queue'. Returns 0 if it is empty.
+static int take_job(JobQueueWorker *const queue, void *job, size_t job_size,
+                    JobQueueStats *const stats) {
+  while (1) {
+    const int rd = load_index(&queue->rd);
+    if (rd + (int)job_size > load_index(&queue->wr)) return 0;
+    if (exchange_index(&queue->rd, rd, rd + (int)job_size)) {
+      memcpy(job, queue->buf_base + rd, job_size);
+      return 1;
+    }
+    ++stats->num_contentions;
+  }
+}
+
+static int find_job(JobQueueRowMt *jobq, int worker, void *job,
+                    size_t job_size) {
+  JobQueueStats *const stats = &jobq->queues[worker].stats;
+  int i;
+
+  if (take_job(&jobq->queues[worker], job, job_size, stats)) return 1;
+
+  for (i = 1; i < jobq->num_queues; ++i) {
+    const int victim = (worker + i) % jobq->num_queues;
+    if (take_job(&jobq->queues[victim], job, job_size, stats)) {
+      ++stats->num_steals;
+      return 1;
+    }
+  }
+  return 0;
 }
 
-int vp9_jobq_dequeue(JobQueueRowMt *jobq, void *job, size_t job_size,
-                     int blocking) {
-  int ret = 0;
 #if CONFIG_MULTITHREAD
-  pthread_mutex_lock(&jobq->mutex);
-#endif
-  if (jobq->buf_end >= jobq->buf_rd + job_size) {
-    while (1) {
-      if (jobq->buf_wr >= jobq->buf_rd + job_size) {
-        memcpy(job, jobq->buf_rd, job_size);
-        jobq->buf_rd = jobq->buf_rd + job_size;
-        ret = 0;
-        break;
-      } else {
-        /* If all the entries have been dequeued, then break and return */
-        if (jobq->terminate == 1) {
-          ret = 1;
-          break;
-        }
-        if (blocking == 1) {
+static int has_job(const JobQueueRowMt *jobq) {
+  int i;
+  for (i = 0; i < jobq->num_queues; ++i) {
+    const JobQueueWorker *const queue = &jobq->queues[i];
+    if (load_index(&queue->rd) < load_index(&queue->wr)) return 1;
+  }
+  return 0;
+}
+#endif  // CONFIG_MULTITHREAD
+
+int vp9_jobq_dequeue(JobQueueRowMt *jobq, int worker, void *job,
+                     size_t job_size, int blocking) {
+  JobQueueStats *const stats = &jobq->queues[worker].stats;
+  int64_t start;
+  int spin_count = 0;
+  int ret;
+
+  if (find_job(jobq, worker, job, job_size)) return 0;
+  /* If there is no job available,
+   * and this is non blocking call then return fail */
+  if (!blocking) return 1;
+
+  start = vpx_nsec_time();
+  while (1) {
+    // All the jobs are queued before the queue is terminated, so read the
+    // flag before looking for a job.
+    const int terminate = load_index(&jobq->terminate);
+    if (find_job(jobq, worker, job, job_size)) {
+      ret = 0;
+      break;
+    }
+    /* If all the entries have been dequeued, then break and return */
+    if (terminate) {
+      ret = 1;
+      break;
+    }
 #if CONFIG_MULTITHREAD
-          pthread_cond_wait(&jobq->cond, &jobq->mutex);
-#endif
-        } else {
-          /* If there is no job available,
-           * and this is non blocking call then return fail */
-          ret = 1;
-          break;
-        }
-      }
+    if (++spin_count < JOBQ_SPIN_COUNT) continue;
+
+    pthread_mutex_lock(&jobq->mutex);
+    vpx_atomic_fetch_add(&jobq->num_idle, 1);
+    while (!has_job(jobq) && !load_index(&jobq->terminate)) {
+      ++stats->num_waits;
+      pthread_cond_wait(&jobq->cond, &jobq->mutex);
     }
-  } else {
-    /* Wrap around case is not supported */
+    vpx_atomic_fetch_add(&jobq->num_idle, -1);
+    pthread_mutex_unlock(&jobq->mutex);
+    spin_count = 0;
+#else
+    // Nothing else can queue a job.
+    (void)spin_count;
     ret = 1;
+    break;
+#endif  // CONFIG_MULTITHREAD
   }
-#if CONFIG_MULTITHREAD
-  pthread_mutex_unlock(&jobq->mutex);
-#endif
+  stats->idle_time += vpx_nsec_time() - start;
 
   return ret;
 }
+
+void vp9_jobq_get_stats(const JobQueueRowMt *jobq, JobQueueStats *stats) {
+  int i;
+  memset(stats, 0, sizeof(*stats));
+  for (i = 0; i < jobq->num_queues; ++i) {
+    const JobQueueStats *const queue_stats = &jobq->queues[i].stats;
+    stats->idle_time += queue_stats->idle_time;
+    stats->num_waits += queue_stats->num_waits;
+    stats->num_steals += queue_stats->num_steals;
+    stats->num_contentions += queue_stats->num_contentions;
+  }
+}
@@ -11,22 +11,62 @@
 #ifndef VPX_VP9_DECODER_VP9_JOB_QUEUE_H_
 #define VPX_VP9_DECODER_VP9_JOB_QUEUE_H_
 
+#include "vpx/vpx_integer.h"
+#include "vpx_util/vpx_atomics.h"
 #include "vpx_util/vpx_thread.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if CONFIG_MULTITHREAD
+typedef vpx_atomic_int JobQueueIndex;
+#else
+typedef int JobQueueIndex;
+#endif
+
+typedef struct {
+  // Time spent waiting for a job, in nanoseconds
+  int64_t idle_time;
+
+  // Number of times the worker went to sleep waiting for a job
+  int num_waits;
+
+  // Number of jobs taken from the queue of another worker
+  int num_steals;
+
+  // Number of attempts to take a job lost to another worker
+  int num_contentions;
+} JobQueueStats;
+
+// Jobs queued by one worker. Only the owner adds jobs, any worker can take
+// them, oldest first. The buffer is not reused before vp9_jobq_reset() so the
+// jobs never move once queued.
 typedef struct {
   // Pointer to buffer base which contains the jobs
   uint8_t *buf_base;
 
-  // Pointer to current address where new job can be added
-  uint8_t *volatile buf_wr;
+  // Size of the job buffer in bytes
+  int buf_size;
 
-  // Pointer to current address from where next job can be obtained
-  uint8_t *volatile buf_rd;
+  // Offset from where next job can be obtained
+  JobQueueIndex rd;
 
-  // Pointer to end of job buffer
-  uint8_t *buf_end;
+  // Offset where new job can be added
+  JobQueueIndex wr;
 
-  int terminate;
+  // Only updated by the owner of the queue
+  JobQueueStats stats;
+} JobQueueWorker;
+
+typedef struct {
+  JobQueueWorker *queues;
+  int num_queues;
+
+  JobQueueIndex terminate;
+
+  // Number of workers sleeping on cond
+  JobQueueIndex num_idle;
 
 #if CONFIG_MULTITHREAD
   pthread_mutex_t mutex;
@@ -34,12 +74,30 @@ typedef struct {
 #endif
 } JobQueueRowMt;
 
-void vp9_jobq_init(JobQueueRowMt *jobq, uint8_t *buf, size_t buf_size);
+// Sets up one queue per worker in 'queues', splitting 'buf' evenly between
+// them.
+void vp9_jobq_init(JobQueueRowMt *jobq, JobQueueWorker *queues, int num_queues,
+                   uint8_t *buf, size_t buf_size);
 void vp9_jobq_reset(JobQueueRowMt *jobq);
 void vp9_jobq_deinit(JobQueueRowMt *jobq);
 void vp9_jobq_terminate(JobQueueRowMt *jobq);
-int vp9_jobq_queue(JobQueueRowMt *jobq, void *job, size_t job_size);
-int vp9_jobq_dequeue(JobQueueRowMt *jobq, void *job, size_t job_size,
-                     int blocking);
+
+// Adds a job to the queue of 'worker'. The calls for a given worker must not
+// overlap.
+int vp9_jobq_queue(JobQueueRowMt *jobq, int worker, void *job,
+                   size_t job_size);
+
+// Takes a job from the queue of 'worker' or, if it is empty, from the queue
+// of another worker. With 'blocking' set, waits for a job until the queue is
+// terminated. Returns 0 when a job was dequeued.
+int vp9_jobq_dequeue(JobQueueRowMt *jobq, int worker, void *job,
+                     size_t job_size, int blocking);
+
+// Sums the statistics of all the workers since vp9_jobq_init().
+void vp9_jobq_get_stats(const JobQueueRowMt *jobq, JobQueueStats *stats);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
 
 #endif  // VPX_VP9_DECODER_VP9_JOB_QUEUE_H_
@@ -943,11 +943,12 @@ static int encode_tile_worker(void *arg1, void *arg2) {
   VP9_COMP *cpi = (VP9_COMP *)arg1;
   VP9BitstreamWorkerData *data = (VP9BitstreamWorkerData *)arg2;
   MACROBLOCKD *const xd = &data->xd;
-  const int tile_row = 0;
+  const int tile_cols = 1 << cpi->common.log2_tile_cols;
+  const int tile_idx = data->tile_row * tile_cols + data->tile_col;
   vpx_start_encode(&data->bit_writer, data->dest);
-  write_modes(cpi, xd, &cpi->tile_data[data->tile_idx].tile_info,
-              &data->bit_writer, tile_row, data->tile_idx,
-              &data->max_mv_magnitude, data->interp_filter_selected);
+  write_modes(cpi, xd, &cpi->tile_data[tile_idx].tile_info, &data->bit_writer,
+              data->tile_row, data->tile_col, &data->max_mv_magnitude,
+              data->interp_filter_selected);
   vpx_stop_encode(&data->bit_writer);
   return 1;
 }
@@ -980,21 +981,19 @@ static int encode_tiles_buffer_alloc(VP9_COMP *const cpi) {
   return 0;
 }
 
-static size_t encode_tiles_mt(VP9_COMP *cpi, uint8_t *data_ptr) {
+// Packs the tiles of one tile row in parallel. The tiles of a column depend on
+// the partition context left by the tile above them, so the tile rows are
+// packed one after the other and each one is written out before the next.
+static size_t encode_tile_row_mt(VP9_COMP *cpi, uint8_t *data_ptr,
+                                 int tile_row) {
   const VPxWorkerInterface *const winterface = vpx_get_worker_interface();
   VP9_COMMON *const cm = &cpi->common;
   const int tile_cols = 1 << cm->log2_tile_cols;
+  const int last_tile_row = tile_row == (1 << cm->log2_tile_rows) - 1;
   const int num_workers = cpi->num_workers;
   size_t total_size = 0;
   int tile_col = 0;
 
-  if (!cpi->vp9_bitstream_worker_data ||
-      cpi->vp9_bitstream_worker_data[1].dest_size >
-          (cpi->oxcf.width * cpi->oxcf.height)) {
-    vp9_bitstream_encode_tiles_buffer_dealloc(cpi);
-    if (encode_tiles_buffer_alloc(cpi)) return 0;
-  }
-
   while (tile_col < tile_cols) {
     int i, j;
     for (i = 0; i < num_workers && tile_col < tile_cols; ++i) {
@@ -1003,7 +1002,8 @@ static size_t encode_tiles_mt(VP9_COMP *cpi, uint8_t *data_ptr) {
 
       // Populate the worker data.
       data->xd = cpi->td.mb.e_mbd;
-      data->tile_idx = tile_col;
+      data->tile_row = tile_row;
+      data->tile_col = tile_col;
       data->max_mv_magnitude = cpi->max_mv_magnitude;
       memset(data->interp_filter_selected, 0,
              sizeof(data->interp_filter_selected[0][0]) * SWITCHABLE);
@@ -1013,7 +1013,8 @@ static size_t encode_tiles_mt(VP9_COMP *cpi, uint8_t *data_ptr) {
         // If this worker happens to be for the last tile, then do not offset it
         // by 4 for the tile size.
         data->dest =
-            data_ptr + total_size + (tile_col == tile_cols - 1 ? 0 : 4);
+            data_ptr + total_size +
+            (last_tile_row && tile_col == tile_cols - 1 ? 0 : 4);
       }
       worker->data1 = cpi;
       worker->data2 = data;
@@ -1045,7 +1046,7 @@ static size_t encode_tiles_mt(VP9_COMP *cpi, uint8_t *data_ptr) {
       }
 
       // Prefix the size of the tile on all but the last.
-      if (tile_col != tile_cols || j < i - 1) {
+      if (!last_tile_row || tile_col != tile_cols || j < i - 1) {
         mem_put_be32(data_ptr + total_size, tile_size);
         total_size += 4;
       }
@@ -1058,6 +1059,28 @@ static size_t encode_tiles_mt(VP9_COMP *cpi, uint8_t *data_ptr) {
   return total_size;
 }
 
+static size_t encode_tiles_mt(VP9_COMP *cpi, uint8_t *data_ptr) {
+  const VP9_COMMON *const cm = &cpi->common;
+  const int tile_rows = 1 << cm->log2_tile_rows;
+  size_t total_size = 0;
+  int tile_row;
+
+  if (!cpi->vp9_bitstream_worker_data ||
+      cpi->vp9_bitstream_worker_data[1].dest_size >
+          (cpi->oxcf.width * cpi->oxcf.height)) {
+    vp9_bitstream_encode_tiles_buffer_dealloc(cpi);
+    if (encode_tiles_buffer_alloc(cpi)) return 0;
+  }
+
+  for (tile_row = 0; tile_row < tile_rows; ++tile_row) {
+    const size_t tile_row_size =
+        encode_tile_row_mt(cpi, data_ptr + total_size, tile_row);
+    if (tile_row_size == 0) return 0;
+    total_size += tile_row_size;
+  }
+  return total_size;
+}
+
 static size_t encode_tiles(VP9_COMP *cpi, uint8_t *data_ptr) {
   VP9_COMMON *const cm = &cpi->common;
   MACROBLOCKD *const xd = &cpi->td.mb.e_mbd;
@@ -1073,8 +1096,7 @@ static size_t encode_tiles(VP9_COMP *cpi, uint8_t *data_ptr) {
   // Encoding tiles in parallel is done only for realtime mode now. In other
   // modes the speed up is insignificant and requires further testing to ensure
   // that it does not make the overall process worse in any case.
-  if (cpi->oxcf.mode == REALTIME && cpi->num_workers > 1 && tile_rows == 1 &&
-      tile_cols > 1) {
+  if (cpi->oxcf.mode == REALTIME && cpi->num_workers > 1 && tile_cols > 1) {
     return encode_tiles_mt(cpi, data_ptr);
   }
 
@@ -21,7 +21,8 @@ typedef struct VP9BitstreamWorkerData {
   uint8_t *dest;
   int dest_size;
   vpx_writer bit_writer;
-  int tile_idx;
+  int tile_row;
+  int tile_col;
   unsigned int max_mv_magnitude;
   // The size of interp_filter_selected in VP9_COMP is actually
   // MAX_REFERENCE_FRAMES x SWITCHABLE. But when encoding tiles, all we ever do
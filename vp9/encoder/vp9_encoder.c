@@ -1035,6 +1035,12 @@ static void dealloc_compressor_data(VP9_COMP *cpi) {
   vp9_free_context_buffers(cm);
 
   vpx_free_frame_buffer(&cpi->last_frame_uf);
+  for (i = 0; i < LPF_SEARCH_LEVELS; ++i) {
+    vpx_free_frame_buffer(&cpi->lpf_search[i].frame);
+    vpx_free(cpi->lpf_search[i].lfm);
+    cpi->lpf_search[i].lfm = NULL;
+    cpi->lpf_search[i].lfm_size = 0;
+  }
   vpx_free_frame_buffer(&cpi->scaled_source);
   vpx_free_frame_buffer(&cpi->scaled_last_source);
   vpx_free_frame_buffer(&cpi->alt_ref_buffer);
@@ -6085,12 +6091,6 @@ static void update_level_info(VP9_COMP *cpi, size_t *size, int arf_src_index) {
   }
 }
 
-typedef struct GF_PICTURE {
-  YV12_BUFFER_CONFIG *frame;
-  int ref_frame[3];
-  FRAME_UPDATE_TYPE update_type;
-} GF_PICTURE;
-
 static void init_gop_frames(VP9_COMP *cpi, GF_PICTURE *gf_picture,
                             const GF_GROUP *gf_group, int *tpl_group_frames) {
   VP9_COMMON *cm = &cpi->common;
@@ -6566,7 +6566,7 @@ static void set_mv_limits(const VP9_COMMON *cm, MACROBLOCK *x, int mi_row,
       ((cm->mi_cols - 1 - mi_col) * MI_SIZE) + (17 - 2 * VP9_INTERP_EXTEND);
 }
 
-static void mode_estimation(VP9_COMP *cpi, MACROBLOCK *x, MACROBLOCKD *xd,
+static void mode_estimation(VP9_COMP *cpi, ThreadData *td,
                             struct scale_factors *sf, GF_PICTURE *gf_picture,
                             int frame_idx, TplDepFrame *tpl_frame,
                             int16_t *src_diff, tran_low_t *coeff,
@@ -6575,7 +6575,8 @@ static void mode_estimation(VP9_COMP *cpi, MACROBLOCK *x, MACROBLOCKD *xd,
                             YV12_BUFFER_CONFIG *ref_frame[], uint8_t *predictor,
                             int64_t *recon_error, int64_t *sse) {
   VP9_COMMON *cm = &cpi->common;
-  ThreadData *td = &cpi->td;
+  MACROBLOCK *const x = &td->mb;
+  MACROBLOCKD *const xd = &x->e_mbd;
 
   const int bw = 4 << b_width_log2_lookup[bsize];
   const int bh = 4 << b_height_log2_lookup[bsize];
@@ -7127,19 +7128,16 @@ static void build_motion_field(
 }
 #endif  // CONFIG_NON_GREEDY_MV
 
-static void mc_flow_dispenser(VP9_COMP *cpi, GF_PICTURE *gf_picture,
-                              int frame_idx, BLOCK_SIZE bsize) {
-  TplDepFrame *tpl_frame = &cpi->tpl_stats[frame_idx];
-  YV12_BUFFER_CONFIG *this_frame = gf_picture[frame_idx].frame;
-  YV12_BUFFER_CONFIG *ref_frame[MAX_INTER_REF_FRAMES] = { NULL, NULL, NULL };
-
-  VP9_COMMON *cm = &cpi->common;
-  struct scale_factors sf;
-  int rdmult, idx;
-  ThreadData *td = &cpi->td;
-  MACROBLOCK *x = &td->mb;
-  MACROBLOCKD *xd = &x->e_mbd;
-  int mi_row, mi_col;
+void vp9_mc_flow_dispenser_row(VP9_COMP *cpi, ThreadData *td,
+                               TplFlowData *flow, int mi_row,
+                               int mi_col_start, int mi_col_end) {
+  TplDepFrame *tpl_frame = &cpi->tpl_stats[flow->frame_idx];
+  const BLOCK_SIZE bsize = flow->bsize;
+  MACROBLOCKD *xd = &td->mb.e_mbd;
+  MODE_INFO **const mi = xd->mi;
+  MODE_INFO mi_buf;
+  MODE_INFO *mi_ptr = &mi_buf;
+  int mi_col;
 
 #if CONFIG_VP9_HIGHBITDEPTH
   DECLARE_ALIGNED(16, uint16_t, predictor16[32 * 32 * 3]);
@@ -7154,28 +7152,57 @@ static void mc_flow_dispenser(VP9_COMP *cpi, GF_PICTURE *gf_picture,
   DECLARE_ALIGNED(16, tran_low_t, dqcoeff[32 * 32]);
 
   const TX_SIZE tx_size = max_txsize_lookup[bsize];
-  const int mi_height = num_8x8_blocks_high_lookup[bsize];
   const int mi_width = num_8x8_blocks_wide_lookup[bsize];
   int64_t recon_error, sse;
-#if CONFIG_NON_GREEDY_MV
-  int square_block_idx;
-  int rf_idx;
-#endif
 
-  // Setup scaling factor
 #if CONFIG_VP9_HIGHBITDEPTH
-  vp9_setup_scale_factors_for_frame(
-      &sf, this_frame->y_crop_width, this_frame->y_crop_height,
-      this_frame->y_crop_width, this_frame->y_crop_height,
-      cpi->common.use_highbitdepth);
-
   if (xd->cur_buf->flags & YV12_FLAG_HIGHBITDEPTH)
     predictor = CONVERT_TO_BYTEPTR(predictor16);
   else
     predictor = predictor8;
+#endif  // CONFIG_VP9_HIGHBITDEPTH
+
+  // mode_estimation() writes the mode of the block it tries, give each thread
+  // its own.
+  vp9_zero(mi_buf);
+  xd->mi = &mi_ptr;
+
+  for (mi_col = mi_col_start; mi_col < mi_col_end; mi_col += mi_width) {
+    mode_estimation(cpi, td, &flow->sf, flow->gf_picture, flow->frame_idx,
+                    tpl_frame, src_diff, coeff, qcoeff, dqcoeff, mi_row, mi_col,
+                    bsize, tx_size, flow->ref_frame, predictor, &recon_error,
+                    &sse);
+    tpl_model_store(tpl_frame->tpl_stats_ptr, mi_row, mi_col, bsize,
+                    tpl_frame->stride);
+  }
+
+  xd->mi = mi;
+}
+
+static void setup_tpl_flow(VP9_COMP *cpi, TplFlowData *flow,
+                           GF_PICTURE *gf_picture, int frame_idx,
+                           BLOCK_SIZE bsize) {
+  TplDepFrame *tpl_frame = &cpi->tpl_stats[frame_idx];
+  YV12_BUFFER_CONFIG *this_frame = gf_picture[frame_idx].frame;
+  YV12_BUFFER_CONFIG **ref_frame = flow->ref_frame;
+
+  VP9_COMMON *cm = &cpi->common;
+  int rdmult, idx;
+  MACROBLOCKD *xd = &cpi->td.mb.e_mbd;
+
+  flow->gf_picture = gf_picture;
+  flow->frame_idx = frame_idx;
+  flow->bsize = bsize;
+
+  // Setup scaling factor
+#if CONFIG_VP9_HIGHBITDEPTH
+  vp9_setup_scale_factors_for_frame(
+      &flow->sf, this_frame->y_crop_width, this_frame->y_crop_height,
+      this_frame->y_crop_width, this_frame->y_crop_height,
+      cpi->common.use_highbitdepth);
 #else
   vp9_setup_scale_factors_for_frame(
-      &sf, this_frame->y_crop_width, this_frame->y_crop_height,
+      &flow->sf, this_frame->y_crop_width, this_frame->y_crop_height,
       this_frame->y_crop_width, this_frame->y_crop_height);
 #endif  // CONFIG_VP9_HIGHBITDEPTH
 
@@ -7183,6 +7210,7 @@ static void mc_flow_dispenser(VP9_COMP *cpi, GF_PICTURE *gf_picture,
   // unavailable, the pointer will be set to Null.
   for (idx = 0; idx < MAX_INTER_REF_FRAMES; ++idx) {
     int rf_idx = gf_picture[frame_idx].ref_frame[idx];
+    ref_frame[idx] = NULL;
     if (rf_idx != -1) ref_frame[idx] = gf_picture[rf_idx].frame;
   }
 
@@ -7199,6 +7227,53 @@ static void mc_flow_dispenser(VP9_COMP *cpi, GF_PICTURE *gf_picture,
 
   cm->base_qindex = tpl_frame->base_qindex;
   vp9_frame_init_quantizer(cpi);
+}
+
+void vp9_mc_flow_dispenser_init_td(VP9_COMP *cpi, ThreadData *td,
+                                   TplFlowData *flow) {
+  const VP9_COMMON *const cm = &cpi->common;
+  MACROBLOCK *const x = &td->mb;
+
+  x->e_mbd.cur_buf = flow->gf_picture[flow->frame_idx].frame;
+  vp9_init_plane_quantizers_qindex(cpi, x, cm->mi->segment_id,
+                                   cpi->tpl_stats[flow->frame_idx].base_qindex);
+}
+
+// Motion flow dependency dispenser. The propagation into the reference frames
+// stays in raster order, so the stats do not depend on the threads.
+static void tpl_model_propagate(VP9_COMP *cpi, TplFlowData *flow) {
+  const VP9_COMMON *const cm = &cpi->common;
+  TplDepFrame *tpl_frame = &cpi->tpl_stats[flow->frame_idx];
+  const int mi_height = num_8x8_blocks_high_lookup[flow->bsize];
+  const int mi_width = num_8x8_blocks_wide_lookup[flow->bsize];
+  int mi_row, mi_col;
+
+  for (mi_row = 0; mi_row < cm->mi_rows; mi_row += mi_height) {
+    for (mi_col = 0; mi_col < cm->mi_cols; mi_col += mi_width) {
+      tpl_model_update(cpi->tpl_stats, tpl_frame->tpl_stats_ptr, mi_row, mi_col,
+                       flow->bsize);
+    }
+  }
+}
+
+static void mc_flow_dispenser(VP9_COMP *cpi, GF_PICTURE *gf_picture,
+                              int frame_idx, BLOCK_SIZE bsize) {
+  TplFlowData flow_data;
+  TplFlowData *const flow = &flow_data;
+  VP9_COMMON *cm = &cpi->common;
+  ThreadData *td = &cpi->td;
+  int mi_row;
+
+  const int mi_height = num_8x8_blocks_high_lookup[bsize];
+#if CONFIG_NON_GREEDY_MV
+  TplDepFrame *tpl_frame = &cpi->tpl_stats[frame_idx];
+  YV12_BUFFER_CONFIG **ref_frame = flow->ref_frame;
+  MACROBLOCK *x = &td->mb;
+  int square_block_idx;
+  int rf_idx;
+#endif
+
+  setup_tpl_flow(cpi, flow, gf_picture, frame_idx, bsize);
 
 #if CONFIG_NON_GREEDY_MV
   for (square_block_idx = 0; square_block_idx < SQUARE_BLOCK_SIZES;
@@ -7217,18 +7292,48 @@ static void mc_flow_dispenser(VP9_COMP *cpi, GF_PICTURE *gf_picture,
   }
 #endif
 
-  for (mi_row = 0; mi_row < cm->mi_rows; mi_row += mi_height) {
-    for (mi_col = 0; mi_col < cm->mi_cols; mi_col += mi_width) {
-      mode_estimation(cpi, x, xd, &sf, gf_picture, frame_idx, tpl_frame,
-                      src_diff, coeff, qcoeff, dqcoeff, mi_row, mi_col, bsize,
-                      tx_size, ref_frame, predictor, &recon_error, &sse);
-      // Motion flow dependency dispenser.
-      tpl_model_store(tpl_frame->tpl_stats_ptr, mi_row, mi_col, bsize,
-                      tpl_frame->stride);
+  // The blocks of a frame are estimated independently of each other.
+  if (cpi->oxcf.max_threads > 1) {
+    vp9_mc_flow_dispenser_frames_mt(cpi, flow, 1);
+  } else {
+    for (mi_row = 0; mi_row < cm->mi_rows; mi_row += mi_height)
+      vp9_mc_flow_dispenser_row(cpi, td, flow, mi_row, 0, cm->mi_cols);
+  }
 
-      tpl_model_update(cpi->tpl_stats, tpl_frame->tpl_stats_ptr, mi_row, mi_col,
-                       bsize);
+  tpl_model_propagate(cpi, flow);
+}
+
+// Estimates the frames of the group at the same time. A frame only needs the
+// mc_flow it gets from the frames that reference it once its own stats are
+// propagated, so that is left to a serial pass afterwards.
+static void mc_flow_dispenser_frames(VP9_COMP *cpi, GF_PICTURE *gf_picture,
+                                     int tpl_group_frames, BLOCK_SIZE bsize) {
+  const VP9_COMMON *const cm = &cpi->common;
+  TplFlowData flows[MAX_ARF_GOP_SIZE];
+  const int mi_height = num_8x8_blocks_high_lookup[bsize];
+  const int mi_width = num_8x8_blocks_wide_lookup[bsize];
+  int num_frames = 0;
+  int frame_idx, i, mi_row, mi_col;
+
+  for (frame_idx = tpl_group_frames - 1; frame_idx > 0; --frame_idx) {
+    if (gf_picture[frame_idx].update_type == USE_BUF_FRAME) continue;
+    setup_tpl_flow(cpi, &flows[num_frames++], gf_picture, frame_idx, bsize);
+  }
+
+  vp9_mc_flow_dispenser_frames_mt(cpi, flows, num_frames);
+
+  for (i = 0; i < num_frames; ++i) {
+    TplDepFrame *tpl_frame = &cpi->tpl_stats[flows[i].frame_idx];
+
+    // Store the blocks again for their mc_dep_cost to include the final
+    // mc_flow.
+    for (mi_row = 0; mi_row < cm->mi_rows; mi_row += mi_height) {
+      for (mi_col = 0; mi_col < cm->mi_cols; mi_col += mi_width) {
+        tpl_model_store(tpl_frame->tpl_stats_ptr, mi_row, mi_col, bsize,
+                        tpl_frame->stride);
+      }
     }
+    tpl_model_propagate(cpi, &flows[i]);
   }
 }
 
@@ -7442,6 +7547,14 @@ static void setup_tpl_stats(VP9_COMP *cpi) {
   const GF_GROUP *gf_group = &cpi->twopass.gf_group;
   int tpl_group_frames = 0;
   int frame_idx;
+#if CONFIG_NON_GREEDY_MV
+  // The motion fields are built one frame at a time.
+  const int frames_mt = 0;
+#else
+  // The stats do not depend on the threads, so all of them are used, with or
+  // without row_mt.
+  const int frames_mt = cpi->oxcf.max_threads > 1;
+#endif  // CONFIG_NON_GREEDY_MV
   cpi->tpl_bsize = BLOCK_32X32;
 
   init_gop_frames(cpi, gf_picture, gf_group, &tpl_group_frames);
@@ -7449,9 +7562,14 @@ static void setup_tpl_stats(VP9_COMP *cpi) {
   init_tpl_stats(cpi);
 
   // Backward propagation from tpl_group_frames to 1.
-  for (frame_idx = tpl_group_frames - 1; frame_idx > 0; --frame_idx) {
-    if (gf_picture[frame_idx].update_type == USE_BUF_FRAME) continue;
-    mc_flow_dispenser(cpi, gf_picture, frame_idx, cpi->tpl_bsize);
+  if (frames_mt) {
+    mc_flow_dispenser_frames(cpi, gf_picture, tpl_group_frames,
+                             cpi->tpl_bsize);
+  } else {
+    for (frame_idx = tpl_group_frames - 1; frame_idx > 0; --frame_idx) {
+      if (gf_picture[frame_idx].update_type == USE_BUF_FRAME) continue;
+      mc_flow_dispenser(cpi, gf_picture, frame_idx, cpi->tpl_bsize);
+    }
   }
 #if CONFIG_NON_GREEDY_MV
   cpi->tpl_ready = 1;
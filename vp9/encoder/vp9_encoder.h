@@ -267,6 +267,8 @@ typedef struct VP9EncoderConfig {
 
   int enable_tpl_model;
 
+  int enable_static_segmentation;
+
   int max_threads;
 
   unsigned int target_level;
@@ -335,6 +337,36 @@ typedef struct TplDepFrame {
 
 #define TPL_DEP_COST_SCALE_LOG2 4
 
+typedef struct GF_PICTURE {
+  YV12_BUFFER_CONFIG *frame;
+  int ref_frame[3];
+  FRAME_UPDATE_TYPE update_type;
+} GF_PICTURE;
+
+// A frame whose TPL stats are being built, shared by the threads that run
+// vp9_mc_flow_dispenser_row() on it.
+typedef struct TplFlowData {
+  GF_PICTURE *gf_picture;
+  int frame_idx;
+  BLOCK_SIZE bsize;
+  YV12_BUFFER_CONFIG *ref_frame[MAX_INTER_REF_FRAMES];
+  struct scale_factors sf;
+} TplFlowData;
+
+// The number of loop filter levels vp9_pick_filter_level() tries at once.
+#define LPF_SEARCH_LEVELS 3
+
+// A loop filter level tried by vp9_pick_filter_level(). It is filtered into a
+// frame and masks of its own so that the levels can be tried on different
+// threads.
+typedef struct LpfSearchLevel {
+  YV12_BUFFER_CONFIG frame;
+  LOOP_FILTER_MASK *lfm;
+  int lfm_size;
+  int filt_level;
+  int64_t err;
+} LpfSearchLevel;
+
 // TODO(jingning) All spatially adaptive variables should go to TileDataEnc.
 typedef struct TileDataEnc {
   TileInfo tile_info;
@@ -739,6 +771,7 @@ typedef struct VP9_COMP {
   double *mi_ssim_rdmult_scaling_factors;
 
   YV12_BUFFER_CONFIG last_frame_uf;
+  LpfSearchLevel lpf_search[LPF_SEARCH_LEVELS];
 
   TOKENEXTRA *tile_tok[4][1 << 6];
   TOKENLIST *tplist[4][1 << 6];
@@ -768,6 +801,7 @@ typedef struct VP9_COMP {
 
   MBGRAPH_FRAME_STATS mbgraph_stats[MAX_LAG_BUFFERS];
   int mbgraph_n_frames;  // number of frames filled in the above
+  MBGRAPH_FRAME_DATA mbgraph_frame_data;
   int static_mb_pct;     // % forced skip mbs by segmentation
   int ref_frame_flags;
 
@@ -925,6 +959,8 @@ typedef struct VP9_COMP {
   // Multi-threading
   int num_workers;
   VPxWorker *workers;
+  // Shared pool running the hooks of the workers, NULL if they own threads.
+  VPxWorkerPool *thread_pool;
   struct EncWorkerData *tile_thr_data;
   VP9LfSync lf_row_sync;
   struct VP9BitstreamWorkerData *vp9_bitstream_worker_data;
@@ -1386,6 +1422,17 @@ void vp9_new_framerate(VP9_COMP *cpi, double framerate);
 
 void vp9_set_row_mt(VP9_COMP *cpi);
 
+// Runs the TPL mode estimation for the blocks of one row of flow->bsize
+// blocks, starting at mi_row.
+void vp9_mc_flow_dispenser_row(VP9_COMP *cpi, ThreadData *td,
+                               TplFlowData *flow, int mi_row,
+                               int mi_col_start, int mi_col_end);
+
+// Points td at the frame of flow, with the quantizer of that frame, so that
+// the threads can estimate the rows of several frames at once.
+void vp9_mc_flow_dispenser_init_td(VP9_COMP *cpi, ThreadData *td,
+                                   TplFlowData *flow);
+
 int vp9_get_psnr(const VP9_COMP *cpi, PSNR_STATS *psnr);
 
 #define LAYER_IDS_TO_IDX(sl, tl, num_tl) ((sl) * (num_tl) + (tl))
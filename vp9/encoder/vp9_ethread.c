@@ -41,16 +41,16 @@ static int enc_worker_hook(void *arg1, void *unused) {
   const VP9_COMMON *const cm = &cpi->common;
   const int tile_cols = 1 << cm->log2_tile_cols;
   const int tile_rows = 1 << cm->log2_tile_rows;
-  int t;
+  int tile_row, tile_col;
 
   (void)unused;
 
-  for (t = thread_data->start; t < tile_rows * tile_cols;
-       t += cpi->num_workers) {
-    int tile_row = t / tile_cols;
-    int tile_col = t % tile_cols;
-
-    vp9_encode_tile(cpi, thread_data->td, tile_row, tile_col);
+  // A tile continues from the tile above it, so each thread encodes whole
+  // tile columns from the top.
+  for (tile_col = thread_data->start; tile_col < tile_cols;
+       tile_col += cpi->num_workers) {
+    for (tile_row = 0; tile_row < tile_rows; ++tile_row)
+      vp9_encode_tile(cpi, thread_data->td, tile_row, tile_col);
   }
 
   return 0;
@@ -104,6 +104,7 @@ static void create_enc_workers(VP9_COMP *cpi, int num_workers) {
 
       ++cpi->num_workers;
       winterface->init(worker);
+      worker->pool = cpi->thread_pool;
 
       if (i < allocated_workers - 1) {
         thread_data->cpi = cpi;
@@ -558,8 +559,139 @@ void vp9_temporal_filter_row_mt(VP9_COMP *cpi) {
   launch_enc_workers(cpi, temporal_filter_worker_hook, multi_thread_ctxt,
                      num_workers);
 }
+
+static int mbgraph_worker_hook(void *arg1, void *arg2) {
+  EncWorkerData *const thread_data = (EncWorkerData *)arg1;
+  MultiThreadHandle *multi_thread_ctxt = (MultiThreadHandle *)arg2;
+  VP9_COMP *const cpi = thread_data->cpi;
+  int end_of_frame;
+  int thread_id = thread_data->thread_id;
+  int cur_tile_id = multi_thread_ctxt->thread_id_to_tile_id[thread_id];
+  JobNode *proc_job = NULL;
+
+  end_of_frame = 0;
+  while (0 == end_of_frame) {
+    // Get the next job in the queue
+    proc_job =
+        (JobNode *)vp9_enc_grp_get_next_job(multi_thread_ctxt, cur_tile_id);
+    if (NULL == proc_job) {
+      // The rows are all in the job queue of tile 0.
+      end_of_frame = vp9_get_tiles_proc_status(
+          multi_thread_ctxt, thread_data->tile_completion_status, &cur_tile_id,
+          1);
+    } else {
+      vp9_update_mbgraph_mb_row_stats(cpi, thread_data->td,
+                                      &cpi->tile_data[0].row_mt_sync,
+                                      proc_job->vert_unit_row_num);
+    }
+  }
+  return 0;
+}
+
+void vp9_update_mbgraph_frame_stats_mt(VP9_COMP *cpi) {
+  VP9_COMMON *const cm = &cpi->common;
+  const int tile_cols = 1 << cm->log2_tile_cols;
+  const int tile_rows = 1 << cm->log2_tile_rows;
+  MultiThreadHandle *multi_thread_ctxt = &cpi->multi_thread_ctxt;
+  int num_workers = VPXMAX(cpi->oxcf.max_threads, 1);
+  int i;
+
+  if (multi_thread_ctxt->allocated_tile_cols < tile_cols ||
+      multi_thread_ctxt->allocated_tile_rows < tile_rows ||
+      multi_thread_ctxt->allocated_vert_unit_rows < cm->mb_rows) {
+    vp9_row_mt_mem_dealloc(cpi);
+    vp9_init_tile_data(cpi);
+    vp9_row_mt_mem_alloc(cpi);
+  } else {
+    vp9_init_tile_data(cpi);
+  }
+
+  create_enc_workers(cpi, num_workers);
+  // Without row_mt the tile encode may have created fewer workers already.
+  num_workers = cpi->num_workers;
+
+  vp9_assign_tile_to_thread(multi_thread_ctxt, 1, num_workers);
+
+  vp9_prepare_job_queue(cpi, MBGRAPH_JOB);
+
+  // Initialize cur_col to -1 for all rows.
+  memset(cpi->tile_data[0].row_mt_sync.cur_col, -1,
+         sizeof(*cpi->tile_data[0].row_mt_sync.cur_col) * cm->mb_rows);
+
+  for (i = 0; i < num_workers; i++) {
+    EncWorkerData *thread_data;
+    thread_data = &cpi->tile_thr_data[i];
+
+    // Before searching a frame, copy the thread data from cpi.
+    if (thread_data->td != &cpi->td) {
+      thread_data->td->mb = cpi->td.mb;
+    }
+  }
+
+  launch_enc_workers(cpi, mbgraph_worker_hook, multi_thread_ctxt, num_workers);
+}
 #endif  // !CONFIG_REALTIME_ONLY
 
+typedef struct TplFramesMT {
+  TplFlowData *flows;
+  int num_frames;
+  int num_workers;
+} TplFramesMT;
+
+// The rows of all the frames are handed out in turn, the frame of a thread
+// changes every few rows.
+static int tpl_frames_worker_hook(void *arg1, void *arg2) {
+  EncWorkerData *const thread_data = (EncWorkerData *)arg1;
+  const TplFramesMT *const frames_mt = (const TplFramesMT *)arg2;
+  VP9_COMP *const cpi = thread_data->cpi;
+  const VP9_COMMON *const cm = &cpi->common;
+  const int mi_height = num_8x8_blocks_high_lookup[frames_mt->flows[0].bsize];
+  const int rows = (cm->mi_rows + mi_height - 1) / mi_height;
+  const int total_jobs = frames_mt->num_frames * rows;
+  TplFlowData *cur_flow = NULL;
+  int job;
+
+  for (job = thread_data->start; job < total_jobs;
+       job += frames_mt->num_workers) {
+    TplFlowData *const flow = &frames_mt->flows[job / rows];
+    if (flow != cur_flow) {
+      vp9_mc_flow_dispenser_init_td(cpi, thread_data->td, flow);
+      cur_flow = flow;
+    }
+    vp9_mc_flow_dispenser_row(cpi, thread_data->td, flow,
+                              (job % rows) * mi_height, 0, cm->mi_cols);
+  }
+  return 0;
+}
+
+void vp9_mc_flow_dispenser_frames_mt(VP9_COMP *cpi, TplFlowData *flows,
+                                     int num_frames) {
+  TplFramesMT frames_mt;
+  int num_workers, i;
+
+  if (num_frames == 0) return;
+
+  create_enc_workers(cpi, VPXMAX(cpi->oxcf.max_threads, 1));
+  // Without row_mt the tile encode may have created fewer workers already.
+  num_workers = cpi->num_workers;
+
+  frames_mt.flows = flows;
+  frames_mt.num_frames = num_frames;
+  frames_mt.num_workers = num_workers;
+
+  for (i = 0; i < num_workers; i++) {
+    EncWorkerData *thread_data;
+    thread_data = &cpi->tile_thr_data[i];
+
+    // Before building the model, copy the thread data from cpi.
+    if (thread_data->td != &cpi->td) {
+      thread_data->td->mb = cpi->td.mb;
+    }
+  }
+
+  launch_enc_workers(cpi, tpl_frames_worker_hook, &frames_mt, num_workers);
+}
+
 static int enc_row_mt_worker_hook(void *arg1, void *arg2) {
   EncWorkerData *const thread_data = (EncWorkerData *)arg1;
   MultiThreadHandle *multi_thread_ctxt = (MultiThreadHandle *)arg2;
@@ -21,6 +21,7 @@ extern "C" {
 
 struct VP9_COMP;
 struct ThreadData;
+struct TplFlowData;
 
 typedef struct EncWorkerData {
   struct VP9_COMP *cpi;
@@ -65,6 +66,12 @@ void vp9_row_mt_sync_mem_dealloc(VP9RowMTSync *row_mt_sync);
 
 void vp9_temporal_filter_row_mt(struct VP9_COMP *cpi);
 
+void vp9_mc_flow_dispenser_frames_mt(struct VP9_COMP *cpi,
+                                     struct TplFlowData *flows,
+                                     int num_frames);
+
+void vp9_update_mbgraph_frame_stats_mt(struct VP9_COMP *cpi);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -29,10 +29,28 @@ typedef struct {
   MBGRAPH_MB_STATS *mb_stats;
 } MBGRAPH_FRAME_STATS;
 
+// The frame vp9_update_mbgraph_stats() searches, shared by the threads that
+// run vp9_update_mbgraph_mb_row_stats().
+typedef struct {
+  MBGRAPH_FRAME_STATS *stats;
+  struct yv12_buffer_config *buf;
+  struct yv12_buffer_config *golden_ref;
+  struct yv12_buffer_config *alt_ref;
+} MBGRAPH_FRAME_DATA;
+
 struct VP9_COMP;
+struct ThreadData;
+struct VP9RowMTSyncData;
 
 void vp9_update_mbgraph_stats(struct VP9_COMP *cpi);
 
+// Searches a row of macroblocks of cpi->mbgraph_frame_data. A row starts once
+// the first block of the row above is done.
+void vp9_update_mbgraph_mb_row_stats(struct VP9_COMP *cpi,
+                                     struct ThreadData *td,
+                                     struct VP9RowMTSyncData *row_mt_sync,
+                                     int mb_row);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -230,7 +230,9 @@ void vp9_prepare_job_queue(VP9_COMP *cpi, JOB_TYPE job_type) {
   VP9_COMMON *const cm = &cpi->common;
   MultiThreadHandle *multi_thread_ctxt = &cpi->multi_thread_ctxt;
   JobQueue *job_queue = multi_thread_ctxt->job_queue;
-  const int tile_cols = 1 << cm->log2_tile_cols;
+  // The mbgraph search carries motion vectors along whole rows, so its rows
+  // are not split into tiles.
+  const int tile_cols = job_type == MBGRAPH_JOB ? 1 : 1 << cm->log2_tile_cols;
   int job_row_num, jobs_per_tile, jobs_per_tile_col = 0, total_jobs;
   const int sb_rows = mi_cols_aligned_to_sb(cm->mi_rows) >> MI_BLOCK_SIZE_LOG2;
   int tile_col, i;
@@ -241,6 +243,7 @@ void vp9_prepare_job_queue(VP9_COMP *cpi, JOB_TYPE job_type) {
     case ARNR_JOB:
       jobs_per_tile_col = ((cm->mi_rows + TF_ROUND) >> TF_SHIFT);
       break;
+    case MBGRAPH_JOB: jobs_per_tile_col = cm->mb_rows; break;
     default: assert(0);
   }
 
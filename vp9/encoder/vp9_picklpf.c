@@ -19,8 +19,11 @@
 #include "vp9/common/vp9_loopfilter.h"
 #include "vp9/common/vp9_onyxc_int.h"
 #include "vp9/common/vp9_quant_common.h"
+#include "vp9/common/vp9_reconinter.h"
+#include "vp9/common/vp9_thread_common.h"
 
 #include "vp9/encoder/vp9_encoder.h"
+#include "vp9/encoder/vp9_ethread.h"
 #include "vp9/encoder/vp9_picklpf.h"
 #include "vp9/encoder/vp9_quantize.h"
 
@@ -75,8 +78,252 @@ static int64_t try_filter_frame(const YV12_BUFFER_CONFIG *sd,
   return filt_err;
 }
 
+// In LPF_PICK_FROM_SAMPLED_ROWS one superblock row in LPF_SAMPLE_ROW_STEP is
+// filtered and measured.
+#define LPF_SAMPLE_ROW_STEP 4
+
+// Gets the superblock rows a level is tried on, from start to stop in steps of
+// step mi rows.
+static void get_search_rows(const VP9_COMMON *cm, LPF_PICK_METHOD method,
+                            int *start, int *stop, int *step) {
+  const int sb_rows = mi_cols_aligned_to_sb(cm->mi_rows) >> MI_BLOCK_SIZE_LOG2;
+  *start = 0;
+  *stop = cm->mi_rows;
+  *step = MI_BLOCK_SIZE;
+  if (method == LPF_PICK_FROM_SUBIMAGE && cm->mi_rows > 8) {
+    *start = (cm->mi_rows >> 1) & 0xfffffff8;
+    *stop = VPXMIN(*start + VPXMAX(cm->mi_rows / 8, 8), cm->mi_rows);
+  } else if (method == LPF_PICK_FROM_SAMPLED_ROWS &&
+             sb_rows >= LPF_SAMPLE_ROW_STEP) {
+    *start = (LPF_SAMPLE_ROW_STEP / 2) * MI_BLOCK_SIZE;
+    *step = LPF_SAMPLE_ROW_STEP * MI_BLOCK_SIZE;
+  }
+}
+
+static LOOP_FILTER_MASK *get_search_lfm(const VP9_COMMON *cm,
+                                        const LpfSearchLevel *level,
+                                        int mi_row, int mi_col) {
+  return &level->lfm[(mi_col >> 3) + (mi_row >> 3) * cm->lf.lfm_stride];
+}
+
+static void alloc_search_level(VP9_COMP *cpi, LpfSearchLevel *level) {
+  VP9_COMMON *const cm = &cpi->common;
+  const int lfm_size =
+      ((cm->mi_rows + (MI_BLOCK_SIZE - 1)) >> 3) * cm->lf.lfm_stride;
+
+  if (vpx_realloc_frame_buffer(&level->frame, cm->width, cm->height,
+                               cm->subsampling_x, cm->subsampling_y,
+#if CONFIG_VP9_HIGHBITDEPTH
+                               cm->use_highbitdepth,
+#endif
+                               VP9_ENC_BORDER_IN_PIXELS, cm->byte_alignment,
+                               NULL, NULL, NULL))
+    vpx_internal_error(&cm->error, VPX_CODEC_MEM_ERROR,
+                       "Failed to allocate loop filter search buffer");
+
+  if (level->lfm_size < lfm_size) {
+    vpx_free(level->lfm);
+    level->lfm_size = 0;
+    CHECK_MEM_ERROR(cm, level->lfm,
+                    vpx_calloc(lfm_size, sizeof(*level->lfm)));
+    level->lfm_size = lfm_size;
+  }
+}
+
+// Builds the masks of a level. The masks depend on cm->lf_info, so this is
+// done on the main thread one level at a time.
+static void build_search_masks(VP9_COMP *cpi, LpfSearchLevel *level,
+                               LPF_PICK_METHOD method) {
+  VP9_COMMON *const cm = &cpi->common;
+  int start, stop, step, mi_row, mi_col;
+
+  if (!level->filt_level) return;
+
+  get_search_rows(cm, method, &start, &stop, &step);
+  vp9_loop_filter_frame_init(cm, level->filt_level);
+
+  for (mi_row = start; mi_row < stop; mi_row += step) {
+    MODE_INFO **mi = cm->mi_grid_visible + mi_row * cm->mi_stride;
+    for (mi_col = 0; mi_col < cm->mi_cols; mi_col += MI_BLOCK_SIZE) {
+      vp9_setup_mask(cm, mi_row, mi_col, mi + mi_col, cm->mi_stride,
+                     get_search_lfm(cm, level, mi_row, mi_col));
+    }
+  }
+}
+
+// Copies the luma rows from start to stop.
+static void copy_y_rows(const YV12_BUFFER_CONFIG *src, YV12_BUFFER_CONFIG *dst,
+                        int start, int stop) {
+  int row;
+#if CONFIG_VP9_HIGHBITDEPTH
+  if (src->flags & YV12_FLAG_HIGHBITDEPTH) {
+    const uint16_t *src16 = CONVERT_TO_SHORTPTR(src->y_buffer);
+    uint16_t *dst16 = CONVERT_TO_SHORTPTR(dst->y_buffer);
+    for (row = start; row < stop; ++row) {
+      memcpy(dst16 + row * dst->y_stride, src16 + row * src->y_stride,
+             src->y_width * sizeof(*src16));
+    }
+    return;
+  }
+#endif  // CONFIG_VP9_HIGHBITDEPTH
+  for (row = start; row < stop; ++row) {
+    memcpy(dst->y_buffer + row * dst->y_stride,
+           src->y_buffer + row * src->y_stride, src->y_width);
+  }
+}
+
+static void filter_search_row(VP9_COMMON *cm, LpfSearchLevel *level,
+                              struct macroblockd_plane *planes, int mi_row) {
+  int mi_col;
+  for (mi_col = 0; mi_col < cm->mi_cols; mi_col += MI_BLOCK_SIZE) {
+    LOOP_FILTER_MASK *const lfm = get_search_lfm(cm, level, mi_row, mi_col);
+    vp9_setup_dst_planes(planes, &level->frame, mi_row, mi_col);
+    vp9_adjust_mask(cm, mi_row, mi_col, lfm);
+    vp9_filter_block_plane_ss00(cm, &planes[0], mi_row, lfm);
+  }
+}
+
+static int64_t get_search_sse(const VP9_COMMON *cm,
+                              const YV12_BUFFER_CONFIG *sd,
+                              const YV12_BUFFER_CONFIG *frame, int vstart,
+                              int height) {
+#if CONFIG_VP9_HIGHBITDEPTH
+  if (cm->use_highbitdepth)
+    return vpx_highbd_get_y_sse_part(sd, frame, 0, sd->y_crop_width, vstart,
+                                     height);
+#else
+  (void)cm;
+#endif  // CONFIG_VP9_HIGHBITDEPTH
+  return vpx_get_y_sse_part(sd, frame, 0, sd->y_crop_width, vstart, height);
+}
+
+// Filters the rows of a level from the unfiltered frame and measures them.
+// With sampled rows the error is scaled up to the height of the frame.
+static void try_search_level(VP9_COMP *cpi, const YV12_BUFFER_CONFIG *sd,
+                             LpfSearchLevel *level, LPF_PICK_METHOD method) {
+  VP9_COMMON *const cm = &cpi->common;
+  struct macroblockd_plane planes[MAX_MB_PLANE];
+  int start, stop, step, mi_row;
+
+  memcpy(planes, cpi->td.mb.e_mbd.plane, sizeof(planes));
+  get_search_rows(cm, method, &start, &stop, &step);
+
+  if (step == MI_BLOCK_SIZE) {
+    vpx_yv12_copy_y(&cpi->last_frame_uf, &level->frame);
+    if (level->filt_level) {
+      for (mi_row = start; mi_row < stop; mi_row += step)
+        filter_search_row(cm, level, planes, mi_row);
+    }
+    level->err = get_search_sse(cm, sd, &level->frame, 0, sd->y_crop_height);
+  } else {
+    int64_t err = 0;
+    int rows = 0;
+    for (mi_row = start; mi_row < stop; mi_row += step) {
+      const int y_start = mi_row * MI_SIZE;
+      const int y_stop =
+          VPXMIN((mi_row + MI_BLOCK_SIZE) * MI_SIZE, sd->y_crop_height);
+      // The filter of the top edge reads the 8 rows above it.
+      copy_y_rows(&cpi->last_frame_uf, &level->frame, y_start - 8,
+                  VPXMIN((mi_row + MI_BLOCK_SIZE) * MI_SIZE,
+                         level->frame.y_height));
+      if (level->filt_level) filter_search_row(cm, level, planes, mi_row);
+      err += get_search_sse(cm, sd, &level->frame, y_start, y_stop - y_start);
+      rows += y_stop - y_start;
+    }
+    level->err = err * sd->y_crop_height / rows;
+  }
+}
+
+typedef struct LpfSearchJob {
+  const YV12_BUFFER_CONFIG *sd;
+  LPF_PICK_METHOD method;
+  int num_levels;
+  int num_workers;
+} LpfSearchJob;
+
+static int search_level_worker_hook(void *arg1, void *arg2) {
+  EncWorkerData *const thread_data = (EncWorkerData *)arg1;
+  const LpfSearchJob *const job = (const LpfSearchJob *)arg2;
+  VP9_COMP *const cpi = thread_data->cpi;
+  int i;
+
+  for (i = thread_data->start; i < job->num_levels; i += job->num_workers)
+    try_search_level(cpi, job->sd, &cpi->lpf_search[i], job->method);
+  return 1;
+}
+
+// Tries the levels of cpi->lpf_search at once, each on an encoder thread when
+// there are enough.
+static void try_search_levels(const YV12_BUFFER_CONFIG *sd, VP9_COMP *cpi,
+                              int num_levels, LPF_PICK_METHOD method) {
+  const VPxWorkerInterface *const winterface = vpx_get_worker_interface();
+  LpfSearchJob job;
+  int i;
+
+  for (i = 0; i < num_levels; ++i) {
+    alloc_search_level(cpi, &cpi->lpf_search[i]);
+    build_search_masks(cpi, &cpi->lpf_search[i], method);
+  }
+
+  job.sd = sd;
+  job.method = method;
+  job.num_levels = num_levels;
+  job.num_workers = VPXMIN(cpi->num_workers, num_levels);
+
+  if (job.num_workers <= 1) {
+    for (i = 0; i < num_levels; ++i)
+      try_search_level(cpi, sd, &cpi->lpf_search[i], method);
+    return;
+  }
+
+  for (i = 0; i < job.num_workers; ++i) {
+    VPxWorker *const worker = &cpi->workers[i];
+    EncWorkerData *const thread_data = &cpi->tile_thr_data[i];
+    worker->hook = search_level_worker_hook;
+    worker->data1 = thread_data;
+    worker->data2 = &job;
+    thread_data->start = i;
+
+    if (i == job.num_workers - 1)
+      winterface->execute(worker);
+    else
+      winterface->launch(worker);
+  }
+
+  for (i = 0; i < job.num_workers; ++i) winterface->sync(&cpi->workers[i]);
+}
+
+// Fills in ss_err for the levels that are not known yet. The levels have to be
+// different.
+static void try_filter_levels(const YV12_BUFFER_CONFIG *sd, VP9_COMP *cpi,
+                              const int *levels, int num_levels,
+                              LPF_PICK_METHOD method, int64_t *ss_err) {
+  int todo[LPF_SEARCH_LEVELS];
+  int num_todo = 0;
+  int i;
+
+  assert(num_levels <= LPF_SEARCH_LEVELS);
+  for (i = 0; i < num_levels; ++i) {
+    if (ss_err[levels[i]] < 0) todo[num_todo++] = levels[i];
+  }
+  if (num_todo == 0) return;
+
+  // One level at a time the frame is filtered in place, on all the threads.
+  if (method != LPF_PICK_FROM_SAMPLED_ROWS &&
+      (num_todo == 1 || cpi->num_workers <= 1)) {
+    const int partial_frame = method == LPF_PICK_FROM_SUBIMAGE;
+    for (i = 0; i < num_todo; ++i)
+      ss_err[todo[i]] = try_filter_frame(sd, cpi, todo[i], partial_frame);
+    return;
+  }
+
+  for (i = 0; i < num_todo; ++i) cpi->lpf_search[i].filt_level = todo[i];
+  try_search_levels(sd, cpi, num_todo, method);
+  for (i = 0; i < num_todo; ++i) ss_err[todo[i]] = cpi->lpf_search[i].err;
+}
+
 static int search_filter_level(const YV12_BUFFER_CONFIG *sd, VP9_COMP *cpi,
-                               int partial_frame) {
+                               LPF_PICK_METHOD method) {
   const VP9_COMMON *const cm = &cpi->common;
   const struct loopfilter *const lf = &cm->lf;
   const int min_filter_level = 0;
@@ -99,13 +346,26 @@ static int search_filter_level(const YV12_BUFFER_CONFIG *sd, VP9_COMP *cpi,
   //  Make a copy of the unfiltered / processed recon buffer
   vpx_yv12_copy_y(cm->frame_to_show, &cpi->last_frame_uf);
 
-  best_err = try_filter_frame(sd, cpi, filt_mid, partial_frame);
+  {
+    // The first step tries both neighbors of the start level, so they are
+    // tried along with it.
+    const int filt_low = VPXMAX(filt_mid - filter_step, min_filter_level);
+    const int filt_high = VPXMIN(filt_mid + filter_step, max_filter_level);
+    int levels[3];
+    int num_levels = 0;
+    levels[num_levels++] = filt_mid;
+    if (filt_low != filt_mid) levels[num_levels++] = filt_low;
+    if (filt_high != filt_mid) levels[num_levels++] = filt_high;
+    try_filter_levels(sd, cpi, levels, num_levels, method, ss_err);
+  }
+  best_err = ss_err[filt_mid];
   filt_best = filt_mid;
-  ss_err[filt_mid] = best_err;
 
   while (filter_step > 0) {
     const int filt_high = VPXMIN(filt_mid + filter_step, max_filter_level);
     const int filt_low = VPXMAX(filt_mid - filter_step, min_filter_level);
+    int levels[2];
+    int num_levels = 0;
 
     // Bias against raising loop filter in favor of lowering it.
     int64_t bias = (best_err >> (15 - (filt_mid / 8))) * filter_step;
@@ -116,11 +376,14 @@ static int search_filter_level(const YV12_BUFFER_CONFIG *sd, VP9_COMP *cpi,
     // yx, bias less for large block size
     if (cm->tx_mode != ONLY_4X4) bias >>= 1;
 
+    // Get the error scores of the levels the step may look at.
+    if (filt_direction <= 0 && filt_low != filt_mid)
+      levels[num_levels++] = filt_low;
+    if (filt_direction >= 0 && filt_high != filt_mid)
+      levels[num_levels++] = filt_high;
+    try_filter_levels(sd, cpi, levels, num_levels, method, ss_err);
+
     if (filt_direction <= 0 && filt_low != filt_mid) {
-      // Get Low filter error score
-      if (ss_err[filt_low] < 0) {
-        ss_err[filt_low] = try_filter_frame(sd, cpi, filt_low, partial_frame);
-      }
       // If value is close to the best so far then bias towards a lower loop
       // filter value.
       if ((ss_err[filt_low] - bias) < best_err) {
@@ -133,9 +396,6 @@ static int search_filter_level(const YV12_BUFFER_CONFIG *sd, VP9_COMP *cpi,
 
     // Now look at filt_high
     if (filt_direction >= 0 && filt_high != filt_mid) {
-      if (ss_err[filt_high] < 0) {
-        ss_err[filt_high] = try_filter_frame(sd, cpi, filt_high, partial_frame);
-      }
       // Was it better than the previous best?
       if (ss_err[filt_high] < (best_err - bias)) {
         best_err = ss_err[filt_high];
@@ -197,7 +457,6 @@ void vp9_pick_filter_level(const YV12_BUFFER_CONFIG *sd, VP9_COMP *cpi,
     if (cm->frame_type == KEY_FRAME) filt_guess -= 4;
     lf->filter_level = clamp(filt_guess, min_filter_level, max_filter_level);
   } else {
-    lf->filter_level =
-        search_filter_level(sd, cpi, method == LPF_PICK_FROM_SUBIMAGE);
+    lf->filter_level = search_filter_level(sd, cpi, method);
   }
 }
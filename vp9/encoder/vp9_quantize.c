@@ -277,11 +277,16 @@ void vp9_init_quantizer(VP9_COMP *cpi) {
 }
 
 void vp9_init_plane_quantizers(VP9_COMP *cpi, MACROBLOCK *x) {
+  vp9_init_plane_quantizers_qindex(cpi, x, x->e_mbd.mi[0]->segment_id,
+                                   cpi->common.base_qindex);
+}
+
+void vp9_init_plane_quantizers_qindex(VP9_COMP *cpi, MACROBLOCK *x,
+                                      int segment_id, int base_qindex) {
   const VP9_COMMON *const cm = &cpi->common;
   MACROBLOCKD *const xd = &x->e_mbd;
   QUANTS *const quants = &cpi->quants;
-  const int segment_id = xd->mi[0]->segment_id;
-  const int qindex = vp9_get_qindex(&cm->seg, segment_id, cm->base_qindex);
+  const int qindex = vp9_get_qindex(&cm->seg, segment_id, base_qindex);
   const int rdmult = vp9_compute_rd_mult(cpi, qindex + cm->y_dc_delta_q);
   int i;
 
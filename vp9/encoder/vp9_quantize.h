@@ -47,6 +47,11 @@ void vp9_frame_init_quantizer(struct VP9_COMP *cpi);
 
 void vp9_init_plane_quantizers(struct VP9_COMP *cpi, MACROBLOCK *x);
 
+// Same as vp9_init_plane_quantizers() for the given segment and base qindex
+// rather than the ones of the frame being encoded.
+void vp9_init_plane_quantizers_qindex(struct VP9_COMP *cpi, MACROBLOCK *x,
+                                      int segment_id, int base_qindex);
+
 void vp9_init_quantizer(struct VP9_COMP *cpi);
 
 void vp9_set_quantizer(struct VP9_COMP *cm, int q);
@@ -4040,6 +4040,11 @@ void vp9_rd_pick_inter_mode_sb_seg_skip(VP9_COMP *cpi, TileDataEnc *tile_data,
   MACROBLOCKD *const xd = &x->e_mbd;
   MODE_INFO *const mi = xd->mi[0];
   unsigned char segment_id = mi->segment_id;
+  // The decoder takes the reference frame of the segment when it has one.
+  const MV_REFERENCE_FRAME ref_frame =
+      segfeature_active(&cm->seg, segment_id, SEG_LVL_REF_FRAME)
+          ? get_segdata(&cm->seg, segment_id, SEG_LVL_REF_FRAME)
+          : LAST_FRAME;
   const int comp_pred = 0;
   int i;
   int64_t best_pred_diff[REFERENCE_MODES];
@@ -4065,7 +4070,7 @@ void vp9_rd_pick_inter_mode_sb_seg_skip(VP9_COMP *cpi, TileDataEnc *tile_data,
 
   mi->mode = ZEROMV;
   mi->uv_mode = DC_PRED;
-  mi->ref_frame[0] = LAST_FRAME;
+  mi->ref_frame[0] = ref_frame;
   mi->ref_frame[1] = NONE;
   mi->mv[0].as_int = 0;
   x->skip = 1;
@@ -4101,7 +4106,7 @@ void vp9_rd_pick_inter_mode_sb_seg_skip(VP9_COMP *cpi, TileDataEnc *tile_data,
 
   // Estimate the reference frame signaling cost and add it
   // to the rolling cost variable.
-  rate2 += ref_costs_single[LAST_FRAME];
+  rate2 += ref_costs_single[ref_frame];
   this_rd = RDCOST(x->rdmult, x->rddiv, rate2, distortion2);
 
   rd_cost->rate = rate2;
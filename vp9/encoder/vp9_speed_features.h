@@ -104,6 +104,8 @@ typedef enum {
   LPF_PICK_FROM_FULL_IMAGE,
   // Try a small portion of the image with different values.
   LPF_PICK_FROM_SUBIMAGE,
+  // Try every fourth superblock row of the image with different values.
+  LPF_PICK_FROM_SAMPLED_ROWS,
   // Estimate the level based on quantizer and frame type
   LPF_PICK_FROM_Q,
   // Pick 0 to disable LPF if LPF was enabled last frame
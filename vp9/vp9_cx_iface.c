@@ -39,6 +39,7 @@ typedef struct vp9_extracfg {
   unsigned int tile_columns;
   unsigned int tile_rows;
   unsigned int enable_tpl_model;
+  unsigned int enable_static_segmentation;
   unsigned int arnr_max_frames;
   unsigned int arnr_strength;
   unsigned int min_gf_interval;
@@ -74,6 +75,7 @@ static struct vp9_extracfg default_extra_cfg = {
   6,                     // tile_columns
   0,                     // tile_rows
   1,                     // enable_tpl_model
+  0,                     // enable_static_segmentation
   7,                     // arnr_max_frames
   5,                     // arnr_strength
   0,                     // min_gf_interval; 0 -> default decision
@@ -177,6 +179,7 @@ static vpx_codec_err_t validate_config(vpx_codec_alg_priv_t *ctx,
   RANGE_CHECK_HI(cfg, rc_min_quantizer, cfg->rc_max_quantizer);
   RANGE_CHECK_BOOL(extra_cfg, lossless);
   RANGE_CHECK_BOOL(extra_cfg, frame_parallel_decoding_mode);
+  RANGE_CHECK_BOOL(extra_cfg, enable_static_segmentation);
   RANGE_CHECK(extra_cfg, aq_mode, 0, AQ_MODE_COUNT - 2);
   RANGE_CHECK(extra_cfg, alt_ref_aq, 0, 1);
   RANGE_CHECK(extra_cfg, frame_periodic_boost, 0, 1);
@@ -585,15 +588,9 @@ static vpx_codec_err_t set_encoder_config(
 
   oxcf->enable_tpl_model = extra_cfg->enable_tpl_model;
 
-  // TODO(yunqing): The dependencies between row tiles cause error in multi-
-  // threaded encoding. For now, tile_rows is forced to be 0 in this case.
-  // The further fix can be done by adding synchronizations after a tile row
-  // is encoded. But this will hurt multi-threaded encoder performance. So,
-  // it is recommended to use tile-rows=0 while encoding with threads > 1.
-  if (oxcf->max_threads > 1 && oxcf->tile_columns > 0)
-    oxcf->tile_rows = 0;
-  else
-    oxcf->tile_rows = extra_cfg->tile_rows;
+  oxcf->enable_static_segmentation = extra_cfg->enable_static_segmentation;
+
+  oxcf->tile_rows = extra_cfg->tile_rows;
 
   oxcf->error_resilient_mode = cfg->g_error_resilient;
   oxcf->frame_parallel_decoding_mode = extra_cfg->frame_parallel_decoding_mode;
@@ -764,6 +761,14 @@ static vpx_codec_err_t ctrl_set_tpl_model(vpx_codec_alg_priv_t *ctx,
   return update_extra_cfg(ctx, &extra_cfg);
 }
 
+static vpx_codec_err_t ctrl_set_static_segmentation(vpx_codec_alg_priv_t *ctx,
+                                                    va_list args) {
+  struct vp9_extracfg extra_cfg = ctx->extra_cfg;
+  extra_cfg.enable_static_segmentation =
+      CAST(VP9E_SET_STATIC_SEGMENTATION, args);
+  return update_extra_cfg(ctx, &extra_cfg);
+}
+
 static vpx_codec_err_t ctrl_set_arnr_max_frames(vpx_codec_alg_priv_t *ctx,
                                                 va_list args) {
   struct vp9_extracfg extra_cfg = ctx->extra_cfg;
@@ -1764,6 +1769,17 @@ static vpx_codec_err_t ctrl_set_external_rate_control(vpx_codec_alg_priv_t *ctx,
   return VPX_CODEC_OK;
 }
 
+static vpx_codec_err_t ctrl_set_thread_pool(vpx_codec_alg_priv_t *ctx,
+                                            va_list args) {
+  VP9_COMP *const cpi = ctx->cpi;
+  vpx_thread_pool_t *const pool = va_arg(args, vpx_thread_pool_t *);
+
+  // The encoder threads are created with the first frame.
+  if (cpi->num_workers > 0) return VPX_CODEC_ERROR;
+  cpi->thread_pool = (VPxWorkerPool *)pool;
+  return VPX_CODEC_OK;
+}
+
 static vpx_codec_ctrl_fn_map_t encoder_ctrl_maps[] = {
   { VP8_COPY_REFERENCE, ctrl_copy_reference },
 
@@ -1817,6 +1833,8 @@ static vpx_codec_ctrl_fn_map_t encoder_ctrl_maps[] = {
   { VP9E_SET_DELTA_Q_UV, ctrl_set_delta_q_uv },
   { VP9E_SET_DISABLE_LOOPFILTER, ctrl_set_disable_loopfilter },
   { VP9E_SET_EXTERNAL_RATE_CONTROL, ctrl_set_external_rate_control },
+  { VP9E_SET_THREAD_POOL, ctrl_set_thread_pool },
+  { VP9E_SET_STATIC_SEGMENTATION, ctrl_set_static_segmentation },
 
   // Getters
   { VP8E_GET_LAST_QUANTIZER, ctrl_get_quantizer },
@@ -2103,6 +2121,7 @@ void vp9_dump_encoder_config(const VP9EncoderConfig *oxcf, FILE *fp) {
   DUMP_STRUCT_VALUE(fp, oxcf, tile_rows);
 
   DUMP_STRUCT_VALUE(fp, oxcf, enable_tpl_model);
+  DUMP_STRUCT_VALUE(fp, oxcf, enable_static_segmentation);
 
   DUMP_STRUCT_VALUE(fp, oxcf, max_threads);
 
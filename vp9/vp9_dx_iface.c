@@ -8,6 +8,7 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <assert.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -19,6 +20,7 @@
 #include "vpx/vpx_decoder.h"
 #include "vpx_dsp/bitreader_buffer.h"
 #include "vpx_dsp/vpx_dsp_common.h"
+#include "vpx_mem/vpx_mem.h"
 #include "vpx_util/vpx_thread.h"
 
 #include "vp9/common/vp9_alloccommon.h"
@@ -56,11 +58,47 @@ static vpx_codec_err_t decoder_init(vpx_codec_ctx_t *ctx,
   return VPX_CODEC_OK;
 }
 
+static void destroy_frame_workers(vpx_codec_alg_priv_t *ctx) {
+  const VPxWorkerInterface *const winterface = vpx_get_worker_interface();
+  int i;
+
+  for (i = 0; i < ctx->num_frame_workers; ++i) {
+    VPxWorker *const worker = &ctx->frame_workers[i];
+    FrameWorkerData *const frame_worker_data = (FrameWorkerData *)worker->data1;
+    winterface->end(worker);
+    if (frame_worker_data != NULL) {
+      vp9_decoder_remove(frame_worker_data->pbi);
+      vpx_free(frame_worker_data->scratch_buffer);
+      vpx_free(frame_worker_data);
+    }
+  }
+#if CONFIG_MULTITHREAD
+  pthread_mutex_destroy(&ctx->buffer_pool->pool_mutex);
+  pthread_cond_destroy(&ctx->buffer_pool->pool_cond);
+#endif
+  vpx_free(ctx->frame_workers);
+  ctx->frame_workers = NULL;
+  ctx->num_frame_workers = 0;
+  ctx->pbi = NULL;
+}
+
 static vpx_codec_err_t decoder_destroy(vpx_codec_alg_priv_t *ctx) {
-  if (ctx->pbi != NULL) {
+  int i;
+
+  for (i = 0; i < VP9_MAX_DECODER_CHECKPOINTS; ++i) {
+    if (ctx->checkpoints[i] != NULL) vp9_free_checkpoint(ctx->checkpoints[i]);
+  }
+
+  if (ctx->frame_workers != NULL) {
+    destroy_frame_workers(ctx);
+  } else if (ctx->pbi != NULL) {
     vp9_decoder_remove(ctx->pbi);
   }
 
+  if (ctx->output_fb.data != NULL)
+    ctx->release_ext_fb_cb(ctx->ext_priv, &ctx->output_fb);
+  vpx_free(ctx->output_buf);
+
   if (ctx->buffer_pool) {
     vp9_free_ref_frame_buffers(ctx->buffer_pool);
     vp9_free_internal_frame_buffers(&ctx->buffer_pool->int_frame_buffers);
@@ -171,6 +209,88 @@ static vpx_codec_err_t decoder_peek_si_internal(
   return VPX_CODEC_OK;
 }
 
+static void header_truncated(void *data) { *(int *)data = 1; }
+
+// Reads the uncompressed header of a frame into 'info', up to the frame size.
+static vpx_codec_err_t parse_frame_header(const uint8_t *data, size_t data_sz,
+                                          vpx_frame_header_info *info,
+                                          vpx_decrypt_cb decrypt_cb,
+                                          void *decrypt_state) {
+  uint8_t clear_buffer[16];
+  int truncated = 0;
+  struct vpx_read_bit_buffer rb;
+  BITSTREAM_PROFILE profile;
+  int i;
+
+  memset(info, 0, sizeof(*info));
+  info->frame_to_show = -1;
+  for (i = 0; i < REFS_PER_FRAME; ++i) info->ref_frame_idx[i] = -1;
+  info->size_from_ref = -1;
+
+  // The headers read here take at most 12 bytes.
+  if (decrypt_cb) {
+    data_sz = VPXMIN(sizeof(clear_buffer), data_sz);
+    decrypt_cb(decrypt_state, data, clear_buffer, (int)data_sz);
+    data = clear_buffer;
+  }
+  rb.bit_buffer = data;
+  rb.bit_buffer_end = data + data_sz;
+  rb.bit_offset = 0;
+  rb.error_handler_data = &truncated;
+  rb.error_handler = header_truncated;
+
+  if (vpx_rb_read_literal(&rb, 2) != VP9_FRAME_MARKER)
+    return VPX_CODEC_UNSUP_BITSTREAM;
+  profile = vp9_read_profile(&rb);
+  if (profile >= MAX_PROFILES) return VPX_CODEC_UNSUP_BITSTREAM;
+
+  if (vpx_rb_read_bit(&rb)) {
+    info->show_existing_frame = 1;
+    info->show_frame = 1;
+    info->frame_to_show = vpx_rb_read_literal(&rb, REF_FRAMES_LOG2);
+    return truncated ? VPX_CODEC_UNSUP_BITSTREAM : VPX_CODEC_OK;
+  }
+
+  info->is_key_frame = !vpx_rb_read_bit(&rb);
+  info->show_frame = vpx_rb_read_bit(&rb);
+  info->error_resilient = vpx_rb_read_bit(&rb);
+
+  if (info->is_key_frame) {
+    if (!vp9_read_sync_code(&rb) ||
+        !parse_bitdepth_colorspace_sampling(profile, &rb))
+      return VPX_CODEC_UNSUP_BITSTREAM;
+    info->refresh_frame_flags = (1 << REF_FRAMES) - 1;
+    vp9_read_frame_size(&rb, (int *)&info->width, (int *)&info->height);
+  } else {
+    info->intra_only = info->show_frame ? 0 : vpx_rb_read_bit(&rb);
+    rb.bit_offset += info->error_resilient ? 0 : 2;  // reset_frame_context
+
+    if (info->intra_only) {
+      if (!vp9_read_sync_code(&rb)) return VPX_CODEC_UNSUP_BITSTREAM;
+      if (profile > PROFILE_0 &&
+          !parse_bitdepth_colorspace_sampling(profile, &rb))
+        return VPX_CODEC_UNSUP_BITSTREAM;
+      info->refresh_frame_flags = vpx_rb_read_literal(&rb, REF_FRAMES);
+      vp9_read_frame_size(&rb, (int *)&info->width, (int *)&info->height);
+    } else {
+      info->refresh_frame_flags = vpx_rb_read_literal(&rb, REF_FRAMES);
+      for (i = 0; i < REFS_PER_FRAME; ++i) {
+        info->ref_frame_idx[i] = vpx_rb_read_literal(&rb, REF_FRAMES_LOG2);
+        rb.bit_offset += 1;  // ref_frame_sign_bias
+      }
+      for (i = 0; i < REFS_PER_FRAME; ++i) {
+        if (vpx_rb_read_bit(&rb)) {
+          info->size_from_ref = i;
+          break;
+        }
+      }
+      if (info->size_from_ref < 0)
+        vp9_read_frame_size(&rb, (int *)&info->width, (int *)&info->height);
+    }
+  }
+  return truncated ? VPX_CODEC_UNSUP_BITSTREAM : VPX_CODEC_OK;
+}
+
 static vpx_codec_err_t decoder_peek_si(const uint8_t *data,
                                        unsigned int data_sz,
                                        vpx_codec_stream_info_t *si) {
@@ -207,7 +327,7 @@ static void init_buffer_callbacks(vpx_codec_alg_priv_t *ctx) {
 
   cm->new_fb_idx = INVALID_IDX;
   cm->byte_alignment = ctx->byte_alignment;
-  cm->skip_loop_filter = ctx->skip_loop_filter;
+  cm->skip_loop_filter = ctx->skip_loop_filter || ctx->thumbnail.scale_log2;
 
   if (ctx->get_ext_fb_cb != NULL && ctx->release_ext_fb_cb != NULL) {
     pool->get_fb_cb = ctx->get_ext_fb_cb;
@@ -222,6 +342,7 @@ static void init_buffer_callbacks(vpx_codec_alg_priv_t *ctx) {
                          "Failed to initialize internal frame buffers");
 
     pool->cb_priv = &pool->int_frame_buffers;
+    pool->int_frame_buffers.low_memory = cm->low_memory;
   }
 }
 
@@ -251,27 +372,143 @@ static void set_ppflags(const vpx_codec_alg_priv_t *ctx, vp9_ppflags_t *flags) {
       ERROR(#memb " out of range [" #lo ".." #hi "]");                   \
   } while (0)
 
+static int frame_worker_hook(void *arg1, void *arg2) {
+  FrameWorkerData *const frame_worker_data = (FrameWorkerData *)arg1;
+  (void)arg2;
+
+  frame_worker_data->result =
+      vp9_receive_frame_tiles(frame_worker_data->pbi, frame_worker_data->data,
+                              frame_worker_data->data_end,
+                              &frame_worker_data->frame_end);
+  return !frame_worker_data->result;
+}
+
+static vpx_codec_err_t init_frame_workers(vpx_codec_alg_priv_t *ctx) {
+  const VPxWorkerInterface *const winterface = vpx_get_worker_interface();
+  int i;
+
+#if CONFIG_MULTITHREAD
+  if (pthread_mutex_init(&ctx->buffer_pool->pool_mutex, NULL)) {
+    set_error_detail(ctx, "Failed to allocate buffer pool mutex");
+    return VPX_CODEC_MEM_ERROR;
+  }
+  if (pthread_cond_init(&ctx->buffer_pool->pool_cond, NULL)) {
+    pthread_mutex_destroy(&ctx->buffer_pool->pool_mutex);
+    set_error_detail(ctx, "Failed to allocate buffer pool cond");
+    return VPX_CODEC_MEM_ERROR;
+  }
+#endif
+
+  ctx->num_frame_workers = VPXMIN((int)ctx->cfg.threads, MAX_FRAME_WORKERS);
+  ctx->next_submit_worker_id = 0;
+  ctx->last_submit_worker_id = -1;
+  ctx->next_retire_worker_id = 0;
+  ctx->frame_workers = (VPxWorker *)vpx_calloc(ctx->num_frame_workers,
+                                               sizeof(*ctx->frame_workers));
+  if (ctx->frame_workers == NULL) {
+    ctx->num_frame_workers = 0;
+#if CONFIG_MULTITHREAD
+    pthread_mutex_destroy(&ctx->buffer_pool->pool_mutex);
+    pthread_cond_destroy(&ctx->buffer_pool->pool_cond);
+#endif
+    set_error_detail(ctx, "Failed to allocate frame workers");
+    return VPX_CODEC_MEM_ERROR;
+  }
+
+  for (i = 0; i < ctx->num_frame_workers; ++i) {
+    VPxWorker *const worker = &ctx->frame_workers[i];
+    FrameWorkerData *frame_worker_data;
+    VP9Decoder *pbi;
+
+    winterface->init(worker);
+    worker->data1 = vpx_calloc(1, sizeof(*frame_worker_data));
+    if (worker->data1 == NULL) {
+      set_error_detail(ctx, "Failed to allocate frame worker data");
+      return VPX_CODEC_MEM_ERROR;
+    }
+    frame_worker_data = (FrameWorkerData *)worker->data1;
+    frame_worker_data->pbi = pbi = vp9_decoder_create(ctx->buffer_pool);
+    if (pbi == NULL) {
+      set_error_detail(ctx, "Failed to allocate decoder");
+      return VPX_CODEC_MEM_ERROR;
+    }
+    // Each frame is decoded by a single thread.
+    pbi->max_threads = 1;
+    pbi->inv_tile_order = ctx->invert_tile_order;
+    pbi->common.frame_parallel_decode = 1;
+    pbi->common.new_fb_idx = INVALID_IDX;
+    pbi->common.byte_alignment = ctx->byte_alignment;
+    pbi->common.skip_loop_filter = ctx->skip_loop_filter;
+    if (vp9_set_decode_stats(pbi, ctx->decode_stats) != VPX_CODEC_OK) {
+      set_error_detail(ctx, "Failed to allocate decode stats");
+      return VPX_CODEC_MEM_ERROR;
+    }
+
+    worker->hook = frame_worker_hook;
+    worker->pool = ctx->thread_pool;
+    if (!winterface->reset(worker)) {
+      set_error_detail(ctx, "Frame worker thread creation failed");
+      return VPX_CODEC_MEM_ERROR;
+    }
+  }
+
+  ctx->pbi = ((FrameWorkerData *)ctx->frame_workers[0].data1)->pbi;
+  return VPX_CODEC_OK;
+}
+
 static vpx_codec_err_t init_decoder(vpx_codec_alg_priv_t *ctx) {
   ctx->last_show_frame = -1;
   ctx->need_resync = 1;
   ctx->flushed = 0;
 
+  RANGE_CHECK(ctx, row_mt, 0, 1);
+  RANGE_CHECK(ctx, lpf_opt, 0, 1);
+  RANGE_CHECK(ctx, frame_parallel, 0, 1);
+  RANGE_CHECK(ctx, low_memory, 0, 1);
+  RANGE_CHECK(ctx, fused_lf, 0, 1);
+  RANGE_CHECK(ctx, mc_prefetch, 0, 8);
+
+  // Frame parallel decode needs several threads, and the compressed frames
+  // are copied so a decryptor working on the caller's buffer cannot be used.
+  // The frames in flight would also defeat the purpose of the slices, and of
+  // converting the output as it is decoded.
+  ctx->frame_parallel_decode =
+      CONFIG_MULTITHREAD && ctx->frame_parallel && ctx->cfg.threads > 1 &&
+      !(ctx->base.init_flags & VPX_CODEC_USE_POSTPROC) &&
+      ctx->decrypt_cb == NULL &&
+      ctx->base.dec.put_slice_cb.u.put_slice == NULL &&
+      ctx->output_fmt == VPX_IMG_FMT_NONE && ctx->thumbnail.scale_log2 == 0;
+
   ctx->buffer_pool = (BufferPool *)vpx_calloc(1, sizeof(BufferPool));
   if (ctx->buffer_pool == NULL) return VPX_CODEC_MEM_ERROR;
 
-  ctx->pbi = vp9_decoder_create(ctx->buffer_pool);
-  if (ctx->pbi == NULL) {
-    set_error_detail(ctx, "Failed to allocate decoder");
-    return VPX_CODEC_MEM_ERROR;
+  if (ctx->frame_parallel_decode) {
+    const vpx_codec_err_t res = init_frame_workers(ctx);
+    if (res != VPX_CODEC_OK) {
+      if (ctx->frame_workers != NULL) destroy_frame_workers(ctx);
+      return res;
+    }
+  } else {
+    ctx->pbi = vp9_decoder_create(ctx->buffer_pool);
+    if (ctx->pbi == NULL) {
+      set_error_detail(ctx, "Failed to allocate decoder");
+      return VPX_CODEC_MEM_ERROR;
+    }
+    ctx->pbi->max_threads = ctx->cfg.threads;
+    ctx->pbi->inv_tile_order = ctx->invert_tile_order;
+    ctx->pbi->row_mt = ctx->row_mt;
+    ctx->pbi->common.low_memory = ctx->low_memory;
+    ctx->pbi->thread_pool = ctx->thread_pool;
+    // The loop filter of a tile worker waits on the tiles of the other
+    // workers, which may not get a thread of the pool.
+    ctx->pbi->lpf_mt_opt = ctx->thread_pool == NULL && ctx->lpf_opt;
+    ctx->pbi->fused_lf = ctx->fused_lf;
+    ctx->pbi->mc_prefetch = ctx->mc_prefetch;
+    if (vp9_set_decode_stats(ctx->pbi, ctx->decode_stats) != VPX_CODEC_OK) {
+      set_error_detail(ctx, "Failed to allocate decode stats");
+      return VPX_CODEC_MEM_ERROR;
+    }
   }
-  ctx->pbi->max_threads = ctx->cfg.threads;
-  ctx->pbi->inv_tile_order = ctx->invert_tile_order;
-
-  RANGE_CHECK(ctx, row_mt, 0, 1);
-  ctx->pbi->row_mt = ctx->row_mt;
-
-  RANGE_CHECK(ctx, lpf_opt, 0, 1);
-  ctx->pbi->lpf_mt_opt = ctx->lpf_opt;
 
   // If postprocessing was enabled by the application and a
   // configuration has not been provided, default it.
@@ -291,9 +528,451 @@ static INLINE void check_resync(vpx_codec_alg_priv_t *const ctx,
     ctx->need_resync = 0;
 }
 
+static int frame_in_flight(const vpx_codec_alg_priv_t *ctx, int worker_id) {
+  const FrameWorkerData *const frame_worker_data =
+      (const FrameWorkerData *)ctx->frame_workers[worker_id].data1;
+  return frame_worker_data->frame_in_flight;
+}
+
+static int has_free_fb(const BufferPool *pool) {
+  int i;
+  for (i = 0; i < FRAME_BUFFERS; ++i)
+    if (pool->frame_bufs[i].ref_count == 0) return 1;
+  return 0;
+}
+
+// Waits for the oldest frame in flight, updates the reference buffers with it
+// and caches it for output.
+static vpx_codec_err_t retire_frame(vpx_codec_alg_priv_t *ctx) {
+  const VPxWorkerInterface *const winterface = vpx_get_worker_interface();
+  VPxWorker *const worker = &ctx->frame_workers[ctx->next_retire_worker_id];
+  FrameWorkerData *const frame_worker_data = (FrameWorkerData *)worker->data1;
+  VP9Decoder *const pbi = frame_worker_data->pbi;
+  VP9_COMMON *const cm = &pbi->common;
+  RefCntBuffer *const frame_bufs = cm->buffer_pool->frame_bufs;
+
+  assert(frame_worker_data->frame_in_flight);
+  winterface->sync(worker);
+  frame_worker_data->frame_in_flight = 0;
+  ctx->next_retire_worker_id =
+      (ctx->next_retire_worker_id + 1) % ctx->num_frame_workers;
+  ctx->pbi = pbi;
+
+  if (frame_worker_data->result != 0) {
+    vp9_retire_frame(pbi, 1);
+    pbi->need_resync = 1;
+    ctx->need_resync = 1;
+    return update_error_state(ctx, &cm->error);
+  }
+
+  if (frame_worker_data->output_frame && cm->show_frame) {
+    ctx->last_show_frame = cm->new_fb_idx;
+    if (!ctx->need_resync) {
+      cache_frame *const frame = &ctx->frame_cache[ctx->num_cache_frames++];
+      assert(ctx->num_cache_frames <= FRAME_CACHE_SIZE);
+      // Hold the frame until the next decode call.
+      ++frame_bufs[cm->new_fb_idx].ref_count;
+      frame->fb_idx = cm->new_fb_idx;
+      yuvconfig2image(&frame->img, &frame_bufs[cm->new_fb_idx].buf,
+                      frame_worker_data->user_priv);
+      frame->img.fb_priv = frame_bufs[cm->new_fb_idx].raw_frame_buffer.priv;
+    }
+  }
+
+  vp9_retire_frame(pbi, 0);
+  return VPX_CODEC_OK;
+}
+
+// Retires all the frames in flight.
+static vpx_codec_err_t flush_frame_workers(vpx_codec_alg_priv_t *ctx) {
+  vpx_codec_err_t res = VPX_CODEC_OK;
+  while (frame_in_flight(ctx, ctx->next_retire_worker_id)) {
+    const vpx_codec_err_t retire_res = retire_frame(ctx);
+    if (res == VPX_CODEC_OK) res = retire_res;
+  }
+  return res;
+}
+
+// Releases the frames returned by the previous decode call.
+static void release_cache_frames(vpx_codec_alg_priv_t *ctx) {
+  BufferPool *const pool = ctx->buffer_pool;
+  int i;
+
+  for (i = 0; i < ctx->num_cache_frames; ++i)
+    decrease_ref_count(ctx->frame_cache[i].fb_idx, pool->frame_bufs, pool);
+  ctx->num_cache_frames = 0;
+  ctx->next_cache_frame = 0;
+}
+
+static void set_decode_region(VP9Decoder *pbi, const vpx_image_rect_t *rect) {
+  pbi->region_x = (int)rect->x;
+  pbi->region_y = (int)rect->y;
+  pbi->region_w = (int)rect->w;
+  pbi->region_h = (int)rect->h;
+}
+
+// Submits the frame at *data to the next frame worker. 'data_sz' is the size
+// of the frame if 'size_known' is set, that of the rest of the chunk
+// otherwise, in which case the frame is waited for to find its end.
+static vpx_codec_err_t frame_parallel_decode_one(vpx_codec_alg_priv_t *ctx,
+                                                 const uint8_t **data,
+                                                 unsigned int data_sz,
+                                                 int size_known,
+                                                 void *user_priv) {
+  const VPxWorkerInterface *const winterface = vpx_get_worker_interface();
+  VPxWorker *const worker = &ctx->frame_workers[ctx->next_submit_worker_id];
+  FrameWorkerData *const frame_worker_data = (FrameWorkerData *)worker->data1;
+  VP9Decoder *const pbi = frame_worker_data->pbi;
+  const uint8_t *tile_data;
+
+  // The worker still holds the oldest frame in flight.
+  if (frame_worker_data->frame_in_flight) {
+    const vpx_codec_err_t res = retire_frame(ctx);
+    if (res != VPX_CODEC_OK) return res;
+  }
+
+  if (frame_worker_data->scratch_buffer_size < data_sz) {
+    vpx_free(frame_worker_data->scratch_buffer);
+    frame_worker_data->scratch_buffer = (uint8_t *)vpx_malloc(data_sz);
+    if (frame_worker_data->scratch_buffer == NULL) {
+      frame_worker_data->scratch_buffer_size = 0;
+      set_error_detail(ctx, "Failed to reallocate scratch buffer");
+      return VPX_CODEC_MEM_ERROR;
+    }
+    frame_worker_data->scratch_buffer_size = data_sz;
+  }
+  memcpy(frame_worker_data->scratch_buffer, *data, data_sz);
+
+  if (ctx->last_submit_worker_id >= 0) {
+    VPxWorker *const prev_worker =
+        &ctx->frame_workers[ctx->last_submit_worker_id];
+    const VP9Decoder *const prev_pbi =
+        ((FrameWorkerData *)prev_worker->data1)->pbi;
+    const VP9_COMMON *const prev_cm = &prev_pbi->common;
+    // The frame context adapted at the end of the previous frame is needed to
+    // read the headers, so decode serially.
+    if (frame_in_flight(ctx, ctx->last_submit_worker_id) &&
+        !prev_cm->show_existing_frame && prev_cm->refresh_frame_context &&
+        !prev_cm->frame_parallel_decoding_mode)
+      winterface->sync(prev_worker);
+    vp9_frameworker_copy_context(pbi, prev_pbi);
+  }
+  if (ctx->need_resync) pbi->need_resync = 1;
+
+  pbi->decrypt_cb = ctx->decrypt_cb;
+  pbi->decrypt_state = ctx->decrypt_state;
+  set_decode_region(pbi, &ctx->decode_region);
+
+  // Make room for the new frame.
+  while (!has_free_fb(ctx->buffer_pool) &&
+         frame_in_flight(ctx, ctx->next_retire_worker_id)) {
+    const vpx_codec_err_t res = retire_frame(ctx);
+    if (res != VPX_CODEC_OK) {
+      vp9_frameworker_release_context(pbi);
+      return res;
+    }
+  }
+
+  tile_data = frame_worker_data->scratch_buffer;
+  if (vp9_receive_frame_headers(pbi, data_sz, &tile_data)) {
+    vp9_frameworker_release_context(pbi);
+    pbi->need_resync = 1;
+    ctx->need_resync = 1;
+    return update_error_state(ctx, &pbi->common.error);
+  }
+
+  check_resync(ctx, pbi);
+
+  frame_worker_data->data = tile_data;
+  frame_worker_data->data_end = frame_worker_data->scratch_buffer + data_sz;
+  // The headers of a frame showing an existing frame end it.
+  frame_worker_data->frame_end = tile_data;
+  frame_worker_data->user_priv = user_priv;
+  frame_worker_data->output_frame = 1;
+  frame_worker_data->result = 0;
+  frame_worker_data->frame_in_flight = 1;
+  if (!pbi->common.show_existing_frame) {
+    worker->had_error = 0;
+    winterface->launch(worker);
+    // Another frame may follow in the chunk from where the bool decoder of the
+    // last tile stopped.
+    if (!size_known) winterface->sync(worker);
+  }
+
+  ctx->last_submit_worker_id = ctx->next_submit_worker_id;
+  ctx->next_submit_worker_id =
+      (ctx->next_submit_worker_id + 1) % ctx->num_frame_workers;
+
+  // The error of a frame that failed is returned when it is retired, and the
+  // rest of the chunk is dropped as in serial decode.
+  if (size_known || frame_worker_data->result != 0)
+    *data += data_sz;
+  else
+    *data += frame_worker_data->frame_end - frame_worker_data->scratch_buffer;
+  return VPX_CODEC_OK;
+}
+
+// Returns the format 'buf' is output in, VPX_IMG_FMT_NONE if it is output as
+// decoded.
+static vpx_img_fmt_t get_output_fmt(const vpx_codec_alg_priv_t *ctx,
+                                    const YV12_BUFFER_CONFIG *buf) {
+  // The thumbnails are made from the frames as decoded.
+  if (ctx->thumbnail.scale_log2 > 0) return VPX_IMG_FMT_NONE;
+  if (buf->subsampling_x != 1 || buf->subsampling_y != 1)
+    return VPX_IMG_FMT_NONE;
+  if (!(buf->flags & YV12_FLAG_HIGHBITDEPTH))
+    return ctx->output_fmt == VPX_IMG_FMT_NV12 ? VPX_IMG_FMT_NV12
+                                               : VPX_IMG_FMT_NONE;
+  return ctx->output_fmt == VPX_IMG_FMT_P010 && buf->bit_depth == 10
+             ? VPX_IMG_FMT_P010
+             : VPX_IMG_FMT_NONE;
+}
+
+// Sets up output_img to receive the rows of 'buf'.
+static void setup_output_frame(vpx_codec_alg_priv_t *ctx,
+                               const YV12_BUFFER_CONFIG *buf) {
+  const vpx_img_fmt_t fmt = get_output_fmt(ctx, buf);
+  const int bytes_per_sample = (fmt & VPX_IMG_FMT_HIGHBITDEPTH) ? 2 : 1;
+  const int w = buf->y_crop_width;
+  const int h = buf->y_crop_height;
+  const size_t stride = ((w + 31) & ~31) * bytes_per_sample;
+  const size_t size = stride * (h + (h + 1) / 2);
+  uint8_t *data;
+
+  ctx->output_src = NULL;
+  if (fmt == VPX_IMG_FMT_NONE) return;
+
+  if (ctx->get_ext_fb_cb != NULL) {
+    // The previous output frame is no longer used by the decoder.
+    if (ctx->output_fb.data != NULL) {
+      ctx->release_ext_fb_cb(ctx->ext_priv, &ctx->output_fb);
+      memset(&ctx->output_fb, 0, sizeof(ctx->output_fb));
+    }
+    if (ctx->get_ext_fb_cb(ctx->ext_priv, size, &ctx->output_fb) < 0 ||
+        ctx->output_fb.data == NULL || ctx->output_fb.size < size) {
+      ctx->output_error = 1;
+      return;
+    }
+    data = ctx->output_fb.data;
+  } else {
+    if (ctx->output_buf_size < size) {
+      vpx_free(ctx->output_buf);
+      ctx->output_buf_size = 0;
+      ctx->output_buf = (uint8_t *)vpx_memalign(32, size);
+      if (ctx->output_buf == NULL) {
+        ctx->output_error = 1;
+        return;
+      }
+      ctx->output_buf_size = size;
+    }
+    data = ctx->output_buf;
+  }
+
+  vpx_img_wrap(&ctx->output_img, fmt, w, h, 32, data);
+  ctx->output_img.cs = buf->color_space;
+  ctx->output_img.range = buf->color_range;
+  ctx->output_img.r_w = buf->render_width;
+  ctx->output_img.r_h = buf->render_height;
+  ctx->output_img.user_priv = ctx->user_priv;
+  ctx->output_src = buf->y_buffer;
+}
+
+// Converts the luma rows [start, end) of 'buf', and the chroma rows next to
+// them, into output_img.
+static void convert_output_rows(vpx_codec_alg_priv_t *ctx,
+                                const YV12_BUFFER_CONFIG *buf, int start,
+                                int end) {
+  const vpx_image_t *const img = &ctx->output_img;
+  const int uv_start = start >> 1;
+  const int uv_end = (end + 1) >> 1;
+  int r, c;
+
+#if CONFIG_VP9_HIGHBITDEPTH
+  if (buf->flags & YV12_FLAG_HIGHBITDEPTH) {
+    // P010 keeps the 10 bits in the most significant bits of the samples.
+    for (r = start; r < end; ++r) {
+      const uint16_t *const src =
+          CONVERT_TO_SHORTPTR(buf->y_buffer) + r * buf->y_stride;
+      uint16_t *const dst =
+          (uint16_t *)(img->planes[VPX_PLANE_Y] + r * img->stride[VPX_PLANE_Y]);
+      for (c = 0; c < buf->y_crop_width; ++c) dst[c] = src[c] << 6;
+    }
+    for (r = uv_start; r < uv_end; ++r) {
+      const uint16_t *const src_u =
+          CONVERT_TO_SHORTPTR(buf->u_buffer) + r * buf->uv_stride;
+      const uint16_t *const src_v =
+          CONVERT_TO_SHORTPTR(buf->v_buffer) + r * buf->uv_stride;
+      uint16_t *const dst =
+          (uint16_t *)(img->planes[VPX_PLANE_U] + r * img->stride[VPX_PLANE_U]);
+      for (c = 0; c < buf->uv_crop_width; ++c) {
+        dst[2 * c] = src_u[c] << 6;
+        dst[2 * c + 1] = src_v[c] << 6;
+      }
+    }
+    return;
+  }
+#endif  // CONFIG_VP9_HIGHBITDEPTH
+
+  for (r = start; r < end; ++r) {
+    memcpy(img->planes[VPX_PLANE_Y] + r * img->stride[VPX_PLANE_Y],
+           buf->y_buffer + r * buf->y_stride, buf->y_crop_width);
+  }
+  for (r = uv_start; r < uv_end; ++r) {
+    const uint8_t *const src_u = buf->u_buffer + r * buf->uv_stride;
+    const uint8_t *const src_v = buf->v_buffer + r * buf->uv_stride;
+    uint8_t *const dst =
+        img->planes[VPX_PLANE_U] + r * img->stride[VPX_PLANE_U];
+    for (c = 0; c < buf->uv_crop_width; ++c) {
+      dst[2 * c] = src_u[c];
+      dst[2 * c + 1] = src_v[c];
+    }
+  }
+}
+
+// Averages each block of 1 << scale_log2 by 1 << scale_log2 samples of
+// 'plane' of 'src' into a sample of 'dst'. The blocks are cut at the edges.
+static void scale_down_plane(const vpx_image_t *src, vpx_image_t *dst,
+                             int plane, int scale_log2) {
+  const int high = (src->fmt & VPX_IMG_FMT_HIGHBITDEPTH) != 0;
+  const int xs = plane ? src->x_chroma_shift : 0;
+  const int ys = plane ? src->y_chroma_shift : 0;
+  const int src_w = (src->d_w + xs) >> xs;
+  const int src_h = (src->d_h + ys) >> ys;
+  const int dst_w = (dst->d_w + xs) >> xs;
+  const int dst_h = (dst->d_h + ys) >> ys;
+  const int size = 1 << scale_log2;
+  int r, c, i, j;
+
+  for (r = 0; r < dst_h; ++r) {
+    const int y0 = r << scale_log2;
+    const int rows = VPXMIN(size, src_h - y0);
+    const uint8_t *const src_row =
+        src->planes[plane] + y0 * src->stride[plane];
+    uint8_t *const dst_row = dst->planes[plane] + r * dst->stride[plane];
+    for (c = 0; c < dst_w; ++c) {
+      const int x0 = c << scale_log2;
+      const int cols = VPXMIN(size, src_w - x0);
+      const int count = rows * cols;
+      int sum = 0;
+      for (i = 0; i < rows; ++i) {
+        const uint8_t *const p = src_row + i * src->stride[plane];
+        if (high) {
+          const uint16_t *const p16 = (const uint16_t *)p + x0;
+          for (j = 0; j < cols; ++j) sum += p16[j];
+        } else {
+          for (j = 0; j < cols; ++j) sum += p[x0 + j];
+        }
+      }
+      if (high) {
+        ((uint16_t *)dst_row)[c] = (uint16_t)((sum + count / 2) / count);
+      } else {
+        dst_row[c] = (uint8_t)((sum + count / 2) / count);
+      }
+    }
+  }
+}
+
+// Scales 'sd' down into output_img. Returns NULL if the buffer cannot be
+// allocated.
+static vpx_image_t *make_thumbnail(vpx_codec_alg_priv_t *ctx,
+                                   const YV12_BUFFER_CONFIG *sd) {
+  const int scale_log2 = ctx->thumbnail.scale_log2;
+  vpx_image_t src;
+  int w, h, plane;
+  size_t stride, size;
+
+  yuvconfig2image(&src, sd, ctx->user_priv);
+  w = (src.d_w + (1 << scale_log2) - 1) >> scale_log2;
+  h = (src.d_h + (1 << scale_log2) - 1) >> scale_log2;
+  stride = ((w + 31) & ~31) * ((src.fmt & VPX_IMG_FMT_HIGHBITDEPTH) ? 2 : 1);
+  size = stride * h + 2 * (stride >> src.x_chroma_shift) *
+                          ((h + src.y_chroma_shift) >> src.y_chroma_shift);
+  if (ctx->output_buf_size < size) {
+    vpx_free(ctx->output_buf);
+    ctx->output_buf_size = 0;
+    ctx->output_buf = (uint8_t *)vpx_memalign(32, size);
+    if (ctx->output_buf == NULL) return NULL;
+    ctx->output_buf_size = size;
+  }
+
+  vpx_img_wrap(&ctx->output_img, src.fmt, w, h, 32, ctx->output_buf);
+  ctx->output_img.bit_depth = src.bit_depth;
+  ctx->output_img.cs = src.cs;
+  ctx->output_img.range = src.range;
+  ctx->output_img.r_w = (src.r_w + (1 << scale_log2) - 1) >> scale_log2;
+  ctx->output_img.r_h = (src.r_h + (1 << scale_log2) - 1) >> scale_log2;
+  ctx->output_img.user_priv = src.user_priv;
+  for (plane = 0; plane < 3; ++plane)
+    scale_down_plane(&src, &ctx->output_img, plane, scale_log2);
+  return &ctx->output_img;
+}
+
+static void put_slice(void *priv, const YV12_BUFFER_CONFIG *buf, int start,
+                      int end) {
+  vpx_codec_alg_priv_t *const ctx = (vpx_codec_alg_priv_t *)priv;
+  const vpx_codec_priv_cb_pair_t *const cb = &ctx->base.dec.put_slice_cb;
+  vpx_image_t img;
+  vpx_image_rect_t valid, update;
+
+  // A new frame is announced before its rows.
+  if (end == 0) {
+    if (ctx->output_fmt != VPX_IMG_FMT_NONE) setup_output_frame(ctx, buf);
+    return;
+  }
+
+  if (ctx->output_src == buf->y_buffer) {
+    convert_output_rows(ctx, buf, start, end);
+    img = ctx->output_img;
+  } else {
+    yuvconfig2image(&img, buf, ctx->user_priv);
+  }
+  if (cb->u.put_slice == NULL) return;
+
+  valid.x = update.x = 0;
+  valid.w = update.w = img.d_w;
+  valid.y = 0;
+  valid.h = end;
+  update.y = start;
+  update.h = end - start;
+  cb->u.put_slice(cb->user_priv, &img, &valid, &update);
+}
+
+// Returns 1 if the frame is skipped in the decode mode, reading only its
+// uncompressed header.
+static int skip_frame(vpx_codec_alg_priv_t *ctx, const uint8_t *data,
+                      unsigned int data_sz) {
+  // Thumbnails of the key frames do not need the other frames.
+  const int key_frames_only =
+      ctx->decode_mode == VPX_DECODE_KEY_FRAMES ||
+      (ctx->thumbnail.scale_log2 > 0 && !ctx->thumbnail.inter_frames);
+  vpx_frame_header_info info;
+
+  if (!key_frames_only && !ctx->skip_to_key_frame &&
+      ctx->decode_mode != VPX_DECODE_REFERENCE_FRAMES)
+    return 0;
+  // The decoder reports the errors.
+  if (parse_frame_header(data, data_sz, &info, ctx->decrypt_cb,
+                         ctx->decrypt_state) != VPX_CODEC_OK)
+    return 0;
+
+  if (info.is_key_frame) {
+    ctx->skip_to_key_frame = 0;
+    return 0;
+  }
+  if (key_frames_only || ctx->skip_to_key_frame) {
+    ctx->skip_to_key_frame = 1;
+    return 1;
+  }
+  // The next frame does not depend on an error resilient frame that leaves
+  // the reference buffers unchanged, unless it is not error resilient.
+  return info.error_resilient && !info.show_existing_frame &&
+         info.refresh_frame_flags == 0;
+}
+
 static vpx_codec_err_t decode_one(vpx_codec_alg_priv_t *ctx,
                                   const uint8_t **data, unsigned int data_sz,
-                                  void *user_priv, int64_t deadline) {
+                                  int size_known, void *user_priv,
+                                  int64_t deadline) {
   (void)deadline;
 
   // Determine the stream parameters. Note that we rely on peek_si to
@@ -309,12 +988,34 @@ static vpx_codec_err_t decode_one(vpx_codec_alg_priv_t *ctx,
     if (!ctx->si.is_kf && !is_intra_only) return VPX_CODEC_ERROR;
   }
 
+  if (skip_frame(ctx, *data, data_sz)) {
+    // Nothing is output for the chunk, not even a frame decoded before.
+    if (ctx->frame_workers == NULL) ctx->pbi->ready_for_new_data = 1;
+    *data += data_sz;
+    return VPX_CODEC_OK;
+  }
+
+  if (ctx->frame_parallel_decode)
+    return frame_parallel_decode_one(ctx, data, data_sz, size_known,
+                                     user_priv);
+
   ctx->user_priv = user_priv;
 
   // Set these even if already initialized.  The caller may have changed the
   // decrypt config between frames.
   ctx->pbi->decrypt_cb = ctx->decrypt_cb;
   ctx->pbi->decrypt_state = ctx->decrypt_state;
+  // The output is converted as the rows are decoded, unless it is
+  // postprocessed once the frame is complete.
+  ctx->pbi->put_rows_cb =
+      ctx->base.dec.put_slice_cb.u.put_slice != NULL ||
+              (ctx->output_fmt != VPX_IMG_FMT_NONE &&
+               !(ctx->base.init_flags & VPX_CODEC_USE_POSTPROC))
+          ? put_slice
+          : NULL;
+  ctx->pbi->put_rows_priv = ctx;
+  ctx->output_error = 0;
+  set_decode_region(ctx->pbi, &ctx->decode_region);
 
   if (vp9_receive_compressed_data(ctx->pbi, data_sz, data)) {
     ctx->pbi->cur_buf->buf.corrupted = 1;
@@ -325,6 +1026,11 @@ static vpx_codec_err_t decode_one(vpx_codec_alg_priv_t *ctx,
 
   check_resync(ctx, ctx->pbi);
 
+  if (ctx->output_error) {
+    set_error_detail(ctx, "Failed to get output frame buffer");
+    return VPX_CODEC_MEM_ERROR;
+  }
+
   return VPX_CODEC_OK;
 }
 
@@ -339,6 +1045,10 @@ static vpx_codec_err_t decoder_decode(vpx_codec_alg_priv_t *ctx,
 
   if (data == NULL && data_sz == 0) {
     ctx->flushed = 1;
+    if (ctx->frame_workers != NULL) {
+      release_cache_frames(ctx);
+      return flush_frame_workers(ctx);
+    }
     return VPX_CODEC_OK;
   }
 
@@ -351,6 +1061,8 @@ static vpx_codec_err_t decoder_decode(vpx_codec_alg_priv_t *ctx,
     if (res != VPX_CODEC_OK) return res;
   }
 
+  if (ctx->frame_workers != NULL) release_cache_frames(ctx);
+
   res = vp9_parse_superframe_index(data, data_sz, frame_sizes, &frame_count,
                                    ctx->decrypt_cb, ctx->decrypt_state);
   if (res != VPX_CODEC_OK) return res;
@@ -371,16 +1083,35 @@ static vpx_codec_err_t decoder_decode(vpx_codec_alg_priv_t *ctx,
         return VPX_CODEC_CORRUPT_FRAME;
       }
 
-      res = decode_one(ctx, &data_start_copy, frame_size, user_priv, deadline);
+      if (ctx->frame_parallel_decode && i > 0) {
+        // As in serial decode, only the last frame of a superframe is output.
+        FrameWorkerData *const frame_worker_data =
+            (FrameWorkerData *)ctx->frame_workers[ctx->last_submit_worker_id]
+                .data1;
+        frame_worker_data->output_frame = 0;
+      }
+
+      res = decode_one(ctx, &data_start_copy, frame_size, 1, user_priv,
+                       deadline);
       if (res != VPX_CODEC_OK) return res;
 
       data_start += frame_size;
     }
   } else {
-    while (data_start < data_end) {
+    int i;
+
+    for (i = 0; data_start < data_end; ++i) {
       const uint32_t frame_size = (uint32_t)(data_end - data_start);
-      const vpx_codec_err_t res =
-          decode_one(ctx, &data_start, frame_size, user_priv, deadline);
+      vpx_codec_err_t res;
+
+      if (ctx->frame_parallel_decode && i > 0) {
+        FrameWorkerData *const frame_worker_data =
+            (FrameWorkerData *)ctx->frame_workers[ctx->last_submit_worker_id]
+                .data1;
+        frame_worker_data->output_frame = 0;
+      }
+
+      res = decode_one(ctx, &data_start, frame_size, 0, user_priv, deadline);
       if (res != VPX_CODEC_OK) return res;
 
       // Account for suboptimal termination by the encoder.
@@ -404,6 +1135,13 @@ static vpx_image_t *decoder_get_frame(vpx_codec_alg_priv_t *ctx,
   // always return only 1 frame per decode call.
   (void)iter;
 
+  // In frame parallel decode a call may retire several frames, or none.
+  if (ctx->frame_workers != NULL) {
+    if (ctx->next_cache_frame < ctx->num_cache_frames)
+      return &ctx->frame_cache[ctx->next_cache_frame++].img;
+    return NULL;
+  }
+
   if (ctx->pbi != NULL) {
     YV12_BUFFER_CONFIG sd;
     vp9_ppflags_t flags = { 0, 0, 0 };
@@ -413,6 +1151,11 @@ static vpx_image_t *decoder_get_frame(vpx_codec_alg_priv_t *ctx,
       RefCntBuffer *const frame_bufs = cm->buffer_pool->frame_bufs;
       ctx->last_show_frame = ctx->pbi->common.new_fb_idx;
       if (ctx->need_resync) return NULL;
+      if (ctx->thumbnail.scale_log2 > 0) return make_thumbnail(ctx, &sd);
+      if (sd.y_buffer == ctx->output_src) {
+        ctx->output_img.fb_priv = ctx->output_fb.priv;
+        return &ctx->output_img;
+      }
       yuvconfig2image(&ctx->img, &sd, ctx->user_priv);
       ctx->img.fb_priv = frame_bufs[cm->new_fb_idx].raw_frame_buffer.priv;
       img = &ctx->img;
@@ -446,6 +1189,11 @@ static vpx_codec_err_t ctrl_set_reference(vpx_codec_alg_priv_t *ctx,
   if (data) {
     vpx_ref_frame_t *const frame = (vpx_ref_frame_t *)data;
     YV12_BUFFER_CONFIG sd;
+    // The reference buffers must not change under the frames in flight.
+    if (ctx->frame_workers != NULL) {
+      const vpx_codec_err_t res = flush_frame_workers(ctx);
+      if (res != VPX_CODEC_OK) return res;
+    }
     image2yuvconfig(&frame->img, &sd);
     return vp9_set_reference_dec(
         &ctx->pbi->common, ref_frame_to_vp9_reframe(frame->frame_type), &sd);
@@ -461,6 +1209,10 @@ static vpx_codec_err_t ctrl_copy_reference(vpx_codec_alg_priv_t *ctx,
   if (data) {
     vpx_ref_frame_t *frame = (vpx_ref_frame_t *)data;
     YV12_BUFFER_CONFIG sd;
+    if (ctx->frame_workers != NULL) {
+      const vpx_codec_err_t res = flush_frame_workers(ctx);
+      if (res != VPX_CODEC_OK) return res;
+    }
     image2yuvconfig(&frame->img, &sd);
     return vp9_copy_reference_dec(ctx->pbi, (VP9_REFFRAME)frame->frame_type,
                                   &sd);
@@ -631,7 +1383,14 @@ static vpx_codec_err_t ctrl_set_byte_alignment(vpx_codec_alg_priv_t *ctx,
     return VPX_CODEC_INVALID_PARAM;
 
   ctx->byte_alignment = byte_alignment;
-  if (ctx->pbi != NULL) {
+  if (ctx->frame_workers != NULL) {
+    int i;
+    for (i = 0; i < ctx->num_frame_workers; ++i) {
+      FrameWorkerData *const frame_worker_data =
+          (FrameWorkerData *)ctx->frame_workers[i].data1;
+      frame_worker_data->pbi->common.byte_alignment = byte_alignment;
+    }
+  } else if (ctx->pbi != NULL) {
     ctx->pbi->common.byte_alignment = byte_alignment;
   }
   return VPX_CODEC_OK;
@@ -641,8 +1400,16 @@ static vpx_codec_err_t ctrl_set_skip_loop_filter(vpx_codec_alg_priv_t *ctx,
                                                  va_list args) {
   ctx->skip_loop_filter = va_arg(args, int);
 
-  if (ctx->pbi != NULL) {
-    ctx->pbi->common.skip_loop_filter = ctx->skip_loop_filter;
+  if (ctx->frame_workers != NULL) {
+    int i;
+    for (i = 0; i < ctx->num_frame_workers; ++i) {
+      FrameWorkerData *const frame_worker_data =
+          (FrameWorkerData *)ctx->frame_workers[i].data1;
+      frame_worker_data->pbi->common.skip_loop_filter = ctx->skip_loop_filter;
+    }
+  } else if (ctx->pbi != NULL) {
+    ctx->pbi->common.skip_loop_filter =
+        ctx->skip_loop_filter || ctx->thumbnail.scale_log2;
   }
 
   return VPX_CODEC_OK;
@@ -672,6 +1439,241 @@ static vpx_codec_err_t ctrl_enable_lpf_opt(vpx_codec_alg_priv_t *ctx,
   return VPX_CODEC_OK;
 }
 
+static vpx_codec_err_t ctrl_set_frame_parallel(vpx_codec_alg_priv_t *ctx,
+                                               va_list args) {
+  ctx->frame_parallel = va_arg(args, int);
+
+  return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t ctrl_set_thread_pool(vpx_codec_alg_priv_t *ctx,
+                                            va_list args) {
+  vpx_thread_pool_t *const pool = va_arg(args, vpx_thread_pool_t *);
+
+  // The decoder threads are created with the first frame.
+  if (ctx->pbi != NULL) return VPX_CODEC_ERROR;
+  ctx->thread_pool = (VPxWorkerPool *)pool;
+  return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t ctrl_set_output_format(vpx_codec_alg_priv_t *ctx,
+                                              va_list args) {
+  const vpx_img_fmt_t fmt = (vpx_img_fmt_t)va_arg(args, int);
+
+  if (fmt != VPX_IMG_FMT_NONE && fmt != VPX_IMG_FMT_NV12 &&
+      fmt != VPX_IMG_FMT_P010)
+    return VPX_CODEC_INVALID_PARAM;
+  // The frame parallel decoding mode is chosen with the first frame.
+  if (ctx->pbi != NULL) return VPX_CODEC_ERROR;
+  ctx->output_fmt = fmt;
+  return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t ctrl_set_decode_region(vpx_codec_alg_priv_t *ctx,
+                                              va_list args) {
+  const vpx_image_rect_t *const rect = va_arg(args, vpx_image_rect_t *);
+
+  if (rect == NULL) {
+    memset(&ctx->decode_region, 0, sizeof(ctx->decode_region));
+  } else {
+    // Frame dimensions are coded on 16 bits.
+    const unsigned int max_size = 1 << 16;
+    if (rect->x > max_size || rect->y > max_size || rect->w > max_size ||
+        rect->h > max_size)
+      return VPX_CODEC_INVALID_PARAM;
+    ctx->decode_region = *rect;
+  }
+  return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t ctrl_set_thumbnail_mode(vpx_codec_alg_priv_t *ctx,
+                                               va_list args) {
+  const vpx_thumbnail_mode *const mode = va_arg(args, vpx_thumbnail_mode *);
+
+  if (mode != NULL && (mode->scale_log2 < 0 || mode->scale_log2 > 3))
+    return VPX_CODEC_INVALID_PARAM;
+  // The frame parallel decoding mode is chosen with the first frame.
+  if (ctx->pbi != NULL) return VPX_CODEC_ERROR;
+  if (mode == NULL) {
+    memset(&ctx->thumbnail, 0, sizeof(ctx->thumbnail));
+  } else {
+    ctx->thumbnail = *mode;
+  }
+  return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t ctrl_parse_frame_headers(vpx_codec_alg_priv_t *ctx,
+                                                va_list args) {
+  vpx_frame_header_list *const list = va_arg(args, vpx_frame_header_list *);
+  uint32_t frame_sizes[8];
+  int frame_count, i;
+  size_t offset = 0;
+  vpx_codec_err_t res;
+
+  if (list == NULL || list->data == NULL || list->data_sz == 0)
+    return VPX_CODEC_INVALID_PARAM;
+
+  res = vp9_parse_superframe_index(list->data, list->data_sz, frame_sizes,
+                                   &frame_count, ctx->decrypt_cb,
+                                   ctx->decrypt_state);
+  if (res != VPX_CODEC_OK) return res;
+
+  list->num_frames = VPXMAX(frame_count, 1);
+  if (list->num_frames > list->max_frames || list->frames == NULL)
+    return VPX_CODEC_INVALID_PARAM;
+
+  for (i = 0; i < list->num_frames; ++i) {
+    // Without an index the chunk holds a single frame.
+    const size_t size = frame_count > 0 ? frame_sizes[i] : list->data_sz;
+    if (size > list->data_sz - offset) {
+      set_error_detail(ctx, "Invalid frame size in index");
+      return VPX_CODEC_CORRUPT_FRAME;
+    }
+    res = parse_frame_header(list->data + offset, size, &list->frames[i],
+                             ctx->decrypt_cb, ctx->decrypt_state);
+    if (res != VPX_CODEC_OK) return res;
+    list->frames[i].offset = offset;
+    list->frames[i].size = size;
+    offset += size;
+  }
+  return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t ctrl_save_checkpoint(vpx_codec_alg_priv_t *ctx,
+                                            va_list args) {
+  const int id = va_arg(args, int);
+  vpx_codec_err_t res;
+
+  if (id < 0 || id >= VP9_MAX_DECODER_CHECKPOINTS)
+    return VPX_CODEC_INVALID_PARAM;
+  if (ctx->pbi == NULL || ctx->frame_workers != NULL) return VPX_CODEC_ERROR;
+
+  if (ctx->checkpoints[id] == NULL) {
+    ctx->checkpoints[id] =
+        (VP9DecoderCheckpoint *)vpx_calloc(1, sizeof(*ctx->checkpoints[id]));
+    if (ctx->checkpoints[id] == NULL) return VPX_CODEC_MEM_ERROR;
+  }
+  res = vp9_save_checkpoint(ctx->pbi, ctx->checkpoints[id]);
+  if (res != VPX_CODEC_OK) {
+    vp9_free_checkpoint(ctx->checkpoints[id]);
+    ctx->checkpoints[id] = NULL;
+  }
+  return res;
+}
+
+static vpx_codec_err_t ctrl_restore_checkpoint(vpx_codec_alg_priv_t *ctx,
+                                               va_list args) {
+  const int id = va_arg(args, int);
+  vpx_codec_err_t res;
+
+  if (id < 0 || id >= VP9_MAX_DECODER_CHECKPOINTS)
+    return VPX_CODEC_INVALID_PARAM;
+  if (ctx->pbi == NULL || ctx->frame_workers != NULL ||
+      ctx->checkpoints[id] == NULL)
+    return VPX_CODEC_ERROR;
+
+  res = vp9_restore_checkpoint(ctx->pbi, ctx->checkpoints[id]);
+  ctx->need_resync = ctx->pbi->need_resync;
+  ctx->last_show_frame = -1;
+  return res;
+}
+
+static vpx_codec_err_t ctrl_release_checkpoint(vpx_codec_alg_priv_t *ctx,
+                                               va_list args) {
+  const int id = va_arg(args, int);
+
+  if (id < 0 || id >= VP9_MAX_DECODER_CHECKPOINTS)
+    return VPX_CODEC_INVALID_PARAM;
+  if (ctx->checkpoints[id] != NULL) {
+    vp9_free_checkpoint(ctx->checkpoints[id]);
+    ctx->checkpoints[id] = NULL;
+  }
+  return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t ctrl_set_decode_mode(vpx_codec_alg_priv_t *ctx,
+                                            va_list args) {
+  const int mode = va_arg(args, int);
+
+  if (mode < VPX_DECODE_ALL_FRAMES || mode > VPX_DECODE_REFERENCE_FRAMES)
+    return VPX_CODEC_INVALID_PARAM;
+  ctx->decode_mode = (vpx_decode_mode)mode;
+  return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t ctrl_set_low_memory(vpx_codec_alg_priv_t *ctx,
+                                           va_list args) {
+  ctx->low_memory = va_arg(args, int);
+
+  return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t ctrl_set_fused_loop_filter(vpx_codec_alg_priv_t *ctx,
+                                                  va_list args) {
+  ctx->fused_lf = va_arg(args, int);
+
+  return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t ctrl_set_mc_prefetch(vpx_codec_alg_priv_t *ctx,
+                                            va_list args) {
+  ctx->mc_prefetch = va_arg(args, int);
+
+  return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t ctrl_set_decode_stats(vpx_codec_alg_priv_t *ctx,
+                                             va_list args) {
+  vpx_codec_err_t res = VPX_CODEC_OK;
+  ctx->decode_stats = va_arg(args, int);
+
+  if (ctx->frame_workers != NULL) {
+    int i;
+    for (i = 0; i < ctx->num_frame_workers && res == VPX_CODEC_OK; ++i) {
+      FrameWorkerData *const frame_worker_data =
+          (FrameWorkerData *)ctx->frame_workers[i].data1;
+      res = vp9_set_decode_stats(frame_worker_data->pbi, ctx->decode_stats);
+    }
+  } else if (ctx->pbi != NULL) {
+    res = vp9_set_decode_stats(ctx->pbi, ctx->decode_stats);
+  }
+
+  return res;
+}
+
+static vpx_codec_err_t ctrl_get_decode_stats(vpx_codec_alg_priv_t *ctx,
+                                             va_list args) {
+  vpx_decode_stats *const stats = va_arg(args, vpx_decode_stats *);
+
+  if (stats == NULL) return VPX_CODEC_INVALID_PARAM;
+  memset(stats, 0, sizeof(*stats));
+
+  if (ctx->frame_workers != NULL) {
+    // Each frame worker decodes with one thread, reported as thread i.
+    int i, j, s;
+    for (i = 0; i < ctx->num_frame_workers; ++i) {
+      const FrameWorkerData *const frame_worker_data =
+          (const FrameWorkerData *)ctx->frame_workers[i].data1;
+      const vpx_decode_stats *const src = frame_worker_data->pbi->stats;
+      const int thread = VPXMIN(i, VPX_DECODE_STATS_MAX_THREADS - 1);
+      if (src == NULL) continue;
+      stats->frames += src->frames;
+      stats->num_threads = VPXMAX(stats->num_threads, thread + 1);
+      stats->num_tiles = VPXMAX(stats->num_tiles, src->num_tiles);
+      for (s = 0; s < VPX_DECODE_STAGES; ++s) {
+        stats->time[s] += src->time[s];
+        stats->thread_time[thread][s] += src->time[s];
+        for (j = 0; j < src->num_tiles; ++j)
+          stats->tile_time[j][s] += src->tile_time[j][s];
+      }
+    }
+  } else if (ctx->pbi != NULL && ctx->pbi->stats != NULL) {
+    *stats = *ctx->pbi->stats;
+  }
+
+  return VPX_CODEC_OK;
+}
+
 static vpx_codec_ctrl_fn_map_t decoder_ctrl_maps[] = {
   { VP8_COPY_REFERENCE, ctrl_copy_reference },
 
@@ -685,6 +1687,19 @@ static vpx_codec_ctrl_fn_map_t decoder_ctrl_maps[] = {
   { VP9_DECODE_SVC_SPATIAL_LAYER, ctrl_set_spatial_layer_svc },
   { VP9D_SET_ROW_MT, ctrl_set_row_mt },
   { VP9D_SET_LOOP_FILTER_OPT, ctrl_enable_lpf_opt },
+  { VP9D_SET_FRAME_PARALLEL, ctrl_set_frame_parallel },
+  { VP9D_SET_THREAD_POOL, ctrl_set_thread_pool },
+  { VP9D_SET_OUTPUT_FORMAT, ctrl_set_output_format },
+  { VP9D_SET_DECODE_REGION, ctrl_set_decode_region },
+  { VP9D_SET_THUMBNAIL_MODE, ctrl_set_thumbnail_mode },
+  { VP9D_SAVE_CHECKPOINT, ctrl_save_checkpoint },
+  { VP9D_RESTORE_CHECKPOINT, ctrl_restore_checkpoint },
+  { VP9D_RELEASE_CHECKPOINT, ctrl_release_checkpoint },
+  { VP9D_SET_DECODE_MODE, ctrl_set_decode_mode },
+  { VP9D_SET_LOW_MEMORY, ctrl_set_low_memory },
+  { VP9D_SET_FUSED_LOOP_FILTER, ctrl_set_fused_loop_filter },
+  { VP9D_SET_MC_PREFETCH, ctrl_set_mc_prefetch },
+  { VP9D_SET_DECODE_STATS, ctrl_set_decode_stats },
 
   // Getters
   { VPXD_GET_LAST_QUANTIZER, ctrl_get_quantizer },
@@ -694,6 +1709,8 @@ static vpx_codec_ctrl_fn_map_t decoder_ctrl_maps[] = {
   { VP9D_GET_DISPLAY_SIZE, ctrl_get_render_size },
   { VP9D_GET_BIT_DEPTH, ctrl_get_bit_depth },
   { VP9D_GET_FRAME_SIZE, ctrl_get_frame_size },
+  { VP9D_PARSE_FRAME_HEADERS, ctrl_parse_frame_headers },
+  { VP9D_GET_DECODE_STATS, ctrl_get_decode_stats },
 
   { -1, NULL },
 };
@@ -708,7 +1725,8 @@ CODEC_INTERFACE(vpx_codec_vp9_dx) = {
   VPX_CODEC_CAP_HIGHBITDEPTH |
 #endif
       VPX_CODEC_CAP_DECODER | VP9_CAP_POSTPROC |
-      VPX_CODEC_CAP_EXTERNAL_FRAME_BUFFER,  // vpx_codec_caps_t
+      VPX_CODEC_CAP_EXTERNAL_FRAME_BUFFER |
+      VPX_CODEC_CAP_PUT_SLICE,  // vpx_codec_caps_t
   decoder_init,                             // vpx_codec_init_fn_t
   decoder_destroy,                          // vpx_codec_destroy_fn_t
   decoder_ctrl_maps,                        // vpx_codec_ctrl_fn_map_t
@@ -12,9 +12,20 @@
 #define VPX_VP9_VP9_DX_IFACE_H_
 
 #include "vp9/decoder/vp9_decoder.h"
+#include "vp9/decoder/vp9_dthread.h"
 
 typedef vpx_codec_stream_info_t vp9_stream_info_t;
 
+// Frames retired by the frame workers are cached until they are returned by
+// decoder_get_frame(). A decode call retires at most every frame in flight
+// and the frames of one superframe.
+#define FRAME_CACHE_SIZE (MAX_FRAME_WORKERS + 8)
+
+typedef struct cache_frame {
+  int fb_idx;
+  vpx_image_t img;
+} cache_frame;
+
 struct vpx_codec_alg_priv {
   vpx_codec_priv_t base;
   vpx_codec_dec_cfg_t cfg;
@@ -47,6 +58,42 @@ struct vpx_codec_alg_priv {
   int svc_spatial_layer;
   int row_mt;
   int lpf_opt;
+  VPxWorkerPool *thread_pool;
+
+  // Output format conversion. The rows of the frame with its luma plane at
+  // output_src are converted into output_img, using output_fb if the frame
+  // buffers are external, or output_buf. The thumbnails are output in
+  // output_img and output_buf as well.
+  vpx_img_fmt_t output_fmt;
+  vpx_image_t output_img;
+  const uint8_t *output_src;
+  vpx_codec_frame_buffer_t output_fb;
+  uint8_t *output_buf;
+  size_t output_buf_size;
+  int output_error;
+  vpx_image_rect_t decode_region;
+  vpx_thumbnail_mode thumbnail;
+  VP9DecoderCheckpoint *checkpoints[VP9_MAX_DECODER_CHECKPOINTS];
+  vpx_decode_mode decode_mode;
+  int skip_to_key_frame;  // set once an inter frame is skipped
+  int low_memory;
+  int fused_lf;
+  int mc_prefetch;
+  int decode_stats;
+
+  // Frame parallel decode. The frame workers are used in turn, each one
+  // decoding a frame with its own VP9Decoder, and ctx->pbi points at the
+  // decoder of the last retired frame.
+  int frame_parallel;
+  int frame_parallel_decode;
+  VPxWorker *frame_workers;
+  int num_frame_workers;
+  int next_submit_worker_id;
+  int last_submit_worker_id;
+  int next_retire_worker_id;
+  cache_frame frame_cache[FRAME_CACHE_SIZE];
+  int num_cache_frames;
+  int next_cache_frame;
 };
 
 #endif  // VPX_VP9_VP9_DX_IFACE_H_
@@ -16,6 +16,7 @@
 #include <stdlib.h>
 #include "vpx/vpx_integer.h"
 #include "vpx/internal/vpx_codec_internal.h"
+#include "vpx_util/vpx_thread.h"
 #include "vpx_version.h"
 
 #define SAVE_STATUS(ctx, var) (ctx ? (ctx->err = var) : var)
@@ -85,6 +86,14 @@ vpx_codec_caps_t vpx_codec_get_caps(vpx_codec_iface_t *iface) {
   return (iface) ? iface->caps : 0;
 }
 
+vpx_thread_pool_t *vpx_thread_pool_create(int max_threads) {
+  return (vpx_thread_pool_t *)vpx_worker_pool_create(max_threads);
+}
+
+void vpx_thread_pool_destroy(vpx_thread_pool_t *pool) {
+  vpx_worker_pool_destroy((VPxWorkerPool *)pool);
+}
+
 vpx_codec_err_t vpx_codec_control_(vpx_codec_ctx_t *ctx, int ctrl_id, ...) {
   vpx_codec_err_t res;
 
@@ -44,7 +44,8 @@ static vpx_image_t *img_alloc_helper(vpx_image_t *img, vpx_img_fmt_t fmt,
     case VPX_IMG_FMT_I422:
     case VPX_IMG_FMT_I440: bps = 16; break;
     case VPX_IMG_FMT_I444: bps = 24; break;
-    case VPX_IMG_FMT_I42016: bps = 24; break;
+    case VPX_IMG_FMT_I42016:
+    case VPX_IMG_FMT_P010: bps = 24; break;
     case VPX_IMG_FMT_I42216:
     case VPX_IMG_FMT_I44016: bps = 32; break;
     case VPX_IMG_FMT_I44416: bps = 48; break;
@@ -69,6 +70,7 @@ static vpx_image_t *img_alloc_helper(vpx_image_t *img, vpx_img_fmt_t fmt,
     case VPX_IMG_FMT_I440:
     case VPX_IMG_FMT_YV12:
     case VPX_IMG_FMT_I42016:
+    case VPX_IMG_FMT_P010:
     case VPX_IMG_FMT_I44016: ycs = 1; break;
     default: ycs = 0; break;
   }
@@ -177,11 +179,11 @@ int vpx_img_set_rect(vpx_image_t *img, unsigned int x, unsigned int y,
           data + x * bytes_per_sample + y * img->stride[VPX_PLANE_Y];
       data += img->h * img->stride[VPX_PLANE_Y];
 
-      if (img->fmt == VPX_IMG_FMT_NV12) {
+      if (img->fmt == VPX_IMG_FMT_NV12 || img->fmt == VPX_IMG_FMT_P010) {
         img->planes[VPX_PLANE_U] =
-            data + (x >> img->x_chroma_shift) +
+            data + (x >> img->x_chroma_shift) * bytes_per_sample +
             (y >> img->y_chroma_shift) * img->stride[VPX_PLANE_U];
-        img->planes[VPX_PLANE_V] = img->planes[VPX_PLANE_U] + 1;
+        img->planes[VPX_PLANE_V] = img->planes[VPX_PLANE_U] + bytes_per_sample;
       } else if (!(img->fmt & VPX_IMG_FMT_UV_FLIP)) {
         img->planes[VPX_PLANE_U] =
             data + (x >> img->x_chroma_shift) * bytes_per_sample +
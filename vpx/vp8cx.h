@@ -712,6 +712,31 @@ enum vp8e_enc_control_id {
    * Supported in codecs: VP9
    */
   VP9E_SET_EXTERNAL_RATE_CONTROL,
+
+  /*!\brief Codec control function to run the encoder threads on a shared
+   * pool.
+   *
+   * The threads requested by g_threads are taken from the given pool, created
+   * with vpx_thread_pool_create(), instead of being created by the encoder.
+   * A pool can be shared by several encoder and decoder instances, and must
+   * be destroyed after all of them.
+   *
+   * Must be set before the first frame is encoded.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9E_SET_THREAD_POOL,
+
+  /*!\brief Codec control function to enable the segmentation of static
+   * regions.
+   *
+   * The ARF frames of a two pass encode search the frames of their GF group
+   * for the blocks that do not change, and code them in a segment of their
+   * own. 0 is off, 1 is on. The default value is 0.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9E_SET_STATIC_SEGMENTATION,
 };
 
 /*!\brief vpx 1-D scaling mode
@@ -1071,6 +1096,12 @@ VPX_CTRL_USE_TYPE(VP9E_SET_DISABLE_LOOPFILTER, int)
 VPX_CTRL_USE_TYPE(VP9E_SET_EXTERNAL_RATE_CONTROL, vpx_rc_funcs_t *)
 #define VPX_CTRL_VP9E_SET_EXTERNAL_RATE_CONTROL
 
+VPX_CTRL_USE_TYPE(VP9E_SET_THREAD_POOL, vpx_thread_pool_t *)
+#define VPX_CTRL_VP9E_SET_THREAD_POOL
+
+VPX_CTRL_USE_TYPE(VP9E_SET_STATIC_SEGMENTATION, unsigned int)
+#define VPX_CTRL_VP9E_SET_STATIC_SEGMENTATION
+
 /*!\endcond */
 /*! @} - end defgroup vp8_encoder */
 #ifdef __cplusplus
@@ -142,6 +142,233 @@ enum vp8_dec_control_id {
    */
   VP9D_SET_LOOP_FILTER_OPT,
 
+  /*!\brief Codec control function to enable frame parallel decoding.
+   *
+   * 0 : off, frames are decoded one after another (default)
+   * 1 : on, up to cfg.threads frames are decoded at the same time, each one
+   *     waiting only for the reference rows it predicts from. Frames are
+   *     output with a delay, call vpx_codec_decode() with NULL data to flush
+   *     the remaining ones at the end of the stream. Has no effect with a
+   *     single thread, when postprocessing is enabled or when a put_slice
+   *     callback is registered.
+   *
+   * Must be set before the first frame is decoded.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9D_SET_FRAME_PARALLEL,
+
+  /*!\brief Codec control function to run the decoder threads on a shared
+   * pool.
+   *
+   * The threads requested by cfg.threads are taken from the given pool,
+   * created with vpx_thread_pool_create(), instead of being created by the
+   * decoder. A pool can be shared by several decoder and encoder instances,
+   * and must be destroyed after all of them. NULL detaches the decoder from
+   * the pool (default).
+   *
+   * Must be set before the first frame is decoded.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9D_SET_THREAD_POOL,
+
+  /*!\brief Codec control function to set the format of the output frames.
+   *
+   * VPX_IMG_FMT_NONE : frames are output in the format they are decoded in
+   *                    (default)
+   * VPX_IMG_FMT_NV12 : 8-bit 4:2:0 frames are output as NV12
+   * VPX_IMG_FMT_P010 : 10-bit 4:2:0 frames are output as P010
+   *
+   * The rows are converted as soon as they are decoded, into frame buffers
+   * taken from the external frame buffer functions if they are set. Other
+   * frames, and frames output with postprocessing, keep their format. Frame
+   * parallel decoding is not used with a format set.
+   *
+   * Must be set before the first frame is decoded.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9D_SET_OUTPUT_FORMAT,
+
+  /*!\brief Codec control function to set the region of the frames to decode,
+   * in pixels. NULL, or a region with a width or height of 0, decodes the
+   * whole frames (default).
+   *
+   * The superblocks away from the region are parsed but not reconstructed or
+   * loop filtered, and their pixels in the output frames are undefined. The
+   * superblocks within 128 pixels of the region are reconstructed as well,
+   * so the region decodes as in the whole frames as long as the motion
+   * vectors into it do not reach further. The pixels brought into the region
+   * by moving it may be wrong until the next key frame.
+   *
+   * Can be changed between frames.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9D_SET_DECODE_REGION,
+
+  /*!\brief Codec control function to decode reduced size thumbnails, with a
+   * pointer to a vpx_thumbnail_mode. NULL, or a scale_log2 of 0, decodes full
+   * size frames (default).
+   *
+   * The frames are output scaled down by 1 << scale_log2, averaging the
+   * blocks of pixels, and are not loop filtered. Only the key frames are
+   * decoded, the other frames are skipped without output, unless
+   * inter_frames is set. The inter frames then drift a little from the
+   * frames decoded without loop filter.
+   *
+   * The output format set with VP9D_SET_OUTPUT_FORMAT does not apply, and
+   * the slices passed to the put_slice callback are at full size. Frame
+   * parallel decoding is not used with thumbnails.
+   *
+   * Must be set before the first frame is decoded.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9D_SET_THUMBNAIL_MODE,
+
+  /*!\brief Codec control function to parse the frame headers of a chunk of
+   * compressed data without decoding it, with a pointer to a
+   * vpx_frame_header_list.
+   *
+   * The frames of a superframe are listed in order, with their position in
+   * the chunk. Their type, the reference buffers they use and refresh, and
+   * their size when coded, are read from the uncompressed headers only, at a
+   * small fraction of the cost of decoding. This is enough to build a seek
+   * index. The decoder is not changed, and chunks can be parsed before the
+   * first frame is decoded. If max_frames is too small, num_frames is set
+   * and VPX_CODEC_INVALID_PARAM is returned.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9D_PARSE_FRAME_HEADERS,
+
+  /*!\brief Codec control function to save the decoder state after the last
+   * decoded frame in a checkpoint, with an int parameter, the checkpoint
+   * from 0 to VP9_MAX_DECODER_CHECKPOINTS - 1.
+   *
+   * The checkpoint holds a copy of the reference frames, the entropy
+   * contexts, the segmentation and the motion vectors of the last frame, and
+   * replaces the one saved before if any. Restored with
+   * VP9D_RESTORE_CHECKPOINT, decoding goes on from the frame after the
+   * checkpoint as it did when the checkpoint was saved, so seeking only
+   * needs the frames from the last checkpoint before the target instead of
+   * the last key frame. The decoder keeps the checkpoints until they are
+   * released with VP9D_RELEASE_CHECKPOINT, or the decoder is destroyed.
+   *
+   * Not supported in frame parallel mode.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9D_SAVE_CHECKPOINT,
+
+  /*!\brief Codec control function to restore the decoder state saved in a
+   * checkpoint with VP9D_SAVE_CHECKPOINT, int parameter.
+   *
+   * The decoder then has no frame to output until the next one is decoded.
+   * If the restore fails, the decoder waits for a key frame.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9D_RESTORE_CHECKPOINT,
+
+  /*!\brief Codec control function to free a checkpoint saved with
+   * VP9D_SAVE_CHECKPOINT, int parameter.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9D_RELEASE_CHECKPOINT,
+
+  /*!\brief Codec control function to skip frames for trick play, int
+   * parameter, one of the vpx_decode_mode values. Default is
+   * VPX_DECODE_ALL_FRAMES.
+   *
+   * Only the uncompressed header of a skipped frame is read, and the decode
+   * call returns no frame for it. VPX_DECODE_KEY_FRAMES skips every frame but
+   * the key frames. Once a frame is skipped this way, the frames that follow
+   * are skipped until the next key frame whatever the mode. With
+   * VPX_DECODE_REFERENCE_FRAMES, the error resilient frames that refresh no
+   * reference buffer are skipped, such as the upper temporal layers of a
+   * real-time stream: the other frames decode as they would otherwise, as
+   * long as they are error resilient too. Other frames carry the entropy
+   * contexts and motion vectors of the frames before them forward, and are
+   * not skipped.
+   *
+   * Can be changed between frames.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9D_SET_DECODE_MODE,
+
+  /*!\brief Codec control function to reduce the memory held by the decoder.
+   *
+   * 0 : off (default), the buffers sized by the frame dimensions only grow
+   * 1 : on, they are resized to the current frame dimensions when these
+   *     shrink, the internal frame buffers that are not in use are freed
+   *     when their size no longer matches the frames, and the motion vectors
+   *     are only kept for the previous frame instead of every frame buffer.
+   *     The output is the same, for more reallocations on resolution
+   *     changes. Has no effect with frame parallel decoding.
+   *
+   * Must be set before the first frame is decoded.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9D_SET_LOW_MEMORY,
+
+  /*!\brief Codec control function to fuse the loop filter with the decoding
+   * of the superblocks when decoding with a single thread.
+   *
+   * 0 : off (default), each superblock row is filtered once the next one is
+   *     decoded
+   * 1 : on, each superblock is filtered once the next one is decoded, while
+   *     its pixels are still in the cache. Helps when a superblock row does
+   *     not fit in the cache, as with 4K frames on small L2 caches. Has no
+   *     effect with several threads or VP9_INVERT_TILE_DECODE_ORDER.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9D_SET_FUSED_LOOP_FILTER,
+
+  /*!\brief Codec control function to prefetch the reference blocks of the
+   * motion compensation in row based multi-threaded decoding.
+   *
+   * 0 : off (default)
+   * 1 - 8 : on, the reference blocks of each superblock are prefetched while
+   *     the superblock this many to its left is reconstructed. The motion
+   *     vectors are known then, as a superblock row is parsed before it is
+   *     reconstructed. Helps when the reference blocks miss the cache, as
+   *     with large motion in 4K frames. Has no effect without
+   *     VP9D_SET_ROW_MT.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9D_SET_MC_PREFETCH,
+
+  /*!\brief Codec control function to time the stages of the decoding.
+   *
+   * 0 : off (default)
+   * 1 : on, the time spent in each stage of the decoding of the next frames,
+   *     one of the vpx_decode_stage values, is added up per thread and per
+   *     tile, and read with VP9D_GET_DECODE_STATS. The times start from 0
+   *     each time the control is set to 1. Timing the stages slows the
+   *     decoding down a little, and not at all when off.
+   *
+   * Can be changed between frames.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9D_SET_DECODE_STATS,
+
+  /*!\brief Codec control function to get the times of the stages of the
+   * decoding, collected since VP9D_SET_DECODE_STATS was set to 1, with a
+   * pointer to a vpx_decode_stats.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9D_GET_DECODE_STATS,
+
   VP8_DECODER_CTRL_ID_MAX
 };
 
@@ -163,6 +390,157 @@ typedef struct vpx_decrypt_init {
   void *decrypt_state;
 } vpx_decrypt_init;
 
+/*!\brief Frames decoded with VP9D_SET_DECODE_MODE */
+typedef enum vpx_decode_mode {
+  VPX_DECODE_ALL_FRAMES = 0,      /**< Decode all the frames */
+  VPX_DECODE_KEY_FRAMES = 1,      /**< Decode the key frames only */
+  VPX_DECODE_REFERENCE_FRAMES = 2 /**< Skip the frames no other frame uses */
+} vpx_decode_mode;
+
+/*!\brief Number of checkpoints of VP9D_SAVE_CHECKPOINT */
+#define VP9_MAX_DECODER_CHECKPOINTS 16
+
+/*!\brief Thumbnail decode settings
+ *
+ * Defines the scale and frames of the thumbnail decode set with
+ * VP9D_SET_THUMBNAIL_MODE.
+ */
+typedef struct vpx_thumbnail_mode {
+  /*! Log2 of the scale down of the output frames, from 0 to 3. */
+  int scale_log2;
+
+  /*! Decode and output the inter frames too. */
+  int inter_frames;
+} vpx_thumbnail_mode;
+
+/*!\brief Uncompressed header of a frame
+ *
+ * Defines the frame information read by VP9D_PARSE_FRAME_HEADERS.
+ */
+typedef struct vpx_frame_header_info {
+  /*! Offset of the frame in the chunk, in bytes. */
+  size_t offset;
+
+  /*! Size of the frame, in bytes. */
+  size_t size;
+
+  /*! The frame only shows the reference buffer frame_to_show. */
+  int show_existing_frame;
+
+  /*! Reference buffer shown by the frame, or -1. */
+  int frame_to_show;
+
+  /*! The frame is a key frame. */
+  int is_key_frame;
+
+  /*! The frame is an intra-only frame. */
+  int intra_only;
+
+  /*! The frame is shown. */
+  int show_frame;
+
+  /*! The frame is coded in error resilient mode. */
+  int error_resilient;
+
+  /*! Bit mask of the reference buffers the frame is stored in. */
+  int refresh_frame_flags;
+
+  /*! Reference buffers of the last, golden and altref frames an inter frame
+   * is predicted from, or -1. */
+  int ref_frame_idx[3];
+
+  /*! Index in ref_frame_idx of the reference the frame takes its size from,
+   * or -1 if the size is coded. */
+  int size_from_ref;
+
+  /*! Frame width when coded, or 0. */
+  unsigned int width;
+
+  /*! Frame height when coded, or 0. */
+  unsigned int height;
+} vpx_frame_header_info;
+
+/*!\brief Frame headers of a chunk of compressed data
+ *
+ * Defines the chunk parsed by VP9D_PARSE_FRAME_HEADERS, and the headers it
+ * reads.
+ */
+typedef struct vpx_frame_header_list {
+  /*! Chunk to parse, as passed to vpx_codec_decode(). */
+  const uint8_t *data;
+
+  /*! Size of the chunk, in bytes. */
+  size_t data_sz;
+
+  /*! Headers of the frames of the chunk. */
+  vpx_frame_header_info *frames;
+
+  /*! Number of entries in frames. A superframe holds up to 8 frames. */
+  int max_frames;
+
+  /*! Number of frames in the chunk. */
+  int num_frames;
+} vpx_frame_header_list;
+
+/*!\brief Stages of the decoding timed with VP9D_SET_DECODE_STATS */
+typedef enum vpx_decode_stage {
+  /*! Frame headers, and probability updates and adaptation. */
+  VPX_DECODE_STAGE_HEADER = 0,
+  /*! Partitions, modes and motion vectors. */
+  VPX_DECODE_STAGE_MODE_INFO = 1,
+  /*! Coefficient tokens. */
+  VPX_DECODE_STAGE_COEFFS = 2,
+  /*! Intra and inter prediction. */
+  VPX_DECODE_STAGE_PREDICTION = 3,
+  /*! Inverse transforms. */
+  VPX_DECODE_STAGE_INV_TRANSFORM = 4,
+  /*! Loop filter, without the waits for other rows. */
+  VPX_DECODE_STAGE_LOOP_FILTER = 5,
+  /*! Postprocessing. */
+  VPX_DECODE_STAGE_POSTPROC = 6,
+  /*! Idle in the job queue of row based multi-threaded decoding. */
+  VPX_DECODE_STAGE_JOB_WAIT = 7,
+  /*! Waiting for the rows the loop filter of a row depends on. */
+  VPX_DECODE_STAGE_LF_SYNC_WAIT = 8,
+  /*! Number of stages. */
+  VPX_DECODE_STAGES = 9
+} vpx_decode_stage;
+
+/*!\brief Number of threads and tiles of vpx_decode_stats */
+#define VPX_DECODE_STATS_MAX_THREADS 64
+#define VPX_DECODE_STATS_MAX_TILES 256
+
+/*!\brief Decoding times
+ *
+ * Defines the times read by VP9D_GET_DECODE_STATS, in nanoseconds, indexed
+ * by vpx_decode_stage.
+ */
+typedef struct vpx_decode_stats {
+  /*! Number of frames decoded. */
+  unsigned int frames;
+
+  /*! Time of each stage, on all the threads. */
+  int64_t time[VPX_DECODE_STAGES];
+
+  /*! Number of entries used in thread_time. */
+  int num_threads;
+
+  /*! Time of each stage per thread. Entry i holds the times of decoder
+   * thread i, and entry 0 also the work of the thread calling
+   * vpx_codec_decode(): the headers, the postprocessing and the single
+   * threaded decoding. The threads beyond the last entry are counted in it.
+   * In frame parallel mode, entry i holds the times of frame worker i. */
+  int64_t thread_time[VPX_DECODE_STATS_MAX_THREADS][VPX_DECODE_STAGES];
+
+  /*! Number of entries used in tile_time. */
+  int num_tiles;
+
+  /*! Time of the stages run within the tiles, per tile, indexed by
+   * tile_row * tile_cols + tile_col. The tiles of frames with different
+   * tile layouts add up by index. */
+  int64_t tile_time[VPX_DECODE_STATS_MAX_TILES][VPX_DECODE_STAGES];
+} vpx_decode_stats;
+
 /*!\cond */
 /*!\brief VP8 decoder control function parameter type
  *
@@ -199,6 +577,36 @@ VPX_CTRL_USE_TYPE(VP9_SET_SKIP_LOOP_FILTER, int)
 VPX_CTRL_USE_TYPE(VP9D_SET_ROW_MT, int)
 #define VPX_CTRL_VP9_SET_LOOP_FILTER_OPT
 VPX_CTRL_USE_TYPE(VP9D_SET_LOOP_FILTER_OPT, int)
+#define VPX_CTRL_VP9_DECODE_SET_FRAME_PARALLEL
+VPX_CTRL_USE_TYPE(VP9D_SET_FRAME_PARALLEL, int)
+#define VPX_CTRL_VP9_DECODE_SET_THREAD_POOL
+VPX_CTRL_USE_TYPE(VP9D_SET_THREAD_POOL, vpx_thread_pool_t *)
+#define VPX_CTRL_VP9_DECODE_SET_OUTPUT_FORMAT
+VPX_CTRL_USE_TYPE(VP9D_SET_OUTPUT_FORMAT, int)
+#define VPX_CTRL_VP9_DECODE_SET_DECODE_REGION
+VPX_CTRL_USE_TYPE(VP9D_SET_DECODE_REGION, vpx_image_rect_t *)
+#define VPX_CTRL_VP9_DECODE_SET_THUMBNAIL_MODE
+VPX_CTRL_USE_TYPE(VP9D_SET_THUMBNAIL_MODE, vpx_thumbnail_mode *)
+#define VPX_CTRL_VP9_DECODE_PARSE_FRAME_HEADERS
+VPX_CTRL_USE_TYPE(VP9D_PARSE_FRAME_HEADERS, vpx_frame_header_list *)
+#define VPX_CTRL_VP9_DECODE_SAVE_CHECKPOINT
+VPX_CTRL_USE_TYPE(VP9D_SAVE_CHECKPOINT, int)
+#define VPX_CTRL_VP9_DECODE_RESTORE_CHECKPOINT
+VPX_CTRL_USE_TYPE(VP9D_RESTORE_CHECKPOINT, int)
+#define VPX_CTRL_VP9_DECODE_RELEASE_CHECKPOINT
+VPX_CTRL_USE_TYPE(VP9D_RELEASE_CHECKPOINT, int)
+#define VPX_CTRL_VP9_DECODE_SET_DECODE_MODE
+VPX_CTRL_USE_TYPE(VP9D_SET_DECODE_MODE, int)
+#define VPX_CTRL_VP9_DECODE_SET_LOW_MEMORY
+VPX_CTRL_USE_TYPE(VP9D_SET_LOW_MEMORY, int)
+#define VPX_CTRL_VP9_DECODE_SET_FUSED_LOOP_FILTER
+VPX_CTRL_USE_TYPE(VP9D_SET_FUSED_LOOP_FILTER, int)
+#define VPX_CTRL_VP9_DECODE_SET_MC_PREFETCH
+VPX_CTRL_USE_TYPE(VP9D_SET_MC_PREFETCH, int)
+#define VPX_CTRL_VP9_DECODE_SET_DECODE_STATS
+VPX_CTRL_USE_TYPE(VP9D_SET_DECODE_STATS, int)
+#define VPX_CTRL_VP9_DECODE_GET_DECODE_STATS
+VPX_CTRL_USE_TYPE(VP9D_GET_DECODE_STATS, vpx_decode_stats *)
 
 /*!\endcond */
 /*! @} - end defgroup vp8_decoder */
@@ -360,6 +360,34 @@ vpx_codec_err_t vpx_codec_destroy(vpx_codec_ctx_t *ctx);
  */
 vpx_codec_caps_t vpx_codec_get_caps(vpx_codec_iface_t *iface);
 
+/*!\brief Shared thread pool
+ *
+ * Opaque set of threads that codec instances can share instead of creating
+ * their own, see #VP9D_SET_THREAD_POOL and #VP9E_SET_THREAD_POOL.
+ */
+typedef struct vpx_thread_pool vpx_thread_pool_t;
+
+/*!\brief Create a shared thread pool
+ *
+ * The threads are started on demand, up to max_threads. The work of all the
+ * attached instances is run in the order it is submitted.
+ *
+ * \param[in] max_threads   Maximum number of threads of the pool
+ *
+ * \retval NULL
+ *     Memory allocation failed, max_threads is not positive or the library
+ *     was built without multithreading support.
+ */
+vpx_thread_pool_t *vpx_thread_pool_create(int max_threads);
+
+/*!\brief Destroy a shared thread pool
+ *
+ * All the codec instances attached to the pool must have been destroyed.
+ *
+ * \param[in] pool   Pool returned by vpx_thread_pool_create()
+ */
+void vpx_thread_pool_destroy(vpx_thread_pool_t *pool);
+
 /*!\brief Control algorithm
  *
  * This function is used to exchange algorithm specific data with the codec
@@ -284,7 +284,10 @@ vpx_codec_err_t vpx_codec_register_put_frame_cb(vpx_codec_ctx_t *ctx,
 /*!\brief put slice callback prototype
  *
  * This callback is invoked by the decoder to notify the application of
- * the availability of partially decoded image data.
+ * the availability of partially decoded image data. The rows of update, and
+ * all the rows of valid, will not change anymore. The callback may be
+ * invoked from a thread of the decoder, before vpx_codec_decode() returns.
+ * The calls for a frame do not overlap and cover its rows top to bottom.
  */
 typedef void (*vpx_codec_put_slice_cb_fn_t)(void *user_priv,
                                             const vpx_image_t *img,
@@ -321,7 +324,7 @@ vpx_codec_err_t vpx_codec_register_put_slice_cb(vpx_codec_ctx_t *ctx,
  * will result in an error code being returned, usually VPX_CODEC_INCAPABLE.
  *
  * \note
- * Currently this only works with VP9.
+ * Currently this works with VP8 and VP9.
  * @{
  */
 
@@ -350,7 +353,8 @@ vpx_codec_err_t vpx_codec_register_put_slice_cb(vpx_codec_ctx_t *ctx,
  * \note
  * When decoding VP9, the application may be required to pass in at least
  * #VP9_MAXIMUM_REF_BUFFERS + #VPX_MAXIMUM_WORK_BUFFERS external frame
- * buffers.
+ * buffers. VP8 uses at most 4 frame buffers at a time, one of them being the
+ * last returned frame, which stays valid until the next call to decode.
  */
 vpx_codec_err_t vpx_codec_set_frame_buffer_functions(
     vpx_codec_ctx_t *ctx, vpx_get_frame_buffer_cb_fn_t cb_get,
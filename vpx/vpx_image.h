@@ -47,7 +47,10 @@ typedef enum vpx_img_fmt {
   VPX_IMG_FMT_I42016 = VPX_IMG_FMT_I420 | VPX_IMG_FMT_HIGHBITDEPTH,
   VPX_IMG_FMT_I42216 = VPX_IMG_FMT_I422 | VPX_IMG_FMT_HIGHBITDEPTH,
   VPX_IMG_FMT_I44416 = VPX_IMG_FMT_I444 | VPX_IMG_FMT_HIGHBITDEPTH,
-  VPX_IMG_FMT_I44016 = VPX_IMG_FMT_I440 | VPX_IMG_FMT_HIGHBITDEPTH
+  VPX_IMG_FMT_I44016 = VPX_IMG_FMT_I440 | VPX_IMG_FMT_HIGHBITDEPTH,
+  /*!\brief NV12 with 16 bit samples, holding 10 bit values in their most
+   * significant bits. */
+  VPX_IMG_FMT_P010 = VPX_IMG_FMT_NV12 | VPX_IMG_FMT_HIGHBITDEPTH
 } vpx_img_fmt_t; /**< alias for enum vpx_img_fmt */
 
 /*!\brief List of supported color spaces */
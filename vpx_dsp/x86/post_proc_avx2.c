@@ -0,0 +1,256 @@
+/*
+ *  Copyright (c) 2026 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <assert.h>
+#include <immintrin.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "./vpx_dsp_rtcd.h"
+#include "vpx/vpx_integer.h"
+#include "vpx_ports/mem.h"
+
+extern const int16_t vpx_rv[];
+
+static INLINE __m256i abs_diff_u8(const __m256i a, const __m256i b) {
+  return _mm256_or_si256(_mm256_subs_epu8(a, b), _mm256_subs_epu8(b, a));
+}
+
+// Averages v with its 4 neighbors, a2 and a1 on one side and b1 and b2 on the
+// other, where all of them differ from v by less than f.
+static INLINE __m256i filter_5tap(const __m256i a2, const __m256i a1,
+                                  const __m256i v, const __m256i b1,
+                                  const __m256i b2, const __m256i f) {
+  const __m256i diff = _mm256_max_epu8(
+      _mm256_max_epu8(abs_diff_u8(v, a2), abs_diff_u8(v, a1)),
+      _mm256_max_epu8(abs_diff_u8(v, b1), abs_diff_u8(v, b2)));
+  // diff >= f where f - diff saturates to 0.
+  const __m256i keep = _mm256_cmpeq_epi8(_mm256_subs_epu8(f, diff),
+                                         _mm256_setzero_si256());
+  const __m256i k1 = _mm256_avg_epu8(a2, a1);
+  const __m256i k2 = _mm256_avg_epu8(b2, b1);
+  const __m256i k3 = _mm256_avg_epu8(k1, k2);
+  return _mm256_blendv_epi8(_mm256_avg_epu8(k3, v), v, keep);
+}
+
+static INLINE __m256i load_u8_32(const uint8_t *p) {
+  return _mm256_loadu_si256((const __m256i *)p);
+}
+
+static INLINE int filter_5tap_c(int a2, int a1, int v, int b1, int b2, int f) {
+  if (abs(v - a2) < f && abs(v - a1) < f && abs(v - b1) < f &&
+      abs(v - b2) < f) {
+    const int k1 = (a2 + a1 + 1) >> 1;
+    const int k2 = (b2 + b1 + 1) >> 1;
+    const int k3 = (k1 + k2 + 1) >> 1;
+    v = (k3 + v + 1) >> 1;
+  }
+  return v;
+}
+
+// Filters a row of dst in place, reading the pixels as they were before the
+// row is modified. dst[-2], dst[-1], dst[cols] and dst[cols + 1] are the
+// extended edges.
+static void post_proc_across(uint8_t *dst, int cols, const uint8_t *flimits) {
+  uint8_t left[2];
+  int col = 0;
+
+  if (cols >= 32) {
+    __m256i out = filter_5tap(load_u8_32(dst - 2), load_u8_32(dst - 1),
+                              load_u8_32(dst), load_u8_32(dst + 1),
+                              load_u8_32(dst + 2), load_u8_32(flimits));
+    // Each block is stored once the next one has read its left neighbors.
+    for (col = 32; col + 32 <= cols; col += 32) {
+      const uint8_t *const p = dst + col;
+      const __m256i next = filter_5tap(
+          load_u8_32(p - 2), load_u8_32(p - 1), load_u8_32(p),
+          load_u8_32(p + 1), load_u8_32(p + 2), load_u8_32(flimits + col));
+      _mm256_storeu_si256((__m256i *)(dst + col - 32), out);
+      out = next;
+    }
+    left[0] = dst[col - 2];
+    left[1] = dst[col - 1];
+    _mm256_storeu_si256((__m256i *)(dst + col - 32), out);
+  } else {
+    left[0] = dst[-2];
+    left[1] = dst[-1];
+  }
+
+  if (col < cols) {
+    uint8_t s[2 + 31 + 2];
+    const int n = cols - col;
+    int i;
+    s[0] = left[0];
+    s[1] = left[1];
+    memcpy(s + 2, dst + col, n + 2);
+    for (i = 0; i < n; ++i) {
+      dst[col + i] = filter_5tap_c(s[i], s[i + 1], s[i + 2], s[i + 3],
+                                   s[i + 4], flimits[col + i]);
+    }
+  }
+}
+
+void vpx_post_proc_down_and_across_mb_row_avx2(unsigned char *src,
+                                               unsigned char *dst,
+                                               int src_pitch, int dst_pitch,
+                                               int cols,
+                                               unsigned char *flimits,
+                                               int size) {
+  int row;
+
+  assert(size >= 8);
+  assert(cols >= 8);
+
+  for (row = 0; row < size; row++) {
+    int col;
+
+    // post_proc_down
+    for (col = 0; col + 32 <= cols; col += 32) {
+      const uint8_t *const s = src + col;
+      const __m256i out = filter_5tap(
+          load_u8_32(s - 2 * src_pitch), load_u8_32(s - src_pitch),
+          load_u8_32(s), load_u8_32(s + src_pitch),
+          load_u8_32(s + 2 * src_pitch), load_u8_32(flimits + col));
+      _mm256_storeu_si256((__m256i *)(dst + col), out);
+    }
+    for (; col < cols; col++) {
+      dst[col] = filter_5tap_c(src[col - 2 * src_pitch], src[col - src_pitch],
+                               src[col], src[col + src_pitch],
+                               src[col + 2 * src_pitch], flimits[col]);
+    }
+
+    // post_proc_across
+    dst[-2] = dst[-1] = dst[0];
+    dst[cols] = dst[cols + 1] = dst[cols - 1];
+    post_proc_across(dst, cols, flimits);
+
+    src += src_pitch;
+    dst += dst_pitch;
+  }
+}
+
+void vpx_mbpost_proc_down_avx2(unsigned char *dst, int pitch, int rows,
+                               int cols, int flimit) {
+  int col;
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i f = _mm256_set1_epi32(flimit);
+  DECLARE_ALIGNED(32, int16_t, above_context[8 * 16]);
+
+  // If rows is less than 8 the bottom border extension fails.
+  assert(cols % 8 == 0);
+  assert(rows >= 8);
+
+  // 16 columns are processed at a time, as in the SSE2 version with 8.
+  for (col = 0; col + 16 <= cols; col += 16) {
+    unsigned char *const d = dst + col;
+    int row, i;
+    __m256i s = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)d));
+    __m256i sum, sumsq_0, sumsq_1;
+    __m256i tmp_0, tmp_1;
+    __m256i below_context = s;
+
+    for (i = 0; i < 8; ++i) {
+      _mm256_store_si256((__m256i *)above_context + i, s);
+    }
+
+    // sum *= 9
+    sum = _mm256_slli_epi16(s, 3);
+    sum = _mm256_add_epi16(s, sum);
+
+    // sum^2 * 9 == (sum * 9) * sum
+    tmp_0 = _mm256_mullo_epi16(sum, s);
+    tmp_1 = _mm256_mulhi_epi16(sum, s);
+
+    // The 32 bit sums hold the columns in the order of the unpacks, which the
+    // pack of the masks restores.
+    sumsq_0 = _mm256_unpacklo_epi16(tmp_0, tmp_1);
+    sumsq_1 = _mm256_unpackhi_epi16(tmp_0, tmp_1);
+
+    // Prime sum/sumsq
+    for (i = 1; i <= 6; ++i) {
+      __m256i a = _mm256_cvtepu8_epi16(
+          _mm_loadu_si128((const __m128i *)(d + i * pitch)));
+      sum = _mm256_add_epi16(sum, a);
+      a = _mm256_mullo_epi16(a, a);
+      sumsq_0 = _mm256_add_epi32(sumsq_0, _mm256_unpacklo_epi16(a, zero));
+      sumsq_1 = _mm256_add_epi32(sumsq_1, _mm256_unpackhi_epi16(a, zero));
+    }
+
+    for (row = 0; row < rows; row++) {
+      const __m256i above =
+          _mm256_load_si256((const __m256i *)above_context + (row & 7));
+      const __m256i this_row = _mm256_cvtepu8_epi16(
+          _mm_loadu_si128((const __m128i *)(d + row * pitch)));
+      __m256i above_sq, below_sq;
+      __m256i mask_0, mask_1;
+      __m256i multmp_0, multmp_1;
+      __m256i rv;
+      __m256i out;
+
+      // Past the bottom the last row is repeated.
+      if (row + 7 < rows) {
+        below_context = _mm256_cvtepu8_epi16(
+            _mm_loadu_si128((const __m128i *)(d + (row + 7) * pitch)));
+      }
+
+      sum = _mm256_sub_epi16(sum, above);
+      sum = _mm256_add_epi16(sum, below_context);
+
+      above_sq = _mm256_mullo_epi16(above, above);
+      sumsq_0 =
+          _mm256_sub_epi32(sumsq_0, _mm256_unpacklo_epi16(above_sq, zero));
+      sumsq_1 =
+          _mm256_sub_epi32(sumsq_1, _mm256_unpackhi_epi16(above_sq, zero));
+
+      below_sq = _mm256_mullo_epi16(below_context, below_context);
+      sumsq_0 =
+          _mm256_add_epi32(sumsq_0, _mm256_unpacklo_epi16(below_sq, zero));
+      sumsq_1 =
+          _mm256_add_epi32(sumsq_1, _mm256_unpackhi_epi16(below_sq, zero));
+
+      // sumsq * 16 - sumsq == sumsq * 15
+      mask_0 = _mm256_sub_epi32(_mm256_slli_epi32(sumsq_0, 4), sumsq_0);
+      mask_1 = _mm256_sub_epi32(_mm256_slli_epi32(sumsq_1, 4), sumsq_1);
+
+      multmp_0 = _mm256_mullo_epi16(sum, sum);
+      multmp_1 = _mm256_mulhi_epi16(sum, sum);
+
+      mask_0 =
+          _mm256_sub_epi32(mask_0, _mm256_unpacklo_epi16(multmp_0, multmp_1));
+      mask_1 =
+          _mm256_sub_epi32(mask_1, _mm256_unpackhi_epi16(multmp_0, multmp_1));
+
+      // mask - f gives a negative value when mask < f
+      mask_0 = _mm256_srai_epi32(_mm256_sub_epi32(mask_0, f), 31);
+      mask_1 = _mm256_srai_epi32(_mm256_sub_epi32(mask_1, f), 31);
+      mask_0 = _mm256_packs_epi32(mask_0, mask_1);
+
+      // Columns 8 to 15 use the same noise as columns 0 to 7.
+      rv = _mm256_broadcastsi128_si256(
+          _mm_loadu_si128((const __m128i *)(vpx_rv + (row & 127))));
+
+      mask_1 = _mm256_add_epi16(rv, sum);
+      mask_1 = _mm256_add_epi16(mask_1, this_row);
+      mask_1 = _mm256_srai_epi16(mask_1, 4);
+
+      out = _mm256_or_si256(_mm256_and_si256(mask_0, mask_1),
+                            _mm256_andnot_si256(mask_0, this_row));
+      out = _mm256_permute4x64_epi64(_mm256_packus_epi16(out, out), 0xd8);
+      _mm_storeu_si128((__m128i *)(d + row * pitch),
+                       _mm256_castsi256_si128(out));
+
+      _mm256_store_si256((__m256i *)above_context + (row & 7), this_row);
+    }
+  }
+
+  if (col < cols) {
+    vpx_mbpost_proc_down_c(dst + col, pitch, rows, cols - col, flimit);
+  }
+}
@@ -27,6 +27,13 @@
 #define __builtin_prefetch(x)
 #endif
 
+/* Hint to load the cache line at address x, which need not be valid. */
+#if (defined(__GNUC__) && __GNUC__) || defined(__clang__)
+#define VPX_PREFETCH(x) __builtin_prefetch(x)
+#else
+#define VPX_PREFETCH(x) (void)(x)
+#endif
+
 /* Shift down with rounding */
 #define ROUND_POWER_OF_TWO(value, n) (((value) + (1 << ((n)-1))) >> (n))
 #define ROUND64_POWER_OF_TWO(value, n) (((value) + (1ULL << ((n)-1))) >> (n))
@@ -32,6 +32,7 @@
  * POSIX specific includes
  */
 #include <sys/time.h>
+#include <time.h>
 
 /* timersub is not provided by msys at this time. */
 #ifndef timersub
@@ -87,6 +88,24 @@ static INLINE int64_t vpx_usec_timer_elapsed(struct vpx_usec_timer *t) {
 #endif
 }
 
+/* Returns the time of a monotonic clock, in nanoseconds. Cheaper than a
+ * vpx_usec_timer for timing short operations. */
+static INLINE int64_t vpx_nsec_time(void) {
+#if defined(_WIN32)
+  LARGE_INTEGER now, freq;
+
+  QueryPerformanceCounter(&now);
+  QueryPerformanceFrequency(&freq);
+  return now.QuadPart / freq.QuadPart * 1000000000 +
+         now.QuadPart % freq.QuadPart * 1000000000 / freq.QuadPart;
+#else
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+#endif
+}
+
 #else /* CONFIG_OS_SUPPORT = 0*/
 
 /* Empty timer functions if CONFIG_OS_SUPPORT = 0 */
@@ -104,6 +123,8 @@ static INLINE void vpx_usec_timer_mark(struct vpx_usec_timer *t) {}
 
 static INLINE int vpx_usec_timer_elapsed(struct vpx_usec_timer *t) { return 0; }
 
+static INLINE int64_t vpx_nsec_time(void) { return 0; }
+
 #endif /* CONFIG_OS_SUPPORT */
 
 #endif  // VPX_VPX_PORTS_VPX_TIMER_H_
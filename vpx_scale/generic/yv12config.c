@@ -47,8 +47,11 @@ int vp8_yv12_de_alloc_frame_buffer(YV12_BUFFER_CONFIG *ybf) {
   return 0;
 }
 
-int vp8_yv12_realloc_frame_buffer(YV12_BUFFER_CONFIG *ybf, int width,
-                                  int height, int border) {
+static int vp8_realloc_frame_buffer(YV12_BUFFER_CONFIG *ybf, int width,
+                                    int height, int border,
+                                    vpx_codec_frame_buffer_t *fb,
+                                    vpx_get_frame_buffer_cb_fn_t cb,
+                                    void *cb_priv) {
   if (ybf) {
     int aligned_width = (width + 15) & ~15;
     int aligned_height = (height + 15) & ~15;
@@ -62,7 +65,18 @@ int vp8_yv12_realloc_frame_buffer(YV12_BUFFER_CONFIG *ybf, int width,
     int uvplane_size = (uv_height + border) * uv_stride;
     const size_t frame_size = yplane_size + 2 * uvplane_size;
 
-    if (!ybf->buffer_alloc) {
+    if (cb != NULL) {
+      const size_t external_frame_size = frame_size + 31;
+
+      assert(fb != NULL);
+      assert(ybf->buffer_alloc_sz == 0);
+
+      if (cb(cb_priv, external_frame_size, fb) < 0) return -1;
+
+      if (fb->data == NULL || fb->size < external_frame_size) return -1;
+
+      ybf->buffer_alloc = (uint8_t *)yv12_align_addr(fb->data, 32);
+    } else if (!ybf->buffer_alloc) {
       ybf->buffer_alloc = (uint8_t *)vpx_memalign(32, frame_size);
 #if defined(__has_feature)
 #if __has_feature(memory_sanitizer)
@@ -75,7 +89,8 @@ int vp8_yv12_realloc_frame_buffer(YV12_BUFFER_CONFIG *ybf, int width,
       ybf->buffer_alloc_sz = frame_size;
     }
 
-    if (!ybf->buffer_alloc || ybf->buffer_alloc_sz < frame_size) return -1;
+    if (!ybf->buffer_alloc) return -1;
+    if (cb == NULL && ybf->buffer_alloc_sz < frame_size) return -1;
 
     /* Only support allocating buffers that have a border that's a multiple
      * of 32. The border restriction is required to get 16-byte alignment of
@@ -116,6 +131,24 @@ int vp8_yv12_realloc_frame_buffer(YV12_BUFFER_CONFIG *ybf, int width,
   return -2;
 }
 
+int vp8_yv12_realloc_frame_buffer(YV12_BUFFER_CONFIG *ybf, int width,
+                                  int height, int border) {
+  return vp8_realloc_frame_buffer(ybf, width, height, border, NULL, NULL, NULL);
+}
+
+int vp8_yv12_alloc_ext_frame_buffer(YV12_BUFFER_CONFIG *ybf, int width,
+                                    int height, int border,
+                                    vpx_codec_frame_buffer_t *fb,
+                                    vpx_get_frame_buffer_cb_fn_t cb,
+                                    void *cb_priv) {
+  if (ybf) {
+    vp8_yv12_de_alloc_frame_buffer(ybf);
+    return vp8_realloc_frame_buffer(ybf, width, height, border, fb, cb,
+                                    cb_priv);
+  }
+  return -2;
+}
+
 int vp8_yv12_alloc_frame_buffer(YV12_BUFFER_CONFIG *ybf, int width, int height,
                                 int border) {
   if (ybf) {
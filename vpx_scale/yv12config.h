@@ -72,6 +72,15 @@ int vp8_yv12_realloc_frame_buffer(YV12_BUFFER_CONFIG *ybf, int width,
                                   int height, int border);
 int vp8_yv12_de_alloc_frame_buffer(YV12_BUFFER_CONFIG *ybf);
 
+// Same as vp8_yv12_alloc_frame_buffer(), but the memory is requested from the
+// application with cb. vp8_yv12_de_alloc_frame_buffer() does not free it; the
+// caller hands fb back to the application once it is done with the frame.
+int vp8_yv12_alloc_ext_frame_buffer(YV12_BUFFER_CONFIG *ybf, int width,
+                                    int height, int border,
+                                    vpx_codec_frame_buffer_t *fb,
+                                    vpx_get_frame_buffer_cb_fn_t cb,
+                                    void *cb_priv);
+
 int vpx_alloc_frame_buffer(YV12_BUFFER_CONFIG *ybf, int width, int height,
                            int ss_x, int ss_y,
 #if CONFIG_VP9_HIGHBITDEPTH
@@ -23,6 +23,23 @@ struct VPxWorkerImpl {
   pthread_mutex_t mutex_;
   pthread_cond_t condition_;
   pthread_t thread_;
+  // Pool running the hook, NULL if the worker owns thread_.
+  VPxWorkerPool *pool_;
+  // Next worker waiting for a thread of the pool.
+  VPxWorker *next_;
+};
+
+struct VPxWorkerPool {
+  pthread_mutex_t mutex_;
+  pthread_cond_t condition_;
+  pthread_t *threads_;
+  int max_threads_;
+  int num_threads_;
+  int num_idle_;
+  int shutdown_;
+  // Launched workers waiting for a thread, oldest first.
+  VPxWorker *head_;
+  VPxWorker *tail_;
 };
 
 //------------------------------------------------------------------------------
@@ -50,6 +67,62 @@ static THREADFN thread_loop(void *ptr) {
   return THREAD_RETURN(NULL);  // Thread is finished
 }
 
+static THREADFN pool_thread_loop(void *ptr) {
+  VPxWorkerPool *const pool = (VPxWorkerPool *)ptr;
+  pthread_mutex_lock(&pool->mutex_);
+  while (1) {
+    VPxWorker *worker;
+    while (pool->head_ == NULL && !pool->shutdown_) {
+      ++pool->num_idle_;
+      pthread_cond_wait(&pool->condition_, &pool->mutex_);
+      --pool->num_idle_;
+    }
+    if (pool->head_ == NULL) break;  // finish the pool
+    worker = pool->head_;
+    pool->head_ = worker->impl_->next_;
+    if (pool->head_ == NULL) pool->tail_ = NULL;
+    pthread_mutex_unlock(&pool->mutex_);
+
+    execute(worker);
+    // signal to the main thread that we're done (for sync())
+    pthread_mutex_lock(&worker->impl_->mutex_);
+    worker->status_ = OK;
+    pthread_cond_signal(&worker->impl_->condition_);
+    pthread_mutex_unlock(&worker->impl_->mutex_);
+
+    pthread_mutex_lock(&pool->mutex_);
+  }
+  pthread_mutex_unlock(&pool->mutex_);
+  return THREAD_RETURN(NULL);  // Thread is finished
+}
+
+// Queues a worker in the WORK state for the next free thread of the pool.
+// Returns 0 if no thread could run it.
+static int pool_queue(VPxWorkerPool *const pool, VPxWorker *const worker) {
+  int ok = 1;
+  pthread_mutex_lock(&pool->mutex_);
+  worker->impl_->next_ = NULL;
+  if (pool->tail_ != NULL) {
+    pool->tail_->impl_->next_ = worker;
+  } else {
+    pool->head_ = worker;
+  }
+  pool->tail_ = worker;
+
+  if (pool->num_idle_ == 0 && pool->num_threads_ < pool->max_threads_) {
+    if (!pthread_create(&pool->threads_[pool->num_threads_], NULL,
+                        pool_thread_loop, pool)) {
+      ++pool->num_threads_;
+    } else if (pool->num_threads_ == 0) {
+      pool->head_ = pool->tail_ = NULL;
+      ok = 0;
+    }
+  }
+  pthread_cond_signal(&pool->condition_);
+  pthread_mutex_unlock(&pool->mutex_);
+  return ok;
+}
+
 // main thread state control
 static void change_state(VPxWorker *const worker, VPxWorkerStatus new_status) {
   // No-op when attempting to change state on a thread that didn't come up.
@@ -105,6 +178,12 @@ static int reset(VPxWorker *const worker) {
       pthread_mutex_destroy(&worker->impl_->mutex_);
       goto Error;
     }
+    worker->impl_->pool_ = worker->pool;
+    if (worker->impl_->pool_ != NULL) {
+      // The threads of the pool are started on launch.
+      worker->status_ = OK;
+      return ok;
+    }
     pthread_mutex_lock(&worker->impl_->mutex_);
     ok = !pthread_create(&worker->impl_->thread_, NULL, thread_loop, worker);
     if (ok) worker->status_ = OK;
@@ -136,6 +215,14 @@ static void execute(VPxWorker *const worker) {
 static void launch(VPxWorker *const worker) {
 #if CONFIG_MULTITHREAD
   change_state(worker, WORK);
+  if (worker->impl_ != NULL && worker->impl_->pool_ != NULL &&
+      !pool_queue(worker->impl_->pool_, worker)) {
+    // No thread could be started, run the hook in the calling thread.
+    execute(worker);
+    pthread_mutex_lock(&worker->impl_->mutex_);
+    worker->status_ = OK;
+    pthread_mutex_unlock(&worker->impl_->mutex_);
+  }
 #else
   execute(worker);
 #endif
@@ -145,7 +232,9 @@ static void end(VPxWorker *const worker) {
 #if CONFIG_MULTITHREAD
   if (worker->impl_ != NULL) {
     change_state(worker, NOT_OK);
-    pthread_join(worker->impl_->thread_, NULL);
+    if (worker->impl_->pool_ == NULL) {
+      pthread_join(worker->impl_->thread_, NULL);
+    }
     pthread_mutex_destroy(&worker->impl_->mutex_);
     pthread_cond_destroy(&worker->impl_->condition_);
     vpx_free(worker->impl_);
@@ -179,3 +268,53 @@ const VPxWorkerInterface *vpx_get_worker_interface(void) {
 }
 
 //------------------------------------------------------------------------------
+
+VPxWorkerPool *vpx_worker_pool_create(int max_threads) {
+#if CONFIG_MULTITHREAD
+  VPxWorkerPool *pool;
+  if (max_threads <= 0) return NULL;
+  pool = (VPxWorkerPool *)vpx_calloc(1, sizeof(*pool));
+  if (pool == NULL) return NULL;
+  pool->threads_ =
+      (pthread_t *)vpx_calloc(max_threads, sizeof(*pool->threads_));
+  if (pool->threads_ == NULL) goto Error;
+  if (pthread_mutex_init(&pool->mutex_, NULL)) goto Error;
+  if (pthread_cond_init(&pool->condition_, NULL)) {
+    pthread_mutex_destroy(&pool->mutex_);
+    goto Error;
+  }
+  pool->max_threads_ = max_threads;
+  return pool;
+
+Error:
+  vpx_free(pool->threads_);
+  vpx_free(pool);
+  return NULL;
+#else
+  (void)max_threads;
+  return NULL;
+#endif
+}
+
+void vpx_worker_pool_destroy(VPxWorkerPool *pool) {
+#if CONFIG_MULTITHREAD
+  int i;
+  if (pool == NULL) return;
+  pthread_mutex_lock(&pool->mutex_);
+  assert(pool->head_ == NULL);
+  pool->shutdown_ = 1;
+  pthread_cond_broadcast(&pool->condition_);
+  pthread_mutex_unlock(&pool->mutex_);
+  for (i = 0; i < pool->num_threads_; ++i) {
+    pthread_join(pool->threads_[i], NULL);
+  }
+  pthread_mutex_destroy(&pool->mutex_);
+  pthread_cond_destroy(&pool->condition_);
+  vpx_free(pool->threads_);
+  vpx_free(pool);
+#else
+  (void)pool;
+#endif
+}
+
+//------------------------------------------------------------------------------
@@ -384,6 +384,9 @@ typedef int (*VPxWorkerHook)(void *, void *);
 // Platform-dependent implementation details for the worker.
 typedef struct VPxWorkerImpl VPxWorkerImpl;
 
+// Set of threads shared by the workers attached to it.
+typedef struct VPxWorkerPool VPxWorkerPool;
+
 // Synchronization object used to launch job in the worker thread
 typedef struct {
   VPxWorkerImpl *impl_;
@@ -392,6 +395,9 @@ typedef struct {
   void *data1;         // first argument passed to 'hook'
   void *data2;         // second argument passed to 'hook'
   int had_error;       // return value of the last call to 'hook'
+  // If set before reset(), the hook is run by a thread of the pool instead
+  // of a thread owned by the worker.
+  VPxWorkerPool *pool;
 } VPxWorker;
 
 // The interface for all thread-worker related functions. All these functions
@@ -429,6 +435,16 @@ int vpx_set_worker_interface(const VPxWorkerInterface *const winterface);
 // Retrieve the currently set thread worker interface.
 const VPxWorkerInterface *vpx_get_worker_interface(void);
 
+// Creates a pool running the hooks of its workers on at most 'max_threads'
+// threads, started on demand. Launched workers are run in launch order, so a
+// hook must only wait on hooks launched before it, or on work taken by hooks
+// already running. Returns NULL in case of error or without multithreading.
+VPxWorkerPool *vpx_worker_pool_create(int max_threads);
+
+// Stops the threads of the pool. All the workers attached to it must have
+// been ended.
+void vpx_worker_pool_destroy(VPxWorkerPool *pool);
+
 //------------------------------------------------------------------------------
 
 #ifdef __cplusplus
@@ -103,6 +103,12 @@ static const arg_def_t rowmtarg =
 static const arg_def_t lpfoptarg =
     ARG_DEF(NULL, "lpf-opt", 1,
             "Do loopfilter without waiting for all threads to sync.");
+static const arg_def_t mcprefetcharg =
+    ARG_DEF(NULL, "mc-prefetch", 1,
+            "Superblocks ahead to prefetch the reference blocks of in VP9 "
+            "row-mt (0: off)");
+static const arg_def_t decodestatsarg = ARG_DEF(
+    NULL, "decode-stats", 0, "Show the time of each decoding stage in VP9");
 
 static const arg_def_t *all_args[] = { &help,
                                        &codecarg,
@@ -132,6 +138,8 @@ static const arg_def_t *all_args[] = { &help,
                                        &framestatsarg,
                                        &rowmtarg,
                                        &lpfoptarg,
+                                       &mcprefetcharg,
+                                       &decodestatsarg,
                                        NULL };
 
 #if CONFIG_VP8_DECODER
@@ -362,6 +370,24 @@ static void show_progress(int frame_in, int frame_out, uint64_t dx_time) {
           (double)frame_out * 1000000.0 / (double)dx_time);
 }
 
+static void show_decode_stats(const vpx_decode_stats *stats) {
+  static const char *const stage_names[VPX_DECODE_STAGES] = {
+    "header",      "mode info", "coeffs",   "prediction",  "inv transform",
+    "loop filter", "postproc",  "job wait", "lf sync wait"
+  };
+  int i, t;
+
+  fprintf(stderr, "%-14s %10s", "stage", "total ms");
+  for (t = 0; t < stats->num_threads; ++t) fprintf(stderr, "  thread%2d", t);
+  fprintf(stderr, "\n");
+  for (i = 0; i < VPX_DECODE_STAGES; ++i) {
+    fprintf(stderr, "%-14s %10.2f", stage_names[i], stats->time[i] / 1e6);
+    for (t = 0; t < stats->num_threads; ++t)
+      fprintf(stderr, " %10.2f", stats->thread_time[t][i] / 1e6);
+    fprintf(stderr, "\n");
+  }
+}
+
 struct ExternalFrameBuffer {
   uint8_t *data;
   size_t size;
@@ -530,6 +556,8 @@ static int main_loop(int argc, const char **argv_) {
   int keep_going = 0;
   int enable_row_mt = 0;
   int enable_lpf_opt = 0;
+  int mc_prefetch = 0;
+  int decode_stats = 0;
   const VpxInterface *interface = NULL;
   const VpxInterface *fourcc_interface = NULL;
   uint64_t dx_time = 0;
@@ -656,6 +684,10 @@ static int main_loop(int argc, const char **argv_) {
       enable_row_mt = arg_parse_uint(&arg);
     } else if (arg_match(&arg, &lpfoptarg, argi)) {
       enable_lpf_opt = arg_parse_uint(&arg);
+    } else if (arg_match(&arg, &mcprefetcharg, argi)) {
+      mc_prefetch = arg_parse_uint(&arg);
+    } else if (arg_match(&arg, &decodestatsarg, argi)) {
+      decode_stats = 1;
     }
 #if CONFIG_VP8_DECODER
     else if (arg_match(&arg, &addnoise_level, argi)) {
@@ -794,6 +826,18 @@ static int main_loop(int argc, const char **argv_) {
             vpx_codec_error(&decoder));
     goto fail;
   }
+  if (interface->fourcc == VP9_FOURCC &&
+      vpx_codec_control(&decoder, VP9D_SET_MC_PREFETCH, mc_prefetch)) {
+    fprintf(stderr, "Failed to set decoder motion compensation prefetch: %s\n",
+            vpx_codec_error(&decoder));
+    goto fail;
+  }
+  if (interface->fourcc == VP9_FOURCC && decode_stats &&
+      vpx_codec_control(&decoder, VP9D_SET_DECODE_STATS, 1)) {
+    fprintf(stderr, "Failed to enable decode stats: %s\n",
+            vpx_codec_error(&decoder));
+    goto fail;
+  }
   if (!quiet) fprintf(stderr, "%s\n", decoder.name);
 
 #if CONFIG_VP8_DECODER
@@ -1054,6 +1098,12 @@ static int main_loop(int argc, const char **argv_) {
     fprintf(stderr, "\n");
   }
 
+  if (interface->fourcc == VP9_FOURCC && decode_stats) {
+    vpx_decode_stats stats;
+    if (!vpx_codec_control(&decoder, VP9D_GET_DECODE_STATS, &stats))
+      show_decode_stats(&stats);
+  }
+
   if (frames_corrupted) {
     fprintf(stderr, "WARNING: %d frames corrupted.\n", frames_corrupted);
   } else {